@@ -78,6 +78,171 @@ static int nsec3_hash(gnutls_digest_algorithm_t algorithm, int iterations,
 	return DNSSEC_EOK;
 }
 
+/*
+ * Batched iterated SHA-1 in parallel lanes.
+ *
+ * All iterations after the first one hash a message of the same length
+ * (previous hash and salt) for each name, so the names can be processed in
+ * lock-step. The lanes are mapped to SIMD registers using vector extensions
+ * of the compiler (SSE2/AVX2 on x86, NEON on ARM), or to a single scalar
+ * otherwise.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+# if defined(__AVX2__)
+#  define SHA1_LANES 8
+# else
+#  define SHA1_LANES 4
+# endif
+typedef uint32_t lane_t __attribute__((vector_size(SHA1_LANES * sizeof(uint32_t))));
+#else
+# define SHA1_LANES 1
+typedef uint32_t lane_t;
+#endif
+
+#define SHA1_WORDS 5
+#define SHA1_BLOCK_WORDS 16
+#define SHA1_MAX_BLOCKS 5 /* 20 bytes of hash, 255 bytes of salt, padding. */
+
+#define ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+static lane_t lane_set(uint32_t value)
+{
+	uint32_t values[SHA1_LANES];
+	for (int i = 0; i < SHA1_LANES; i++) {
+		values[i] = value;
+	}
+
+	lane_t result;
+	memcpy(&result, values, sizeof(result));
+	return result;
+}
+
+static uint32_t read_be32(const uint8_t *data)
+{
+	return (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16 |
+	       (uint32_t)data[2] << 8 | (uint32_t)data[3];
+}
+
+static void write_be32(uint8_t *data, uint32_t value)
+{
+	data[0] = value >> 24;
+	data[1] = value >> 16;
+	data[2] = value >> 8;
+	data[3] = value;
+}
+
+/*!
+ * SHA-1 compression function for all lanes.
+ */
+static void sha1_lanes_compress(lane_t state[SHA1_WORDS],
+				const lane_t block[SHA1_BLOCK_WORDS])
+{
+	lane_t w[SHA1_BLOCK_WORDS];
+	memcpy(w, block, sizeof(w));
+
+	lane_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+#define SCHEDULE(t) (w[(t) & 15] = ROL(w[((t) - 3) & 15] ^ w[((t) - 8) & 15] ^ \
+                                       w[((t) - 14) & 15] ^ w[(t) & 15], 1))
+#define ROUND(f, k, wt) do { \
+		lane_t tmp = ROL(a, 5) + (f) + e + lane_set(k) + (wt); \
+		e = d; d = c; c = ROL(b, 30); b = a; a = tmp; \
+	} while (0)
+
+	for (int t = 0; t < 16; t++) {
+		ROUND((b & c) | (~b & d), 0x5a827999, w[t]);
+	}
+	for (int t = 16; t < 20; t++) {
+		ROUND((b & c) | (~b & d), 0x5a827999, SCHEDULE(t));
+	}
+	for (int t = 20; t < 40; t++) {
+		ROUND(b ^ c ^ d, 0x6ed9eba1, SCHEDULE(t));
+	}
+	for (int t = 40; t < 60; t++) {
+		ROUND((b & c) | (b & d) | (c & d), 0x8f1bbcdc, SCHEDULE(t));
+	}
+	for (int t = 60; t < 80; t++) {
+		ROUND(b ^ c ^ d, 0xca62c1d6, SCHEDULE(t));
+	}
+
+#undef ROUND
+#undef SCHEDULE
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+}
+
+/*!
+ * Compute remaining NSEC3 SHA-1 iterations for up to SHA1_LANES hashes.
+ *
+ * \param hashes      Hashes after the first iteration, updated in place.
+ * \param count       Number of hashes (unused lanes are computed in vain).
+ * \param iterations  Number of remaining iterations.
+ * \param salt        NSEC3 salt.
+ */
+static void nsec3_sha1_lanes(dnssec_binary_t *hashes, size_t count,
+			     int iterations, const dnssec_binary_t *salt)
+{
+	assert(count > 0 && count <= SHA1_LANES);
+
+	/* Padded message template (hash, salt, padding, bit length). */
+	size_t msg_size = SHA1_WORDS * sizeof(uint32_t) + salt->size;
+	size_t blocks = (msg_size + 8) / 64 + 1;
+	assert(blocks <= SHA1_MAX_BLOCKS);
+
+	uint8_t msg[SHA1_MAX_BLOCKS * 64] = { 0 };
+	memcpy(msg + SHA1_WORDS * sizeof(uint32_t), salt->data, salt->size);
+	msg[msg_size] = 0x80;
+	uint64_t bits = (uint64_t)msg_size * 8;
+	write_be32(msg + blocks * 64 - 8, bits >> 32);
+	write_be32(msg + blocks * 64 - 4, bits);
+
+	lane_t block[SHA1_MAX_BLOCKS][SHA1_BLOCK_WORDS];
+	for (size_t i = 0; i < blocks * SHA1_BLOCK_WORDS; i++) {
+		block[i / SHA1_BLOCK_WORDS][i % SHA1_BLOCK_WORDS] =
+			lane_set(read_be32(msg + i * sizeof(uint32_t)));
+	}
+
+	/* Previous hashes as message words. */
+	uint32_t words[SHA1_WORDS][SHA1_LANES] = { { 0 } };
+	for (size_t lane = 0; lane < count; lane++) {
+		for (int i = 0; i < SHA1_WORDS; i++) {
+			words[i][lane] = read_be32(hashes[lane].data + i * sizeof(uint32_t));
+		}
+	}
+	for (int i = 0; i < SHA1_WORDS; i++) {
+		memcpy(&block[0][i], words[i], sizeof(lane_t));
+	}
+
+	const uint32_t iv[SHA1_WORDS] = {
+		0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0
+	};
+
+	lane_t state[SHA1_WORDS];
+	for (int it = 0; it < iterations; it++) {
+		for (int i = 0; i < SHA1_WORDS; i++) {
+			state[i] = lane_set(iv[i]);
+		}
+		for (size_t i = 0; i < blocks; i++) {
+			sha1_lanes_compress(state, block[i]);
+		}
+		memcpy(block[0], state, sizeof(state));
+	}
+
+	for (int i = 0; i < SHA1_WORDS; i++) {
+		memcpy(words[i], &block[0][i], sizeof(lane_t));
+	}
+	for (size_t lane = 0; lane < count; lane++) {
+		for (int i = 0; i < SHA1_WORDS; i++) {
+			write_be32(hashes[lane].data + i * sizeof(uint32_t), words[i][lane]);
+		}
+	}
+}
+
 /*!
  * Get GnuTLS digest algorithm from DNSSEC algorithm number.
  */
@@ -111,6 +276,58 @@ int dnssec_nsec3_hash(const dnssec_binary_t *data,
 	return nsec3_hash(algorithm, params->iterations, &params->salt, data, hash);
 }
 
+/*!
+ * Compute NSEC3 hashes for a batch of data.
+ */
+_public_
+int dnssec_nsec3_hash_batch(const dnssec_binary_t *data, size_t count,
+			    const dnssec_nsec3_params_t *params,
+			    dnssec_binary_t *hashes)
+{
+	if ((count > 0 && (!data || !hashes)) || !params) {
+		return DNSSEC_EINVAL;
+	}
+
+	gnutls_digest_algorithm_t algorithm = algorithm_d2g(params->algorithm);
+	if (algorithm == GNUTLS_DIG_UNKNOWN) {
+		return DNSSEC_INVALID_NSEC3_ALGORITHM;
+	}
+
+	int hash_size = gnutls_hash_get_len(algorithm);
+	if (algorithm != GNUTLS_DIG_SHA1 ||
+	    hash_size != SHA1_WORDS * sizeof(uint32_t)) {
+		return DNSSEC_NSEC3_HASHING_ERROR;
+	}
+
+	_cleanup_hash_ gnutls_hash_hd_t digest = NULL;
+	int result = gnutls_hash_init(&digest, algorithm);
+	if (result < 0) {
+		return DNSSEC_NSEC3_HASHING_ERROR;
+	}
+
+	/* The first iteration hashes data of different lengths. */
+	for (size_t i = 0; i < count; i++) {
+		result = dnssec_binary_resize(&hashes[i], hash_size);
+		if (result != DNSSEC_EOK) {
+			return result;
+		}
+
+		if (gnutls_hash(digest, data[i].data, data[i].size) < 0 ||
+		    gnutls_hash(digest, params->salt.data, params->salt.size) < 0) {
+			return DNSSEC_NSEC3_HASHING_ERROR;
+		}
+
+		gnutls_hash_output(digest, hashes[i].data);
+	}
+
+	for (size_t i = 0; i < count && params->iterations > 0; i += SHA1_LANES) {
+		size_t lanes = count - i < SHA1_LANES ? count - i : SHA1_LANES;
+		nsec3_sha1_lanes(hashes + i, lanes, params->iterations, &params->salt);
+	}
+
+	return DNSSEC_EOK;
+}
+
 /*!
  * Get length of raw NSEC3 hash for a given algorithm.
  */
@@ -14,6 +14,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdbool.h>
 #include <string.h>
 #include <tap/basic.h>
 
@@ -84,6 +85,54 @@ static void test_hashing(void)
 	dnssec_binary_free(&hash);
 }
 
+static void test_hashing_batch(void)
+{
+	uint8_t names[11][64] = { { 0 } };
+	dnssec_binary_t data[11] = { { 0 } };
+	for (int i = 0; i < 11; i++) {
+		/* Names of different lengths: 'a'..'aaa...' under 'cz'. */
+		int len = 1 + i * 5;
+		names[i][0] = len;
+		memset(names[i] + 1, 'a' + i, len);
+		memcpy(names[i] + 1 + len, "\x02""cz", 4);
+		data[i].data = names[i];
+		data[i].size = len + 5;
+	}
+
+	uint8_t salt[255];
+	for (int i = 0; i < sizeof(salt); i++) {
+		salt[i] = i;
+	}
+
+	const int iterations[] = { 0, 1, 7, 150 };
+	const size_t salt_sizes[] = { 0, 14, 40, 255 };
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			const dnssec_nsec3_params_t params = {
+				.algorithm = DNSSEC_NSEC3_ALGORITHM_SHA1,
+				.iterations = iterations[i],
+				.salt = { .size = salt_sizes[j], .data = salt }
+			};
+
+			dnssec_binary_t hashes[11] = { { 0 } };
+			int result = dnssec_nsec3_hash_batch(data, 11, &params, hashes);
+
+			bool match = (result == DNSSEC_EOK);
+			for (int k = 0; k < 11; k++) {
+				dnssec_binary_t hash = { 0 };
+				dnssec_nsec3_hash(&data[k], &params, &hash);
+				match = match && dnssec_binary_cmp(&hash, &hashes[k]) == 0;
+				dnssec_binary_free(&hash);
+				dnssec_binary_free(&hashes[k]);
+			}
+
+			ok(match, "dnssec_nsec3_hash_batch(), %d iterations, "
+			   "%zu bytes of salt", iterations[i], salt_sizes[j]);
+		}
+	}
+}
+
 static void test_clear(void)
 {
 	const dnssec_nsec3_params_t empty = { 0 };
@@ -107,6 +156,7 @@ int main(void)
 	test_length();
 	test_parsing();
 	test_hashing();
+	test_hashing_batch();
 	test_clear();
 
 	return 0;
@@ -0,0 +1,56 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*!
+ * \file
+ *
+ * \brief Static user-space tracing probes (USDT).
+ *
+ * The probes are compiled in only if configured with --enable-usdt, and
+ * belong to the 'knot' provider. Otherwise the macros expand to nothing,
+ * so probe arguments must not have side effects.
+ *
+ * \addtogroup common_lib
+ * @{
+ */
+
+#pragma once
+
+#ifdef ENABLE_USDT
+
+#include <sys/sdt.h>
+
+#define KNOT_PROBE(name) \
+	DTRACE_PROBE(knot, name)
+#define KNOT_PROBE1(name, a1) \
+	DTRACE_PROBE1(knot, name, a1)
+#define KNOT_PROBE2(name, a1, a2) \
+	DTRACE_PROBE2(knot, name, a1, a2)
+#define KNOT_PROBE3(name, a1, a2, a3) \
+	DTRACE_PROBE3(knot, name, a1, a2, a3)
+#define KNOT_PROBE4(name, a1, a2, a3, a4) \
+	DTRACE_PROBE4(knot, name, a1, a2, a3, a4)
+
+#else
+
+#define KNOT_PROBE(name)
+#define KNOT_PROBE1(name, a1)
+#define KNOT_PROBE2(name, a1, a2)
+#define KNOT_PROBE3(name, a1, a2, a3)
+#define KNOT_PROBE4(name, a1, a2, a3, a4)
+
+#endif /* ENABLE_USDT */
+
+/*! @} */
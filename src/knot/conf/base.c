@@ -133,6 +133,18 @@ static void init_cache(
 	val = conf_get(conf, C_SRV, C_MAX_TCP_CLIENTS);
 	conf->cache.srv_max_tcp_clients = conf_int(&val);
 
+	val = conf_get(conf, C_SRV, C_MAX_TCP_PREFIX);
+	conf->cache.srv_max_tcp_prefix = conf_int(&val);
+
+	val = conf_get(conf, C_SRV, C_MAX_EXPENSIVE_QUERIES);
+	conf->cache.srv_max_expensive_queries = conf_int(&val);
+
+	val = conf_get(conf, C_SRV, C_UDP_ANSWER_CACHE);
+	conf->cache.srv_udp_answer_cache = conf_int(&val);
+
+	val = conf_get(conf, C_SRV, C_MEMORY_PRESSURE);
+	conf->cache.srv_memory_pressure = conf_int(&val);
+
 	val = conf_get(conf, C_SRV, C_RATE_LIMIT_SLIP);
 	conf->cache.srv_rate_limit_slip = conf_int(&val);
 
@@ -699,7 +711,10 @@ int conf_parse(
 			                        node->data_len);
 		}
 		if (check_ret != KNOT_EOK) {
-			log_parser_err(parser, check_ret);
+			// Full database is grown and the import retried.
+			if (check_ret != KNOT_ESPACE) {
+				log_parser_err(parser, check_ret);
+			}
 			break;
 		}
 
@@ -726,39 +741,58 @@ parse_error:
 	return ret;
 }
 
-int conf_import(
+static int import_txn(
 	conf_t *conf,
 	const char *input,
 	bool is_file)
 {
-	if (conf == NULL || input == NULL) {
-		return KNOT_EINVAL;
-	}
-
-	int ret;
-
 	knot_db_txn_t txn;
-	ret = conf->api->txn_begin(conf->db, &txn, 0);
+	int ret = conf->api->txn_begin(conf->db, &txn, 0);
 	if (ret != KNOT_EOK) {
-		goto import_error;
+		return ret;
 	}
 
 	// Initialize the DB.
 	ret = conf_db_init(conf, &txn, true);
 	if (ret != KNOT_EOK) {
 		conf->api->txn_abort(&txn);
-		goto import_error;
+		return ret;
 	}
 
 	// Parse and import given file.
 	ret = conf_parse(conf, &txn, input, is_file);
 	if (ret != KNOT_EOK) {
 		conf->api->txn_abort(&txn);
-		goto import_error;
+		return ret;
 	}
 
 	// Commit new configuration.
-	ret = conf->api->txn_commit(&txn);
+	return conf->api->txn_commit(&txn);
+}
+
+int conf_import(
+	conf_t *conf,
+	const char *input,
+	bool is_file)
+{
+	if (conf == NULL || input == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	int ret;
+	while ((ret = import_txn(conf, input, is_file)) == KNOT_ESPACE) {
+		// The database can grow only if no transaction is open.
+		conf->api->txn_abort(&conf->read_txn);
+		int grow_ret = knot_db_lmdb_grow(conf->db);
+		ret = conf->api->txn_begin(conf->db, &conf->read_txn, KNOT_DB_RDONLY);
+		if (ret != KNOT_EOK) {
+			goto import_error;
+		}
+		if (grow_ret != KNOT_EOK) {
+			ret = KNOT_ESPACE;
+			break;
+		}
+	}
 	if (ret != KNOT_EOK) {
 		goto import_error;
 	}
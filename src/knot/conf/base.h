@@ -106,6 +106,10 @@ typedef struct {
 		int32_t srv_tcp_idle_timeout;
 		int32_t srv_tcp_reply_timeout;
 		int32_t srv_max_tcp_clients;
+		int32_t srv_max_tcp_prefix;
+		int32_t srv_max_expensive_queries;
+		int32_t srv_udp_answer_cache;
+		int32_t srv_memory_pressure;
 		int32_t srv_rate_limit_slip;
 		int32_t ctl_timeout;
 		conf_val_t srv_nsid;
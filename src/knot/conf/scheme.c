@@ -87,6 +87,13 @@ static const knot_lookup_t serial_policies[] = {
 	{ 0, NULL }
 };
 
+static const knot_lookup_t warm_up_modes[] = {
+	{ WARM_UP_NONE, "none" },
+	{ WARM_UP_HOT,  "hot" },
+	{ WARM_UP_FULL, "full" },
+	{ 0, NULL }
+};
+
 static const knot_lookup_t log_severities[] = {
 	{ LOG_UPTO(LOG_CRIT),    "critical" },
 	{ LOG_UPTO(LOG_ERR),     "error" },
@@ -106,12 +113,18 @@ static const yp_item_t desc_server[] = {
 	{ C_PIDFILE,              YP_TSTR,  YP_VSTR = { "knot.pid" } },
 	{ C_UDP_WORKERS,          YP_TINT,  YP_VINT = { 1, 255, YP_NIL } },
 	{ C_TCP_WORKERS,          YP_TINT,  YP_VINT = { 1, 255, YP_NIL } },
+	{ C_MIN_UDP_WORKERS,      YP_TINT,  YP_VINT = { 1, 255, YP_NIL } },
+	{ C_MIN_TCP_WORKERS,      YP_TINT,  YP_VINT = { 1, 255, YP_NIL } },
 	{ C_BG_WORKERS,           YP_TINT,  YP_VINT = { 1, 255, YP_NIL } },
 	{ C_ASYNC_START,          YP_TBOOL, YP_VNONE },
 	{ C_TCP_HSHAKE_TIMEOUT,   YP_TINT,  YP_VINT = { 0, INT32_MAX, 5, YP_STIME } },
 	{ C_TCP_IDLE_TIMEOUT,     YP_TINT,  YP_VINT = { 0, INT32_MAX, 20, YP_STIME } },
 	{ C_TCP_REPLY_TIMEOUT,    YP_TINT,  YP_VINT = { 0, INT32_MAX, 10, YP_STIME } },
 	{ C_MAX_TCP_CLIENTS,      YP_TINT,  YP_VINT = { 0, INT32_MAX, 100 } },
+	{ C_MAX_TCP_PREFIX,       YP_TINT,  YP_VINT = { 0, INT32_MAX, 0 } },
+	{ C_MAX_EXPENSIVE_QUERIES, YP_TINT, YP_VINT = { 0, INT32_MAX, 0 } },
+	{ C_UDP_ANSWER_CACHE,     YP_TINT,  YP_VINT = { 0, INT32_MAX, 0 } },
+	{ C_MEMORY_PRESSURE,      YP_TINT,  YP_VINT = { 0, 100, 90 } },
 	{ C_MAX_UDP_PAYLOAD,      YP_TINT,  YP_VINT = { KNOT_EDNS_MIN_UDP_PAYLOAD,
 	                                                KNOT_EDNS_MAX_UDP_PAYLOAD,
 	                                                4096, YP_SSIZE } },
@@ -127,6 +140,9 @@ static const yp_item_t desc_server[] = {
 	{ C_RATE_LIMIT_WHITELIST, YP_TDATA, YP_VDATA = { 0, NULL, addr_range_to_bin,
 	                                                 addr_range_to_txt }, YP_FMULTI },
 	{ C_LISTEN,               YP_TADDR, YP_VADDR = { 53 }, YP_FMULTI },
+	{ C_LISTEN_TLS,           YP_TADDR, YP_VADDR = { 853 }, YP_FMULTI },
+	{ C_CERT_FILE,            YP_TSTR,  YP_VNONE },
+	{ C_KEY_FILE,             YP_TSTR,  YP_VNONE },
 	{ C_COMMENT,              YP_TSTR,  YP_VNONE },
 	{ NULL }
 };
@@ -226,6 +242,8 @@ static const yp_item_t desc_remote[] = {
 	{ C_ACL,                 YP_TREF,  YP_VREF = { C_ACL }, YP_FMULTI, { check_ref } }, \
 	{ C_SEM_CHECKS,          YP_TBOOL, YP_VNONE, FLAGS }, \
 	{ C_DISABLE_ANY,         YP_TBOOL, YP_VNONE }, \
+	{ C_ALIAS_OF,            YP_TDNAME, YP_VNONE, FLAGS }, \
+	{ C_CATALOG,             YP_TBOOL, YP_VNONE, FLAGS }, \
 	{ C_ZONEFILE_SYNC,       YP_TINT,  YP_VINT = { -1, INT32_MAX, 0, YP_STIME } }, \
 	{ C_IXFR_DIFF,           YP_TBOOL, YP_VNONE }, \
 	{ C_MAX_JOURNAL_SIZE,    YP_TINT,  YP_VINT = { 0, INT64_MAX, INT64_MAX, YP_SSIZE }, \
@@ -235,7 +253,9 @@ static const yp_item_t desc_remote[] = {
 	{ C_KASP_DB,             YP_TSTR,  YP_VSTR = { "keys" }, FLAGS }, \
 	{ C_DNSSEC_SIGNING,      YP_TBOOL, YP_VNONE, FLAGS }, \
 	{ C_DNSSEC_POLICY,       YP_TREF,  YP_VREF = { C_POLICY }, FLAGS, { check_ref_dflt } }, \
+	{ C_DNSSEC_VALIDATION,   YP_TBOOL, YP_VNONE }, \
 	{ C_SERIAL_POLICY,       YP_TOPT,  YP_VOPT = { serial_policies, SERIAL_POLICY_INCREMENT } }, \
+	{ C_WARM_UP,             YP_TOPT,  YP_VOPT = { warm_up_modes, WARM_UP_NONE }, FLAGS }, \
 	{ C_REQUEST_EDNS_OPTION, YP_TDATA, YP_VDATA = { 0, NULL, edns_opt_to_bin, edns_opt_to_txt } }, \
 	{ C_MODULE,              YP_TDATA, YP_VDATA = { 0, NULL, mod_id_to_bin, mod_id_to_txt }, \
 	                                   YP_FMULTI | FLAGS, { check_modref } }, \
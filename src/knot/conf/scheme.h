@@ -32,10 +32,13 @@
 #define C_ACTION		"\x06""action"
 #define C_ADDR			"\x07""address"
 #define C_ALG			"\x09""algorithm"
+#define C_ALIAS_OF		"\x08""alias-of"
 #define C_ANY			"\x03""any"
 #define C_ASYNC_START		"\x0B""async-start"
 #define C_BACKEND		"\x07""backend"
 #define C_BG_WORKERS		"\x12""background-workers"
+#define C_CATALOG		"\x07""catalog"
+#define C_CERT_FILE		"\x09""cert-file"
 #define C_COMMENT		"\x07""comment"
 #define C_CONFIG		"\x06""config"
 #define C_CTL			"\x07""control"
@@ -45,6 +48,7 @@
 #define C_DNSKEY_TTL		"\x0A""dnskey-ttl"
 #define C_DNSSEC_POLICY		"\x0D""dnssec-policy"
 #define C_DNSSEC_SIGNING	"\x0E""dnssec-signing"
+#define C_DNSSEC_VALIDATION	"\x11""dnssec-validation"
 #define C_DOMAIN		"\x06""domain"
 #define C_FILE			"\x04""file"
 #define C_GLOBAL_MODULE		"\x0D""global-module"
@@ -56,17 +60,24 @@
 #define C_KASP_DB		"\x07""kasp-db"
 #define C_KEY			"\x03""key"
 #define C_KEYSTORE		"\x08""keystore"
+#define C_KEY_FILE		"\x08""key-file"
 #define C_KSK_SIZE		"\x08""ksk-size"
 #define C_LISTEN		"\x06""listen"
+#define C_LISTEN_TLS		"\x0A""listen-tls"
 #define C_LOG			"\x03""log"
 #define C_MANUAL		"\x06""manual"
 #define C_MASTER		"\x06""master"
+#define C_MAX_EXPENSIVE_QUERIES	"\x15""max-expensive-queries"
 #define C_MAX_JOURNAL_SIZE	"\x10""max-journal-size"
 #define C_MAX_TCP_CLIENTS	"\x0F""max-tcp-clients"
+#define C_MAX_TCP_PREFIX	"\x1A""max-tcp-clients-per-prefix"
 #define C_MAX_UDP_PAYLOAD	"\x0F""max-udp-payload"
 #define C_MAX_ZONE_SIZE		"\x0D""max-zone-size"
 #define C_MAX_IPV4_UDP_PAYLOAD	"\x14""max-ipv4-udp-payload"
 #define C_MAX_IPV6_UDP_PAYLOAD	"\x14""max-ipv6-udp-payload"
+#define C_MEMORY_PRESSURE	"\x0F""memory-pressure"
+#define C_MIN_TCP_WORKERS	"\x0F""min-tcp-workers"
+#define C_MIN_UDP_WORKERS	"\x0F""min-udp-workers"
 #define C_MODULE		"\x06""module"
 #define C_NOTIFY		"\x06""notify"
 #define C_NSEC3			"\x05""nsec3"
@@ -100,10 +111,12 @@
 #define C_TIMEOUT		"\x07""timeout"
 #define C_TIMER_DB		"\x08""timer-db"
 #define C_TPL			"\x08""template"
+#define C_UDP_ANSWER_CACHE	"\x10""udp-answer-cache"
 #define C_UDP_WORKERS		"\x0B""udp-workers"
 #define C_USER			"\x04""user"
 #define C_VERSION		"\x07""version"
 #define C_VIA			"\x03""via"
+#define C_WARM_UP		"\x07""warm-up"
 #define C_ZONE			"\x04""zone"
 #define C_ZONEFILE_SYNC		"\x0D""zonefile-sync"
 #define C_ZSK_LIFETIME		"\x0C""zsk-lifetime"
@@ -119,6 +132,12 @@ enum {
 	SERIAL_POLICY_UNIXTIME  = 2
 };
 
+enum {
+	WARM_UP_NONE = 1,
+	WARM_UP_HOT  = 2,
+	WARM_UP_FULL = 3
+};
+
 extern const knot_lookup_t acl_actions[];
 
 extern const yp_item_t conf_scheme[];
@@ -497,6 +497,42 @@ int check_zone(
 		return KNOT_EINVAL;
 	}
 
+	// Zone alias has no own contents.
+	conf_val_t alias = conf_zone_get_txn(args->conf, args->txn,
+	                                     C_ALIAS_OF, args->id);
+	if (alias.code == KNOT_EOK) {
+		if (knot_dname_is_equal(conf_dname(&alias), args->id)) {
+			args->err_str = "zone alias of itself";
+			return KNOT_EINVAL;
+		}
+		if (conf_val_count(&master) > 0 || conf_bool(&dnssec)) {
+			args->err_str = "zone alias with master or DNSSEC signing";
+			return KNOT_EINVAL;
+		}
+
+		// The aliased zone must be configured with own contents.
+		conf_val(&alias);
+		if (!conf_rawid_exists_txn(args->conf, args->txn, C_ZONE,
+		                           alias.data, alias.len)) {
+			args->err_str = "zone alias of a non-existent zone";
+			return KNOT_EINVAL;
+		}
+		conf_val_t target = conf_zone_get_txn(args->conf, args->txn,
+		                                      C_ALIAS_OF, alias.data);
+		if (target.code == KNOT_EOK) {
+			args->err_str = "zone alias of a zone alias";
+			return KNOT_EINVAL;
+		}
+	}
+
+	// Catalog zone must have its own contents.
+	conf_val_t catalog = conf_zone_get_txn(args->conf, args->txn,
+	                                       C_CATALOG, args->id);
+	if (alias.code == KNOT_EOK && conf_bool(&catalog)) {
+		args->err_str = "catalog zone alias";
+		return KNOT_EINVAL;
+	}
+
 	conf_val_t signing = conf_zone_get_txn(args->conf, args->txn,
 	                                       C_DNSSEC_SIGNING, args->id);
 	conf_val_t policy = conf_zone_get_txn(args->conf, args->txn,
@@ -14,6 +14,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <inttypes.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -247,6 +248,64 @@ static int zone_status(zone_t *zone, ctl_args_t *args)
 	return knot_ctl_send(args->ctl, KNOT_CTL_TYPE_EXTRA, &data);
 }
 
+static int zone_cputime(zone_t *zone, ctl_args_t *args)
+{
+	// Zone name.
+	char name[KNOT_DNAME_TXT_MAXLEN + 1];
+	if (knot_dname_to_str(name, zone->name, sizeof(name)) == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	knot_ctl_data_t data = {
+		[KNOT_CTL_IDX_ZONE] = name
+	};
+
+	zone_cputime_stats_t stats;
+	zone_cputime_get(zone->cputime, &stats);
+
+	// Estimated query time.
+	char buff[64];
+	int ret = snprintf(buff, sizeof(buff), "%"PRIu64".%06"PRIu64"s",
+	                   stats.query_ns / 1000000000,
+	                   stats.query_ns % 1000000000 / 1000);
+	if (ret < 0 || ret >= sizeof(buff)) {
+		return KNOT_ESPACE;
+	}
+
+	data[KNOT_CTL_IDX_TYPE] = "queries";
+	data[KNOT_CTL_IDX_DATA] = buff;
+
+	ret = knot_ctl_send(args->ctl, KNOT_CTL_TYPE_DATA, &data);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	// Executed events.
+	for (zone_event_type_t type = 0; type < ZONE_EVENT_COUNT; type++) {
+		if (stats.event_count[type] == 0) {
+			continue;
+		}
+
+		ret = snprintf(buff, sizeof(buff), "%"PRIu64".%06"PRIu64"s, %"PRIu64" runs",
+		               stats.event_ns[type] / 1000000000,
+		               stats.event_ns[type] % 1000000000 / 1000,
+		               stats.event_count[type]);
+		if (ret < 0 || ret >= sizeof(buff)) {
+			return KNOT_ESPACE;
+		}
+
+		data[KNOT_CTL_IDX_TYPE] = zone_events_get_name(type);
+		data[KNOT_CTL_IDX_DATA] = buff;
+
+		ret = knot_ctl_send(args->ctl, KNOT_CTL_TYPE_EXTRA, &data);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
 static int zone_reload(zone_t *zone, ctl_args_t *args)
 {
 	UNUSED(args);
@@ -943,6 +1002,8 @@ static int ctl_zone(ctl_args_t *args, ctl_cmd_t cmd)
 	switch (cmd) {
 	case CTL_ZONE_STATUS:
 		return zones_apply(args, zone_status);
+	case CTL_ZONE_CPUTIME:
+		return zones_apply(args, zone_cputime);
 	case CTL_ZONE_RELOAD:
 		return zones_apply(args, zone_reload);
 	case CTL_ZONE_REFRESH:
@@ -1268,6 +1329,7 @@ static const desc_t cmd_table[] = {
 	[CTL_RELOAD]          = { "reload",          ctl_server },
 
 	[CTL_ZONE_STATUS]     = { "zone-status",     ctl_zone },
+	[CTL_ZONE_CPUTIME]    = { "zone-cputime",    ctl_zone },
 	[CTL_ZONE_RELOAD]     = { "zone-reload",     ctl_zone },
 	[CTL_ZONE_REFRESH]    = { "zone-refresh",    ctl_zone },
 	[CTL_ZONE_RETRANSFER] = { "zone-retransfer", ctl_zone },
@@ -40,6 +40,7 @@ typedef enum {
 	CTL_RELOAD,
 
 	CTL_ZONE_STATUS,
+	CTL_ZONE_CPUTIME,
 	CTL_ZONE_RELOAD,
 	CTL_ZONE_REFRESH,
 	CTL_ZONE_RETRANSFER,
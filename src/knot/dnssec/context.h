@@ -21,6 +21,7 @@
 #include <dnssec/kasp.h>
 #include <dnssec/keystore.h>
 
+#include "knot/dnssec/rrsig-cache.h"
 #include "libknot/dname.h"
 
 /*!
@@ -38,6 +39,8 @@ struct kdnssec_ctx {
 	uint32_t old_serial;
 	uint32_t new_serial;
 	bool rrsig_drop_existing;
+
+	rrsig_cache_t *rrsig_cache;	/*!< Known valid signatures, or NULL. */
 };
 
 typedef struct kdnssec_ctx kdnssec_ctx_t;
@@ -16,6 +16,7 @@
 
 #include <assert.h>
 
+#include "dnssec/error.h"
 #include "dnssec/nsec.h"
 #include "libknot/dname.h"
 #include "knot/dnssec/nsec-chain.h"
@@ -303,28 +304,25 @@ static zone_node_t *create_nsec3_node(knot_dname_t *owner,
 /*!
  * \brief Create new NSEC3 node for given regular node.
  *
- * \param node       Node for which the NSEC3 node is created.
- * \param apex       Zone apex node.
- * \param params     NSEC3 hash function parameters.
- * \param ttl        TTL of the new NSEC3 node.
+ * \param node         Node for which the NSEC3 node is created.
+ * \param nsec3_owner  Owner of the new NSEC3 node (hashed node owner).
+ * \param apex         Zone apex node.
+ * \param params       NSEC3 hash function parameters.
+ * \param ttl          TTL of the new NSEC3 node.
  *
  * \return Error code, KNOT_EOK if successful.
  */
 static zone_node_t *create_nsec3_node_for_node(zone_node_t *node,
+                                               knot_dname_t *nsec3_owner,
                                                zone_node_t *apex,
                                                const dnssec_nsec3_params_t *params,
                                                uint32_t ttl)
 {
 	assert(node);
+	assert(nsec3_owner);
 	assert(apex);
 	assert(params);
 
-	knot_dname_t *nsec3_owner;
-	nsec3_owner = knot_create_nsec3_owner(node->owner, apex->owner, params);
-	if (!nsec3_owner) {
-		return NULL;
-	}
-
 	dnssec_nsec_bitmap_t *rr_types = dnssec_nsec_bitmap_new();
 	if (!rr_types) {
 		return NULL;
@@ -406,6 +404,62 @@ static int connect_nsec3_nodes(zone_node_t *a, zone_node_t *b,
 	return KNOT_EOK;
 }
 
+/*! \brief Number of owners hashed at once when creating NSEC3 nodes. */
+#define NSEC3_HASH_BATCH 64
+
+/*!
+ * \brief Batch of nodes waiting for NSEC3 node creation.
+ */
+typedef struct {
+	zone_node_t *nodes[NSEC3_HASH_BATCH];
+	dnssec_binary_t owners[NSEC3_HASH_BATCH];
+	dnssec_binary_t hashes[NSEC3_HASH_BATCH];
+	size_t count;
+} nsec3_batch_t;
+
+/*!
+ * \brief Hash owners of batched nodes and create their NSEC3 nodes.
+ */
+static int create_nsec3_nodes_batch(nsec3_batch_t *batch,
+                                    const zone_contents_t *zone,
+                                    const dnssec_nsec3_params_t *params,
+                                    uint32_t ttl,
+                                    zone_tree_t *nsec3_nodes)
+{
+	int ret = dnssec_nsec3_hash_batch(batch->owners, batch->count, params,
+	                                  batch->hashes);
+	if (ret != DNSSEC_EOK) {
+		return ret;
+	}
+
+	size_t count = batch->count;
+	batch->count = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		knot_dname_t *nsec3_owner;
+		nsec3_owner = knot_nsec3_hash_to_dname(batch->hashes[i].data,
+		                                       batch->hashes[i].size,
+		                                       zone->apex->owner);
+		if (!nsec3_owner) {
+			return KNOT_ENOMEM;
+		}
+
+		zone_node_t *nsec3_node;
+		nsec3_node = create_nsec3_node_for_node(batch->nodes[i], nsec3_owner,
+		                                        zone->apex, params, ttl);
+		if (!nsec3_node) {
+			return KNOT_ENOMEM;
+		}
+
+		ret = zone_tree_insert(nsec3_nodes, nsec3_node);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
 /*!
  * \brief Create NSEC3 node for each regular node in the zone.
  *
@@ -428,6 +482,8 @@ static int create_nsec3_nodes(const zone_contents_t *zone,
 
 	int result = KNOT_EOK;
 
+	nsec3_batch_t batch = { .count = 0 };
+
 	hattrie_iter_t *it = hattrie_iter_begin(zone->nodes);
 	while (!hattrie_iter_finished(it)) {
 		zone_node_t *node = (zone_node_t *)*hattrie_iter_val(it);
@@ -448,17 +504,16 @@ static int create_nsec3_nodes(const zone_contents_t *zone,
 			continue;
 		}
 
-		zone_node_t *nsec3_node;
-		nsec3_node = create_nsec3_node_for_node(node, zone->apex,
-		                                        params, ttl);
-		if (!nsec3_node) {
-			result = KNOT_ENOMEM;
-			break;
-		}
-
-		result = zone_tree_insert(nsec3_nodes, nsec3_node);
-		if (result != KNOT_EOK) {
-			break;
+		batch.nodes[batch.count] = node;
+		batch.owners[batch.count].data = node->owner;
+		batch.owners[batch.count].size = knot_dname_size(node->owner);
+		batch.count += 1;
+		if (batch.count == NSEC3_HASH_BATCH) {
+			result = create_nsec3_nodes_batch(&batch, zone, params,
+			                                  ttl, nsec3_nodes);
+			if (result != KNOT_EOK) {
+				break;
+			}
 		}
 
 		hattrie_iter_next(it);
@@ -466,6 +521,15 @@ static int create_nsec3_nodes(const zone_contents_t *zone,
 
 	hattrie_iter_free(it);
 
+	if (result == KNOT_EOK && batch.count > 0) {
+		result = create_nsec3_nodes_batch(&batch, zone, params, ttl,
+		                                  nsec3_nodes);
+	}
+
+	for (size_t i = 0; i < NSEC3_HASH_BATCH; i++) {
+		dnssec_binary_free(&batch.hashes[i]);
+	}
+
 	return result;
 }
 
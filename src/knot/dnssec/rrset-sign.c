@@ -147,7 +147,11 @@ static int sign_ctx_add_self(dnssec_sign_ctx_t *ctx, const uint8_t *rdata)
 	const uint8_t *rdata_signer = rdata + RRSIG_RDATA_SIGNER_OFFSET;
 	dnssec_binary_t signer = { 0 };
 	signer.data = knot_dname_copy(rdata_signer, NULL);
+	if (signer.data == NULL) {
+		return KNOT_ENOMEM;
+	}
 	signer.size = knot_dname_size(signer.data);
+	knot_dname_to_lower(signer.data);
 
 	result = dnssec_sign_add(ctx, &signer);
 	free(signer.data);
@@ -156,16 +160,16 @@ static int sign_ctx_add_self(dnssec_sign_ctx_t *ctx, const uint8_t *rdata)
 }
 
 /*!
- * \brief Add covered RRs to signing context.
+ * \brief Convert covered RRs into the canonical wire format.
  *
  * Requires all DNAMEs in canonical form and all RRs ordered canonically.
  *
- * \param ctx      Signing context.
  * \param covered  Covered RRs.
+ * \param wire     Output wire format, must be freed by the caller.
  *
  * \return Error code, KNOT_EOK if successful.
  */
-static int sign_ctx_add_records(dnssec_sign_ctx_t *ctx, const knot_rrset_t *covered)
+static int covered_to_wire(const knot_rrset_t *covered, dnssec_binary_t *wire)
 {
 	// huge block of rrsets can be optionally created
 	uint8_t *rrwf = malloc(KNOT_WIRE_MAX_PKTSIZE);
@@ -179,13 +183,10 @@ static int sign_ctx_add_records(dnssec_sign_ctx_t *ctx, const knot_rrset_t *cove
 		return written;
 	}
 
-	dnssec_binary_t rrset_wire = { 0 };
-	rrset_wire.size = written;
-	rrset_wire.data = rrwf;
-	int result = dnssec_sign_add(ctx, &rrset_wire);
-	free(rrwf);
+	wire->size = written;
+	wire->data = rrwf;
 
-	return result;
+	return KNOT_EOK;
 }
 
 /*!
@@ -194,24 +195,22 @@ static int sign_ctx_add_records(dnssec_sign_ctx_t *ctx, const knot_rrset_t *cove
  * RFC 4034: The signature covers RRSIG RDATA field (excluding the signature)
  * and all matching RR records, which are ordered canonically.
  *
- * Requires all DNAMEs in canonical form and all RRs ordered canonically.
- *
- * \param ctx          Signing context.
- * \param rrsig_rdata  RRSIG RDATA with populated fields except signature.
- * \param covered      Covered RRs.
+ * \param ctx           Signing context.
+ * \param rrsig_rdata   RRSIG RDATA with populated fields except signature.
+ * \param covered_wire  Covered RRs in the canonical wire format.
  *
  * \return Error code, KNOT_EOK if successful.
  */
 static int sign_ctx_add_data(dnssec_sign_ctx_t *ctx,
                              const uint8_t *rrsig_rdata,
-                             const knot_rrset_t *covered)
+                             const dnssec_binary_t *covered_wire)
 {
 	int result = sign_ctx_add_self(ctx, rrsig_rdata);
 	if (result != KNOT_EOK) {
 		return result;
 	}
 
-	return sign_ctx_add_records(ctx, covered);
+	return dnssec_sign_add(ctx, covered_wire);
 }
 
 /*!
@@ -223,6 +222,7 @@ static int sign_ctx_add_data(dnssec_sign_ctx_t *ctx,
  * \param[in]  key           Key used for signing.
  * \param[in]  sig_incepted  Timestamp of signature inception.
  * \param[in]  sig_expires   Timestamp of signature expiration.
+ * \param[in]  rrsig_cache   Cache to store the new signature into (can be NULL).
  *
  * \return Error code, KNOT_EOK if successful.
  */
@@ -230,6 +230,7 @@ static int rrsigs_create_rdata(knot_rrset_t *rrsigs, dnssec_sign_ctx_t *ctx,
                                const knot_rrset_t *covered,
                                const dnssec_key_t *key,
                                uint32_t sig_incepted, uint32_t sig_expires,
+                               rrsig_cache_t *rrsig_cache,
                                knot_mm_t *mm)
 {
 	assert(rrsigs);
@@ -258,14 +259,22 @@ static int rrsigs_create_rdata(knot_rrset_t *rrsigs, dnssec_sign_ctx_t *ctx,
 		return res;
 	}
 
-	res = sign_ctx_add_data(ctx, header, covered);
+	dnssec_binary_t covered_wire = { 0 };
+	res = covered_to_wire(covered, &covered_wire);
+	if (res != KNOT_EOK) {
+		return res;
+	}
+
+	res = sign_ctx_add_data(ctx, header, &covered_wire);
 	if (res != KNOT_EOK) {
+		dnssec_binary_free(&covered_wire);
 		return res;
 	}
 
 	dnssec_binary_t signature = { 0 };
 	res = dnssec_sign_write(ctx, &signature);
 	if (res != DNSSEC_EOK) {
+		dnssec_binary_free(&covered_wire);
 		return res;
 	}
 	assert(signature.size > 0);
@@ -277,6 +286,13 @@ static int rrsigs_create_rdata(knot_rrset_t *rrsigs, dnssec_sign_ctx_t *ctx,
 
 	dnssec_binary_free(&signature);
 
+	// failure only means a verification on the next re-sign
+	if (rrsig_cache != NULL) {
+		const dnssec_binary_t rrsig_bin = { .data = rrsig, .size = rrsig_size };
+		rrsig_cache_add(rrsig_cache, key, &rrsig_bin, &covered_wire);
+	}
+	dnssec_binary_free(&covered_wire);
+
 	return knot_rrset_add_rdata(rrsigs, rrsig, rrsig_size,
 	                            knot_rdata_ttl(covered_data), mm);
 }
@@ -296,7 +312,7 @@ int knot_sign_rrset(knot_rrset_t *rrsigs, const knot_rrset_t *covered,
 	uint32_t sig_expire = sig_incept + dnssec_ctx->policy->rrsig_lifetime;
 
 	return rrsigs_create_rdata(rrsigs, sign_ctx, covered, key, sig_incept,
-	                           sig_expire, mm);
+	                           sig_expire, dnssec_ctx->rrsig_cache, mm);
 }
 
 int knot_synth_rrsig(uint16_t type, const knot_rdataset_t *rrsig_rrs,
@@ -347,6 +363,39 @@ static bool is_expired_signature(const knot_rrset_t *rrsigs, size_t pos,
 	return expire_in <= refresh_before;
 }
 
+int knot_verify_signature(const dnssec_binary_t *covered_wire,
+                          const knot_rrset_t *rrsigs, size_t pos,
+                          dnssec_sign_ctx_t *sign_ctx)
+{
+	if (!covered_wire || knot_rrset_empty(rrsigs) || !sign_ctx) {
+		return KNOT_EINVAL;
+	}
+
+	const knot_rdata_t *rr_data = knot_rdataset_at(&rrsigs->rrs, pos);
+	uint8_t *rdata = knot_rdata_data(rr_data);
+	if (!rdata) {
+		return KNOT_EINVAL;
+	}
+
+	dnssec_binary_t signature = { 0 };
+	knot_rrsig_signature(&rrsigs->rrs, pos, &signature.data, &signature.size);
+	if (!signature.data) {
+		return KNOT_EINVAL;
+	}
+
+	int result = dnssec_sign_init(sign_ctx);
+	if (result != KNOT_EOK) {
+		return result;
+	}
+
+	result = sign_ctx_add_data(sign_ctx, rdata, covered_wire);
+	if (result != KNOT_EOK) {
+		return result;
+	}
+
+	return dnssec_sign_verify(sign_ctx, &signature);
+}
+
 int knot_check_signature(const knot_rrset_t *covered,
                     const knot_rrset_t *rrsigs, size_t pos,
                     const dnssec_key_t *key,
@@ -371,23 +420,32 @@ int knot_check_signature(const knot_rrset_t *covered,
 		return KNOT_EINVAL;
 	}
 
-	dnssec_binary_t signature = { 0 };
-	knot_rrsig_signature(&rrsigs->rrs, pos, &signature.data, &signature.size);
-	if (!signature.data) {
-		return KNOT_EINVAL;
+	dnssec_binary_t covered_wire = { 0 };
+	int result = covered_to_wire(covered, &covered_wire);
+	if (result != KNOT_EOK) {
+		return result;
 	}
 
-	// perform the validation
+	// skip the validation of signatures made or verified before
 
-	int result = dnssec_sign_init(sign_ctx);
-	if (result != KNOT_EOK) {
-		return result;
+	const dnssec_binary_t rrsig = {
+		.data = rdata,
+		.size = knot_rdata_rdlen(rr_data)
+	};
+	if (rrsig_cache_contains(dnssec_ctx->rrsig_cache, key, &rrsig,
+	                         &covered_wire)) {
+		dnssec_binary_free(&covered_wire);
+		return KNOT_EOK;
 	}
 
-	result = sign_ctx_add_data(sign_ctx, rdata, covered);
-	if (result != KNOT_EOK) {
-		return result;
+	// perform the validation
+
+	result = knot_verify_signature(&covered_wire, rrsigs, pos, sign_ctx);
+	if (result == KNOT_EOK && dnssec_ctx->rrsig_cache != NULL) {
+		rrsig_cache_add(dnssec_ctx->rrsig_cache, key, &rrsig, &covered_wire);
 	}
 
-	return dnssec_sign_verify(sign_ctx, &signature);
+	dnssec_binary_free(&covered_wire);
+
+	return result;
 }
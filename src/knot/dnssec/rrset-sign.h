@@ -70,6 +70,23 @@ int knot_sign_rrset(knot_rrset_t *rrsigs,
 int knot_synth_rrsig(uint16_t type, const knot_rdataset_t *rrsig_rrs,
                      knot_rdataset_t *out_sig, knot_mm_t *mm);
 
+/*!
+ * \brief Verify RRSIG signature cryptographically.
+ *
+ * Unlike \ref knot_check_signature, the validity period is not checked.
+ *
+ * \param covered_wire  Covered RRs in the canonical wire format.
+ * \param rrsigs        RR set with RRSIGs.
+ * \param pos           Number of RRSIG RR in 'rrsigs' to be verified.
+ * \param sign_ctx      Signing context of the key the signature is made with.
+ *
+ * \return Error code, KNOT_EOK if successful and the signature is valid.
+ * \retval KNOT_DNSSEC_EINVALID_SIGNATURE  The signature is invalid.
+ */
+int knot_verify_signature(const dnssec_binary_t *covered_wire,
+                          const knot_rrset_t *rrsigs, size_t pos,
+                          dnssec_sign_ctx_t *sign_ctx);
+
 /*!
  * \brief Check if RRSIG signature is valid.
  *
@@ -0,0 +1,205 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contrib/qp-trie/qp.h"
+#include "dnssec/error.h"
+#include "dnssec/random.h"
+#include "dnssec/tsig.h"
+#include "knot/dnssec/rrsig-cache.h"
+#include "libknot/errcode.h"
+
+/*! \brief Digest algorithm, keyed by a random secret to resist collisions. */
+#define CACHE_DIGEST_ALG	DNSSEC_TSIG_HMAC_SHA256
+#define CACHE_SECRET_SIZE	32
+/*! \brief Stored part of the digest. */
+#define CACHE_KEY_SIZE		16
+
+struct rrsig_cache {
+	trie_t *entries;	/*!< Digests, values hold the generation of last use. */
+	uintptr_t generation;	/*!< Current generation (0 if not tracking). */
+	uint8_t secret[CACHE_SECRET_SIZE];
+};
+
+static int compute_digest(const rrsig_cache_t *cache, const dnssec_key_t *key,
+                          const dnssec_binary_t *rrsig,
+                          const dnssec_binary_t *covered,
+                          uint8_t out[CACHE_KEY_SIZE])
+{
+	dnssec_binary_t key_rdata = { 0 };
+	int ret = dnssec_key_get_rdata(key, &key_rdata);
+	if (ret != DNSSEC_EOK) {
+		return ret;
+	}
+
+	const dnssec_binary_t secret = {
+		.data = (uint8_t *)cache->secret,
+		.size = sizeof(cache->secret)
+	};
+
+	dnssec_tsig_ctx_t *ctx = NULL;
+	ret = dnssec_tsig_new(&ctx, CACHE_DIGEST_ALG, &secret);
+	if (ret != DNSSEC_EOK) {
+		return ret;
+	}
+
+	dnssec_tsig_add(ctx, &key_rdata);
+	dnssec_tsig_add(ctx, rrsig);
+	dnssec_tsig_add(ctx, covered);
+
+	uint8_t digest[dnssec_tsig_size(ctx)];
+	assert(sizeof(digest) >= CACHE_KEY_SIZE);
+	ret = dnssec_tsig_write(ctx, digest);
+	dnssec_tsig_free(ctx);
+	if (ret != DNSSEC_EOK) {
+		return ret;
+	}
+
+	memcpy(out, digest, CACHE_KEY_SIZE);
+
+	return KNOT_EOK;
+}
+
+rrsig_cache_t *rrsig_cache_new(void)
+{
+	rrsig_cache_t *cache = calloc(1, sizeof(*cache));
+	if (cache == NULL) {
+		return NULL;
+	}
+
+	cache->entries = trie_create(NULL);
+	if (cache->entries == NULL ||
+	    dnssec_random_buffer(cache->secret, sizeof(cache->secret)) != DNSSEC_EOK) {
+		rrsig_cache_free(cache);
+		return NULL;
+	}
+
+	return cache;
+}
+
+void rrsig_cache_free(rrsig_cache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	if (cache->entries != NULL) {
+		trie_free(cache->entries);
+	}
+	free(cache);
+}
+
+void rrsig_cache_clear(rrsig_cache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	trie_clear(cache->entries);
+}
+
+void rrsig_cache_begin(rrsig_cache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	cache->generation += 1;
+	if (cache->generation == 0) {
+		cache->generation = 1;
+	}
+}
+
+void rrsig_cache_sweep(rrsig_cache_t *cache)
+{
+	if (cache == NULL || cache->generation == 0) {
+		return;
+	}
+
+	trie_t *used = trie_create(NULL);
+	if (used == NULL) {
+		// Keep all, a stale entry still describes a valid signature.
+		cache->generation = 0;
+		return;
+	}
+
+	trie_it_t *it = trie_it_begin(cache->entries);
+	while (it != NULL && !trie_it_finished(it)) {
+		if ((uintptr_t)*trie_it_val(it) == cache->generation) {
+			size_t len = 0;
+			const char *key = trie_it_key(it, &len);
+			trie_val_t *val = trie_get_ins(used, key, len);
+			if (val != NULL) {
+				*val = (trie_val_t)cache->generation;
+			}
+		}
+		trie_it_next(it);
+	}
+	trie_it_free(it);
+
+	trie_free(cache->entries);
+	cache->entries = used;
+	cache->generation = 0;
+}
+
+int rrsig_cache_add(rrsig_cache_t *cache, const dnssec_key_t *key,
+                    const dnssec_binary_t *rrsig,
+                    const dnssec_binary_t *covered)
+{
+	if (cache == NULL || key == NULL || rrsig == NULL || covered == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	uint8_t digest[CACHE_KEY_SIZE];
+	int ret = compute_digest(cache, key, rrsig, covered, digest);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	trie_val_t *val = trie_get_ins(cache->entries, (char *)digest, sizeof(digest));
+	if (val == NULL) {
+		return KNOT_ENOMEM;
+	}
+	*val = (trie_val_t)cache->generation;
+
+	return KNOT_EOK;
+}
+
+bool rrsig_cache_contains(rrsig_cache_t *cache, const dnssec_key_t *key,
+                          const dnssec_binary_t *rrsig,
+                          const dnssec_binary_t *covered)
+{
+	if (cache == NULL || key == NULL || rrsig == NULL || covered == NULL) {
+		return false;
+	}
+
+	uint8_t digest[CACHE_KEY_SIZE];
+	if (compute_digest(cache, key, rrsig, covered, digest) != KNOT_EOK) {
+		return false;
+	}
+
+	trie_val_t *val = trie_get_try(cache->entries, (char *)digest, sizeof(digest));
+	if (val == NULL) {
+		return false;
+	}
+	*val = (trie_val_t)cache->generation;
+
+	return true;
+}
@@ -0,0 +1,97 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*!
+ * \file
+ *
+ * \brief Cache of known valid RRSIGs.
+ *
+ * Holds a keyed digest of the signing key, the RRSIG RDATA and the covered
+ * RR set for each signature the signer created or verified. A signature
+ * found in the cache is kept on the next re-sign without a public-key
+ * verification. Signatures not found (created elsewhere, changed data,
+ * new key, server restart) are verified as usual.
+ *
+ * \addtogroup dnssec
+ * @{
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "dnssec/binary.h"
+#include "dnssec/key.h"
+
+struct rrsig_cache;
+typedef struct rrsig_cache rrsig_cache_t;
+
+/*!
+ * \brief Create an empty cache.
+ */
+rrsig_cache_t *rrsig_cache_new(void);
+
+/*!
+ * \brief Free the cache.
+ */
+void rrsig_cache_free(rrsig_cache_t *cache);
+
+/*!
+ * \brief Remove all entries.
+ */
+void rrsig_cache_clear(rrsig_cache_t *cache);
+
+/*!
+ * \brief Start tracking of used entries.
+ *
+ * Entries neither added nor found until \ref rrsig_cache_sweep is called are
+ * then removed. Used for full zone signing, which visits all signatures.
+ */
+void rrsig_cache_begin(rrsig_cache_t *cache);
+
+/*!
+ * \brief Remove entries not used since \ref rrsig_cache_begin.
+ */
+void rrsig_cache_sweep(rrsig_cache_t *cache);
+
+/*!
+ * \brief Insert a valid signature.
+ *
+ * \param cache    Cache.
+ * \param key      Key the signature was made with.
+ * \param rrsig    Complete RRSIG RDATA.
+ * \param covered  Covered RR set in the canonical wire format.
+ *
+ * \return Error code, KNOT_EOK if successful.
+ */
+int rrsig_cache_add(rrsig_cache_t *cache, const dnssec_key_t *key,
+                    const dnssec_binary_t *rrsig,
+                    const dnssec_binary_t *covered);
+
+/*!
+ * \brief Check if the signature is known to be valid.
+ *
+ * \param cache    Cache.
+ * \param key      Key the signature is claimed to be made with.
+ * \param rrsig    Complete RRSIG RDATA.
+ * \param covered  Covered RR set in the canonical wire format.
+ *
+ * \return The same signature was inserted for the same key and data.
+ */
+bool rrsig_cache_contains(rrsig_cache_t *cache, const dnssec_key_t *key,
+                          const dnssec_binary_t *rrsig,
+                          const dnssec_binary_t *covered);
+
+/*! @} */
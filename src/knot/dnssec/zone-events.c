@@ -146,7 +146,8 @@ static uint32_t schedule_next(kdnssec_ctx_t *kctx, const zone_keyset_t *keyset,
 }
 
 int knot_dnssec_zone_sign(zone_contents_t *zone, changeset_t *out_ch,
-                          zone_sign_flags_t flags, uint32_t *refresh_at)
+                          zone_sign_flags_t flags, uint32_t *refresh_at,
+                          rrsig_cache_t *rrsig_cache)
 {
 	if (!zone || !out_ch || !refresh_at) {
 		return KNOT_EINVAL;
@@ -166,6 +167,8 @@ int knot_dnssec_zone_sign(zone_contents_t *zone, changeset_t *out_ch,
 		goto done;
 	}
 
+	ctx.rrsig_cache = rrsig_cache;
+
 	result = sign_process_events(zone_name, &ctx);
 	if (result != KNOT_EOK) {
 		log_zone_error(zone_name, "DNSSEC, failed to process events (%s)",
@@ -192,6 +195,7 @@ int knot_dnssec_zone_sign(zone_contents_t *zone, changeset_t *out_ch,
 	}
 
 	uint32_t zone_expire = 0;
+	rrsig_cache_begin(rrsig_cache);
 	result = knot_zone_sign(zone, &keyset, &ctx, out_ch, &zone_expire);
 	if (result != KNOT_EOK) {
 		log_zone_error(zone_name, "DNSSEC, failed to sign zone content (%s)",
@@ -199,6 +203,9 @@ int knot_dnssec_zone_sign(zone_contents_t *zone, changeset_t *out_ch,
 		goto done;
 	}
 
+	// drop signatures no longer present in the zone
+	rrsig_cache_sweep(rrsig_cache);
+
 	// SOA finishing
 
 	if (changeset_empty(out_ch) &&
@@ -230,7 +237,8 @@ done:
 int knot_dnssec_sign_changeset(const zone_contents_t *zone,
                                const changeset_t *in_ch,
                                changeset_t *out_ch,
-                               uint32_t *refresh_at)
+                               uint32_t *refresh_at,
+                               rrsig_cache_t *rrsig_cache)
 {
 	if (zone == NULL || in_ch == NULL || out_ch == NULL || refresh_at == NULL) {
 		return KNOT_EINVAL;
@@ -250,6 +258,8 @@ int knot_dnssec_sign_changeset(const zone_contents_t *zone,
 		goto done;
 	}
 
+	ctx.rrsig_cache = rrsig_cache;
+
 	result = load_zone_keys(ctx.zone, ctx.keystore,
 	                        ctx.policy->nsec3_enabled, ctx.now, &keyset);
 	if (result != KNOT_EOK) {
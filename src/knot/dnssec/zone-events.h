@@ -47,11 +47,13 @@ typedef enum zone_sign_flags zone_sign_flags_t;
  * \param out_ch       New records will be added to this changeset.
  * \param flags        Zone signing flags.
  * \param refresh_at   Signature refresh time of the oldest signature in zone.
+ * \param rrsig_cache  Cache of known valid signatures (can be NULL).
  *
  * \return Error code, KNOT_EOK if successful.
  */
 int knot_dnssec_zone_sign(zone_contents_t *zone, changeset_t *out_ch,
-                          zone_sign_flags_t flags, uint32_t *refresh_at);
+                          zone_sign_flags_t flags, uint32_t *refresh_at,
+                          rrsig_cache_t *rrsig_cache);
 
 /*!
  * \brief Sign changeset created by DDNS or zone-diff.
@@ -60,12 +62,14 @@ int knot_dnssec_zone_sign(zone_contents_t *zone, changeset_t *out_ch,
  * \param in_ch           Changeset created bvy DDNS or zone-diff
  * \param out_ch          New records will be added to this changeset.
  * \param refresh_at      Signature refresh time of the new signatures.
+ * \param rrsig_cache     Cache of known valid signatures (can be NULL).
  *
  * \return Error code, KNOT_EOK if successful.
  */
 int knot_dnssec_sign_changeset(const zone_contents_t *zone,
                                const changeset_t *in_ch,
                                changeset_t *out_ch,
-                               uint32_t *refresh_at);
+                               uint32_t *refresh_at,
+                               rrsig_cache_t *rrsig_cache);
 
 /*! @} */
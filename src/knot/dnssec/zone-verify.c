@@ -0,0 +1,554 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dnssec/error.h"
+#include "dnssec/key.h"
+#include "dnssec/sign.h"
+#include "knot/dnssec/rrset-sign.h"
+#include "knot/dnssec/zone-verify.h"
+#include "knot/updates/changesets.h"
+#include "libknot/libknot.h"
+#include "contrib/macros.h"
+
+/*! \brief Number of nodes a thread takes at once. */
+#define VERIFY_CHUNK 64
+
+/*! \brief Zone key usable for verification. */
+typedef struct {
+	dnssec_key_t *key;
+	dnssec_sign_ctx_t *ctx;
+	uint16_t keytag;
+	uint8_t algorithm;
+} verify_key_t;
+
+/*! \brief Per-thread verification state. */
+typedef struct {
+	verify_key_t *keys;
+	size_t keys_count;
+	uint8_t *wire;		/*!< Buffer for the canonical covered RR set. */
+} verifier_t;
+
+/*! \brief Shared verification context. */
+typedef struct {
+	const zone_contents_t *zone;
+	knot_dname_t signer[KNOT_DNAME_MAXLEN];	/*!< Zone name, lowercased. */
+	uint32_t now;
+
+	const zone_node_t **nodes;
+	size_t nodes_count;
+	size_t nodes_max;
+	size_t next;		/*!< Next node to be taken, updated atomically. */
+
+	pthread_mutex_t lock;	/*!< Serializes the error handler. */
+	err_handler_t *handler;
+	bool invalid;		/*!< Some RR set is not signed correctly. */
+	int ret;		/*!< First internal error. */
+} verify_ctx_t;
+
+static void verifier_deinit(verifier_t *v)
+{
+	for (size_t i = 0; i < v->keys_count; i++) {
+		dnssec_sign_free(v->keys[i].ctx);
+		dnssec_key_free(v->keys[i].key);
+	}
+	free(v->keys);
+	free(v->wire);
+	memset(v, 0, sizeof(*v));
+}
+
+/*!
+ * \brief Load zone keys from the apex DNSKEY RR set.
+ *
+ * Keys with an unsupported algorithm or without the Zone Key flag are
+ * skipped, the signatures made with them are not accepted.
+ */
+static int verifier_init(verifier_t *v, const verify_ctx_t *ctx)
+{
+	memset(v, 0, sizeof(*v));
+
+	v->wire = malloc(KNOT_WIRE_MAX_PKTSIZE);
+	const knot_rdataset_t *dnskeys = node_rdataset(ctx->zone->apex,
+	                                               KNOT_RRTYPE_DNSKEY);
+	assert(dnskeys);
+	v->keys = calloc(dnskeys->rr_count, sizeof(verify_key_t));
+	if (v->wire == NULL || v->keys == NULL) {
+		verifier_deinit(v);
+		return KNOT_ENOMEM;
+	}
+
+	for (uint16_t i = 0; i < dnskeys->rr_count; i++) {
+		const knot_rdata_t *rr = knot_rdataset_at(dnskeys, i);
+		dnssec_binary_t rdata = {
+			.data = knot_rdata_data(rr),
+			.size = knot_rdata_rdlen(rr)
+		};
+		if (rdata.size < 4 || !(rdata.data[0] & 0x01)) {
+			continue;
+		}
+
+		verify_key_t *k = &v->keys[v->keys_count];
+		if (dnssec_key_new(&k->key) != DNSSEC_EOK) {
+			verifier_deinit(v);
+			return KNOT_ENOMEM;
+		}
+		if (dnssec_key_set_dname(k->key, ctx->signer) != DNSSEC_EOK ||
+		    dnssec_key_set_rdata(k->key, &rdata) != DNSSEC_EOK ||
+		    dnssec_sign_new(&k->ctx, k->key) != DNSSEC_EOK) {
+			dnssec_key_free(k->key);
+			k->key = NULL;
+			continue;
+		}
+		k->keytag = dnssec_key_get_keytag(k->key);
+		k->algorithm = dnssec_key_get_algorithm(k->key);
+		v->keys_count += 1;
+	}
+
+	return KNOT_EOK;
+}
+
+static verify_key_t *find_key(verifier_t *v, uint8_t algorithm, uint16_t keytag)
+{
+	for (size_t i = 0; i < v->keys_count; i++) {
+		if (v->keys[i].keytag == keytag && v->keys[i].algorithm == algorithm) {
+			return &v->keys[i];
+		}
+	}
+
+	return NULL;
+}
+
+/*!
+ * \brief Write the covered RR set in the canonical form (RFC 4034, 6.2).
+ *
+ * Names are lowercased and TTLs replaced with the Original TTL, as the
+ * transferred records are stored as received.
+ */
+static int canonical_wire(const knot_rrset_t *covered, uint32_t orig_ttl,
+                          uint8_t *wire, dnssec_binary_t *out)
+{
+	knot_dname_t owner[KNOT_DNAME_MAXLEN];
+	if (knot_dname_to_wire(owner, covered->owner, sizeof(owner)) < 0) {
+		return KNOT_EINVAL;
+	}
+
+	knot_rrset_t canon;
+	knot_rrset_init(&canon, owner, covered->type, covered->rclass);
+	int ret = knot_rdataset_copy(&canon.rrs, &covered->rrs, NULL);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	for (uint16_t i = 0; i < canon.rrs.rr_count; i++) {
+		knot_rrset_t one = canon;
+		one.rrs.rr_count = 1;
+		one.rrs.data = knot_rdataset_at(&canon.rrs, i);
+		ret = knot_rrset_rr_to_canonical(&one);
+		if (ret != KNOT_EOK) {
+			knot_rdataset_clear(&canon.rrs, NULL);
+			return ret;
+		}
+		knot_rdata_set_ttl(one.rrs.data, orig_ttl);
+	}
+
+	ret = knot_rrset_to_wire(&canon, wire, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	knot_rdataset_clear(&canon.rrs, NULL);
+	if (ret < 0) {
+		return ret;
+	}
+
+	out->data = wire;
+	out->size = ret;
+
+	return KNOT_EOK;
+}
+
+static bool signer_matches(const verify_ctx_t *ctx, const knot_rdataset_t *rrsigs,
+                           size_t pos)
+{
+	knot_dname_t signer[KNOT_DNAME_MAXLEN];
+	const knot_dname_t *rdata_signer = knot_rrsig_signer_name(rrsigs, pos);
+	if (knot_dname_to_wire(signer, rdata_signer, sizeof(signer)) < 0) {
+		return false;
+	}
+	knot_dname_to_lower(signer);
+
+	return knot_dname_is_equal(signer, ctx->signer);
+}
+
+/*!
+ * \brief Find a valid signature of the RR set.
+ *
+ * \param[out] error  Semantic error code if no valid signature, 0 otherwise.
+ *
+ * \return Error code, KNOT_EOK if the verification was performed.
+ */
+static int verify_rrset(const verify_ctx_t *ctx, verifier_t *v,
+                        const knot_rrset_t *covered, const knot_rrset_t *rrsigs,
+                        int *error)
+{
+	bool signed_rrset = false;
+	bool timely = false;
+	bool have_wire = false;
+	uint32_t wire_ttl = 0;
+	dnssec_binary_t wire = { 0 };
+
+	for (uint16_t i = 0; i < rrsigs->rrs.rr_count; i++) {
+		if (knot_rrsig_type_covered(&rrsigs->rrs, i) != covered->type) {
+			continue;
+		}
+		signed_rrset = true;
+
+		uint32_t inception = knot_rrsig_sig_inception(&rrsigs->rrs, i);
+		uint32_t expiration = knot_rrsig_sig_expiration(&rrsigs->rrs, i);
+		if (ctx->now < inception || ctx->now > expiration) {
+			continue;
+		}
+		timely = true;
+
+		verify_key_t *key = find_key(v, knot_rrsig_algorithm(&rrsigs->rrs, i),
+		                             knot_rrsig_key_tag(&rrsigs->rrs, i));
+		if (key == NULL || !signer_matches(ctx, &rrsigs->rrs, i)) {
+			continue;
+		}
+
+		uint32_t orig_ttl = knot_rrsig_original_ttl(&rrsigs->rrs, i);
+		if (!have_wire || wire_ttl != orig_ttl) {
+			int ret = canonical_wire(covered, orig_ttl, v->wire, &wire);
+			if (ret != KNOT_EOK) {
+				return ret;
+			}
+			have_wire = true;
+			wire_ttl = orig_ttl;
+		}
+
+		int ret = knot_verify_signature(&wire, rrsigs, i, key->ctx);
+		if (ret == KNOT_EOK) {
+			*error = 0;
+			return KNOT_EOK;
+		} else if (ret == KNOT_ENOMEM || ret == DNSSEC_ENOMEM) {
+			return KNOT_ENOMEM;
+		}
+	}
+
+	if (!signed_rrset) {
+		*error = ZC_ERR_RRSIG_NO_RRSIG;
+	} else if (!timely) {
+		*error = ZC_ERR_RRSIG_RDATA_EXPIRATION;
+	} else {
+		*error = ZC_ERR_RRSIG_INVALID;
+	}
+
+	return KNOT_EOK;
+}
+
+static int report(verify_ctx_t *ctx, const zone_node_t *node, uint16_t type,
+                  int error)
+{
+	char type_str[16] = { '\0' };
+	knot_rrtype_to_string(type, type_str, sizeof(type_str));
+	char info_str[50] = { '\0' };
+	(void)snprintf(info_str, sizeof(info_str), "record type '%s'", type_str);
+
+	pthread_mutex_lock(&ctx->lock);
+	ctx->invalid = true;
+	int ret = ctx->handler->cb(ctx->handler, ctx->zone, node, error, info_str);
+	pthread_mutex_unlock(&ctx->lock);
+
+	return ret;
+}
+
+static int verify_node(verify_ctx_t *ctx, verifier_t *v, const zone_node_t *node)
+{
+	if (node->flags & NODE_FLAGS_NONAUTH) {
+		return KNOT_EOK;
+	}
+
+	bool deleg = node->flags & NODE_FLAGS_DELEG;
+	knot_rrset_t rrsigs = node_rrset(node, KNOT_RRTYPE_RRSIG);
+
+	for (uint16_t i = 0; i < node->rrset_count; i++) {
+		knot_rrset_t rrset = node_rrset_at(node, i);
+		if (rrset.type == KNOT_RRTYPE_RRSIG) {
+			continue;
+		}
+		// only DS and NSEC are authoritative at a delegation
+		if (deleg && rrset.type != KNOT_RRTYPE_DS &&
+		    rrset.type != KNOT_RRTYPE_NSEC) {
+			continue;
+		}
+
+		int error = 0;
+		int ret = verify_rrset(ctx, v, &rrset, &rrsigs, &error);
+		if (ret == KNOT_EOK && error != 0) {
+			ret = report(ctx, node, rrset.type, error);
+		}
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+static void *verify_thread(void *data)
+{
+	verify_ctx_t *ctx = data;
+
+	verifier_t v;
+	int ret = verifier_init(&v, ctx);
+
+	while (ret == KNOT_EOK && ctx->ret == KNOT_EOK) {
+		size_t begin = __sync_fetch_and_add(&ctx->next, VERIFY_CHUNK);
+		if (begin >= ctx->nodes_count) {
+			break;
+		}
+		size_t end = MIN(begin + VERIFY_CHUNK, ctx->nodes_count);
+		for (size_t i = begin; ret == KNOT_EOK && i < end; i++) {
+			ret = verify_node(ctx, &v, ctx->nodes[i]);
+		}
+	}
+
+	if (ret != KNOT_EOK) {
+		pthread_mutex_lock(&ctx->lock);
+		if (ctx->ret == KNOT_EOK) {
+			ctx->ret = ret;
+		}
+		pthread_mutex_unlock(&ctx->lock);
+	}
+
+	verifier_deinit(&v);
+
+	return NULL;
+}
+
+static int verify_nodes(verify_ctx_t *ctx, unsigned threads)
+{
+	threads = MAX(1, MIN(threads, ctx->nodes_count / VERIFY_CHUNK + 1));
+
+	pthread_t workers[threads];
+	unsigned started = 0;
+	for (unsigned i = 1; i < threads; i++) {
+		if (pthread_create(&workers[started], NULL, verify_thread, ctx) != 0) {
+			break;
+		}
+		started += 1;
+	}
+
+	// the calling thread takes part too
+	verify_thread(ctx);
+
+	for (unsigned i = 0; i < started; i++) {
+		pthread_join(workers[i], NULL);
+	}
+
+	if (ctx->ret != KNOT_EOK) {
+		return ctx->ret;
+	}
+
+	return ctx->invalid ? KNOT_ESEMCHECK : KNOT_EOK;
+}
+
+static int verify_ctx_init(verify_ctx_t *ctx, const zone_contents_t *zone,
+                           time_t now, err_handler_t *handler)
+{
+	memset(ctx, 0, sizeof(*ctx));
+
+	ctx->zone = zone;
+	ctx->now = now;
+	ctx->handler = handler;
+	if (knot_dname_to_wire(ctx->signer, zone->apex->owner,
+	                       sizeof(ctx->signer)) < 0) {
+		return KNOT_EINVAL;
+	}
+	knot_dname_to_lower(ctx->signer);
+
+	size_t count = zone_tree_count(zone->nodes);
+	if (zone->nsec3_nodes != NULL) {
+		count += zone_tree_count(zone->nsec3_nodes);
+	}
+	ctx->nodes = malloc(count * sizeof(zone_node_t *));
+	if (ctx->nodes == NULL) {
+		return KNOT_ENOMEM;
+	}
+	ctx->nodes_max = count;
+
+	pthread_mutex_init(&ctx->lock, NULL);
+
+	return KNOT_EOK;
+}
+
+static void verify_ctx_deinit(verify_ctx_t *ctx)
+{
+	pthread_mutex_destroy(&ctx->lock);
+	free(ctx->nodes);
+}
+
+static int add_node(zone_node_t **node, void *data)
+{
+	verify_ctx_t *ctx = data;
+	ctx->nodes[ctx->nodes_count++] = *node;
+
+	return KNOT_EOK;
+}
+
+static bool zone_has_dnskey(const zone_contents_t *zone)
+{
+	return node_rrtype_exists(zone->apex, KNOT_RRTYPE_DNSKEY);
+}
+
+int knot_zone_verify(const zone_contents_t *zone, time_t now, unsigned threads,
+                     err_handler_t *handler)
+{
+	if (zone == NULL || handler == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	if (!zone_has_dnskey(zone)) {
+		return KNOT_EOK;
+	}
+
+	verify_ctx_t ctx;
+	int ret = verify_ctx_init(&ctx, zone, now, handler);
+	if (ret != KNOT_EOK) {
+		free(ctx.nodes);
+		return ret;
+	}
+
+	ret = zone_tree_apply(zone->nodes, add_node, &ctx);
+	if (ret == KNOT_EOK && zone->nsec3_nodes != NULL) {
+		ret = zone_tree_apply(zone->nsec3_nodes, add_node, &ctx);
+	}
+	if (ret == KNOT_EOK) {
+		ret = verify_nodes(&ctx, threads);
+	}
+
+	verify_ctx_deinit(&ctx);
+
+	return ret;
+}
+
+static int node_ptr_cmp(const void *a, const void *b)
+{
+	const zone_node_t *x = *(const zone_node_t **)a;
+	const zone_node_t *y = *(const zone_node_t **)b;
+
+	return (x > y) - (x < y);
+}
+
+/*! \brief Drop duplicates, a node may have several changed RR sets. */
+static void unique_nodes(verify_ctx_t *ctx)
+{
+	qsort(ctx->nodes, ctx->nodes_count, sizeof(zone_node_t *), node_ptr_cmp);
+
+	size_t unique = 0;
+	for (size_t i = 0; i < ctx->nodes_count; i++) {
+		if (unique == 0 || ctx->nodes[unique - 1] != ctx->nodes[i]) {
+			ctx->nodes[unique++] = ctx->nodes[i];
+		}
+	}
+	ctx->nodes_count = unique;
+}
+
+static void add_changed_node(verify_ctx_t *ctx, const zone_node_t *node)
+{
+	if (ctx->nodes_count == ctx->nodes_max) {
+		unique_nodes(ctx);
+		// all zone nodes are already present
+		if (ctx->nodes_count == ctx->nodes_max) {
+			return;
+		}
+	}
+
+	ctx->nodes[ctx->nodes_count++] = node;
+}
+
+static bool dnskey_changed(const changeset_t *ch, const knot_dname_t *apex)
+{
+	const zone_contents_t *parts[] = { ch->add, ch->remove };
+	for (int i = 0; i < 2; i++) {
+		if (parts[i] == NULL) {
+			continue;
+		}
+		const zone_node_t *node = zone_contents_find_node(parts[i], apex);
+		if (node != NULL && node_rrtype_exists(node, KNOT_RRTYPE_DNSKEY)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int knot_zone_verify_changesets(zone_contents_t *zone, list_t *changesets,
+                                time_t now, unsigned threads,
+                                err_handler_t *handler)
+{
+	if (zone == NULL || changesets == NULL || handler == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	if (!zone_has_dnskey(zone)) {
+		return KNOT_EOK;
+	}
+
+	changeset_t *ch = NULL;
+	WALK_LIST(ch, *changesets) {
+		if (dnskey_changed(ch, zone->apex->owner)) {
+			return knot_zone_verify(zone, now, threads, handler);
+		}
+	}
+
+	verify_ctx_t ctx;
+	int ret = verify_ctx_init(&ctx, zone, now, handler);
+	if (ret != KNOT_EOK) {
+		free(ctx.nodes);
+		return ret;
+	}
+
+	// the SOA is always changed
+	add_changed_node(&ctx, zone->apex);
+
+	WALK_LIST(ch, *changesets) {
+		changeset_iter_t it;
+		ret = changeset_iter_all(&it, ch);
+		if (ret != KNOT_EOK) {
+			break;
+		}
+
+		knot_rrset_t rr = changeset_iter_next(&it);
+		while (!knot_rrset_empty(&rr)) {
+			const zone_node_t *node = zone_contents_find_node_for_rr(zone, &rr);
+			if (node != NULL) {
+				add_changed_node(&ctx, node);
+			}
+			rr = changeset_iter_next(&it);
+		}
+		changeset_iter_clear(&it);
+	}
+
+	if (ret == KNOT_EOK) {
+		unique_nodes(&ctx);
+		ret = verify_nodes(&ctx, threads);
+	}
+
+	verify_ctx_deinit(&ctx);
+
+	return ret;
+}
@@ -0,0 +1,74 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*!
+ * \file
+ *
+ * \brief Cryptographic verification of zone signatures.
+ *
+ * Each authoritative RR set of a signed zone must have at least one RRSIG
+ * which is currently valid and verifies with a zone key from the apex
+ * DNSKEY RR set. The zone nodes are split into ranges processed by several
+ * threads. Failures are reported through the semantic check error handler
+ * as ZC_ERR_RRSIG_NO_RRSIG, ZC_ERR_RRSIG_RDATA_EXPIRATION, or
+ * ZC_ERR_RRSIG_INVALID.
+ *
+ * \addtogroup dnssec
+ * @{
+ */
+
+#pragma once
+
+#include <time.h>
+
+#include "contrib/ucw/lists.h"
+#include "knot/zone/contents.h"
+#include "knot/zone/semantic-check.h"
+
+/*!
+ * \brief Verify all signatures in the zone.
+ *
+ * Unsigned zones (without DNSKEY in the apex) are skipped.
+ *
+ * \param zone     Zone contents (adjusted).
+ * \param now      Time to check the signature validity period against.
+ * \param threads  Number of verification threads.
+ * \param handler  Error handler, called serialized.
+ *
+ * \retval KNOT_EOK        all RR sets have a valid signature.
+ * \retval KNOT_ESEMCHECK  some RR sets are not signed correctly.
+ * \retval KNOT_E*         verification failed.
+ */
+int knot_zone_verify(const zone_contents_t *zone, time_t now, unsigned threads,
+                     err_handler_t *handler);
+
+/*!
+ * \brief Verify signatures of nodes touched by the changesets.
+ *
+ * All signatures are verified if the apex DNSKEY RR set has changed.
+ *
+ * \param zone        Updated zone contents (adjusted).
+ * \param changesets  Changesets applied to the zone.
+ * \param now         Time to check the signature validity period against.
+ * \param threads     Number of verification threads.
+ * \param handler     Error handler, called serialized.
+ *
+ * \return See \ref knot_zone_verify.
+ */
+int knot_zone_verify_changesets(zone_contents_t *zone, list_t *changesets,
+                                time_t now, unsigned threads,
+                                err_handler_t *handler);
+
+/*! @} */
@@ -20,6 +20,8 @@
 
 #include "libknot/libknot.h"
 #include "knot/common/log.h"
+#include "knot/common/probe.h"
+#include "knot/dnssec/rrsig-cache.h"
 #include "knot/events/events.h"
 #include "knot/events/handlers.h"
 #include "knot/events/replan.h"
@@ -33,17 +35,18 @@ typedef struct event_info {
 	zone_event_type_t type;
 	const zone_event_cb callback;
 	const char *name;
+	mempressure_event_t memory;
 } event_info_t;
 
 static const event_info_t EVENT_INFO[] = {
-	{ ZONE_EVENT_LOAD,    event_load,    "load" },
-	{ ZONE_EVENT_REFRESH, event_refresh, "refresh" },
-	{ ZONE_EVENT_XFER,    event_xfer,    "transfer" },
-	{ ZONE_EVENT_UPDATE,  event_update,  "update" },
-	{ ZONE_EVENT_EXPIRE,  event_expire,  "expiration" },
-	{ ZONE_EVENT_FLUSH,   event_flush,   "journal flush" },
-	{ ZONE_EVENT_NOTIFY,  event_notify,  "notify" },
-	{ ZONE_EVENT_DNSSEC,  event_dnssec,  "DNSSEC resign" },
+	{ ZONE_EVENT_LOAD,    event_load,    "load",          MEMPRESSURE_REPLACE },
+	{ ZONE_EVENT_REFRESH, event_refresh, "refresh",       MEMPRESSURE_LIGHT },
+	{ ZONE_EVENT_XFER,    event_xfer,    "transfer",      MEMPRESSURE_REPLACE },
+	{ ZONE_EVENT_UPDATE,  event_update,  "update",        MEMPRESSURE_COPY },
+	{ ZONE_EVENT_EXPIRE,  event_expire,  "expiration",    MEMPRESSURE_LIGHT },
+	{ ZONE_EVENT_FLUSH,   event_flush,   "journal flush", MEMPRESSURE_LIGHT },
+	{ ZONE_EVENT_NOTIFY,  event_notify,  "notify",        MEMPRESSURE_LIGHT },
+	{ ZONE_EVENT_DNSSEC,  event_dnssec,  "DNSSEC resign", MEMPRESSURE_COPY },
 	{ 0 }
 };
 
@@ -149,12 +152,84 @@ static void reschedule(zone_events_t *events)
 	evsched_schedule(events->event, diff * 1000);
 }
 
+/*!
+ * \brief Pass the results of the old zone's events to the zone replacing it.
+ *
+ * Contents switches and event planning are forwarded as they happen, the
+ * events due on the old zone and its state changed by a finished event are
+ * handed over here.
+ */
+static void handover_results(zone_t *zone, zone_t *successor, bool ran)
+{
+	if (ran) {
+		successor->zonefile = zone->zonefile;
+		successor->bootstrap_retry = zone->bootstrap_retry;
+		successor->flags &= ~ZONE_EXPIRED;
+		successor->flags |= (zone->flags & ZONE_EXPIRED);
+	}
+
+	time_t times[ZONE_EVENT_COUNT];
+	pthread_mutex_lock(&zone->events.mx);
+	memcpy(times, zone->events.time, sizeof(times));
+	pthread_mutex_unlock(&zone->events.mx);
+
+	time_t now = time(NULL);
+	for (zone_event_type_t type = 0; type < ZONE_EVENT_COUNT; type++) {
+		if (times[type] != 0 && times[type] <= now) {
+			zone_events_schedule_at(successor, type, times[type]);
+		}
+	}
+
+	/* Updates queued to the old zone during the reload. */
+	replan_update(successor, zone);
+}
+
+/*!
+ * \brief Finish the running event, release or free the zone.
+ *
+ * A replaced zone frees itself once it's retired and idle, the successor
+ * held back until then starts its own events.
+ */
+static void event_done(zone_t *zone, bool ran)
+{
+	zone_events_t *events = &zone->events;
+
+	pthread_mutex_lock(&events->mx);
+	zone_t *successor = events->successor;
+	if (successor == NULL) {
+		bool retired = events->retired;
+		events->running = false;
+		reschedule(events);
+		pthread_mutex_unlock(&events->mx);
+
+		if (retired) {
+			zone_free(&zone);
+		}
+		return;
+	}
+	pthread_mutex_unlock(&events->mx);
+
+	handover_results(zone, successor, ran);
+
+	pthread_mutex_lock(&events->mx);
+	bool retired = events->retired;
+	events->running = false;
+	pthread_mutex_unlock(&events->mx);
+
+	/* Otherwise, zone_events_retire() releases the successor. */
+	if (retired) {
+		zone->contents = NULL;
+		zone_free(&zone);
+		event_done(successor, false);
+	}
+}
+
 /*!
  * \brief Zone event wrapper, expected to be called from a worker thread.
  *
  * 1. Takes the next planned event.
  * 2. Resets the event's scheduled time.
- * 3. Perform the event's callback.
+ * 3. Perform the event's callback, or defer it under memory pressure.
  * 4. Schedule next event planned event.
  */
 static void event_wrap(task_t *task)
@@ -167,15 +242,33 @@ static void event_wrap(task_t *task)
 
 	pthread_mutex_lock(&events->mx);
 	zone_event_type_t type = get_next_event(events);
-	if (!valid_event(type)) {
+	if (!valid_event(type) || events->frozen) {
+		/* Events queued before a reload are left to the successor. */
+		pthread_mutex_unlock(&events->mx);
+		event_done(zone, false);
+		return;
+	}
+	const event_info_t *info = get_event_info(type);
+
+	/* Defer the events copying the zone contents under memory pressure. */
+	if (!mempressure_event_begin(events->pressure, info->memory,
+	                             zone->contents != NULL)) {
+		event_set_time(events, type, time(NULL) + MEMPRESSURE_DEFER);
 		events->running = false;
+		reschedule(events);
 		pthread_mutex_unlock(&events->mx);
+		log_zone_debug(zone->name, "zone event '%s' deferred, memory pressure",
+		              info->name);
 		return;
 	}
+
 	event_set_time(events, type, 0);
 	pthread_mutex_unlock(&events->mx);
 
-	const event_info_t *info = get_event_info(type);
+	/* Drop the optional signature cache under memory pressure. */
+	if (info->memory != MEMPRESSURE_LIGHT && mempressure_active(events->pressure)) {
+		rrsig_cache_clear(zone->rrsig_cache);
+	}
 
 	/* Create a configuration copy just for this event. */
 	conf_t *conf;
@@ -184,7 +277,11 @@ static void event_wrap(task_t *task)
 	rcu_read_unlock();
 	if (ret == KNOT_EOK) {
 		/* Execute the event callback. */
+		KNOT_PROBE2(zone__event__start, zone->name, type);
+		uint64_t begin = zone_cputime_now();
 		ret = info->callback(conf, zone);
+		zone_cputime_event(zone->cputime, type, zone_cputime_now() - begin);
+		KNOT_PROBE3(zone__event__done, zone->name, type, ret);
 		conf_free(conf);
 	}
 
@@ -193,10 +290,9 @@ static void event_wrap(task_t *task)
 		               info->name, knot_strerror(ret));
 	}
 
-	pthread_mutex_lock(&events->mx);
-	events->running = false;
-	reschedule(events);
-	pthread_mutex_unlock(&events->mx);
+	mempressure_event_end(events->pressure, info->memory);
+
+	event_done(zone, true);
 }
 
 /*!
@@ -234,7 +330,8 @@ int zone_events_init(zone_t *zone)
 }
 
 int zone_events_setup(struct zone *zone, worker_pool_t *workers,
-                      evsched_t *scheduler, knot_db_t *timers_db)
+                      evsched_t *scheduler, knot_db_t *timers_db,
+                      mempressure_t *pressure)
 {
 	if (!zone || !workers || !scheduler) {
 		return KNOT_EINVAL;
@@ -249,6 +346,7 @@ int zone_events_setup(struct zone *zone, worker_pool_t *workers,
 	zone->events.event = event;
 	zone->events.pool = workers;
 	zone->events.timers_db = timers_db;
+	zone->events.pressure = pressure;
 
 	return KNOT_EOK;
 }
@@ -276,6 +374,15 @@ void zone_events_schedule_at(zone_t *zone, zone_event_type_t type, time_t time)
 	zone_events_t *events = &zone->events;
 
 	pthread_mutex_lock(&events->mx);
+
+	/* Planning of a replaced zone belongs to the new zone. */
+	zone_t *successor = events->successor;
+	if (successor != NULL) {
+		pthread_mutex_unlock(&events->mx);
+		zone_events_schedule_at(successor, type, time);
+		return;
+	}
+
 	time_t current = event_get_time(events, type);
 	if (time == 0 || current == 0 || time < current) {
 		event_set_time(events, type, time);
@@ -349,10 +456,57 @@ void zone_events_start(zone_t *zone)
 	}
 
 	pthread_mutex_lock(&zone->events.mx);
+	zone->events.frozen = false;
 	reschedule(&zone->events);
 	pthread_mutex_unlock(&zone->events.mx);
 }
 
+void zone_events_handover(zone_t *old_zone, zone_t *zone)
+{
+	if (!old_zone || !zone) {
+		return;
+	}
+
+	pthread_mutex_lock(&old_zone->events.mx);
+	assert(old_zone->events.frozen);
+	assert(old_zone->events.successor == NULL);
+	zone->contents = old_zone->contents;
+	/* Held as running until the old zone is retired and idle. */
+	zone->events.running = true;
+	old_zone->events.successor = zone;
+	pthread_mutex_unlock(&old_zone->events.mx);
+}
+
+void zone_events_retire(zone_t *zone)
+{
+	if (!zone) {
+		return;
+	}
+
+	zone_events_t *events = &zone->events;
+
+	pthread_mutex_lock(&events->mx);
+	if (events->running) {
+		/* Freed by the worker finishing the event. */
+		events->retired = true;
+		pthread_mutex_unlock(&events->mx);
+		return;
+	}
+	zone_t *successor = events->successor;
+	pthread_mutex_unlock(&events->mx);
+
+	if (successor != NULL) {
+		handover_results(zone, successor, false);
+		zone->contents = NULL;
+	}
+
+	zone_free(&zone);
+
+	if (successor != NULL) {
+		event_done(successor, false);
+	}
+}
+
 time_t zone_events_get_time(const struct zone *zone, zone_event_type_t type)
 {
 	if (zone == NULL) {
@@ -22,6 +22,7 @@
 
 #include "knot/conf/conf.h"
 #include "knot/common/evsched.h"
+#include "knot/server/mempressure.h"
 #include "knot/worker/pool.h"
 #include "libknot/db/db.h"
 
@@ -49,10 +50,13 @@ typedef struct zone_events {
 	pthread_mutex_t mx;		//!< Mutex protecting the struct.
 	bool running;			//!< Some zone event is being run.
 	bool frozen;			//!< Terminated, don't schedule new events.
+	bool retired;			//!< Removed from the database, free when idle.
+	struct zone *successor;		//!< Zone replacing this one after reload.
 
 	event_t *event;			//!< Scheduler event.
 	worker_pool_t *pool;		//!< Server worker pool.
 	knot_db_t *timers_db;		//!< Persistent zone timers database.
+	mempressure_t *pressure;	//!< Server memory pressure detection.
 
 	task_t task;			//!< Event execution context.
 	time_t time[ZONE_EVENT_COUNT];	//!< Event execution times.
@@ -77,11 +81,13 @@ int zone_events_init(struct zone *zone);
  * \param workers    Worker thread pool.
  * \param scheduler  Event scheduler.
  * \param timers_db  Persistent timers database. Can be NULL.
+ * \param pressure   Memory pressure detection. Can be NULL.
  *
  * \return KNOT_E*
  */
 int zone_events_setup(struct zone *zone, worker_pool_t *workers,
-                      evsched_t *scheduler, knot_db_t *timers_db);
+                      evsched_t *scheduler, knot_db_t *timers_db,
+                      mempressure_t *pressure);
 
 /*!
  * \brief Deinitialize zone events.
@@ -155,6 +161,29 @@ void zone_events_freeze(struct zone *zone);
  */
 void zone_events_start(struct zone *zone);
 
+/*!
+ * \brief Hand a zone over to the new zone replacing it on reload.
+ *
+ * The new zone takes the contents of the old one. Its events are held back
+ * until the old zone is retired and its running or queued event finished.
+ * Until then, contents switches and event planning of the old zone are
+ * passed to the new zone.
+ *
+ * \param old_zone  Frozen zone being replaced.
+ * \param zone      New zone, not yet published.
+ */
+void zone_events_handover(struct zone *old_zone, struct zone *zone);
+
+/*!
+ * \brief Free a frozen zone removed from the zone database.
+ *
+ * The zone is freed immediately if no event is running, otherwise after
+ * the running event finishes. The zone replacing it is then released.
+ *
+ * \param zone  Zone to be freed.
+ */
+void zone_events_retire(struct zone *zone);
+
 /*!
  * \brief Return time of the occurrence of the given event.
  *
@@ -73,7 +73,8 @@ int event_dnssec(conf_t *conf, zone_t *zone)
 		sign_flags = 0;
 	}
 
-	ret = knot_dnssec_zone_sign(zone->contents, &ch, sign_flags, &refresh_at);
+	ret = knot_dnssec_zone_sign(zone->contents, &ch, sign_flags, &refresh_at,
+	                            zone->rrsig_cache);
 	if (ret != KNOT_EOK) {
 		goto done;
 	}
@@ -103,7 +104,7 @@ int event_dnssec(conf_t *conf, zone_t *zone)
 		}
 
 		/* Switch zone contents. */
-		zone_contents_t *old_contents = zone_switch_contents(zone, new_contents);
+		zone_contents_t *old_contents = zone_switch_change(zone, new_contents, &ch);
 		zone->flags &= ~ZONE_EXPIRED;
 		synchronize_rcu();
 		update_free_zone(&old_contents);
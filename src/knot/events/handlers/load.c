@@ -28,6 +28,11 @@ int event_load(conf_t *conf, zone_t *zone)
 {
 	assert(zone);
 
+	/* Zone alias has no own contents. */
+	if (zone->alias_of != NULL) {
+		return KNOT_EOK;
+	}
+
 	zone_contents_t *contents = NULL;
 
 	/* Take zone file mtime and load it. */
@@ -98,14 +98,22 @@ static void replan_flush(conf_t *conf, zone_t *zone, const zone_t *old_zone)
 /*!< \brief Creates new DDNS q in the new zone - q contains references from the old zone. */
 static void duplicate_ddns_q(zone_t *zone, zone_t *old_zone)
 {
+	// The old zone may still be processing updates or receiving new ones.
+	pthread_mutex_lock(&old_zone->ddns_lock);
+	pthread_mutex_lock(&zone->ddns_lock);
+
 	ptrnode_t *node = NULL;
 	WALK_LIST(node, old_zone->ddns_queue) {
 		ptrlist_add(&zone->ddns_queue, node->d, NULL);
 	}
-	zone->ddns_queue_size = old_zone->ddns_queue_size;
+	zone->ddns_queue_size += old_zone->ddns_queue_size;
 
 	// Reset the list, new zone will free the data.
 	ptrlist_free(&old_zone->ddns_queue, NULL);
+	old_zone->ddns_queue_size = 0;
+
+	pthread_mutex_unlock(&zone->ddns_lock);
+	pthread_mutex_unlock(&old_zone->ddns_lock);
 }
 
 /*!< Replans DNSSEC event. Not whole resign needed, \todo #247 */
@@ -14,6 +14,9 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <poll.h>
+#include <unistd.h>
+
 #include "knot/query/requestor.h"
 #include "knot/common/log.h"
 #include "knot/modules/dnsproxy.h"
@@ -54,9 +57,77 @@ struct dnsproxy {
 	int timeout;
 };
 
+/*! \brief Send the query over UDP and suspend until the response arrives. */
+static int dnsproxy_send(int state, struct query_data *qdata, struct dnsproxy *proxy)
+{
+	int *fd = mm_alloc(qdata->mm, sizeof(*fd));
+	if (fd == NULL) {
+		return state; /* Ignore, not enough memory. */
+	}
+
+	const struct sockaddr *dst = (const struct sockaddr *)&proxy->remote.addr;
+	const struct sockaddr *src = (const struct sockaddr *)&proxy->remote.via;
+	*fd = net_connected_socket(SOCK_DGRAM, dst, src);
+	if (*fd < 0) {
+		qdata->rcode = KNOT_RCODE_SERVFAIL;
+		return KNOT_STATE_FAIL;
+	}
+
+	knot_pkt_t *query = qdata->query;
+	if (net_dgram_send(*fd, query->wire, query->size, NULL) != query->size) {
+		close(*fd);
+		qdata->rcode = KNOT_RCODE_SERVFAIL;
+		return KNOT_STATE_FAIL;
+	}
+
+	return process_query_yield(qdata, *fd, POLLIN, proxy->timeout, fd);
+}
+
+/*! \brief Receive the response of a suspended forwarding. */
+static int dnsproxy_recv(knot_pkt_t *pkt, struct query_data *qdata)
+{
+	int *fd = qdata->yield.data;
+	knot_pkt_t *resp = NULL;
+	int ret = KNOT_ECONN;
+
+	if (qdata->yield.revents & POLLIN) {
+		resp = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, qdata->mm);
+		if (resp != NULL) {
+			ret = net_dgram_recv(*fd, resp->wire, resp->max_size, 0);
+		}
+	}
+	close(*fd);
+
+	if (ret > 0) {
+		resp->size = ret;
+		(void) knot_pkt_parse(resp, 0);
+		ret = knot_pkt_copy(pkt, resp);
+	} else {
+		ret = KNOT_ECONN;
+	}
+	knot_pkt_free(&resp);
+
+	/* Check result. */
+	if (ret != KNOT_EOK) {
+		qdata->rcode = KNOT_RCODE_SERVFAIL;
+		return KNOT_STATE_FAIL; /* Forwarding failed, SERVFAIL. */
+	}
+
+	return KNOT_STATE_DONE;
+}
+
 static int dnsproxy_fwd(int state, knot_pkt_t *pkt, struct query_data *qdata, void *ctx)
 {
-	if (pkt == NULL || qdata == NULL || ctx == NULL) {
+	if (pkt == NULL || qdata == NULL) {
+		return KNOT_STATE_FAIL;
+	}
+
+	/* Resume suspended forwarding, also without context if abandoned. */
+	if (qdata->yield.data != NULL) {
+		return dnsproxy_recv(pkt, qdata);
+	}
+
+	if (ctx == NULL) {
 		return KNOT_STATE_FAIL;
 	}
 
@@ -67,6 +138,12 @@ static int dnsproxy_fwd(int state, knot_pkt_t *pkt, struct query_data *qdata, vo
 		return state;
 	}
 
+	/* Don't block the UDP handler if the query can be suspended. */
+	bool is_tcp = net_is_stream(qdata->param->socket);
+	if (!is_tcp && process_query_can_yield(qdata)) {
+		return dnsproxy_send(state, qdata, proxy);
+	}
+
 	/* Capture layer context. */
 	const knot_layer_api_t *capture = query_capture_api();
 	struct capture_param capture_param = {
@@ -80,7 +157,6 @@ static int dnsproxy_fwd(int state, knot_pkt_t *pkt, struct query_data *qdata, vo
 		return state; /* Ignore, not enough memory. */
 	}
 
-	bool is_tcp = net_is_stream(qdata->param->socket);
 	const struct sockaddr *dst = (const struct sockaddr *)&proxy->remote.addr;
 	const struct sockaddr *src = (const struct sockaddr *)&proxy->remote.via;
 	struct knot_request *req = knot_request_make(re.mm, dst, src, qdata->query,
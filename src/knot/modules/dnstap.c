@@ -71,6 +71,11 @@ static int log_message(int state, const knot_pkt_t *pkt, struct query_data *qdat
 		return KNOT_STATE_FAIL;
 	}
 
+	/* Logging is the first to go under overload. */
+	if (qdata->param->proc_flags & NS_QUERY_DEGRADED) {
+		return state;
+	}
+
 	int ret = KNOT_ERROR;
 	struct fstrm_iothr_queue *ioq =
 		fstrm_iothr_get_input_queue_idx(ctx->iothread, qdata->param->thread_id);
@@ -587,6 +587,8 @@ int online_sign_load(struct query_plan *plan, struct query_module *module,
 		return KNOT_ERROR;
 	}
 
+	plan->expensive = true;
+
 	query_plan_step(plan, QPLAN_ANSWER, synth_answer, ctx);
 	query_plan_step(plan, QPLAN_ANSWER, sign_section, ctx);
 
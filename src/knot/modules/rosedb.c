@@ -15,6 +15,7 @@
  */
 
 #include <lmdb.h>
+#include <stdint.h>
 
 #include "dnssec/random.h"
 #include "knot/common/log.h"
@@ -53,7 +54,14 @@ int check_mod_rosedb(conf_check_t *args)
  *        as the cache implementation requires DUPSORT.
  */
 
+/*! \note The map costs only address space, so reserve enough of it for the
+ *        query path never to resize the map under the running transactions.
+ */
+#if SIZE_MAX > UINT32_MAX
+#define LMDB_MAPSIZE ((size_t)16 * 1024 * 1024 * 1024)
+#else
 #define LMDB_MAPSIZE (100 * 1024 * 1024)
+#endif
 
 struct cache
 {
@@ -136,6 +144,49 @@ static void dbase_close(struct cache *cache)
 	mdb_env_close(cache->env);
 }
 
+/*! \brief Double the map size, no transaction may be active. */
+static int dbase_grow(struct cache *cache)
+{
+	long page_size = sysconf(_SC_PAGESIZE);
+	if (page_size <= 0) {
+		return KNOT_EINVAL;
+	}
+
+	MDB_envinfo info;
+	int ret = mdb_env_info(cache->env, &info);
+	if (ret != 0) {
+		return ret;
+	}
+
+	size_t map_size = ((2 * info.me_mapsize) / page_size) * page_size;
+	if (map_size <= info.me_mapsize) {
+		return MDB_MAP_FULL;
+	}
+
+	return mdb_env_set_mapsize(cache->env, map_size);
+}
+
+/*!
+ * \brief Adjust the map after a transaction failed on its size.
+ *
+ * Grows the map on MDB_MAP_FULL, adopts the map grown by another process
+ * on MDB_MAP_RESIZED.
+ *
+ * \note No transaction may be active in the process, so only the tool may
+ *       call this. The query path ignores the database until reloaded.
+ */
+static int cache_remap(struct cache *cache, int error)
+{
+	switch (error) {
+	case MDB_MAP_FULL:
+		return dbase_grow(cache);
+	case MDB_MAP_RESIZED:
+		return mdb_env_set_mapsize(cache->env, 0);
+	default:
+		return error;
+	}
+}
+
 /*                       data access                                          */
 
 static MDB_cursor *cursor_acquire(MDB_txn *txn, MDB_dbi dbi)
@@ -603,13 +654,11 @@ static int rosedb_query(int state, knot_pkt_t *pkt, struct query_data *qdata, vo
 	}
 
 	ret = rosedb_query_txn(txn, cache->dbi, pkt, qdata);
+	mdb_txn_abort(txn);
 	if (ret != 0) { /* Can't find matching zone, ignore. */
-		mdb_txn_abort(txn);
 		return state;
 	}
 
-	mdb_txn_abort(txn);
-
 	return KNOT_STATE_DONE;
 }
 
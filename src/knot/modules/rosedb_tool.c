@@ -134,20 +134,30 @@ int main(int argc, char *argv[])
 			/* Now set as found. */
 			found = true;
 
-			MDB_txn *txn = NULL;
-			int ret = mdb_txn_begin(cache->env, NULL, 0, &txn);
-			if (ret != MDB_SUCCESS) {
-				fprintf(stderr, "failed to open transaction, aborting\n");
-				break;
-			}
-
-			/* Execute operation handler. */
-			ret = ta->func(cache, txn, argc, argv);
-			if (ret != 0) {
+			/* Retry with a bigger map if the database is full. */
+			int txn_ret;
+			do {
+				MDB_txn *txn = NULL;
+				txn_ret = mdb_txn_begin(cache->env, NULL, 0, &txn);
+				if (txn_ret == MDB_MAP_RESIZED) {
+					continue;
+				} else if (txn_ret != MDB_SUCCESS) {
+					fprintf(stderr, "failed to open transaction, aborting\n");
+					break;
+				}
+
+				/* Execute operation handler. */
+				txn_ret = ta->func(cache, txn, argc, argv);
+				if (txn_ret != 0) {
+					mdb_txn_abort(txn);
+				} else {
+					txn_ret = mdb_txn_commit(txn);
+				}
+			} while ((txn_ret == MDB_MAP_FULL || txn_ret == MDB_MAP_RESIZED) &&
+			         cache_remap(cache, txn_ret) == 0);
+
+			if (txn_ret != 0) {
 				fprintf(stderr, "'%s' failed, aborting transaction\n", action);
-				mdb_txn_abort(txn);
-			} else {
-				mdb_txn_commit(txn);
 			}
 
 			break;
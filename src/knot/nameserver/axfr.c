@@ -20,9 +20,12 @@
 #include "contrib/print.h"
 #include "contrib/sockaddr.h"
 #include "knot/common/log.h"
+#include "knot/common/probe.h"
 #include "knot/conf/conf.h"
+#include "knot/dnssec/zone-verify.h"
 #include "knot/nameserver/axfr.h"
 #include "knot/nameserver/internet.h"
+#include "knot/server/dthreads.h"
 #include "knot/zone/zonefile.h"
 #include "libknot/libknot.h"
 
@@ -233,6 +236,7 @@ int axfr_process_query(knot_pkt_t *pkt, struct query_data *qdata)
 		} else {
 			AXFROUT_LOG(LOG_INFO, "started, serial %u",
 			           zone_contents_serial(qdata->zone->contents));
+			KNOT_PROBE1(axfr__out__start, qdata->zone->name);
 		}
 	}
 
@@ -251,10 +255,14 @@ int axfr_process_query(knot_pkt_t *pkt, struct query_data *qdata)
 		            "finished, %.02f seconds, %u messages, %u bytes",
 		            time_diff(&axfr->proc.tstamp, &now) / 1000.0,
 		            axfr->proc.npkts, axfr->proc.nbytes);
+		KNOT_PROBE3(axfr__out__done, qdata->zone->name, KNOT_EOK,
+		            axfr->proc.nbytes);
 		return KNOT_STATE_DONE;
 		break;
 	default:          /* Generic error. */
 		AXFROUT_LOG(LOG_ERR, "failed (%s)", knot_strerror(ret));
+		KNOT_PROBE3(axfr__out__done, qdata->zone->name, ret,
+		            axfr->proc.nbytes);
 		return KNOT_STATE_FAIL;
 	}
 }
@@ -323,8 +331,20 @@ static int axfr_answer_finalize(struct answer_data *adata)
 		return rc;
 	}
 
-	conf_val_t val = conf_zone_get(adata->param->conf, C_MAX_ZONE_SIZE,
+	conf_val_t val = conf_zone_get(adata->param->conf, C_DNSSEC_VALIDATION,
 	                               proc->contents->apex->owner);
+	if (conf_bool(&val)) {
+		rc = knot_zone_verify(proc->contents, time(NULL), dt_optimal_size(),
+		                      &handler._cb);
+		if (rc != KNOT_EOK) {
+			AXFRIN_LOG(LOG_WARNING, "DNSSEC validation failed (%s)",
+			           knot_strerror(rc));
+			return rc;
+		}
+	}
+
+	val = conf_zone_get(adata->param->conf, C_MAX_ZONE_SIZE,
+	                    proc->contents->apex->owner);
 	int64_t size_limit = conf_int(&val);
 
 	if (proc->contents->size > size_limit) {
@@ -418,6 +438,7 @@ int axfr_process_answer(knot_pkt_t *pkt, struct answer_data *adata)
 	if (adata->ext == NULL) {
 		NS_NEED_TSIG_SIGNED(&adata->param->tsig_ctx, 0);
 		AXFRIN_LOG(LOG_INFO, "starting");
+		KNOT_PROBE1(axfr__in__start, adata->param->zone->name);
 
 		int ret = axfr_answer_init(adata);
 		if (ret != KNOT_EOK) {
@@ -437,6 +458,7 @@ int axfr_process_answer(knot_pkt_t *pkt, struct answer_data *adata)
 		if (fret != KNOT_EOK) {
 			ret = KNOT_STATE_FAIL;
 		}
+		KNOT_PROBE2(axfr__in__done, adata->param->zone->name, fret);
 	}
 
 	return ret;
@@ -16,6 +16,7 @@
 
 #include "libknot/libknot.h"
 #include "libknot/descriptor.h"
+#include "libknot/rrtype/naptr.h"
 #include "libknot/rrtype/rdname.h"
 #include "libknot/rrtype/soa.h"
 #include "knot/common/log.h"
@@ -27,6 +28,7 @@
 #include "knot/nameserver/query_module.h"
 #include "knot/zone/serial.h"
 #include "knot/zone/zonedb.h"
+#include "contrib/macros.h"
 #include "contrib/mempattern.h"
 #include "contrib/sockaddr.h"
 
@@ -121,10 +123,168 @@ static bool dname_cname_cannot_synth(const knot_rrset_t *rrset, const knot_dname
 	}
 }
 
+/*!
+ * \brief Rewrites a name from the answering zone to the queried zone alias.
+ *
+ * \return Size of the written name or an error code.
+ */
+static int alias_dname_rewrite(uint8_t *dst, size_t maxlen, const knot_dname_t *name,
+                               const knot_dname_t *zone, const knot_dname_t *alias)
+{
+	/* Names outside of the zone are kept. */
+	if (!knot_dname_in(zone, name)) {
+		int size = knot_dname_size(name);
+		if (size > maxlen) {
+			return KNOT_ESPACE;
+		}
+		memcpy(dst, name, size);
+		return size;
+	}
+
+	int labels = knot_dname_labels(name, NULL) - knot_dname_labels(zone, NULL);
+	int prefix_size = knot_dname_prefixlen(name, labels, NULL);
+	int alias_size = knot_dname_size(alias);
+	if (prefix_size + alias_size > MIN(maxlen, KNOT_DNAME_MAXLEN)) {
+		return KNOT_ESPACE;
+	}
+
+	memcpy(dst, name, prefix_size);
+	memcpy(dst + prefix_size, alias, alias_size);
+
+	return prefix_size + alias_size;
+}
+
+/*! \brief Rewrites names in the RDATA from the answering zone to the zone alias. */
+static int alias_rdata_rewrite(uint8_t *dst, size_t maxlen, const knot_rdata_t *rdata,
+                               const knot_rdata_descriptor_t *desc,
+                               const knot_dname_t *zone, const knot_dname_t *alias)
+{
+	const uint8_t *pos = knot_rdata_data(rdata);
+	const uint8_t *end = pos + knot_rdata_rdlen(rdata);
+	size_t size = 0;
+
+	for (int i = 0; desc->block_types[i] != KNOT_RDATA_WF_END && pos < end; ++i) {
+		int type = desc->block_types[i];
+		int block_size = 0;
+		switch (type) {
+		case KNOT_RDATA_WF_COMPRESSIBLE_DNAME:
+		case KNOT_RDATA_WF_DECOMPRESSIBLE_DNAME:
+		case KNOT_RDATA_WF_FIXED_DNAME:
+			block_size = alias_dname_rewrite(dst + size, maxlen - size,
+			                                 pos, zone, alias);
+			if (block_size < 0) {
+				return block_size;
+			}
+			pos += knot_dname_size(pos);
+			size += block_size;
+			continue;
+		case KNOT_RDATA_WF_NAPTR_HEADER:
+			block_size = knot_naptr_header_size(pos, end);
+			if (block_size < 0) {
+				return block_size;
+			}
+			break;
+		case KNOT_RDATA_WF_REMAINDER:
+			block_size = end - pos;
+			break;
+		default:
+			/* Fixed size block */
+			assert(type > 0);
+			block_size = type;
+		}
+
+		if (block_size > end - pos || block_size > maxlen - size) {
+			return KNOT_EMALF;
+		}
+		memcpy(dst + size, pos, block_size);
+		pos += block_size;
+		size += block_size;
+	}
+
+	return size;
+}
+
+/*!
+ * \brief Synthesizes a copy of the RRSet with names rewritten to the zone alias.
+ *
+ * Names at or below the answering zone apex are moved below the zone alias
+ * apex both in the owner and in the RDATA.
+ */
+static int alias_rrset_synth(knot_rrset_t *dst, const knot_rrset_t *src,
+                             const knot_dname_t *owner, struct query_data *qdata,
+                             knot_mm_t *mm)
+{
+	const knot_dname_t *zone = qdata->zone->name;
+
+	uint8_t owner_buf[KNOT_DNAME_MAXLEN];
+	int ret = alias_dname_rewrite(owner_buf, sizeof(owner_buf), owner, zone,
+	                              qdata->alias);
+	if (ret < 0) {
+		return ret;
+	}
+
+	knot_dname_t *owner_copy = knot_dname_copy(owner_buf, mm);
+	if (owner_copy == NULL) {
+		return KNOT_ENOMEM;
+	}
+	knot_rrset_init(dst, owner_copy, src->type, src->rclass);
+	dst->additional = src->additional;
+
+	/* Share RDATA without names. */
+	const knot_rdata_descriptor_t *desc = knot_get_rdata_descriptor(src->type);
+	int dnames = 0;
+	for (int i = 0; desc->block_types[i] != KNOT_RDATA_WF_END; ++i) {
+		int type = desc->block_types[i];
+		if (type == KNOT_RDATA_WF_COMPRESSIBLE_DNAME ||
+		    type == KNOT_RDATA_WF_DECOMPRESSIBLE_DNAME ||
+		    type == KNOT_RDATA_WF_FIXED_DNAME) {
+			dnames++;
+		}
+	}
+	if (dnames == 0) {
+		ret = knot_rdataset_copy(&dst->rrs, &src->rrs, mm);
+		if (ret != KNOT_EOK) {
+			knot_rrset_clear(dst, mm);
+		}
+		return ret;
+	}
+
+	for (uint16_t i = 0; i < src->rrs.rr_count; ++i) {
+		const knot_rdata_t *rdata = knot_rdataset_at(&src->rrs, i);
+		/* Each name may grow by at most KNOT_DNAME_MAXLEN. */
+		uint8_t buf[knot_rdata_rdlen(rdata) + dnames * KNOT_DNAME_MAXLEN];
+		ret = alias_rdata_rewrite(buf, MIN(sizeof(buf), UINT16_MAX), rdata,
+		                          desc, zone, qdata->alias);
+		if (ret >= 0) {
+			ret = knot_rrset_add_rdata(dst, buf, ret, knot_rdata_ttl(rdata), mm);
+		}
+		if (ret != KNOT_EOK) {
+			knot_rrset_clear(dst, mm);
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+/*! \brief Check if the packet contains RRSet of the same owner and type. */
+static bool alias_pkt_contains(const knot_pkt_t *pkt, const knot_rrset_t *rr)
+{
+	for (uint16_t i = 0; i < pkt->rrset_count; ++i) {
+		if (pkt->rr[i].type == rr->type &&
+		    knot_dname_is_equal(pkt->rr[i].owner, rr->owner)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 /*! \brief DNSSEC both requested & available. */
 static bool have_dnssec(struct query_data *qdata)
 {
-	return knot_pkt_has_dnssec(qdata->query) &&
+	/* Signatures don't cover rewritten names of a zone alias. */
+	return knot_pkt_has_dnssec(qdata->query) && qdata->alias == NULL &&
 	       zone_contents_is_signed(qdata->zone->contents);
 }
 
@@ -297,6 +457,10 @@ static int put_additional(knot_pkt_t *pkt, const knot_rrset_t *rr,
 
 		/* Optional glue doesn't cause truncation. (RFC 1034/4.3.2 step 3b). */
 		if (state != DELEG || glue->optional) {
+			/* Minimal responses if overloaded. */
+			if (qdata->param->proc_flags & NS_QUERY_DEGRADED) {
+				continue;
+			}
 			flags |= KNOT_PF_NOTRUNC;
 		}
 
@@ -668,7 +832,24 @@ int ns_put_rr(knot_pkt_t *pkt, const knot_rrset_t *rr,
 	 * we can just insert RRSet and fake synthesis by using compression
 	 * hint. */
 	knot_rrset_t to_add;
-	if (compr_hint == KNOT_COMPR_HINT_NONE && expand) {
+	if (qdata->alias != NULL) {
+		/* Signatures and proofs don't cover the rewritten names. */
+		if (knot_rrtype_is_dnssec(rr->type)) {
+			return KNOT_EOK;
+		}
+		/* Zone alias, rewrite the names. The compression hint stays
+		 * valid as the QNAME was rewritten the same way. */
+		ret = alias_rrset_synth(&to_add, rr, expand ? qdata->name : rr->owner,
+		                        qdata, &pkt->mm);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+		if ((flags & KNOT_PF_CHECKDUP) && alias_pkt_contains(pkt, &to_add)) {
+			knot_rrset_clear(&to_add, &pkt->mm);
+			return KNOT_EOK;
+		}
+		flags |= KNOT_PF_FREE;
+	} else if (compr_hint == KNOT_COMPR_HINT_NONE && expand) {
 		knot_dname_t *qname_cpy = knot_dname_copy(qdata->name, &pkt->mm);
 		if (qname_cpy == NULL) {
 			return KNOT_ENOMEM;
@@ -693,7 +874,7 @@ int ns_put_rr(knot_pkt_t *pkt, const knot_rrset_t *rr,
 	}
 
 	const bool inserted = (prev_count != pkt->rrset_count);
-	if (inserted &&
+	if (inserted && qdata->alias == NULL &&
 	    !knot_rrset_empty(rrsigs) && rr->type != KNOT_RRTYPE_RRSIG) {
 		// Get rrinfo of just inserted RR.
 		knot_rrinfo_t *rrinfo = &pkt->rr_info[pkt->rrset_count - 1];
@@ -785,6 +966,45 @@ static int answer_query(struct query_plan *plan, knot_pkt_t *response, struct qu
 
 #undef SOLVE_STEP
 
+/*!
+ * \brief Switch the answering zone to the zone the queried zone is alias of.
+ *
+ * The QNAME is moved below the aliased zone apex, the answer names are
+ * moved back when written, see ns_put_rr().
+ */
+static int alias_resolve(struct query_data *qdata)
+{
+	const zone_t *alias = qdata->zone;
+
+	knot_zonedb_t *zonedb = qdata->param->server->zone_db;
+	const zone_t *zone = knot_zonedb_find(zonedb, alias->alias_of);
+	if (zone == NULL || zone->alias_of != NULL) {
+		return KNOT_ENOZONE;
+	}
+
+	/* Replace the QNAME suffix, the name must fit. */
+	int labels = knot_dname_labels(alias->name, NULL);
+	int prefix_size = knot_dname_prefixlen(qdata->name, knot_dname_labels(
+	                                       qdata->name, NULL) - labels, NULL);
+	int zone_size = knot_dname_size(zone->name);
+	if (prefix_size + zone_size > KNOT_DNAME_MAXLEN) {
+		return KNOT_EINVAL;
+	}
+
+	knot_dname_t *name = mm_alloc(qdata->mm, prefix_size + zone_size);
+	if (name == NULL) {
+		return KNOT_ENOMEM;
+	}
+	memcpy(name, qdata->name, prefix_size);
+	memcpy(name + prefix_size, zone->name, zone_size);
+
+	qdata->alias = alias->name;
+	qdata->zone = zone;
+	qdata->name = name;
+
+	return KNOT_EOK;
+}
+
 int internet_process_query(knot_pkt_t *response, struct query_data *qdata)
 {
 	if (response == NULL || qdata == NULL) {
@@ -803,12 +1023,29 @@ int internet_process_query(knot_pkt_t *response, struct query_data *qdata)
 		knot_pkt_reserve(response, knot_tsig_wire_maxsize(&qdata->sign.tsig_key));
 	}
 
-	NS_NEED_ZONE_CONTENTS(qdata, KNOT_RCODE_SERVFAIL); /* Expired */
+	/* Query plan of the queried zone, even if aliased. */
+	struct query_plan *plan = qdata->zone->query_plan;
 
 	/* Get answer to QNAME. */
 	qdata->name = knot_pkt_qname(qdata->query);
 
-	return answer_query(qdata->zone->query_plan, response, qdata);
+	/* Answer from the aliased zone instead. */
+	if (qdata->zone->alias_of != NULL) {
+		int ret = alias_resolve(qdata);
+		if (ret != KNOT_EOK) {
+			qdata->rcode = KNOT_RCODE_SERVFAIL;
+			return KNOT_STATE_FAIL;
+		}
+	}
+
+	NS_NEED_ZONE_CONTENTS(qdata, KNOT_RCODE_SERVFAIL); /* Expired */
+
+	/* Sample the name for the warm-up of new zone contents. */
+	if (qdata->zone->flags & ZONE_WARM_UP) {
+		zone_hot_record(qdata->zone->hot, qdata->name);
+	}
+
+	return answer_query(plan, response, qdata);
 }
 
 #include "knot/nameserver/log.h"
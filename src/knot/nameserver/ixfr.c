@@ -17,9 +17,12 @@
 #include <urcu.h>
 
 #include "knot/common/log.h"
+#include "knot/common/probe.h"
+#include "knot/dnssec/zone-verify.h"
 #include "knot/nameserver/axfr.h"
 #include "knot/nameserver/ixfr.h"
 #include "knot/nameserver/internet.h"
+#include "knot/server/dthreads.h"
 #include "knot/updates/apply.h"
 #include "knot/zone/serial.h"
 #include "knot/zone/semantic-check.h"
@@ -395,8 +398,23 @@ static int ixfrin_finalize(struct answer_data *adata)
 		return ret;
 	}
 
-	conf_val_t val = conf_zone_get(adata->param->conf, C_MAX_ZONE_SIZE,
+	conf_val_t val = conf_zone_get(adata->param->conf, C_DNSSEC_VALIDATION,
 	                               ixfr->zone->name);
+	if (conf_bool(&val)) {
+		ret = knot_zone_verify_changesets(new_contents, &ixfr->changesets,
+		                                  time(NULL), dt_optimal_size(),
+		                                  &handler._cb);
+		if (ret != KNOT_EOK) {
+			IXFRIN_LOG(LOG_WARNING, "DNSSEC validation failed (%s)",
+			           knot_strerror(ret));
+			update_rollback(&a_ctx);
+			update_free_zone(&new_contents);
+			return ret;
+		}
+	}
+
+	val = conf_zone_get(adata->param->conf, C_MAX_ZONE_SIZE,
+	                    ixfr->zone->name);
 	const int64_t size_limit = conf_int(&val);
 
 	if (new_contents->size > size_limit) {
@@ -417,7 +435,8 @@ static int ixfrin_finalize(struct answer_data *adata)
 	}
 
 	/* Switch zone contents. */
-	zone_contents_t *old_contents = zone_switch_contents(ixfr->zone, new_contents);
+	zone_contents_t *old_contents = zone_switch_changes(ixfr->zone, new_contents,
+	                                                    &ixfr->changesets);
 	ixfr->zone->flags &= ~ZONE_EXPIRED;
 	synchronize_rcu();
 
@@ -673,6 +692,7 @@ int ixfr_process_query(knot_pkt_t *pkt, struct query_data *qdata)
 			IXFROUT_LOG(LOG_INFO, "started, serial %u -> %u",
 			            knot_soa_serial(&ixfr->soa_from->rrs),
 			            knot_soa_serial(&ixfr->soa_to->rrs));
+			KNOT_PROBE1(ixfr__out__start, qdata->zone->name);
 			break;
 		case KNOT_EUPTODATE: /* Our zone is same age/older, send SOA. */
 			IXFROUT_LOG(LOG_INFO, "zone is up-to-date");
@@ -702,10 +722,14 @@ int ixfr_process_query(knot_pkt_t *pkt, struct query_data *qdata)
 		            "finished, %.02f seconds, %u messages, %u bytes",
 		            time_diff(&ixfr->proc.tstamp, &now) / 1000.0,
 		            ixfr->proc.npkts, ixfr->proc.nbytes);
+		KNOT_PROBE3(ixfr__out__done, qdata->zone->name, KNOT_EOK,
+		            ixfr->proc.nbytes);
 		ret = KNOT_STATE_DONE;
 		break;
 	default:          /* Generic error. */
 		IXFROUT_LOG(LOG_ERR, "failed (%s)", knot_strerror(ret));
+		KNOT_PROBE3(ixfr__out__done, qdata->zone->name, ret,
+		            ixfr->proc.nbytes);
 		ret = KNOT_STATE_FAIL;
 		break;
 	}
@@ -763,6 +787,7 @@ int ixfr_process_answer(knot_pkt_t *pkt, struct answer_data *adata)
 		}
 
 		IXFRIN_LOG(LOG_INFO, "starting");
+		KNOT_PROBE1(ixfr__in__start, adata->param->zone->name);
 		// First packet with IXFR, init context
 		int ret = ixfrin_answer_init(adata);
 		if (ret != KNOT_EOK) {
@@ -780,6 +805,7 @@ int ixfr_process_answer(knot_pkt_t *pkt, struct answer_data *adata)
 		if (fret != KNOT_EOK) {
 			ret = KNOT_STATE_FAIL;
 		}
+		KNOT_PROBE2(ixfr__in__done, adata->param->zone->name, fret);
 	}
 
 	return ret;
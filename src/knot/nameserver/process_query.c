@@ -14,10 +14,12 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <poll.h>
 #include <urcu.h>
 
 #include "dnssec/tsig.h"
 #include "knot/common/log.h"
+#include "knot/common/probe.h"
 #include "knot/nameserver/process_query.h"
 #include "knot/nameserver/query_module.h"
 #include "knot/nameserver/chaos.h"
@@ -27,6 +29,7 @@
 #include "knot/nameserver/update.h"
 #include "knot/nameserver/nsec_proofs.h"
 #include "knot/nameserver/notify.h"
+#include "knot/dnssec/zone-nsec.h"
 #include "libknot/libknot.h"
 #include "contrib/macros.h"
 #include "contrib/mempattern.h"
@@ -61,6 +64,73 @@ static int process_query_begin(knot_layer_t *ctx, void *module_param)
 	return KNOT_STATE_CONSUME;
 }
 
+/*! \brief Query processing cost classes. */
+enum query_cost {
+	QUERY_COST_CHEAP = 0, /*!< Plain lookups, transfers, notifications. */
+	QUERY_COST_EXPENSIVE  /*!< ANY, NSEC3 denials, online signing, updates. */
+};
+
+/*! \brief Estimate the query processing cost before answering. */
+static int query_cost(const knot_pkt_t *query, const struct query_data *qdata)
+{
+	switch (qdata->packet_type) {
+	case KNOT_QUERY_NORMAL:
+		break;
+	case KNOT_QUERY_UPDATE:
+		return QUERY_COST_EXPENSIVE;
+	default:
+		return QUERY_COST_CHEAP;
+	}
+
+	if (knot_pkt_qtype(query) == KNOT_RRTYPE_ANY) {
+		return QUERY_COST_EXPENSIVE;
+	}
+
+	const zone_t *zone = qdata->zone;
+	if (zone == NULL || zone->contents == NULL || zone->alias_of != NULL) {
+		return QUERY_COST_CHEAP;
+	}
+
+	/* Answers are signed on the fly. */
+	if (zone->query_plan != NULL && zone->query_plan->expensive) {
+		return QUERY_COST_EXPENSIVE;
+	}
+
+	/* Denial of existence needs NSEC3 hashing. */
+	if (knot_pkt_has_dnssec(query) && knot_is_nsec3_enabled(zone->contents) &&
+	    zone_contents_find_node(zone->contents, knot_pkt_qname(query)) == NULL) {
+		return QUERY_COST_EXPENSIVE;
+	}
+
+	return QUERY_COST_CHEAP;
+}
+
+/*! \brief Admit the query, expensive queries only within the configured limit. */
+static bool cost_admit(const knot_pkt_t *query, struct query_data *qdata)
+{
+	int limit = conf()->cache.srv_max_expensive_queries;
+	if (limit == 0 || query_cost(query, qdata) == QUERY_COST_CHEAP) {
+		return true;
+	}
+
+	server_t *server = qdata->param->server;
+	if (__sync_add_and_fetch(&server->expensive_queries, 1) > limit) {
+		__sync_sub_and_fetch(&server->expensive_queries, 1);
+		return false;
+	}
+
+	qdata->expensive = true;
+	return true;
+}
+
+static void cost_release(struct query_data *qdata)
+{
+	if (qdata->expensive) {
+		__sync_sub_and_fetch(&qdata->param->server->expensive_queries, 1);
+		qdata->expensive = false;
+	}
+}
+
 static int process_query_reset(knot_layer_t *ctx)
 {
 	assert(ctx);
@@ -69,6 +139,9 @@ static int process_query_reset(knot_layer_t *ctx)
 	/* Remember persistent parameters. */
 	struct process_query_param *module_param = qdata->param;
 
+	/* Release the expensive query slot. */
+	cost_release(qdata);
+
 	/* Free allocated data. */
 	ptrlist_free(&qdata->wildcards, qdata->mm);
 	nsec_clear_rrsigs(qdata);
@@ -112,6 +185,8 @@ static int process_query_in(knot_layer_t *ctx, knot_pkt_t *pkt)
 	qdata->query = pkt;
 	qdata->packet_type = knot_pkt_type(pkt);
 
+	KNOT_PROBE3(query__receive, qdata, qdata->packet_type, pkt->size);
+
 	/* Declare having response. */
 	return KNOT_STATE_PRODUCE;
 }
@@ -221,6 +296,40 @@ static int answer_edns_reserve(knot_pkt_t *resp, struct query_data *qdata)
 	return knot_pkt_reserve(resp, knot_edns_wire_size(&qdata->opt_rr));
 }
 
+static int answer_edns_keepalive(const knot_pkt_t *query,
+                                 struct query_data *qdata)
+{
+	uint8_t *opt = knot_edns_get_option(query->opt_rr,
+	                                    KNOT_EDNS_OPTION_TCP_KEEPALIVE);
+	if (opt == NULL) {
+		return KNOT_EOK;
+	}
+
+	/* Ignored over UDP, the option is meaningful only for TCP. */
+	unsigned keepalive = qdata->param->tcp_keepalive;
+	if (keepalive == 0) {
+		return KNOT_EOK;
+	}
+
+	/* Clients must not send the timeout value. */
+	if (knot_edns_opt_get_length(opt) != 0) {
+		qdata->rcode = KNOT_RCODE_FORMERR;
+		return KNOT_EOK;
+	}
+
+	/* Timeout in units of 100 milliseconds. */
+	uint16_t timeout = MIN(keepalive * 10, UINT16_MAX);
+	uint8_t data[KNOT_EDNS_MAX_OPTION_TCP_KEEPALIVE];
+	size_t data_len = knot_edns_keepalive_size(timeout);
+	int ret = knot_edns_keepalive_write(data, sizeof(data), timeout);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	return knot_edns_add_option(&qdata->opt_rr, KNOT_EDNS_OPTION_TCP_KEEPALIVE,
+	                            data_len, data, qdata->mm);
+}
+
 static int answer_edns_init(const knot_pkt_t *query, knot_pkt_t *resp,
                             struct query_data *qdata)
 {
@@ -282,6 +391,12 @@ static int answer_edns_init(const knot_pkt_t *query, knot_pkt_t *resp,
 		}
 	}
 
+	/* Advertise TCP idle timeout if requested (RFC 7828). */
+	ret = answer_edns_keepalive(query, qdata);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
 	return answer_edns_reserve(resp, qdata);
 }
 
@@ -338,8 +453,12 @@ static int prepare_answer(const knot_pkt_t *query, knot_pkt_t *resp, knot_layer_
 	if (ret != KNOT_EOK) {
 		return ret;
 	}
-	/* Find zone for QNAME. */
-	qdata->zone = answer_zone_find(query, server->zone_db);
+	/* Find zone for QNAME, unless already found by the caller. */
+	if (qdata->param->proc_flags & NS_QUERY_ZONE_FOUND) {
+		qdata->zone = qdata->param->zone;
+	} else {
+		qdata->zone = answer_zone_find(query, server->zone_db);
+	}
 
 	/* Setup EDNS. */
 	ret = answer_edns_init(query, resp, qdata);
@@ -456,8 +575,11 @@ static int ratelimit_apply(int state, knot_pkt_t *pkt, knot_layer_t *ctx)
 		return state;
 	}
 
-	/* Now it is slip or drop. */
+	/* Now it is slip or drop, drop is cheaper if overloaded. */
 	int slip = conf()->cache.srv_rate_limit_slip;
+	if (qdata->param->proc_flags & NS_QUERY_DEGRADED) {
+		slip = 0;
+	}
 	if (slip > 0 && rrl_slip_roll(slip)) {
 		/* Answer slips. */
 		if (process_query_err(ctx, pkt) != KNOT_STATE_DONE) {
@@ -472,19 +594,173 @@ static int ratelimit_apply(int state, knot_pkt_t *pkt, knot_layer_t *ctx)
 	return KNOT_STATE_DONE;
 }
 
+/*!
+ * \brief Remember the suspended step and the zone answering the query.
+ *
+ * The read lock is released while suspended, so the plan and the zone are
+ * identified by values which are not reused after they are freed.
+ */
+static void yield_save(struct query_data *qdata, struct query_plan *plan,
+                       int stage, int state, struct query_step *step)
+{
+	struct query_yield *yield = &qdata->yield;
+	yield->stage = stage;
+	yield->state = state;
+	yield->plan_id = plan->id;
+	yield->step = step;
+	yield->process = step->process;
+
+	yield->has_zone = (qdata->zone != NULL);
+	yield->generation = 0;
+	if (yield->has_zone) {
+		const knot_dname_t *name = qdata->zone->name;
+		memcpy(yield->zone, name, knot_dname_size(name));
+		if (qdata->zone->contents != NULL) {
+			yield->generation = qdata->zone->contents->generation;
+		}
+	}
+}
+
+/*!
+ * \brief Check if the suspended step may continue and find the zone again.
+ *
+ * The answer being assembled after the BEGIN stage refers to the zone
+ * contents, which must stay the same.
+ *
+ * \note Must be called with the read lock held.
+ */
+static bool yield_restore(struct query_data *qdata, const struct query_plan *plan)
+{
+	struct query_yield *yield = &qdata->yield;
+	if (plan == NULL || plan->id != yield->plan_id) {
+		return false;
+	}
+
+	if (!yield->has_zone) {
+		return true;
+	}
+
+	const zone_t *zone = knot_zonedb_find(qdata->param->server->zone_db,
+	                                      yield->zone);
+	qdata->zone = zone;
+	if (yield->stage == QPLAN_BEGIN) {
+		return true;
+	}
+
+	if (zone == NULL) {
+		return false;
+	}
+
+	uint64_t generation = (zone->contents != NULL) ? zone->contents->generation : 0;
+	return generation == yield->generation;
+}
+
+/*!
+ * \brief Abandon the suspended step which can't continue.
+ *
+ * The step is called only to release its continuation, its context may be
+ * freed already.
+ */
+static void yield_abandon(knot_pkt_t *pkt, struct query_data *qdata)
+{
+	struct query_yield *yield = &qdata->yield;
+	yield->revents = POLLNVAL;
+	(void)yield->process(yield->state, pkt, qdata, NULL);
+	yield->data = NULL;
+
+	/* Drop references to the replaced zone contents. */
+	qdata->zone = NULL;
+	qdata->node = NULL;
+	qdata->encloser = NULL;
+	qdata->previous = NULL;
+	qdata->rcode = KNOT_RCODE_SERVFAIL;
+}
+
+/*!
+ * \brief Run query plan steps of the given stage.
+ *
+ * \param step  First step to run (NULL for the first step of the stage).
+ */
+static int run_steps(struct query_plan *plan, int stage, struct query_step *step,
+                     int state, knot_pkt_t *pkt, struct query_data *qdata)
+{
+	if (step == NULL) {
+		step = HEAD(plan->stage[stage]);
+	}
+
+	for (; step->node.next != NULL; step = (struct query_step *)step->node.next) {
+		qdata->yield.allowed = (qdata->param->proc_flags & NS_QUERY_YIELD);
+		int next_state = step->process(state, pkt, qdata, step->ctx);
+		qdata->yield.allowed = false;
+
+		/* Remember where to continue. */
+		if (next_state == KNOT_STATE_YIELD) {
+			yield_save(qdata, plan, stage, state, step);
+			return KNOT_STATE_YIELD;
+		}
+
+		qdata->yield.data = NULL;
+		state = next_state;
+	}
+
+	return state;
+}
+
+/*! \brief Charge a sampled query to the answering zone, under the read lock. */
+static void query_cputime(struct query_data *qdata, uint64_t begin)
+{
+	if (begin != 0 && qdata->zone != NULL) {
+		zone_cputime_query_end(qdata->zone->cputime, begin);
+	}
+}
+
+/*! \brief Leave the read-side section while the query is suspended. */
+static int query_suspend(struct query_data *qdata, uint64_t cpu_begin)
+{
+	query_cputime(qdata, cpu_begin);
+	rcu_read_unlock();
+
+	return KNOT_STATE_YIELD;
+}
+
 static int process_query_out(knot_layer_t *ctx, knot_pkt_t *pkt)
 {
 	assert(pkt && ctx);
 
+	struct query_data *qdata = QUERY_DATA(ctx);
+	struct query_plan *plan = NULL;
+	knot_pkt_t *query = qdata->query;
+	int next_state = KNOT_STATE_PRODUCE;
+	uint64_t cpu_begin = zone_cputime_query_begin();
+
 	rcu_read_lock();
 
-	struct query_data *qdata = QUERY_DATA(ctx);
-	struct query_plan *plan = conf()->query_plan;
-	struct query_step *step = NULL;
+	plan = conf()->query_plan;
+
+	/* Resume suspended step, unless the plan or the zone changed meanwhile. */
+	if (qdata->yield.step != NULL) {
+		struct query_yield *yield = &qdata->yield;
+		struct query_step *step = yield->step;
+		int stage = yield->stage;
+		yield->step = NULL;
+		if (!yield_restore(qdata, plan)) {
+			yield_abandon(pkt, qdata);
+			plan = NULL;
+			next_state = KNOT_STATE_FAIL;
+			goto finish;
+		}
+		next_state = run_steps(plan, stage, step, yield->state, pkt, qdata);
+		if (next_state == KNOT_STATE_YIELD) {
+			return query_suspend(qdata, cpu_begin);
+		}
+		if (stage == QPLAN_BEGIN) {
+			goto answer;
+		} else {
+			goto limit;
+		}
+	}
 
 	/* Check parse state. */
-	knot_pkt_t *query = qdata->query;
-	int next_state = KNOT_STATE_PRODUCE;
 	if (query->parsed < query->size) {
 		knot_pkt_clear(pkt);
 		qdata->rcode = KNOT_RCODE_FORMERR;
@@ -501,13 +777,29 @@ static int process_query_out(knot_layer_t *ctx, knot_pkt_t *pkt)
 		goto finish;
 	}
 
+	/* Expensive queries over the limit, truncate over UDP or refuse. */
+	if (!cost_admit(query, qdata)) {
+		if ((qdata->param->proc_flags & NS_QUERY_LIMIT_SIZE) &&
+		    qdata->packet_type == KNOT_QUERY_NORMAL) {
+			knot_wire_set_tc(pkt->wire);
+			next_state = KNOT_STATE_DONE;
+			goto answer;
+		} else {
+			qdata->rcode = KNOT_RCODE_REFUSED;
+			next_state = KNOT_STATE_FAIL;
+			goto finish;
+		}
+	}
+
 	/* Before query processing code. */
 	if (plan) {
-		WALK_LIST(step, plan->stage[QPLAN_BEGIN]) {
-			next_state = step->process(next_state, pkt, qdata, step->ctx);
+		next_state = run_steps(plan, QPLAN_BEGIN, NULL, next_state, pkt, qdata);
+		if (next_state == KNOT_STATE_YIELD) {
+			return query_suspend(qdata, cpu_begin);
 		}
 	}
 
+answer:
 	/* Answer based on qclass. */
 	if (next_state != KNOT_STATE_DONE) {
 		switch (knot_pkt_qclass(pkt)) {
@@ -566,21 +858,50 @@ finish:
 
 	/* After query processing code. */
 	if (plan) {
-		WALK_LIST(step, plan->stage[QPLAN_END]) {
-			next_state = step->process(next_state, pkt, qdata, step->ctx);
+		next_state = run_steps(plan, QPLAN_END, NULL, next_state, pkt, qdata);
+		if (next_state == KNOT_STATE_YIELD) {
+			return query_suspend(qdata, cpu_begin);
 		}
 	}
 
+limit:
 	/* Rate limits (if applicable). */
 	if (qdata->param->proc_flags & NS_QUERY_LIMIT_RATE) {
 		next_state = ratelimit_apply(next_state, pkt, ctx);
 	}
 
+	cost_release(qdata);
+
+	query_cputime(qdata, cpu_begin);
+
 	rcu_read_unlock();
 
+	KNOT_PROBE4(query__answer, qdata, next_state, qdata->rcode, pkt->size);
+
 	return next_state;
 }
 
+bool process_query_can_yield(const struct query_data *qdata)
+{
+	return qdata != NULL && qdata->yield.allowed;
+}
+
+int process_query_yield(struct query_data *qdata, int fd, short events,
+                        int timeout, void *data)
+{
+	if (!process_query_can_yield(qdata) || data == NULL || timeout < 0) {
+		return KNOT_STATE_FAIL;
+	}
+
+	qdata->yield.fd = fd;
+	qdata->yield.events = events;
+	qdata->yield.revents = 0;
+	qdata->yield.timeout = timeout;
+	qdata->yield.data = data;
+
+	return KNOT_STATE_YIELD;
+}
+
 bool process_query_acl_check(conf_t *conf, const knot_dname_t *zone_name,
                              acl_action_t action, struct query_data *qdata)
 {
@@ -38,7 +38,10 @@ enum process_query_flag {
 	NS_QUERY_NO_IXFR    = 1 << 1, /* Don't process IXFR */
 	NS_QUERY_LIMIT_ANY  = 1 << 2, /* Limit ANY QTYPE (respond with TC=1) */
 	NS_QUERY_LIMIT_RATE = 1 << 3, /* Apply rate limits. */
-	NS_QUERY_LIMIT_SIZE = 1 << 4  /* Apply UDP size limit. */
+	NS_QUERY_LIMIT_SIZE = 1 << 4, /* Apply UDP size limit. */
+	NS_QUERY_YIELD      = 1 << 5, /* Processing may be suspended. */
+	NS_QUERY_DEGRADED   = 1 << 6, /* Server overloaded, skip optional work. */
+	NS_QUERY_ZONE_FOUND = 1 << 7  /* Answering zone looked up by the caller. */
 };
 
 /* Module load parameters. */
@@ -48,6 +51,34 @@ struct process_query_param {
 	int        socket;
 	const struct sockaddr_storage *remote;
 	unsigned   thread_id;
+	unsigned   tcp_keepalive; /*!< Advertised TCP idle timeout in seconds. */
+	const zone_t *zone;       /*!< Answering zone if NS_QUERY_ZONE_FOUND, the
+	                               caller holds the read lock until answered. */
+};
+
+struct query_plan;
+struct query_step;
+struct query_data;
+
+/*! \brief Suspended query processing state, see \ref process_query_yield. */
+struct query_yield {
+	int fd;        /*!< Awaited descriptor (or -1 for a timer only). */
+	short events;  /*!< Awaited poll events. */
+	short revents; /*!< Returned poll events (0 on timeout). */
+	int timeout;   /*!< Wait limit in milliseconds. */
+	void *data;    /*!< Step continuation (NULL on the first call). */
+
+	/* Private, maintained by the query processing. */
+	bool allowed;              /*!< Current step may be suspended. */
+	int stage;                 /*!< Suspended plan stage. */
+	int state;                 /*!< Input state of the suspended step. */
+	uint64_t plan_id;          /*!< Identifier of the suspended query plan. */
+	struct query_step *step;   /*!< Suspended step (NULL if running). */
+	int (*process)(int, knot_pkt_t *, struct query_data *, void *);
+	                           /*!< Suspended step callback. */
+	bool has_zone;             /*!< Zone found before the suspension. */
+	uint64_t generation;       /*!< Zone contents generation (0 if none). */
+	uint8_t zone[KNOT_DNAME_MAXLEN]; /*!< Zone name. */
 };
 
 /*! \brief Query processing intermediate data. */
@@ -57,6 +88,7 @@ struct query_data {
 	uint16_t packet_type; /*!< Resolved packet type. */
 	knot_pkt_t *query;    /*!< Query to be solved. */
 	const zone_t *zone;   /*!< Zone from which is answered. */
+	const knot_dname_t *alias; /*!< Queried zone alias name (or NULL). */
 	list_t wildcards;     /*!< Visited wildcards. */
 	list_t rrsigs;        /*!< Section RRSIGs. */
 
@@ -76,6 +108,11 @@ struct query_data {
 	void (*ext_cleanup)(struct query_data*); /*!< Extensions cleanup callback. */
 	knot_sign_context_t sign;            /*!< Signing context. */
 
+	/* Asynchronous processing. */
+	struct query_yield yield;
+
+	bool expensive; /*!< Holds an expensive query slot. */
+
 	/* Everything below should be kept on reset. */
 	struct process_query_param *param; /*!< Module parameters. */
 	knot_mm_t *mm;                     /*!< Memory context. */
@@ -130,6 +167,42 @@ int process_query_verify(struct query_data *qdata);
  */
 int process_query_sign_response(knot_pkt_t *pkt, struct query_data *qdata);
 
+/*!
+ * \brief Check if the current query plan step may suspend the processing.
+ *
+ * Only the global BEGIN and END stage steps may be suspended and only
+ * if the query handler is able to park the query (NS_QUERY_YIELD).
+ *
+ * \param qdata  Query data.
+ */
+bool process_query_can_yield(const struct query_data *qdata);
+
+/*!
+ * \brief Suspend the current query plan step until an event or a timeout.
+ *
+ * The step returns the result of this function to the query processing.
+ * Once the descriptor is ready or the timeout elapses, the handler resumes
+ * the processing and the same step is called again with the same input
+ * state, the continuation data in qdata->yield.data and the received events
+ * in qdata->yield.revents (0 on timeout, POLLNVAL if the query is abandoned).
+ *
+ * The RCU read lock is released while the processing is suspended. If the
+ * query plan or the answering zone contents were replaced meanwhile, the
+ * query fails with SERVFAIL and the step is called once more with POLLNVAL
+ * and NULL context, only to release the continuation data.
+ *
+ * \param qdata    Query data.
+ * \param fd       Descriptor to wait for (-1 for a timer only).
+ * \param events   Poll events to wait for.
+ * \param timeout  Wait limit in milliseconds.
+ * \param data     Step continuation data (must not be NULL).
+ *
+ * \retval KNOT_STATE_YIELD if suspended.
+ * \retval KNOT_STATE_FAIL if the suspension is not possible.
+ */
+int process_query_yield(struct query_data *qdata, int fd, short events,
+                        int timeout, void *data);
+
 /*!
  * \brief Restore QNAME letter case.
  *
@@ -48,6 +48,9 @@ static_module_t MODULES[] = {
 	{ NULL }
 };
 
+/*! \brief Source of the query plan identifiers. */
+static uint64_t plan_id = 0;
+
 struct query_plan *query_plan_create(knot_mm_t *mm)
 {
 	struct query_plan *plan = mm_alloc(mm, sizeof(struct query_plan));
@@ -56,6 +59,8 @@ struct query_plan *query_plan_create(knot_mm_t *mm)
 	}
 
 	plan->mm = mm;
+	plan->expensive = false;
+	plan->id = __sync_add_and_fetch(&plan_id, 1);
 	for (unsigned i = 0; i < QUERY_PLAN_STAGES; ++i) {
 		init_list(&plan->stage[i]);
 	}
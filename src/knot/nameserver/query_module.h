@@ -116,6 +116,8 @@ struct query_step {
 struct query_plan {
 	knot_mm_t *mm;
 	list_t stage[QUERY_PLAN_STAGES];
+	bool expensive; /*!< Steps are costly (e.g. online signing). */
+	uint64_t id;    /*!< Unique identifier, not reused with the address. */
 };
 
 static_module_t *find_module(const yp_name_t *name);
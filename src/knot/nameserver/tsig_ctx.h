@@ -20,6 +20,7 @@
 
 #include "libknot/packet/pkt.h"
 #include "libknot/tsig.h"
+#include "libknot/tsig-op.h"
 
 #define TSIG_MAX_DIGEST_SIZE 64
 
@@ -35,9 +36,7 @@ typedef struct tsig_ctx {
 
 	/* Unsigned packets handling. */
 	unsigned unsigned_count;
-	uint8_t *buffer;
-	size_t buffer_used;
-	size_t buffer_size;
+	knot_tsig_stream_t stream;
 } tsig_ctx_t;
 
 /*!
@@ -71,7 +70,8 @@ int tsig_sign_packet(tsig_ctx_t *ctx, knot_pkt_t *packet);
  *
  * If the packet is not signed, the function will succeed, but an internal
  * counter of unsigned packets is increased. When a packet is signed, the
- * same counter is reset to zero.
+ * same counter is reset to zero. Unsigned packets are hashed immediately,
+ * they don't have to be kept until the next signed one.
  *
  * \see tsig_unsigned_count
  *
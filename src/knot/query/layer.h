@@ -28,7 +28,8 @@ enum knot_layer_state {
 	KNOT_STATE_CONSUME = 1 << 0, /*!< Consume data. */
 	KNOT_STATE_PRODUCE = 1 << 1, /*!< Produce data. */
 	KNOT_STATE_DONE    = 1 << 2, /*!< Finished. */
-	KNOT_STATE_FAIL    = 1 << 3  /*!< Error. */
+	KNOT_STATE_FAIL    = 1 << 3, /*!< Error. */
+	KNOT_STATE_YIELD   = 1 << 4  /*!< Suspended, produce again to resume. */
 };
 
 struct knot_layer_api;
@@ -0,0 +1,291 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/server/answer-cache.h"
+#include "libknot/descriptor.h"
+#include "libknot/dname.h"
+#include "libknot/errcode.h"
+#include "libknot/packet/wire.h"
+#include "libknot/rrtype/opt.h"
+#include "contrib/murmurhash3/murmurhash3.h"
+#include "contrib/tolower.h"
+#include "contrib/wire.h"
+
+/*! \brief Hit counter saturation. */
+#define HITS_MAX UINT16_MAX
+
+typedef struct {
+	uint64_t generation;  /*!< Zone contents generation, 0 if empty. */
+	uint32_t hash;
+	uint16_t qtype;
+	uint16_t limit;
+	uint16_t hits;        /*!< Aged hit counter for the victim choice. */
+	uint16_t size;        /*!< Answer size without the OPT record. */
+	bool edns;
+	uint8_t wire[ANSWER_CACHE_WIRE_MAX]; /*!< Answer with lowercased QNAME. */
+} entry_t;
+
+struct answer_cache {
+	size_t mask;          /*!< Number of buckets minus one. */
+	entry_t entries[];
+};
+
+answer_cache_t *answer_cache_new(size_t size)
+{
+	if (size == 0) {
+		return NULL;
+	}
+
+	size_t buckets = 1;
+	while (buckets * ANSWER_CACHE_WAYS < size) {
+		buckets <<= 1;
+	}
+
+	answer_cache_t *cache = calloc(1, sizeof(*cache) +
+	                               buckets * ANSWER_CACHE_WAYS * sizeof(entry_t));
+	if (cache == NULL) {
+		return NULL;
+	}
+	cache->mask = buckets - 1;
+
+	return cache;
+}
+
+void answer_cache_free(answer_cache_t *cache)
+{
+	free(cache);
+}
+
+int answer_cache_parse(answer_cache_query_t *q, const uint8_t *wire, size_t size)
+{
+	if (q == NULL || wire == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	if (size < KNOT_WIRE_HEADER_SIZE + KNOT_WIRE_QUESTION_MIN_SIZE ||
+	    knot_wire_get_qr(wire) || knot_wire_get_opcode(wire) != KNOT_OPCODE_QUERY ||
+	    knot_wire_get_qdcount(wire) != 1 || knot_wire_get_ancount(wire) != 0 ||
+	    knot_wire_get_nscount(wire) != 0 || knot_wire_get_arcount(wire) > 1) {
+		return KNOT_ENOTSUP;
+	}
+
+	const uint8_t *qname = wire + KNOT_WIRE_HEADER_SIZE;
+	const uint8_t *end = wire + size;
+	int qname_size = knot_dname_wire_check(qname, end, NULL);
+	if (qname_size <= 0 || qname + qname_size + 2 * sizeof(uint16_t) > end) {
+		return KNOT_EMALF;
+	}
+
+	const uint8_t *pos = qname + qname_size;
+	q->qtype = wire_read_u16(pos);
+	if (wire_read_u16(pos + 2) != KNOT_CLASS_IN || q->qtype == KNOT_RRTYPE_ANY ||
+	    q->qtype == KNOT_RRTYPE_AXFR || q->qtype == KNOT_RRTYPE_IXFR) {
+		return KNOT_ENOTSUP;
+	}
+	pos += 2 * sizeof(uint16_t);
+
+	/* Only an empty OPT without the DO bit, version 0 and no extended RCODE. */
+	q->edns = (knot_wire_get_arcount(wire) == 1);
+	if (q->edns) {
+		if (end - pos != KNOT_EDNS_MIN_SIZE || pos[0] != '\0' ||
+		    wire_read_u16(pos + 1) != KNOT_RRTYPE_OPT ||
+		    wire_read_u32(pos + 5) != 0 || wire_read_u16(pos + 9) != 0) {
+			return KNOT_ENOTSUP;
+		}
+		q->payload = wire_read_u16(pos + 3);
+	} else if (pos != end) {
+		return KNOT_ENOTSUP;
+	} else {
+		q->payload = 0;
+	}
+
+	q->wire = wire;
+	q->qname_size = qname_size;
+	for (int i = 0; i < qname_size; i++) {
+		q->qname[i] = knot_tolower(qname[i]);
+	}
+	q->limit = KNOT_WIRE_MIN_PKTSIZE;
+	q->hash = hash((const char *)q->qname, qname_size) ^ (q->qtype * 0x9E3779B1U);
+
+	return KNOT_EOK;
+}
+
+static entry_t *bucket(answer_cache_t *cache, uint32_t hash)
+{
+	return cache->entries + (hash & cache->mask) * ANSWER_CACHE_WAYS;
+}
+
+static bool entry_match(const entry_t *e, const answer_cache_query_t *q)
+{
+	return e->generation != 0 && e->hash == q->hash && e->qtype == q->qtype &&
+	       e->edns == q->edns && e->limit == q->limit &&
+	       memcmp(e->wire + KNOT_WIRE_HEADER_SIZE, q->qname, q->qname_size) == 0;
+}
+
+/*! \brief Append an empty OPT record with the server payload. */
+static size_t opt_write(uint8_t *wire, size_t size, uint16_t opt_payload)
+{
+	uint8_t *opt = wire + size;
+	memset(opt, 0, KNOT_EDNS_MIN_SIZE);
+	wire_write_u16(opt + 1, KNOT_RRTYPE_OPT);
+	wire_write_u16(opt + 3, opt_payload);
+	knot_wire_set_arcount(wire, knot_wire_get_arcount(wire) + 1);
+
+	return size + KNOT_EDNS_MIN_SIZE;
+}
+
+size_t answer_cache_answer(answer_cache_t *cache, const answer_cache_query_t *q,
+                           uint64_t generation, uint16_t opt_payload,
+                           uint8_t *out, size_t out_max)
+{
+	if (cache == NULL || q == NULL || out == NULL || generation == 0) {
+		return 0;
+	}
+
+	entry_t *e = bucket(cache, q->hash);
+	for (int i = 0; i < ANSWER_CACHE_WAYS; i++, e++) {
+		if (!entry_match(e, q)) {
+			continue;
+		}
+		if (e->generation != generation) {
+			/* Outdated, the slot will be reused by the next insert. */
+			e->hits = 0;
+			return 0;
+		}
+
+		size_t size = e->size + (q->edns ? KNOT_EDNS_MIN_SIZE : 0);
+		if (size > out_max || size > q->limit) {
+			return 0;
+		}
+
+		memcpy(out, e->wire, e->size);
+
+		/* Query ID, RD and CD flags and the QNAME letter case. */
+		memcpy(out, q->wire, sizeof(uint16_t));
+		out[KNOT_WIRE_OFFSET_FLAGS1] &= ~KNOT_WIRE_RD_MASK;
+		out[KNOT_WIRE_OFFSET_FLAGS1] |= q->wire[KNOT_WIRE_OFFSET_FLAGS1] & KNOT_WIRE_RD_MASK;
+		out[KNOT_WIRE_OFFSET_FLAGS2] &= ~KNOT_WIRE_CD_MASK;
+		out[KNOT_WIRE_OFFSET_FLAGS2] |= q->wire[KNOT_WIRE_OFFSET_FLAGS2] & KNOT_WIRE_CD_MASK;
+		memcpy(out + KNOT_WIRE_HEADER_SIZE, q->wire + KNOT_WIRE_HEADER_SIZE,
+		       q->qname_size);
+
+		if (q->edns) {
+			(void)opt_write(out, e->size, opt_payload);
+		}
+
+		if (e->hits < HITS_MAX) {
+			e->hits++;
+		}
+
+		return size;
+	}
+
+	return 0;
+}
+
+bool answer_cache_insert(answer_cache_t *cache, const answer_cache_query_t *q,
+                         uint64_t generation, const uint8_t *wire, size_t size)
+{
+	if (cache == NULL || q == NULL || wire == NULL || generation == 0 ||
+	    size < KNOT_WIRE_HEADER_SIZE + q->qname_size + sizeof(uint16_t)) {
+		return false;
+	}
+
+	uint8_t rcode = knot_wire_get_rcode(wire);
+	if (!knot_wire_get_qr(wire) || !knot_wire_get_aa(wire) || knot_wire_get_tc(wire) ||
+	    (rcode != KNOT_RCODE_NOERROR && rcode != KNOT_RCODE_NXDOMAIN) ||
+	    knot_wire_get_qdcount(wire) != 1 ||
+	    wire_read_u16(wire + KNOT_WIRE_HEADER_SIZE + q->qname_size) != q->qtype) {
+		return false;
+	}
+	for (int i = 0; i < q->qname_size; i++) {
+		if (knot_tolower(wire[KNOT_WIRE_HEADER_SIZE + i]) != q->qname[i]) {
+			return false;
+		}
+	}
+
+	/* The OPT record is the last one, it's rebuilt for each answer. */
+	uint16_t arcount = knot_wire_get_arcount(wire);
+	if (q->edns) {
+		const uint8_t *opt = wire + size - KNOT_EDNS_MIN_SIZE;
+		if (arcount == 0 || size < KNOT_WIRE_HEADER_SIZE + KNOT_EDNS_MIN_SIZE ||
+		    opt[0] != '\0' || wire_read_u16(opt + 1) != KNOT_RRTYPE_OPT ||
+		    wire_read_u32(opt + 5) != 0 || wire_read_u16(opt + 9) != 0) {
+			return false;
+		}
+		size -= KNOT_EDNS_MIN_SIZE;
+		arcount -= 1;
+	}
+	if (size > ANSWER_CACHE_WIRE_MAX) {
+		return false;
+	}
+
+	/* Same key or an empty slot, otherwise the least hit entry. */
+	entry_t *set = bucket(cache, q->hash);
+	entry_t *victim = NULL;
+	for (int i = 0; i < ANSWER_CACHE_WAYS; i++) {
+		entry_t *e = set + i;
+		if (entry_match(e, q) || e->generation == 0) {
+			victim = e;
+			break;
+		}
+		if (victim == NULL || e->hits < victim->hits) {
+			victim = e;
+		}
+	}
+
+	/* Aging, so that formerly hot entries may be replaced. */
+	for (int i = 0; i < ANSWER_CACHE_WAYS; i++) {
+		set[i].hits >>= 1;
+	}
+
+	victim->generation = generation;
+	victim->hash = q->hash;
+	victim->qtype = q->qtype;
+	victim->limit = q->limit;
+	victim->edns = q->edns;
+	victim->hits = 0;
+	victim->size = size;
+	memcpy(victim->wire, wire, size);
+	memcpy(victim->wire + KNOT_WIRE_HEADER_SIZE, q->qname, q->qname_size);
+	knot_wire_set_arcount(victim->wire, arcount);
+
+	return true;
+}
+
+size_t answer_cache_slip(const answer_cache_query_t *q, uint16_t opt_payload,
+                         uint8_t *wire)
+{
+	if (q == NULL || wire == NULL) {
+		return 0;
+	}
+
+	knot_wire_clear_aa(wire);
+	knot_wire_set_tc(wire);
+	knot_wire_set_ancount(wire, 0);
+	knot_wire_set_nscount(wire, 0);
+	knot_wire_set_arcount(wire, 0);
+
+	size_t size = KNOT_WIRE_HEADER_SIZE + q->qname_size + 2 * sizeof(uint16_t);
+	if (q->edns) {
+		size = opt_write(wire, size, opt_payload);
+	}
+
+	return size;
+}
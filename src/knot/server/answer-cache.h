@@ -0,0 +1,139 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*!
+ * \file
+ *
+ * \brief Cache of encoded UDP answers.
+ *
+ * Plain queries (no DNSSEC, no EDNS options, no TSIG) for hot names are
+ * answered by copying a previously encoded answer and patching the message
+ * ID, the RD and CD flags, the letter case of the QNAME and the OPT record.
+ * The cached answer is bound to a generation of the zone contents, so it's
+ * never served after the zone changes.
+ *
+ * The cache is not thread-safe, each UDP worker has its own one.
+ *
+ * \addtogroup server
+ * @{
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libknot/consts.h"
+
+/*! \brief Maximum size of a cached answer without the OPT record. */
+#define ANSWER_CACHE_WIRE_MAX 512
+
+/*! \brief Number of entries sharing one hash bucket. */
+#define ANSWER_CACHE_WAYS 4
+
+/*! \brief Answer cache. */
+typedef struct answer_cache answer_cache_t;
+
+/*! \brief Cache key parsed from a query. */
+typedef struct {
+	const uint8_t *wire;        /*!< Query wire. */
+	uint8_t qname[KNOT_DNAME_MAXLEN]; /*!< Lowercased QNAME. */
+	uint8_t qname_size;         /*!< QNAME size. */
+	uint16_t qtype;             /*!< QTYPE. */
+	bool edns;                  /*!< Query has EDNS. */
+	uint16_t payload;           /*!< Client EDNS payload. */
+	uint16_t limit;             /*!< Answer size limit, set by the caller. */
+	uint32_t hash;              /*!< Hash of the QNAME and QTYPE. */
+} answer_cache_query_t;
+
+/*!
+ * \brief Creates a cache.
+ *
+ * \param size  Number of entries, rounded up to a whole number of buckets.
+ *
+ * \return Cache or NULL.
+ */
+answer_cache_t *answer_cache_new(size_t size);
+
+/*!
+ * \brief Frees the cache.
+ */
+void answer_cache_free(answer_cache_t *cache);
+
+/*!
+ * \brief Parses a query that may be answered from the cache.
+ *
+ * The query must be a standard query for the IN class, without the DNSSEC
+ * OK bit, EDNS options or any other record than OPT.
+ *
+ * \param q     Output cache key.
+ * \param wire  Query wire.
+ * \param size  Query size.
+ *
+ * \retval KNOT_EOK if the query is cacheable.
+ * \return KNOT_E* otherwise.
+ */
+int answer_cache_parse(answer_cache_query_t *q, const uint8_t *wire, size_t size);
+
+/*!
+ * \brief Writes a cached answer for the query.
+ *
+ * \param cache        Cache.
+ * \param q            Parsed query.
+ * \param generation   Current generation of the zone contents.
+ * \param opt_payload  Server EDNS payload to put into the OPT record.
+ * \param out          Output buffer.
+ * \param out_max      Output buffer size.
+ *
+ * \return Answer size or 0 if not cached.
+ */
+size_t answer_cache_answer(answer_cache_t *cache, const answer_cache_query_t *q,
+                           uint64_t generation, uint16_t opt_payload,
+                           uint8_t *out, size_t out_max);
+
+/*!
+ * \brief Stores an answer to the query.
+ *
+ * Only authoritative answers with NOERROR or NXDOMAIN that were not
+ * truncated are stored, others are ignored.
+ *
+ * \param cache       Cache.
+ * \param q           Parsed query.
+ * \param generation  Generation of the zone contents used to make the answer.
+ * \param wire        Answer wire.
+ * \param size        Answer size.
+ *
+ * \return True if stored.
+ */
+bool answer_cache_insert(answer_cache_t *cache, const answer_cache_query_t *q,
+                         uint64_t generation, const uint8_t *wire, size_t size);
+
+/*!
+ * \brief Truncates an answer written by \ref answer_cache_answer to a slip.
+ *
+ * The rate limited answer keeps only the question and the OPT record,
+ * the TC flag is set, as in the query processing.
+ *
+ * \param q            Parsed query.
+ * \param opt_payload  Server EDNS payload to put into the OPT record.
+ * \param wire         Answer wire, modified in place.
+ *
+ * \return Slipped answer size.
+ */
+size_t answer_cache_slip(const answer_cache_query_t *q, uint16_t opt_payload,
+                         uint8_t *wire);
+
+/*! @} */
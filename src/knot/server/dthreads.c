@@ -15,6 +15,7 @@
  */
 
 #include <signal.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -434,6 +435,22 @@ void dt_delete(dt_unit_t **unit)
 	*unit = 0;
 }
 
+/*! \brief Create the system thread, blocks signals in the new thread. */
+static int dt_spawn(dthread_t *thread)
+{
+	sigset_t mask_all, mask_old;
+	sigfillset(&mask_all);
+	sigdelset(&mask_all, SIGPROF);
+	pthread_sigmask(SIG_SETMASK, &mask_all, &mask_old);
+	int res = pthread_create(&thread->_thr,  /* pthread_t */
+	                         &thread->_attr, /* pthread_attr_t */
+	                         thread_ep,      /* routine: thread_ep */
+	                         thread);        /* passed object: dthread_t */
+	pthread_sigmask(SIG_SETMASK, &mask_old, NULL);
+
+	return res;
+}
+
 static int dt_start_id(dthread_t *thread)
 {
 	// Check input
@@ -458,21 +475,72 @@ static int dt_start_id(dthread_t *thread)
 	}
 
 	// Start thread
-	sigset_t mask_all, mask_old;
-	sigfillset(&mask_all);
-	sigdelset(&mask_all, SIGPROF);
-	pthread_sigmask(SIG_SETMASK, &mask_all, &mask_old);
-	int res = pthread_create(&thread->_thr,  /* pthread_t */
-	                         &thread->_attr, /* pthread_attr_t */
-	                         thread_ep,      /* routine: thread_ep */
-	                         thread);        /* passed object: dthread_t */
-	pthread_sigmask(SIG_SETMASK, &mask_old, NULL);
+	int res = dt_spawn(thread);
 
 	// Unlock thread
 	unlock_thread_rw(thread);
 	return res;
 }
 
+int dt_extend(dt_unit_t *unit, int count)
+{
+	// Check input
+	if (unit == 0 || count < unit->size) {
+		return KNOT_EINVAL;
+	}
+
+	// Lock unit
+	pthread_mutex_lock(&unit->_notify_mx);
+	dt_unit_lock(unit);
+
+	dthread_t **threads = realloc(unit->threads, count * sizeof(dthread_t *));
+	if (threads == 0) {
+		dt_unit_unlock(unit);
+		pthread_mutex_unlock(&unit->_notify_mx);
+		return KNOT_ENOMEM;
+	}
+	unit->threads = threads;
+
+	// New threads inherit the purpose of the first one
+	dthread_t *first = unit->threads[0];
+	lock_thread_rw(first);
+	bool started = (first->state != ThreadJoined);
+	unlock_thread_rw(first);
+
+	int ret = KNOT_EOK;
+	for (int i = unit->size; i < count; ++i) {
+		dthread_t *thread = dt_create_thread(unit);
+		if (thread == 0) {
+			ret = KNOT_ENOMEM;
+			break;
+		}
+		thread->run = first->run;
+		thread->destruct = first->destruct;
+		thread->_adata = first->_adata;
+
+		// Started threads sleep until activated
+		if (started) {
+			lock_thread_rw(thread);
+			thread->state = ThreadIdle | ThreadParked;
+			int res = dt_spawn(thread);
+			unlock_thread_rw(thread);
+			if (res != 0) {
+				dt_delete_thread(&thread);
+				ret = KNOT_ERROR;
+				break;
+			}
+		}
+
+		unit->threads[i] = thread;
+		unit->size = i + 1;
+	}
+
+	// Unlock unit
+	dt_unit_unlock(unit);
+	pthread_mutex_unlock(&unit->_notify_mx);
+	return ret;
+}
+
 int dt_start(dt_unit_t *unit)
 {
 	// Check input
@@ -662,6 +730,17 @@ int dt_cancel(dthread_t *thread)
 	return dt_update_thread(thread, ThreadIdle | ThreadCancelled);
 }
 
+int dt_park(dthread_t *thread)
+{
+	int ret = dt_update_thread(thread, ThreadIdle | ThreadParked);
+	if (ret == KNOT_EOK) {
+		/* Interrupt blocking I/O to notice the request. */
+		dt_signalize(thread, SIGALRM);
+	}
+
+	return ret;
+}
+
 int dt_compact(dt_unit_t *unit)
 {
 	// Check input
@@ -751,20 +830,35 @@ int dt_is_cancelled(dthread_t *thread)
 	return thread->state & ThreadCancelled; /* No need to be locked. */
 }
 
+int dt_is_parked(dthread_t *thread)
+{
+	// Check input
+	if (thread == 0) {
+		return 0;
+	}
+
+	return (thread->state & ThreadParked) ? 1 : 0; /* No need to be locked. */
+}
+
 unsigned dt_get_id(dthread_t *thread)
 {
 	if (thread == NULL || thread->unit == NULL) {
 		return 0;
 	}
 
+	/* The thread array may be reallocated by dt_extend(). */
 	dt_unit_t *unit = thread->unit;
+	unsigned id = 0;
+	dt_unit_lock(unit);
 	for(int tid = 0; tid < unit->size; ++tid) {
 		if (thread == unit->threads[tid]) {
-			return tid;
+			id = tid;
+			break;
 		}
 	}
+	dt_unit_unlock(unit);
 
-	return 0;
+	return id;
 }
 
 int dt_unit_lock(dt_unit_t *unit)
@@ -55,7 +55,8 @@ typedef enum {
 	ThreadCancelled = 1 << 2, /*!< Thread is cancelled, finishing task. */
 	ThreadDead      = 1 << 3, /*!< Thread is finished, exiting. */
 	ThreadIdle      = 1 << 4, /*!< Thread is idle, waiting for purpose. */
-	ThreadActive    = 1 << 5  /*!< Thread is active, working on a task. */
+	ThreadActive    = 1 << 5, /*!< Thread is active, working on a task. */
+	ThreadParked    = 1 << 6  /*!< Thread is idle until activated again. */
 } dt_state_t;
 
 /*!
@@ -129,6 +130,23 @@ dt_unit_t *dt_create(int count, runnable_t runnable, runnable_t destructor, void
  */
 void dt_delete(dt_unit_t **unit);
 
+/*!
+ * \brief Add threads to a running or stopped unit.
+ *
+ * New threads share the runnable, the destructor and the data of the first
+ * thread. If the unit has been started, the new threads are started parked
+ * and enter the runnable after dt_activate(), otherwise they are started
+ * with dt_start(). Existing threads keep their IDs.
+ *
+ * \param unit Unit to be extended.
+ * \param count New unit width, must not be lower than the current one.
+ *
+ * \retval KNOT_EOK on success.
+ * \retval KNOT_EINVAL on invalid parameters.
+ * \retval KNOT_ENOMEM out of memory.
+ */
+int dt_extend(dt_unit_t *unit, int count);
+
 /*!
  * \brief Start all threads in selected unit.
  *
@@ -222,6 +240,23 @@ int dt_activate(dthread_t *thread);
  */
 int dt_cancel(dthread_t *thread);
 
+/*!
+ * \brief Park thread, finish its current work and keep it idle.
+ *
+ * Unlike dt_cancel(), the runnable isn't requested to return immediately.
+ * It should stop accepting new work, finish the pending one and return
+ * if dt_is_parked() is set. The thread then sleeps without consuming CPU
+ * until it is woken up with dt_activate(), which also revokes the request
+ * if the runnable hasn't returned yet.
+ *
+ * \param thread Target thread instance.
+ *
+ * \retval KNOT_EOK on success.
+ * \retval KNOT_EINVAL on invalid parameters.
+ * \retval KNOT_ENOTSUP operation not supported.
+ */
+int dt_park(dthread_t *thread);
+
 /*!
  * \brief Collect and dispose idle threads.
  *
@@ -262,6 +297,16 @@ int dt_optimal_size(void);
  */
 int dt_is_cancelled(dthread_t *thread);
 
+/*!
+ * \brief Return true if thread is requested to park.
+ *
+ * \param thread Target thread instance.
+ *
+ * \retval 1 if parked.
+ * \retval 0 if not parked.
+ */
+int dt_is_parked(dthread_t *thread);
+
 /*!
  * \brief Return thread index in threading unit.
  *
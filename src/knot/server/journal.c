@@ -25,6 +25,7 @@
 #include <assert.h>
 
 #include "knot/common/log.h"
+#include "knot/common/probe.h"
 #include "contrib/files.h"
 #include "knot/server/journal.h"
 #include "knot/server/serialization.h"
@@ -461,6 +462,7 @@ int journal_write_out(journal_t *journal, journal_node_t *n)
 
 	/* Node write successful. */
 	journal->qtail = jnext;
+	KNOT_PROBE2(journal__write, n->id, size);
 
 	/* Write back queue state, not essential as it may be recovered.
 	 * qhead - lowest valid node identifier (least recent)
@@ -569,6 +571,8 @@ static int journal_read_node(journal_t *journal, journal_node_t *n, char *dst)
 		return KNOT_ERROR;
 	}
 
+	KNOT_PROBE2(journal__read, n->id, n->len);
+
 	return KNOT_EOK;
 }
 
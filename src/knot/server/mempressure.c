@@ -0,0 +1,197 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "knot/common/log.h"
+#include "knot/server/mempressure.h"
+#include "libknot/errcode.h"
+
+#define CGROUP_ROOT	"/sys/fs/cgroup"
+#define PROC_CGROUP	"/proc/self/cgroup"
+#define PROC_PRESSURE	"/proc/pressure/memory"
+
+static int read_file(const char *dir, const char *name, char *buf, size_t size)
+{
+	char path[PATH_MAX];
+	if (dir != NULL) {
+		int ret = snprintf(path, sizeof(path), "%s/%s", dir, name);
+		if (ret < 0 || ret >= sizeof(path)) {
+			return KNOT_ESPACE;
+		}
+		name = path;
+	}
+
+	FILE *file = fopen(name, "r");
+	if (file == NULL) {
+		return KNOT_ENOENT;
+	}
+
+	size_t len = fread(buf, 1, size - 1, file);
+	fclose(file);
+	buf[len] = '\0';
+
+	return (len > 0) ? KNOT_EOK : KNOT_ENOENT;
+}
+
+/*! \brief Find the cgroup v2 directory of the process ("0::<path>"). */
+static char *cgroup_dir(void)
+{
+	char buf[4096];
+	if (read_file(NULL, PROC_CGROUP, buf, sizeof(buf)) != KNOT_EOK) {
+		return NULL;
+	}
+
+	char *line = strstr(buf, "0::");
+	if (line == NULL || (line != buf && line[-1] != '\n')) {
+		return NULL;
+	}
+	line += 3;
+	line[strcspn(line, "\n")] = '\0';
+
+	char dir[PATH_MAX];
+	int ret = snprintf(dir, sizeof(dir), "%s%s", CGROUP_ROOT,
+	                   strcmp(line, "/") == 0 ? "" : line);
+	if (ret < 0 || ret >= sizeof(dir)) {
+		return NULL;
+	}
+
+	return strdup(dir);
+}
+
+int mempressure_init(mempressure_t *mp, const char *dir)
+{
+	if (mp == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	memset(mp, 0, sizeof(*mp));
+
+	mp->dir = (dir != NULL) ? strdup(dir) : cgroup_dir();
+
+	return KNOT_EOK;
+}
+
+void mempressure_deinit(mempressure_t *mp)
+{
+	if (mp == NULL) {
+		return;
+	}
+
+	free(mp->dir);
+	memset(mp, 0, sizeof(*mp));
+}
+
+int mempressure_read(const mempressure_t *mp, mempressure_sample_t *sample)
+{
+	if (mp == NULL || sample == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	memset(sample, 0, sizeof(*sample));
+	bool found = false;
+	char buf[512];
+
+	if (read_file(mp->dir, "memory.current", buf, sizeof(buf)) == KNOT_EOK &&
+	    sscanf(buf, "%"SCNu64, &sample->current) == 1) {
+		found = true;
+		/* The limit is "max" if not set. */
+		if (read_file(mp->dir, "memory.max", buf, sizeof(buf)) == KNOT_EOK &&
+		    sscanf(buf, "%"SCNu64, &sample->max) != 1) {
+			sample->max = 0;
+		}
+	}
+
+	/* Line "some avg10=1.23 avg60=0.45 avg300=0.12 total=12345". */
+	int ret = read_file(mp->dir, "memory.pressure", buf, sizeof(buf));
+	if (ret != KNOT_EOK) {
+		ret = read_file(NULL, PROC_PRESSURE, buf, sizeof(buf));
+	}
+	if (ret == KNOT_EOK && sscanf(buf, "some avg10=%lf", &sample->psi_some) == 1) {
+		found = true;
+	}
+
+	return found ? KNOT_EOK : KNOT_ENOENT;
+}
+
+void mempressure_update(mempressure_t *mp, const mempressure_sample_t *sample,
+                        unsigned limit)
+{
+	if (mp == NULL) {
+		return;
+	}
+
+	if (sample == NULL || limit == 0) {
+		mp->idle = 0;
+		mp->active = false;
+		return;
+	}
+
+	bool over_limit = sample->max > 0 &&
+	                  sample->current >= sample->max / 100 * limit;
+	bool stalled = sample->psi_some >= MEMPRESSURE_PSI;
+
+	if (over_limit || stalled) {
+		mp->idle = 0;
+		if (!mp->active) {
+			mp->active = true;
+			log_warning("memory pressure detected, usage %"PRIu64" MiB "
+			            "of %"PRIu64" MiB, stalled %.2f%%, deferring "
+			            "zone events and dropping caches",
+			            sample->current >> 20, sample->max >> 20,
+			            sample->psi_some);
+		}
+	} else if (mp->active && ++mp->idle >= MEMPRESSURE_PERIODS) {
+		mp->idle = 0;
+		mp->active = false;
+		log_info("memory pressure ceased, usage %"PRIu64" MiB",
+		         sample->current >> 20);
+	}
+}
+
+bool mempressure_event_begin(mempressure_t *mp, mempressure_event_t type,
+                             bool loaded)
+{
+	if (mp == NULL || type == MEMPRESSURE_LIGHT) {
+		return true;
+	}
+
+	/* Count copying events also without pressure, it may start anytime. */
+	int copying;
+	do {
+		copying = mp->copying;
+		if (mp->active &&
+		    ((type == MEMPRESSURE_REPLACE && loaded) || copying > 0)) {
+			return false;
+		}
+	} while (!__sync_bool_compare_and_swap(&mp->copying, copying, copying + 1));
+
+	return true;
+}
+
+void mempressure_event_end(mempressure_t *mp, mempressure_event_t type)
+{
+	if (mp == NULL || type == MEMPRESSURE_LIGHT) {
+		return;
+	}
+
+	__sync_sub_and_fetch(&mp->copying, 1);
+}
@@ -0,0 +1,134 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file mempressure.h
+ *
+ * \brief Memory pressure detection based on the cgroup v2 memory controller.
+ *
+ * The memory usage of the server cgroup (memory.current) is compared with
+ * its limit (memory.max) and the pressure stall information (memory.pressure,
+ * or /proc/pressure/memory outside of a cgroup) is checked. The pressure is
+ * signalled by the first sample over a threshold and ceases after several
+ * consecutive samples below the thresholds.
+ *
+ * Under pressure, zone events creating a new copy of the zone contents are
+ * limited: reloads and transfers of already loaded zones are deferred and
+ * the remaining copying events run one at a time.
+ *
+ * \addtogroup server
+ * @{
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*! \brief Sampling period (milliseconds). */
+#define MEMPRESSURE_PERIOD	1000
+/*! \brief Number of consecutive samples without pressure to cease. */
+#define MEMPRESSURE_PERIODS	3
+/*! \brief Share of time with tasks stalled on memory to signal (percent). */
+#define MEMPRESSURE_PSI		10.0
+/*! \brief Delay of a deferred zone event (seconds). */
+#define MEMPRESSURE_DEFER	5
+
+/*! \brief Zone event class with respect to the memory usage. */
+typedef enum {
+	MEMPRESSURE_LIGHT = 0, /*!< Doesn't copy the zone contents. */
+	MEMPRESSURE_COPY,      /*!< Creates a shallow copy of the zone contents. */
+	MEMPRESSURE_REPLACE,   /*!< Builds completely new zone contents. */
+} mempressure_event_t;
+
+/*! \brief Memory usage sample. */
+typedef struct {
+	uint64_t current;  /*!< Cgroup memory usage, 0 if unknown. */
+	uint64_t max;      /*!< Cgroup memory limit, 0 if unlimited or unknown. */
+	double psi_some;   /*!< Share of time with some tasks stalled (avg10, percent). */
+} mempressure_sample_t;
+
+/*! \brief Memory pressure detection state. */
+typedef struct {
+	char *dir;             /*!< Cgroup directory, NULL if not known. */
+	unsigned idle;         /*!< Consecutive samples without pressure. */
+	volatile bool active;  /*!< Pressure is signalled. */
+	volatile int copying;  /*!< Running zone events copying the contents. */
+} mempressure_t;
+
+/*!
+ * \brief Initialize the detection.
+ *
+ * \param mp   Detection state.
+ * \param dir  Cgroup directory, NULL to use the cgroup of the process.
+ *
+ * \return KNOT_E*
+ */
+int mempressure_init(mempressure_t *mp, const char *dir);
+
+/*!
+ * \brief Deinitialize the detection.
+ */
+void mempressure_deinit(mempressure_t *mp);
+
+/*!
+ * \brief Read the current memory usage.
+ *
+ * \param mp      Detection state.
+ * \param sample  Output sample.
+ *
+ * \retval KNOT_EOK if at least one of the signals is available.
+ * \retval KNOT_ENOENT if no signal is available.
+ */
+int mempressure_read(const mempressure_t *mp, mempressure_sample_t *sample);
+
+/*!
+ * \brief Evaluate a sample.
+ *
+ * \param mp      Detection state.
+ * \param sample  Memory usage sample, NULL if detection is disabled.
+ * \param limit   Usage threshold in percent of the limit, 0 disables detection.
+ */
+void mempressure_update(mempressure_t *mp, const mempressure_sample_t *sample,
+                        unsigned limit);
+
+/*!
+ * \brief Check if the pressure is signalled.
+ */
+static inline bool mempressure_active(const mempressure_t *mp)
+{
+	return mp != NULL && mp->active;
+}
+
+/*!
+ * \brief Admit a zone event.
+ *
+ * \param mp      Detection state (can be NULL).
+ * \param type    Event class.
+ * \param loaded  The zone has contents.
+ *
+ * \retval true if the event may run, \ref mempressure_event_end must follow.
+ * \retval false if the event should be deferred.
+ */
+bool mempressure_event_begin(mempressure_t *mp, mempressure_event_t type,
+                             bool loaded);
+
+/*!
+ * \brief Finish an admitted zone event.
+ */
+void mempressure_event_end(mempressure_t *mp, mempressure_event_t type);
+
+/*! @} */
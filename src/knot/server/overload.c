@@ -0,0 +1,69 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <inttypes.h>
+
+#include "knot/common/log.h"
+#include "knot/server/overload.h"
+
+uint32_t overload_sock_drops(volatile uint32_t *last, uint32_t value)
+{
+	uint32_t old;
+	do {
+		old = *last;
+		/* Counter wraps, compare the difference. */
+		if ((int32_t)(value - old) <= 0) {
+			return 0;
+		}
+	} while (!__sync_bool_compare_and_swap(last, old, value));
+
+	return value - old;
+}
+
+void overload_update(overload_t *ov, uint32_t drops, time_t now)
+{
+	if (drops > 0) {
+		__sync_add_and_fetch(&ov->drops, drops);
+	}
+
+	/* Only one thread evaluates the finished period. */
+	time_t period = ov->period;
+	if (now <= period || !__sync_bool_compare_and_swap(&ov->period, period, now)) {
+		return;
+	}
+
+	uint64_t total = ov->drops;
+	uint64_t delta = total - ov->period_drops;
+	ov->period_drops = total;
+
+	if (delta > 0) {
+		ov->loaded += 1;
+		ov->idle = 0;
+	} else {
+		ov->loaded = 0;
+		ov->idle += now - period;
+	}
+
+	if (!ov->active && ov->loaded >= OVERLOAD_PERIODS) {
+		ov->active = true;
+		log_warning("UDP, overload detected, %"PRIu64" queries dropped, "
+		            "shedding optional processing", delta);
+	} else if (ov->active && ov->idle >= OVERLOAD_PERIODS) {
+		ov->active = false;
+		log_info("UDP, overload ceased, %"PRIu64" queries dropped in total",
+		         total);
+	}
+}
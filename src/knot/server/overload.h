@@ -0,0 +1,78 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*!
+ * \file overload.h
+ *
+ * \brief UDP overload detection based on kernel receive queue drops.
+ *
+ * The UDP sockets report the number of datagrams dropped by the kernel
+ * (SO_RXQ_OVFL). The overload is signalled after drops occur in several
+ * consecutive periods and ceases after the same number of periods without
+ * drops.
+ *
+ * \addtogroup network
+ * @{
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/*! \brief Number of consecutive one-second periods to change the state. */
+#define OVERLOAD_PERIODS 3
+
+/*! \brief Overload detection state. */
+typedef struct {
+	volatile uint64_t drops;  /*!< Total datagrams dropped by the kernel. */
+	volatile time_t period;   /*!< Current period start. */
+	uint64_t period_drops;    /*!< Total drops at the current period start. */
+	unsigned loaded;          /*!< Consecutive periods with drops. */
+	unsigned idle;            /*!< Consecutive periods without drops. */
+	volatile bool active;     /*!< Overload is signalled. */
+} overload_t;
+
+/*!
+ * \brief Update the last known drop counter of a socket.
+ *
+ * The counter may be shared by several threads, older samples are ignored.
+ *
+ * \param last   Last known socket drop counter.
+ * \param value  Socket drop counter received with a datagram.
+ *
+ * \return Number of new drops.
+ */
+uint32_t overload_sock_drops(volatile uint32_t *last, uint32_t value);
+
+/*!
+ * \brief Account new drops and evaluate finished periods.
+ *
+ * \param ov     Overload detection state.
+ * \param drops  Number of new drops.
+ * \param now    Current time.
+ */
+void overload_update(overload_t *ov, uint32_t drops, time_t now);
+
+/*!
+ * \brief Check if the overload is signalled.
+ */
+static inline bool overload_active(const overload_t *ov)
+{
+	return ov->active;
+}
+
+/*! @} */
@@ -19,6 +19,7 @@
 
 #include "dnssec/random.h"
 #include "knot/common/log.h"
+#include "knot/common/probe.h"
 #include "knot/server/rrl.h"
 #include "knot/zone/zone.h"
 #include "libknot/libknot.h"
@@ -494,6 +495,8 @@ int rrl_query(rrl_table_t *rrl, const struct sockaddr_storage *a, rrl_req_t *req
 		ret = KNOT_ELIMIT;
 	}
 
+	KNOT_PROBE4(rrl__query, a, b->cls, b->ntok, ret);
+
 	if (lock > -1) {
 		rrl_unlock(rrl, lock);
 	}
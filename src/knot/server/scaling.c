@@ -0,0 +1,85 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "knot/server/scaling.h"
+#include "contrib/macros.h"
+#include "contrib/time.h"
+
+uint64_t scaling_now(void)
+{
+	timev_t now;
+	time_now(&now);
+#ifdef HAVE_CLOCK_GETTIME
+	return now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+#else
+	return now.tv_sec * 1000000ULL + now.tv_usec;
+#endif
+}
+
+void scaling_account(scaling_stats_t *stats, uint64_t begin, bool backlog)
+{
+	stats->busy += scaling_now() - begin;
+	stats->wakeups += 1;
+	if (backlog) {
+		stats->backlog += 1;
+	}
+}
+
+void scaling_sum(scaling_sample_t *sample, const scaling_stats_t *stats)
+{
+	sample->busy += stats->busy;
+	sample->wakeups += stats->wakeups;
+	sample->backlog += stats->backlog;
+}
+
+unsigned scaling_update(scaling_t *sc, const scaling_sample_t *sample, uint64_t now,
+                        unsigned active, unsigned min, unsigned max, bool overload)
+{
+	uint64_t elapsed = now - sc->time;
+	uint64_t busy = sample->busy - sc->last.busy;
+	uint64_t wakeups = sample->wakeups - sc->last.wakeups;
+	uint64_t backlog = sample->backlog - sc->last.backlog;
+	bool baseline = (sc->time == 0);
+
+	sc->last = *sample;
+	sc->time = now;
+
+	unsigned target = active;
+	if (!baseline && elapsed > 0 && active > 0) {
+		uint64_t util = busy * 100 / (elapsed * active);
+		bool queued = (backlog * 100 >= wakeups * SCALING_BACKLOG) && backlog > 0;
+
+		if (util >= SCALING_HIGH || queued || overload) {
+			/* Enough workers for the target utilisation, at least one more. */
+			uint64_t capacity = elapsed * SCALING_TARGET;
+			uint64_t needed = (busy * 100 + capacity - 1) / capacity;
+			target = MAX(needed, active + 1);
+			sc->idle = 0;
+		} else if (util < SCALING_LOW) {
+			/* Park one worker at a time. */
+			if (++sc->idle >= SCALING_IDLE_PERIODS) {
+				target = active - 1;
+				sc->idle = 0;
+			}
+		} else {
+			sc->idle = 0;
+		}
+	}
+
+	/* Configured bounds take precedence. */
+	return MAX(MIN(target, max), min);
+}
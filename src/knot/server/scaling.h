@@ -0,0 +1,110 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file scaling.h
+ *
+ * \brief Elastic sizing of the UDP and TCP worker sets.
+ *
+ * Each worker measures the time it spends processing events and counts the
+ * event batches which left more work queued behind (a full receive batch or
+ * several ready sockets). The scheduler periodically sums the counters of a
+ * worker set and derives its utilisation. A worker is added when the
+ * utilisation or the queue depth is high, or under UDP overload, and parked
+ * again after several underutilised periods. The count of serving workers
+ * stays within the configured bounds.
+ *
+ * \addtogroup server
+ * @{
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*! \brief Sampling period (milliseconds). */
+#define SCALING_PERIOD		1000
+/*! \brief Utilisation to add workers (percent). */
+#define SCALING_HIGH		70
+/*! \brief Utilisation to aim for when adding workers (percent). */
+#define SCALING_TARGET		50
+/*! \brief Utilisation to park a worker (percent). */
+#define SCALING_LOW		25
+/*! \brief Share of event batches with queued work to add a worker (percent). */
+#define SCALING_BACKLOG		10
+/*! \brief Number of consecutive underutilised periods to park a worker. */
+#define SCALING_IDLE_PERIODS	10
+
+/*! \brief Activity counters of a worker, written by the worker only. */
+typedef struct {
+	volatile uint64_t busy;     /*!< Time spent processing events (microseconds). */
+	volatile uint64_t wakeups;  /*!< Processed event batches. */
+	volatile uint64_t backlog;  /*!< Batches which left queued work behind. */
+} scaling_stats_t;
+
+/*! \brief Summed activity counters of a worker set. */
+typedef struct {
+	uint64_t busy;
+	uint64_t wakeups;
+	uint64_t backlog;
+} scaling_sample_t;
+
+/*! \brief Worker set scaling state. */
+typedef struct {
+	scaling_sample_t last;  /*!< Counters at the last sample. */
+	uint64_t time;          /*!< Time of the last sample, 0 if none. */
+	unsigned idle;          /*!< Consecutive underutilised periods. */
+} scaling_t;
+
+/*!
+ * \brief Get the current monotonic time in microseconds.
+ */
+uint64_t scaling_now(void);
+
+/*!
+ * \brief Account a processed event batch.
+ *
+ * \param stats    Worker counters.
+ * \param begin    Start of the processing (\ref scaling_now).
+ * \param backlog  Work was left queued behind.
+ */
+void scaling_account(scaling_stats_t *stats, uint64_t begin, bool backlog);
+
+/*!
+ * \brief Add worker counters to a sample.
+ */
+void scaling_sum(scaling_sample_t *sample, const scaling_stats_t *stats);
+
+/*!
+ * \brief Evaluate a sample and compute the number of serving workers.
+ *
+ * The first sample only sets the baseline.
+ *
+ * \param sc        Scaling state.
+ * \param sample    Summed counters of all workers of the set.
+ * \param now       Sampling time (\ref scaling_now).
+ * \param active    Current number of serving workers.
+ * \param min       Lower bound.
+ * \param max       Upper bound.
+ * \param overload  The workers drop queries.
+ *
+ * \return New number of serving workers.
+ */
+unsigned scaling_update(scaling_t *sc, const scaling_sample_t *sample, uint64_t now,
+                        unsigned active, unsigned min, unsigned max, bool overload);
+
+/*! @} */
@@ -29,6 +29,7 @@
 #include "knot/zone/timers.h"
 #include "knot/zone/zonedb-load.h"
 #include "knot/worker/pool.h"
+#include "contrib/macros.h"
 #include "contrib/net.h"
 #include "contrib/sockaddr.h"
 #include "contrib/trim.h"
@@ -51,6 +52,7 @@ static void server_deinit_iface(iface_t *iface)
 		}
 	}
 	free(iface->fd_udp);
+	free((void *)iface->fd_udp_drops);
 
 	/* Free TCP handler. */
 	if (iface->fd_tcp > -1) {
@@ -129,23 +131,40 @@ static bool enable_pktinfo(int sock, int family)
 	return setsockopt(sock, level, option, &on, sizeof(on)) == 0;
 }
 
+/*!
+ * \brief Enable reporting of datagrams dropped by the kernel.
+ */
+static bool enable_rxq_ovfl(int sock)
+{
+#if defined(SO_RXQ_OVFL)
+	const int on = 1;
+	return setsockopt(sock, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) == 0;
+#else
+	return false;
+#endif
+}
+
 /*!
  * \brief Initialize new interface from config value.
  *
- * Both TCP and UDP sockets will be created for the interface.
+ * Both TCP and UDP sockets will be created for the interface, only the TCP
+ * socket for a TLS interface.
  *
  * \param new_if Allocated memory for the interface.
  * \param cfg_if Interface template from config.
+ * \param tls    DNS-over-TLS interface.
  *
  * \retval 0 if successful (EOK).
  * \retval <0 on errors (EACCES, EINVAL, ENOMEM, EADDRINUSE).
  */
-static int server_init_iface(iface_t *new_if, struct sockaddr_storage *addr, int udp_thread_count)
+static int server_init_iface(iface_t *new_if, struct sockaddr_storage *addr,
+                             int udp_thread_count, bool tls)
 {
 	/* Initialize interface. */
 	int ret = 0;
 	memset(new_if, 0, sizeof(iface_t));
 	memcpy(&new_if->addr, addr, sizeof(struct sockaddr_storage));
+	new_if->tls = tls;
 
 	/* Convert to string address format. */
 	char addr_str[SOCKADDR_STRLEN] = { 0 };
@@ -159,8 +178,15 @@ static int server_init_iface(iface_t *new_if, struct sockaddr_storage *addr, int
 	bind_flags |= NET_BIND_MULTIPLE;
 #endif
 
-	new_if->fd_udp = malloc(udp_socket_count * sizeof(int));
-	if (!new_if->fd_udp) {
+	if (tls) {
+		udp_socket_count = 0;
+	}
+
+	new_if->fd_udp = malloc(MAX(udp_socket_count, 1) * sizeof(int));
+	new_if->fd_udp_drops = calloc(MAX(udp_socket_count, 1), sizeof(uint32_t));
+	if (!new_if->fd_udp || !new_if->fd_udp_drops) {
+		free(new_if->fd_udp);
+		free((void *)new_if->fd_udp_drops);
 		return KNOT_ENOMEM;
 	}
 
@@ -202,6 +228,9 @@ static int server_init_iface(iface_t *new_if, struct sockaddr_storage *addr, int
 			log_warning("failed to enable received packet information retrieval");
 		}
 
+		/* Best effort, used for overload detection only. */
+		(void)enable_rxq_ovfl(sock);
+
 		new_if->fd_udp[new_if->fd_udp_count] = sock;
 		new_if->fd_udp_count += 1;
 	}
@@ -248,47 +277,31 @@ static void remove_ifacelist(struct ref *p)
 		free(n);
 	}
 
+	tls_ctx_free(ifaces->tls);
 	free(ifaces);
 }
 
 /*!
- * \brief Update bound sockets according to configuration.
+ * \brief Move configured interfaces to the new list, bind the missing ones.
  *
- * \param server Server instance.
  * \return number of added sockets.
  */
-static int reconfigure_sockets(conf_t *conf, server_t *s)
+static int bind_ifaces(server_t *s, ifacelist_t *newlist, conf_val_t *listen_val,
+                       const char *rundir, bool tls)
 {
-	/* Prepare helper lists. */
 	int bound = 0;
-	ifacelist_t *oldlist = s->ifaces;
-	ifacelist_t *newlist = malloc(sizeof(ifacelist_t));
-	ref_init(&newlist->ref, &remove_ifacelist);
-	ref_retain(&newlist->ref);
-	init_list(&newlist->u);
-	init_list(&newlist->l);
-
-	/* Duplicate current list. */
-	/*! \note Pointers to addr, handlers etc. will be shared. */
-	if (s->ifaces) {
-		list_dup(&s->ifaces->u, &s->ifaces->l, sizeof(iface_t));
-	}
-
-	/* Update bound interfaces. */
-	conf_val_t listen_val = conf_get(conf, C_SRV, C_LISTEN);
-	conf_val_t rundir_val = conf_get(conf, C_SRV, C_RUNDIR);
-	char *rundir = conf_abs_path(&rundir_val, NULL);
-	while (listen_val.code == KNOT_EOK) {
+	while (listen_val->code == KNOT_EOK) {
 		iface_t *m = NULL;
 
 		/* Find already matching interface. */
 		int found_match = 0;
-		struct sockaddr_storage addr = conf_addr(&listen_val, rundir);
+		struct sockaddr_storage addr = conf_addr(listen_val, rundir);
 		if (s->ifaces) {
 			WALK_LIST(m, s->ifaces->u) {
-				/* Matching port and address. */
+				/* Matching port, address and protocol. */
 				if (sockaddr_cmp((struct sockaddr *)&addr,
-				                 (struct sockaddr *)&m->addr) == 0) {
+				                 (struct sockaddr *)&m->addr) == 0 &&
+				    m->tls == tls) {
 					found_match = 1;
 					break;
 				}
@@ -301,12 +314,12 @@ static int reconfigure_sockets(conf_t *conf, server_t *s)
 		} else {
 			char addr_str[SOCKADDR_STRLEN] = { 0 };
 			sockaddr_tostr(addr_str, sizeof(addr_str), (struct sockaddr *)&addr);
-			log_info("binding to interface '%s'", addr_str);
+			log_info("binding to %sinterface '%s'", tls ? "TLS " : "", addr_str);
 
 			/* Create new interface. */
 			m = malloc(sizeof(iface_t));
-			unsigned size = s->handlers[IO_UDP].handler.unit->size;
-			if (server_init_iface(m, &addr, size) < 0) {
+			unsigned size = s->handlers[IO_UDP].size;
+			if (server_init_iface(m, &addr, size, tls) < 0) {
 				free(m);
 				m = 0;
 			}
@@ -318,45 +331,236 @@ static int reconfigure_sockets(conf_t *conf, server_t *s)
 			++bound;
 		}
 
-		conf_val_next(&listen_val);
+		conf_val_next(listen_val);
 	}
-	free(rundir);
 
-	/* Wait for readers that are reconfiguring right now. */
-	/*! \note This subsystem will be reworked in #239 */
-	for (unsigned proto = IO_UDP; proto <= IO_TCP; ++proto) {
-		dt_unit_t *tu = s->handlers[proto].handler.unit;
-		iohandler_t *ioh = &s->handlers[proto].handler;
-		for (unsigned i = 0; i < tu->size; ++i) {
-			while (ioh->thread_state[i] & ServerReload) {
-				sleep(1);
-			}
+	return bound;
+}
+
+/*! \brief Load the DNS-over-TLS credentials. */
+static tls_ctx_t *load_tls_ctx(conf_t *conf)
+{
+	conf_val_t val = conf_get(conf, C_SRV, C_CERT_FILE);
+	char *cert_file = conf_abs_path(&val, NULL);
+	val = conf_get(conf, C_SRV, C_KEY_FILE);
+	char *key_file = conf_abs_path(&val, NULL);
+
+	tls_ctx_t *ctx = NULL;
+	if (cert_file == NULL || key_file == NULL) {
+		log_error("TLS, missing certificate or key file");
+	} else {
+		int ret = tls_ctx_new(&ctx, cert_file, key_file);
+		if (ret != KNOT_EOK) {
+			log_error("TLS, failed to load certificate '%s' or key '%s' (%s)",
+			          cert_file, key_file, knot_strerror(ret));
 		}
 	}
 
+	free(cert_file);
+	free(key_file);
+
+	return ctx;
+}
+
+/*!
+ * \brief Update bound sockets according to configuration.
+ *
+ * \param server Server instance.
+ * \return number of added sockets.
+ */
+static int reconfigure_sockets(conf_t *conf, server_t *s)
+{
+	/* Prepare helper lists. */
+	int bound = 0;
+	ifacelist_t *oldlist = s->ifaces;
+	ifacelist_t *newlist = malloc(sizeof(ifacelist_t));
+	ref_init(&newlist->ref, &remove_ifacelist);
+	ref_retain(&newlist->ref);
+	init_list(&newlist->u);
+	init_list(&newlist->l);
+	newlist->tls = NULL;
+
+	/* Duplicate current list. */
+	/*! \note Pointers to addr, handlers etc. will be shared. */
+	if (s->ifaces) {
+		list_dup(&s->ifaces->u, &s->ifaces->l, sizeof(iface_t));
+	}
+
+	/* Update bound interfaces. */
+	conf_val_t listen_val = conf_get(conf, C_SRV, C_LISTEN);
+	conf_val_t rundir_val = conf_get(conf, C_SRV, C_RUNDIR);
+	char *rundir = conf_abs_path(&rundir_val, NULL);
+	bound += bind_ifaces(s, newlist, &listen_val, rundir, false);
+
+	/* TLS interfaces, the credentials are reloaded each time. */
+	listen_val = conf_get(conf, C_SRV, C_LISTEN_TLS);
+	if (listen_val.code == KNOT_EOK) {
+		newlist->tls = load_tls_ctx(conf);
+		if (newlist->tls != NULL) {
+			bound += bind_ifaces(s, newlist, &listen_val, rundir, true);
+		}
+	}
+	free(rundir);
+
 	/* Publish new list. */
-	s->ifaces = newlist;
+	rcu_assign_pointer(s->ifaces, newlist);
 
 	/* Update TCP+UDP ifacelist (reload all threads). */
-	unsigned thread_count = 0;
 	for (unsigned proto = IO_UDP; proto <= IO_TCP; ++proto) {
-		dt_unit_t *tu = s->handlers[proto].handler.unit;
+		iohandler_t *ioh = &s->handlers[proto].handler;
+		pthread_mutex_lock(&ioh->lock);
+		dt_unit_t *tu = ioh->unit;
 		for (unsigned i = 0; i < tu->size; ++i) {
-			ref_retain((ref_t *)newlist);
-			s->handlers[proto].handler.thread_state[i] |= ServerReload;
-			s->handlers[proto].handler.thread_id[i] = thread_count++;
-			if (s->state & ServerRunning) {
+			__sync_or_and_fetch(&ioh->threads[i]->state, ServerReload);
+			if ((s->state & ServerRunning) && i < ioh->active) {
 				dt_activate(tu->threads[i]);
 				dt_signalize(tu->threads[i], SIGALRM);
 			}
 		}
+		pthread_mutex_unlock(&ioh->lock);
 	}
 
+	/* Threads take their own references, wait for those reading the old list. */
+	synchronize_rcu();
 	ref_release(&oldlist->ref);
 
 	return bound;
 }
 
+/*! \brief Periodic memory pressure sampling, runs in the scheduler thread. */
+static void mempressure_sample(event_t *event)
+{
+	server_t *server = event->data;
+
+	rcu_read_lock();
+	unsigned limit = conf()->cache.srv_memory_pressure;
+	rcu_read_unlock();
+
+	mempressure_sample_t sample;
+	if (limit > 0 && mempressure_read(&server->mempressure, &sample) == KNOT_EOK) {
+		mempressure_update(&server->mempressure, &sample, limit);
+	} else {
+		mempressure_update(&server->mempressure, NULL, 0);
+	}
+
+	evsched_schedule(event, MEMPRESSURE_PERIOD);
+}
+
+/*!
+ * \brief Activate or park threads to get the given number of serving threads.
+ *
+ * \note Handler lock must be held.
+ */
+static void handler_scale(iohandler_t *h, int index, unsigned active)
+{
+	unsigned old = h->active;
+	if (active == old) {
+		return;
+	}
+
+	h->active = active;
+	if (!(h->server->state & ServerRunning)) {
+		return;
+	}
+
+	dt_unit_t *unit = h->unit;
+
+	/* UDP sockets are redistributed among the serving threads. */
+	if (index == IO_UDP) {
+		for (unsigned i = 0; i < MAX(old, active); ++i) {
+			__sync_or_and_fetch(&h->threads[i]->state, ServerReload);
+			if (i < MIN(old, active)) {
+				dt_signalize(unit->threads[i], SIGALRM);
+			}
+		}
+	}
+
+	/* Parked threads finish the queries in progress first. */
+	for (unsigned i = MIN(old, active); i < MAX(old, active); ++i) {
+		if (i < active) {
+			dt_activate(unit->threads[i]);
+			dt_signalize(unit->threads[i], SIGALRM);
+		} else {
+			dt_park(unit->threads[i]);
+		}
+	}
+
+	log_debug("%s, %u of %u workers serving", (index == IO_UDP) ? "UDP" : "TCP",
+	          active, unit->size);
+}
+
+/*! \brief Periodic I/O threads scaling, runs in the scheduler thread. */
+static void scaling_sample(event_t *event)
+{
+	server_t *server = event->data;
+	uint64_t now = scaling_now();
+
+	for (int proto = IO_UDP; proto <= IO_TCP; ++proto) {
+		if (!(server->state & ServerRunning) || server->handlers[proto].size == 0) {
+			continue;
+		}
+
+		iohandler_t *h = &server->handlers[proto].handler;
+		pthread_mutex_lock(&h->lock);
+
+		scaling_sample_t sample = { 0 };
+		for (int i = 0; i < h->unit->size; ++i) {
+			scaling_sum(&sample, &h->threads[i]->stats);
+		}
+
+		bool overload = (proto == IO_UDP) && overload_active(&server->overload);
+		unsigned active = scaling_update(&h->scaling, &sample, now, h->active,
+		                                 server->handlers[proto].min_size,
+		                                 server->handlers[proto].size, overload);
+		handler_scale(h, proto, active);
+
+		pthread_mutex_unlock(&h->lock);
+	}
+
+	evsched_schedule(event, SCALING_PERIOD);
+}
+
+/*! \brief Applies the batched member zone changes, runs in the scheduler thread. */
+static void catalog_event(event_t *event)
+{
+	server_t *server = event->data;
+
+	/* Changes recorded from now on schedule another run. */
+	(void)__sync_bool_compare_and_swap(&server->catalog_pending, 1, 0);
+
+	/* Not in an RCU read-side section, take a copy. */
+	conf_t *conf = NULL;
+	rcu_read_lock();
+	int ret = conf_clone(&conf);
+	rcu_read_unlock();
+	if (ret != KNOT_EOK) {
+		log_error("catalog, failed to update member zones (%s)",
+		          knot_strerror(ret));
+		return;
+	}
+
+	pthread_mutex_lock(&server->catalog_upd.lock);
+	zonedb_update_catalogs(conf, server);
+	pthread_mutex_unlock(&server->catalog_upd.lock);
+
+	conf_free(conf);
+}
+
+/*!
+ * \brief Schedules the member zone changes, called by the switching catalog.
+ *
+ * The zone database is rebuilt once for the changes of several switches,
+ * and the switching worker doesn't wait for it.
+ */
+static void update_catalogs(void *ctx)
+{
+	server_t *server = ctx;
+
+	if (__sync_bool_compare_and_swap(&server->catalog_pending, 0, 1)) {
+		evsched_schedule(server->catalog_event, CATALOG_UPDATE_DELAY);
+	}
+}
+
 int server_init(server_t *server, int bg_workers)
 {
 	if (server == NULL) {
@@ -377,6 +581,57 @@ int server_init(server_t *server, int bg_workers)
 		return KNOT_ENOMEM;
 	}
 
+	/* Initialize memory pressure detection. */
+	mempressure_init(&server->mempressure, NULL);
+	server->mempressure_event = evsched_event_create(&server->sched,
+	                                                 mempressure_sample, server);
+	if (server->mempressure_event == NULL) {
+		mempressure_deinit(&server->mempressure);
+		worker_pool_destroy(server->workers);
+		evsched_deinit(&server->sched);
+		return KNOT_ENOMEM;
+	}
+	evsched_schedule(server->mempressure_event, MEMPRESSURE_PERIOD);
+
+	/* Initialize I/O threads scaling. */
+	server->scaling_event = evsched_event_create(&server->sched, scaling_sample,
+	                                             server);
+	if (server->scaling_event == NULL) {
+		evsched_cancel(server->mempressure_event);
+		evsched_event_free(server->mempressure_event);
+		mempressure_deinit(&server->mempressure);
+		worker_pool_destroy(server->workers);
+		evsched_deinit(&server->sched);
+		return KNOT_ENOMEM;
+	}
+	evsched_schedule(server->scaling_event, SCALING_PERIOD);
+
+	/* Initialize catalog member zone changes. */
+	if (catalog_update_init(&server->catalog_upd, update_catalogs,
+	                        server) != KNOT_EOK) {
+		evsched_cancel(server->scaling_event);
+		evsched_event_free(server->scaling_event);
+		evsched_cancel(server->mempressure_event);
+		evsched_event_free(server->mempressure_event);
+		mempressure_deinit(&server->mempressure);
+		worker_pool_destroy(server->workers);
+		evsched_deinit(&server->sched);
+		return KNOT_ENOMEM;
+	}
+	server->catalog_event = evsched_event_create(&server->sched, catalog_event,
+	                                             server);
+	if (server->catalog_event == NULL) {
+		catalog_update_deinit(&server->catalog_upd);
+		evsched_cancel(server->scaling_event);
+		evsched_event_free(server->scaling_event);
+		evsched_cancel(server->mempressure_event);
+		evsched_event_free(server->mempressure_event);
+		mempressure_deinit(&server->mempressure);
+		worker_pool_destroy(server->workers);
+		evsched_deinit(&server->sched);
+		return KNOT_ENOMEM;
+	}
+
 	return KNOT_EOK;
 }
 
@@ -392,6 +647,7 @@ void server_deinit(server_t *server)
 		WALK_LIST_DELSAFE(n, m, server->ifaces->l) {
 			server_remove_iface(n);
 		}
+		tls_ctx_free(server->ifaces->tls);
 		free(server->ifaces);
 	}
 
@@ -405,7 +661,15 @@ void server_deinit(server_t *server)
 	knot_zonedb_deep_free(&server->zone_db);
 
 	/* Free remaining events. */
+	evsched_cancel(server->catalog_event);
+	evsched_event_free(server->catalog_event);
+	evsched_cancel(server->scaling_event);
+	evsched_event_free(server->scaling_event);
+	evsched_cancel(server->mempressure_event);
+	evsched_event_free(server->mempressure_event);
 	evsched_deinit(&server->sched);
+	mempressure_deinit(&server->mempressure);
+	catalog_update_deinit(&server->catalog_upd);
 
 	/* Close persistent timers database. */
 	close_timers_db(server->timers_db);
@@ -426,22 +690,70 @@ static int server_init_handler(server_t *server, int index, int thread_count,
 		return KNOT_ENOMEM;
 	}
 
-	h->thread_state = calloc(thread_count, sizeof(unsigned));
-	if (h->thread_state == NULL) {
+	h->threads = calloc(thread_count, sizeof(iothread_t *));
+	if (h->threads == NULL) {
 		dt_delete(&h->unit);
 		return KNOT_ENOMEM;
 	}
 
-	h->thread_id = calloc(thread_count, sizeof(unsigned));
-	if (h->thread_id == NULL) {
-		free(h->thread_state);
-		dt_delete(&h->unit);
-		return KNOT_ENOMEM;
+	for (int i = 0; i < thread_count; ++i) {
+		h->threads[i] = calloc(1, sizeof(iothread_t));
+		if (h->threads[i] == NULL) {
+			for (int j = 0; j < i; ++j) {
+				free(h->threads[j]);
+			}
+			free(h->threads);
+			dt_delete(&h->unit);
+			return KNOT_ENOMEM;
+		}
 	}
 
+	h->active = thread_count;
+	pthread_mutex_init(&h->lock, NULL);
+
 	return KNOT_EOK;
 }
 
+/*!
+ * \brief Add parked threads to a handler.
+ *
+ * \note Handler lock must be held.
+ */
+static int server_extend_handler(iohandler_t *h, int thread_count)
+{
+	int size = h->unit->size;
+
+	/* Thread contexts are looked up under the unit lock. */
+	dt_unit_lock(h->unit);
+	iothread_t **threads = realloc(h->threads, thread_count * sizeof(iothread_t *));
+	if (threads != NULL) {
+		h->threads = threads;
+		for (int i = size; i < thread_count; ++i) {
+			h->threads[i] = calloc(1, sizeof(iothread_t));
+			if (h->threads[i] == NULL) {
+				thread_count = i;
+				break;
+			}
+		}
+	}
+	dt_unit_unlock(h->unit);
+	if (threads == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	int ret = dt_extend(h->unit, thread_count);
+
+	/* Drop the contexts of threads which failed to start. */
+	for (int i = h->unit->size; i < thread_count; ++i) {
+		free(h->threads[i]);
+	}
+	if (ret == KNOT_EOK && h->unit->size < thread_count) {
+		ret = KNOT_ENOMEM;
+	}
+
+	return ret;
+}
+
 static void server_free_handler(iohandler_t *h)
 {
 	if (h == NULL || h->server == NULL) {
@@ -455,9 +767,14 @@ static void server_free_handler(iohandler_t *h)
 	}
 
 	/* Destroy worker context. */
+	if (h->threads != NULL) {
+		for (int i = 0; i < h->unit->size; ++i) {
+			free(h->threads[i]);
+		}
+	}
 	dt_delete(&h->unit);
-	free(h->thread_state);
-	free(h->thread_id);
+	free(h->threads);
+	pthread_mutex_destroy(&h->lock);
 	memset(h, 0, sizeof(iohandler_t));
 }
 
@@ -616,15 +933,13 @@ void server_stop(server_t *server)
 	server->state &= ~ServerRunning;
 }
 
-static int reset_handler(server_t *server, int index, unsigned size, runnable_t run)
+static int reset_handler(server_t *server, int index, unsigned size,
+                         unsigned min_size, runnable_t run)
 {
-	if (server->handlers[index].size != size) {
-		/* Free old handlers */
-		if (server->handlers[index].size > 0) {
-			server_free_handler(&server->handlers[index].handler);
-		}
+	iohandler_t *h = &server->handlers[index].handler;
 
-		/* Initialize I/O handlers. */
+	/* Initialize I/O handlers. */
+	if (server->handlers[index].size == 0) {
 		int ret = server_init_handler(server, index, size, run, NULL);
 		if (ret != KNOT_EOK) {
 			return ret;
@@ -632,26 +947,74 @@ static int reset_handler(server_t *server, int index, unsigned size, runnable_t
 
 		/* Start if server is running. */
 		if (server->state & ServerRunning) {
-			ret = dt_start(server->handlers[index].handler.unit);
+			ret = dt_start(h->unit);
 			if (ret != KNOT_EOK) {
 				return ret;
 			}
 		}
 		server->handlers[index].size = size;
+		server->handlers[index].min_size = min_size;
+
+		return KNOT_EOK;
 	}
 
-	return KNOT_EOK;
+	/* Resize live, the sockets and the queries in progress are kept. */
+	pthread_mutex_lock(&h->lock);
+	int ret = KNOT_EOK;
+	if (size > h->unit->size) {
+		ret = server_extend_handler(h, size);
+	}
+	if (ret == KNOT_EOK) {
+		server->handlers[index].size = size;
+		server->handlers[index].min_size = min_size;
+		handler_scale(h, index, MAX(MIN(h->active, size), min_size));
+	}
+	pthread_mutex_unlock(&h->lock);
+
+	return ret;
+}
+
+/*! \brief Get the configured minimum of serving threads. */
+static unsigned min_threads(conf_t *conf, const yp_name_t *name, unsigned size)
+{
+	conf_val_t val = conf_get(conf, C_SRV, name);
+	int64_t min_size = conf_int(&val);
+	if (min_size == YP_NIL || min_size > size) {
+		return size;
+	}
+
+	return min_size;
 }
 
 /*! \brief Reconfigure UDP and TCP query processing threads. */
 static int reconfigure_threads(conf_t *conf, server_t *server)
 {
-	int ret = reset_handler(server, IO_UDP, conf_udp_threads(conf), udp_master);
+	unsigned udp_size = conf_udp_threads(conf);
+	int ret = reset_handler(server, IO_UDP, udp_size,
+	                        min_threads(conf, C_MIN_UDP_WORKERS, udp_size),
+	                        udp_master);
 	if (ret != KNOT_EOK) {
 		return ret;
 	}
 
-	return reset_handler(server, IO_TCP, conf_tcp_threads(conf), tcp_master);
+	unsigned tcp_size = conf_tcp_threads(conf);
+	ret = reset_handler(server, IO_TCP, tcp_size,
+	                    min_threads(conf, C_MIN_TCP_WORKERS, tcp_size),
+	                    tcp_master);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	/* Unique identifiers of the serving threads, picked up on reload. */
+	for (unsigned proto = IO_UDP; proto <= IO_TCP; ++proto) {
+		iohandler_t *h = &server->handlers[proto].handler;
+		unsigned base = (proto == IO_TCP) ? server->handlers[IO_UDP].size : 0;
+		for (unsigned i = 0; i < h->unit->size; ++i) {
+			h->threads[i]->id = base + i;
+		}
+	}
+
+	return KNOT_EOK;
 }
 
 static int reconfigure_rate_limits(conf_t *conf, server_t *server)
@@ -744,25 +1107,30 @@ void server_update_zones(conf_t *conf, server_t *server)
 		return;
 	}
 
+	/* Catalog member zone changes are serialized with the reload. */
+	pthread_mutex_lock(&server->catalog_upd.lock);
+
 	/* Prevent emitting of new zone events. */
 	if (server->zone_db) {
 		knot_zonedb_foreach(server->zone_db, zone_events_freeze);
 	}
 
-	/* Suspend workers, clear wating events, finish running events. */
-	worker_pool_suspend(server->workers);
-	worker_pool_clear(server->workers);
-	worker_pool_wait(server->workers);
-
-	/* Reload zone database and free old zones. */
+	/*
+	 * Reload zone database and free old zones. Running and queued events
+	 * of the old zones finish in the background, the new zones take over
+	 * their results.
+	 */
 	reopen_timers_database(conf, server);
 	zonedb_reload(conf, server);
 
+	/* The members of all catalogs were just collected. */
+	catalog_update_clear(&server->catalog_upd);
+	pthread_mutex_unlock(&server->catalog_upd.lock);
+
 	/* Trim extra heap. */
 	mem_trim();
 
-	/* Resume workers and allow events on new zones. */
-	worker_pool_resume(server->workers);
+	/* Allow events on new zones. */
 	if (server->zone_db) {
 		knot_zonedb_foreach(server->zone_db, zone_events_start);
 	}
@@ -777,19 +1145,25 @@ ref_t *server_set_ifaces(server_t *server, fdset_t *fds, int index, int thread_i
 	rcu_read_lock();
 	fdset_clear(fds);
 
+	ifacelist_t *ifaces = rcu_dereference(server->ifaces);
+	ref_retain(&ifaces->ref);
+
 	iface_t *i = NULL;
-	WALK_LIST(i, server->ifaces->l) {
-#ifdef ENABLE_REUSEPORT
-		int udp_id = thread_id % i->fd_udp_count;
-#else
-		int udp_id = 0;
-#endif
+	WALK_LIST(i, ifaces->l) {
 		switch(index) {
 		case IO_TCP:
-			fdset_add(fds, i->fd_tcp, POLLIN, NULL);
+			/* TLS listeners carry the credentials as context. */
+			fdset_add(fds, i->fd_tcp, POLLIN, i->tls ? ifaces->tls : NULL);
 			break;
 		case IO_UDP:
-			fdset_add(fds, i->fd_udp[udp_id], POLLIN, NULL);
+			if (i->fd_udp_count == 0) {
+				break; /* TCP-only (TLS) interface. */
+			}
+#ifdef ENABLE_REUSEPORT
+			fdset_add(fds, i->fd_udp[thread_id % i->fd_udp_count], POLLIN, NULL);
+#else
+			fdset_add(fds, i->fd_udp[0], POLLIN, NULL);
+#endif
 			break;
 		default:
 			assert(0);
@@ -797,5 +1171,16 @@ ref_t *server_set_ifaces(server_t *server, fdset_t *fds, int index, int thread_i
 	}
 	rcu_read_unlock();
 
-	return &server->ifaces->ref;
+	return &ifaces->ref;
+}
+
+iothread_t *server_iothread(iohandler_t *handler, dthread_t *thread)
+{
+	unsigned id = dt_get_id(thread);
+
+	dt_unit_lock(handler->unit);
+	iothread_t *io = handler->threads[id];
+	dt_unit_unlock(handler->unit);
+
+	return io;
 }
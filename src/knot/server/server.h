@@ -34,7 +34,11 @@
 #include "knot/common/fdset.h"
 #include "knot/server/dthreads.h"
 #include "knot/common/ref.h"
+#include "knot/server/mempressure.h"
+#include "knot/server/overload.h"
 #include "knot/server/rrl.h"
+#include "knot/server/scaling.h"
+#include "knot/server/tls.h"
 #include "knot/worker/pool.h"
 #include "knot/zone/zonedb.h"
 #include "contrib/ucw/lists.h"
@@ -42,14 +46,24 @@
 /* Forwad declarations. */
 struct server;
 
+/*! \brief I/O handler thread context, stable for the thread lifetime.
+  */
+typedef struct iothread {
+	volatile unsigned  state;  /*!< Thread state */
+	unsigned           id;     /*!< Thread identifier. */
+	scaling_stats_t    stats;  /*!< Thread activity. */
+} iothread_t;
+
 /*! \brief I/O handler structure.
   */
 typedef struct iohandler {
 	struct node        n;
 	struct server      *server; /*!< Reference to server */
 	dt_unit_t          *unit;   /*!< Threading unit */
-	unsigned           *thread_state; /*!< Thread state */
-	unsigned           *thread_id; /*!< Thread identifier. */
+	iothread_t         **threads; /*!< Thread contexts, by unit thread index. */
+	volatile unsigned  active;  /*!< Number of serving threads, the rest is parked. */
+	scaling_t          scaling; /*!< Serving threads scaling state. */
+	pthread_mutex_t    lock;    /*!< Scaling and resizing lock. */
 } iohandler_t;
 
 /*! \brief Server state flags.
@@ -66,8 +80,10 @@ typedef enum {
 typedef struct iface {
 	struct node n;
 	int *fd_udp;
+	volatile uint32_t *fd_udp_drops; /*!< Last kernel drop counters of UDP sockets. */
 	int fd_udp_count;
 	int fd_tcp;
+	bool tls; /*!< DNS-over-TLS interface (TCP only). */
 	struct sockaddr_storage addr;
 } iface_t;
 
@@ -81,6 +97,7 @@ typedef struct ifacelist {
 	ref_t ref;
 	list_t l;
 	list_t u;
+	tls_ctx_t *tls; /*!< Credentials for the TLS interfaces. */
 } ifacelist_t;
 
 /*!
@@ -99,7 +116,8 @@ typedef struct server {
 
 	/*! \brief I/O handlers. */
 	struct {
-		unsigned size;
+		unsigned size;      /*!< Maximum number of serving threads. */
+		unsigned min_size;  /*!< Minimum number of serving threads. */
 		iohandler_t handler;
 	} handlers[2];
 
@@ -115,6 +133,24 @@ typedef struct server {
 	/*! \brief Rate limiting. */
 	rrl_table_t *rrl;
 
+	/*! \brief Number of expensive queries in progress. */
+	volatile int expensive_queries;
+
+	/*! \brief UDP overload detection. */
+	overload_t overload;
+
+	/*! \brief Memory pressure detection. */
+	mempressure_t mempressure;
+	event_t *mempressure_event;
+
+	/*! \brief I/O threads scaling. */
+	event_t *scaling_event;
+
+	/*! \brief Pending member zone changes of catalogs. */
+	catalog_update_t catalog_upd;
+	event_t *catalog_event;
+	volatile int catalog_pending;
+
 } server_t;
 
 /*!
@@ -189,8 +225,18 @@ void server_update_zones(conf_t *conf, server_t *server);
  * \param fds     File descriptor set.
  * \param index   I/O index (UDP/TCP).
  *
- * \return new interface list
+ * \return new interface list, retained for the caller
  */
 ref_t *server_set_ifaces(server_t *server, fdset_t *fds, int index, int thread_id);
 
+/*!
+ * \brief Get the context of an I/O handler thread.
+ *
+ * \param handler  I/O handler.
+ * \param thread   Handler thread.
+ *
+ * \return Thread context.
+ */
+iothread_t *server_iothread(iohandler_t *handler, dthread_t *thread);
+
 /*! @} */
@@ -34,6 +34,7 @@
 
 #include "dnssec/random.h"
 #include "knot/server/tcp-handler.h"
+#include "knot/server/tls.h"
 #include "knot/common/fdset.h"
 #include "knot/common/log.h"
 #include "knot/nameserver/process_query.h"
@@ -57,9 +58,19 @@ typedef struct tcp_context {
 	unsigned thread_id;         /*!< Thread identifier. */
 } tcp_context_t;
 
+/*! \brief TCP client state (fdset context). */
+typedef struct tcp_client {
+	struct sockaddr_storage addr; /*!< Remote address. */
+	time_t last_active;           /*!< Time of the last received query. */
+	tls_conn_t *tls;              /*!< TLS connection (DNS-over-TLS client). */
+	bool tls_ready;               /*!< TLS handshake is complete. */
+} tcp_client_t;
+
 /*
  * Forward decls.
  */
+#define TCP_PREFIX_IPV4 24 /*!< Network prefix length for client quotas. */
+#define TCP_PREFIX_IPV6 56 /*!< Network prefix length for client quotas. */
 #define TCP_THROTTLE_LO 0 /*!< Minimum recovery time on errors. */
 #define TCP_THROTTLE_HI 2 /*!< Maximum recovery time on errors. */
 
@@ -68,6 +79,15 @@ static inline int tcp_throttle(void) {
 	return TCP_THROTTLE_LO + (dnssec_random_uint16_t() % TCP_THROTTLE_HI);
 }
 
+/*! \brief Release client state. */
+static void tcp_client_free(tcp_client_t *client)
+{
+	if (client != NULL) {
+		tls_conn_free(client->tls);
+	}
+	free(client);
+}
+
 /*! \brief Sweep TCP connection. */
 static enum fdset_sweep_state tcp_sweep(fdset_t *set, int i, void *data)
 {
@@ -85,14 +105,53 @@ static enum fdset_sweep_state tcp_sweep(fdset_t *set, int i, void *data)
 	}
 
 	close(fd);
+	tcp_client_free(set->ctx[i]);
 
 	return FDSET_SWEEP;
 }
 
+/*! \brief Maximal number of clients per TCP thread (under RCU lock). */
+static unsigned tcp_max_clients(void)
+{
+	int clients = conf()->cache.srv_max_tcp_clients;
+	return MAX(clients / conf_tcp_threads(conf()), 1);
+}
+
+/*! \brief Maximal number of clients per network prefix (under RCU lock). */
+static unsigned tcp_max_prefix_clients(void)
+{
+	int clients = conf()->cache.srv_max_tcp_prefix;
+	if (clients == 0) {
+		return 0;
+	}
+
+	return MAX(clients / conf_tcp_threads(conf()), 1);
+}
+
+/*!
+ * \brief Current client idle timeout in seconds (under RCU lock).
+ *
+ * The configured timeout is used until half of the client slots are taken,
+ * then it shrinks linearly with the remaining free slots, down to 1 second.
+ */
+static int tcp_idle_timeout(const tcp_context_t *tcp)
+{
+	int timeout = conf()->cache.srv_tcp_idle_timeout;
+	unsigned max = tcp_max_clients();
+	unsigned half = max / 2;
+	unsigned clients = tcp->set.n - tcp->client_threshold;
+	if (timeout <= 1 || clients <= half) {
+		return timeout;
+	}
+
+	unsigned free = (clients < max) ? max - clients : 0;
+	return MAX(timeout * free / (max - half), 1);
+}
+
 /*!
  * \brief TCP event handler function.
  */
-static int tcp_handle(tcp_context_t *tcp, int fd,
+static int tcp_handle(tcp_context_t *tcp, int fd, tls_conn_t *tls,
                       struct iovec *rx, struct iovec *tx)
 {
 	/* Create query processing parameter. */
@@ -115,10 +174,12 @@ static int tcp_handle(tcp_context_t *tcp, int fd,
 	/* Timeout. */
 	rcu_read_lock();
 	int timeout = 1000 * conf()->cache.srv_tcp_reply_timeout;
+	param.tcp_keepalive = tcp_idle_timeout(tcp);
 	rcu_read_unlock();
 
 	/* Receive data. */
-	int ret = net_dns_tcp_recv(fd, rx->iov_base, rx->iov_len, timeout);
+	int ret = (tls != NULL) ? tls_dns_recv(tls, rx->iov_base, rx->iov_len, timeout)
+	                        : net_dns_tcp_recv(fd, rx->iov_base, rx->iov_len, timeout);
 	if (ret <= 0) {
 		if (ret == KNOT_EAGAIN) {
 			char addr_str[SOCKADDR_STRLEN] = {0};
@@ -150,7 +211,9 @@ static int tcp_handle(tcp_context_t *tcp, int fd,
 
 		/* Send, if response generation passed and wasn't ignored. */
 		if (ans->size > 0 && !(state & (KNOT_STATE_FAIL|KNOT_STATE_NOOP))) {
-			if (net_dns_tcp_send(fd, ans->wire, ans->size, timeout) != ans->size) {
+			ssize_t sent = (tls != NULL) ? tls_dns_send(tls, ans->wire, ans->size, timeout)
+			                             : net_dns_tcp_send(fd, ans->wire, ans->size, timeout);
+			if (sent != ans->size) {
 				ret = KNOT_ECONNREFUSED;
 				break;
 			}
@@ -167,10 +230,10 @@ static int tcp_handle(tcp_context_t *tcp, int fd,
 	return ret;
 }
 
-int tcp_accept(int fd)
+int tcp_accept(int fd, struct sockaddr_storage *addr)
 {
 	/* Accept incoming connection. */
-	int incoming = net_accept(fd, NULL);
+	int incoming = net_accept(fd, addr);
 
 	/* Evaluate connection. */
 	if (incoming >= 0) {
@@ -190,16 +253,103 @@ int tcp_accept(int fd)
 	return incoming;
 }
 
+/*! \brief Close client connection and release its state. */
+static void tcp_client_close(tcp_context_t *tcp, unsigned i)
+{
+	assert(i >= tcp->client_threshold);
+
+	close(tcp->set.pfd[i].fd);
+	tcp_client_free(tcp->set.ctx[i]);
+	fdset_remove(&tcp->set, i);
+}
+
+/*!
+ * \brief Find a client to be evicted in favour of a new client.
+ *
+ * If the new client's network prefix has reached its quota, the oldest idle
+ * client from the same prefix is chosen. If the whole set is full, the oldest
+ * idle client overall is chosen.
+ *
+ * \return Index of the client to evict, or -1 if there is space left.
+ */
+static int tcp_client_victim(tcp_context_t *tcp, const struct sockaddr_storage *addr,
+                             unsigned max_clients, unsigned max_prefix)
+{
+	fdset_t *set = &tcp->set;
+	unsigned prefix = (addr->ss_family == AF_INET6) ? TCP_PREFIX_IPV6
+	                                                : TCP_PREFIX_IPV4;
+
+	int oldest = -1, oldest_net = -1;
+	unsigned clients = 0, clients_net = 0;
+	for (unsigned i = tcp->client_threshold; i < set->n; ++i) {
+		const tcp_client_t *client = set->ctx[i];
+		if (oldest < 0 || client->last_active <
+		    ((tcp_client_t *)set->ctx[oldest])->last_active) {
+			oldest = i;
+		}
+		clients += 1;
+
+		if (max_prefix == 0 ||
+		    !sockaddr_net_match((struct sockaddr *)&client->addr,
+		                        (struct sockaddr *)addr, prefix)) {
+			continue;
+		}
+		if (oldest_net < 0 || client->last_active <
+		    ((tcp_client_t *)set->ctx[oldest_net])->last_active) {
+			oldest_net = i;
+		}
+		clients_net += 1;
+	}
+
+	if (max_prefix > 0 && clients_net >= max_prefix) {
+		return oldest_net;
+	}
+	if (clients >= max_clients) {
+		return oldest;
+	}
+
+	return -1;
+}
+
 static int tcp_event_accept(tcp_context_t *tcp, unsigned i)
 {
+	tcp_client_t *ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return KNOT_ENOMEM;
+	}
+
 	/* Accept client. */
 	int fd = tcp->set.pfd[i].fd;
-	int client = tcp_accept(fd);
+	int client = tcp_accept(fd, &ctx->addr);
 	if (client >= 0) {
+		ctx->last_active = tcp->last_poll_time.tv_sec;
+
+		/* TLS listeners carry the server credentials. */
+		tls_ctx_t *tls = tcp->set.ctx[i];
+		if (tls != NULL) {
+			ctx->tls = tls_conn_new(tls, client);
+			if (ctx->tls == NULL) {
+				close(client);
+				free(ctx);
+				return KNOT_ENOMEM;
+			}
+		}
+
+		/* Make room for the client if over a limit. */
+		rcu_read_lock();
+		unsigned max_clients = tcp_max_clients();
+		unsigned max_prefix = tcp_max_prefix_clients();
+		rcu_read_unlock();
+		int victim = tcp_client_victim(tcp, &ctx->addr, max_clients, max_prefix);
+		if (victim >= 0) {
+			tcp_client_close(tcp, victim);
+		}
+
 		/* Assign to fdset. */
-		int next_id = fdset_add(&tcp->set, client, POLLIN, NULL);
+		int next_id = fdset_add(&tcp->set, client, POLLIN, ctx);
 		if (next_id < 0) {
 			close(client);
+			tcp_client_free(ctx);
 			return next_id; /* Contains errno. */
 		}
 
@@ -212,21 +362,66 @@ static int tcp_event_accept(tcp_context_t *tcp, unsigned i)
 		return KNOT_EOK;
 	}
 
+	free(ctx);
 	return client;
 }
 
+/*!
+ * \brief Complete the TLS handshake of a DNS-over-TLS client.
+ *
+ * \param client       Client state.
+ * \param query_ready  Set if a query has already been received.
+ */
+static int tcp_tls_handshake(tcp_client_t *client, bool *query_ready)
+{
+	rcu_read_lock();
+	int timeout = 1000 * conf()->cache.srv_tcp_hshake_timeout;
+	rcu_read_unlock();
+
+	int ret = tls_conn_handshake(client->tls, timeout);
+	if (ret != KNOT_EOK) {
+		char addr_str[SOCKADDR_STRLEN] = {0};
+		sockaddr_tostr(addr_str, sizeof(addr_str), (struct sockaddr *)&client->addr);
+		log_debug("TLS, handshake failed, address '%s' (%s)", addr_str,
+		          knot_strerror(ret));
+		return ret;
+	}
+
+	client->tls_ready = true;
+
+	/* The first query may have arrived with the handshake. */
+	*query_ready = tls_conn_pending(client->tls);
+
+	return KNOT_EOK;
+}
+
 static int tcp_event_serve(tcp_context_t *tcp, unsigned i)
 {
 	int fd = tcp->set.pfd[i].fd;
-	int ret = tcp_handle(tcp, fd, &tcp->iov[0], &tcp->iov[1]);
+	tcp_client_t *client = tcp->set.ctx[i];
 
-	/* Flush per-query memory. */
-	mp_flush(tcp->layer.mm->ctx);
+	int ret = KNOT_EOK;
+	bool query_ready = true;
+	if (client->tls != NULL && !client->tls_ready) {
+		ret = tcp_tls_handshake(client, &query_ready);
+	}
+
+	/* Queries buffered by the TLS layer don't wake up poll(). */
+	while (ret == KNOT_EOK && query_ready) {
+		ret = tcp_handle(tcp, fd, client->tls, &tcp->iov[0], &tcp->iov[1]);
+
+		/* Flush per-query memory. */
+		mp_flush(tcp->layer.mm->ctx);
+
+		query_ready = (client->tls != NULL && tls_conn_pending(client->tls));
+	}
 
 	if (ret == KNOT_EOK) {
+		client->last_active = tcp->last_poll_time.tv_sec;
+
 		/* Update socket activity timer. */
 		rcu_read_lock();
-		int timeout = conf()->cache.srv_tcp_idle_timeout;
+		int timeout = tcp_idle_timeout(tcp);
 		fdset_set_watchdog(&tcp->set, i, timeout);
 		rcu_read_unlock();
 	}
@@ -234,7 +429,7 @@ static int tcp_event_serve(tcp_context_t *tcp, unsigned i)
 	return ret;
 }
 
-static int tcp_wait_for_events(tcp_context_t *tcp)
+static int tcp_wait_for_events(tcp_context_t *tcp, scaling_stats_t *stats)
 {
 	/* Wait for events. */
 	fdset_t *set = &tcp->set;
@@ -243,21 +438,15 @@ static int tcp_wait_for_events(tcp_context_t *tcp)
 	/* Mark the time of last poll call. */
 	time_now(&tcp->last_poll_time);
 	bool is_throttled = (tcp->last_poll_time.tv_sec < tcp->throttle_end.tv_sec);
-	if (!is_throttled) {
-		/* Configuration limit, infer maximal pool size. */
-		rcu_read_lock();
-		int clients = conf()->cache.srv_max_tcp_clients;
-		unsigned max_per_set = MAX(clients / conf_tcp_threads(conf()), 1);
-		rcu_read_unlock();
-		/* Subtract master sockets check limits. */
-		is_throttled = (set->n - tcp->client_threshold) >= max_per_set;
-	}
+
+	/* Several ready sockets mean queued work. */
+	uint64_t begin = scaling_now();
+	bool woken = (nfds > 0), backlog = (nfds > 1);
 
 	/* Process events. */
 	unsigned i = 0;
 	while (nfds > 0 && i < set->n) {
 		bool should_close = false;
-		int fd = set->pfd[i].fd;
 		if (set->pfd[i].revents & (POLLERR|POLLHUP|POLLNVAL)) {
 			should_close = (i >= tcp->client_threshold);
 			--nfds;
@@ -279,16 +468,27 @@ static int tcp_wait_for_events(tcp_context_t *tcp)
 
 		/* Evaluate */
 		if (should_close) {
-			fdset_remove(set, i);
-			close(fd);
+			tcp_client_close(tcp, i);
 		} else {
 			++i;
 		}
 	}
 
+	if (woken) {
+		scaling_account(stats, begin, backlog);
+	}
+
 	return nfds;
 }
 
+/*! \brief Stop or resume accepting new clients. */
+static void tcp_set_accepting(tcp_context_t *tcp, bool accepting)
+{
+	for (unsigned i = 0; i < tcp->client_threshold; ++i) {
+		tcp->set.pfd[i].events = accepting ? POLLIN : 0;
+	}
+}
+
 int tcp_master(dthread_t *thread)
 {
 	if (!thread || !thread->data) {
@@ -296,7 +496,7 @@ int tcp_master(dthread_t *thread)
 	}
 
 	iohandler_t *handler = (iohandler_t *)thread->data;
-	unsigned *iostate = &handler->thread_state[dt_get_id(thread)];
+	iothread_t *io = server_iothread(handler, thread);
 
 	int ret = KNOT_EOK;
 	ref_t *ref = NULL;
@@ -309,7 +509,7 @@ int tcp_master(dthread_t *thread)
 
 	/* Create TCP answering context. */
 	tcp.server = handler->server;
-	tcp.thread_id = handler->thread_id[dt_get_id(thread)];
+	tcp.thread_id = io->id;
 	knot_layer_init(&tcp.layer, &mm, process_query_layer());
 
 	/* Prepare structures for bound sockets. */
@@ -331,15 +531,18 @@ int tcp_master(dthread_t *thread)
 	time_now(&next_sweep);
 	next_sweep.tv_sec += TCP_SWEEP_INTERVAL;
 
+	bool accepting = true;
 	for(;;) {
 
 		/* Check handler state. */
-		if (unlikely(*iostate & ServerReload)) {
-			*iostate &= ~ServerReload;
+		if (unlikely(ref == NULL || (io->state & ServerReload))) {
+			__sync_and_and_fetch(&io->state, ~ServerReload);
+			tcp.thread_id = io->id;
 
 			/* Cancel client connections. */
 			for (unsigned i = tcp.client_threshold; i < tcp.set.n; ++i) {
 				close(tcp.set.pfd[i].fd);
+				tcp_client_free(tcp.set.ctx[i]);
 			}
 
 			ref_release(ref);
@@ -349,6 +552,7 @@ int tcp_master(dthread_t *thread)
 			}
 
 			tcp.client_threshold = tcp.set.n;
+			accepting = true;
 		}
 
 		/* Check for cancellation. */
@@ -356,8 +560,18 @@ int tcp_master(dthread_t *thread)
 			break;
 		}
 
+		/* Parked threads serve the connected clients until they leave. */
+		bool parked = dt_is_parked(thread);
+		if (unlikely(parked == accepting)) {
+			accepting = !parked;
+			tcp_set_accepting(&tcp, accepting);
+		}
+		if (unlikely(parked && tcp.set.n == tcp.client_threshold)) {
+			break;
+		}
+
 		/* Serve client requests. */
-		tcp_wait_for_events(&tcp);
+		tcp_wait_for_events(&tcp, &io->stats);
 
 		/* Sweep inactive clients. */
 		if (tcp.last_poll_time.tv_sec >= next_sweep.tv_sec) {
@@ -368,6 +582,9 @@ int tcp_master(dthread_t *thread)
 	}
 
 finish:
+	for (unsigned i = tcp.client_threshold; i < tcp.set.n; ++i) {
+		tcp_client_free(tcp.set.ctx[i]);
+	}
 	free(tcp.iov[0].iov_base);
 	free(tcp.iov[1].iov_base);
 	mp_delete(mm.ctx);
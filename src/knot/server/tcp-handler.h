@@ -38,11 +38,12 @@
 /*!
  * \brief Accept a TCP connection.
  * \param fd Associated socket.
+ * \param addr Remote address (can be NULL).
  *
  * \retval Created connection fd if success.
  * \retval <0 on error.
  */
-int tcp_accept(int fd);
+int tcp_accept(int fd, struct sockaddr_storage *addr);
 
 /*!
  * \brief TCP handler thread runnable.
@@ -0,0 +1,274 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <gnutls/gnutls.h>
+#include <poll.h>
+#include <stdlib.h>
+
+#include "knot/server/tls.h"
+#include "libknot/errcode.h"
+#include "contrib/net.h"
+
+#if GNUTLS_VERSION_NUMBER >= 0x030703
+#include <gnutls/socket.h>
+#define HAVE_GNUTLS_KTLS
+#endif
+
+/*! \brief Protocols allowed for DNS-over-TLS (RFC 8310). */
+#define TLS_PRIORITY "NORMAL:-VERS-ALL:+VERS-TLS1.3:+VERS-TLS1.2"
+
+struct tls_ctx {
+	gnutls_certificate_credentials_t credentials;
+	gnutls_priority_t priority;
+};
+
+struct tls_conn {
+	gnutls_session_t session;
+	int fd;
+	bool ktls;
+};
+
+int tls_ctx_new(tls_ctx_t **ctx, const char *cert_file, const char *key_file)
+{
+	if (ctx == NULL || cert_file == NULL || key_file == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	tls_ctx_t *new_ctx = calloc(1, sizeof(*new_ctx));
+	if (new_ctx == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	int ret = gnutls_certificate_allocate_credentials(&new_ctx->credentials);
+	if (ret != GNUTLS_E_SUCCESS) {
+		free(new_ctx);
+		return KNOT_ENOMEM;
+	}
+
+	ret = gnutls_certificate_set_x509_key_file(new_ctx->credentials, cert_file,
+	                                           key_file, GNUTLS_X509_FMT_PEM);
+	if (ret == GNUTLS_E_SUCCESS) {
+		ret = gnutls_priority_init(&new_ctx->priority, TLS_PRIORITY, NULL);
+	}
+	if (ret != GNUTLS_E_SUCCESS) {
+		tls_ctx_free(new_ctx);
+		return (ret == GNUTLS_E_FILE_ERROR) ? KNOT_EFILE : KNOT_EMALF;
+	}
+
+	*ctx = new_ctx;
+
+	return KNOT_EOK;
+}
+
+void tls_ctx_free(tls_ctx_t *ctx)
+{
+	if (ctx == NULL) {
+		return;
+	}
+
+	if (ctx->priority != NULL) {
+		gnutls_priority_deinit(ctx->priority);
+	}
+	gnutls_certificate_free_credentials(ctx->credentials);
+	free(ctx);
+}
+
+tls_conn_t *tls_conn_new(tls_ctx_t *ctx, int fd)
+{
+	if (ctx == NULL || fd < 0) {
+		return NULL;
+	}
+
+	tls_conn_t *conn = calloc(1, sizeof(*conn));
+	if (conn == NULL) {
+		return NULL;
+	}
+
+	if (gnutls_init(&conn->session, GNUTLS_SERVER | GNUTLS_NONBLOCK) != GNUTLS_E_SUCCESS) {
+		free(conn);
+		return NULL;
+	}
+
+	if (gnutls_priority_set(conn->session, ctx->priority) != GNUTLS_E_SUCCESS ||
+	    gnutls_credentials_set(conn->session, GNUTLS_CRD_CERTIFICATE,
+	                           ctx->credentials) != GNUTLS_E_SUCCESS) {
+		tls_conn_free(conn);
+		return NULL;
+	}
+
+	gnutls_certificate_server_set_request(conn->session, GNUTLS_CERT_IGNORE);
+	gnutls_transport_set_int(conn->session, fd);
+	conn->fd = fd;
+
+	return conn;
+}
+
+void tls_conn_free(tls_conn_t *conn)
+{
+	if (conn == NULL) {
+		return;
+	}
+
+	gnutls_deinit(conn->session);
+	free(conn);
+}
+
+/*! \brief Waits until the interrupted GnuTLS operation can continue. */
+static int tls_wait(tls_conn_t *conn, int timeout_ms)
+{
+	struct pollfd pfd = {
+		.fd = conn->fd,
+		.events = gnutls_record_get_direction(conn->session) ? POLLOUT : POLLIN
+	};
+
+	int ret;
+	do {
+		ret = poll(&pfd, 1, timeout_ms);
+	} while (ret == -1 && errno == EINTR);
+
+	if (ret == 0) {
+		return KNOT_ETIMEOUT;
+	} else if (ret < 0 || (pfd.revents & (POLLERR | POLLNVAL))) {
+		return KNOT_ECONN;
+	}
+
+	return KNOT_EOK;
+}
+
+int tls_conn_handshake(tls_conn_t *conn, int timeout_ms)
+{
+	if (conn == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	int ret;
+	while ((ret = gnutls_handshake(conn->session)) != GNUTLS_E_SUCCESS) {
+		if (gnutls_error_is_fatal(ret) != 0) {
+			return KNOT_NET_ECONNECT;
+		}
+		if (ret == GNUTLS_E_AGAIN) {
+			int wait_ret = tls_wait(conn, timeout_ms);
+			if (wait_ret != KNOT_EOK) {
+				return wait_ret;
+			}
+		}
+	}
+
+#ifdef HAVE_GNUTLS_KTLS
+	conn->ktls = (gnutls_transport_is_ktls_enabled(conn->session) == GNUTLS_KTLS_DUPLEX);
+#endif
+
+	return KNOT_EOK;
+}
+
+bool tls_conn_ktls(const tls_conn_t *conn)
+{
+	return conn != NULL && conn->ktls;
+}
+
+bool tls_conn_pending(tls_conn_t *conn)
+{
+	return conn != NULL && gnutls_record_check_pending(conn->session) > 0;
+}
+
+/*! \brief Receives exactly \a size bytes through the GnuTLS record layer. */
+static int tls_recv_all(tls_conn_t *conn, uint8_t *buffer, size_t size, int timeout_ms)
+{
+	size_t done = 0;
+	while (done < size) {
+		ssize_t ret = gnutls_record_recv(conn->session, buffer + done, size - done);
+		if (ret > 0) {
+			done += ret;
+		} else if (ret == 0) {
+			return KNOT_ECONN;
+		} else if (ret == GNUTLS_E_AGAIN) {
+			int wait_ret = tls_wait(conn, timeout_ms);
+			if (wait_ret != KNOT_EOK) {
+				return wait_ret;
+			}
+		} else if (gnutls_error_is_fatal(ret) != 0) {
+			return KNOT_NET_ERECV;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+ssize_t tls_dns_recv(tls_conn_t *conn, uint8_t *buffer, size_t size, int timeout_ms)
+{
+	if (conn == NULL || buffer == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	/* Data decrypted before the kTLS switch must be drained first. */
+	if (conn->ktls && gnutls_record_check_pending(conn->session) == 0) {
+		return net_dns_tcp_recv(conn->fd, buffer, size, timeout_ms);
+	}
+
+	uint16_t pktsize = 0;
+	int ret = tls_recv_all(conn, (uint8_t *)&pktsize, sizeof(pktsize), timeout_ms);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	pktsize = ntohs(pktsize);
+	if (size < pktsize) {
+		return KNOT_ESPACE;
+	}
+
+	ret = tls_recv_all(conn, buffer, pktsize, timeout_ms);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	return pktsize;
+}
+
+ssize_t tls_dns_send(tls_conn_t *conn, const uint8_t *buffer, size_t size,
+                     int timeout_ms)
+{
+	if (conn == NULL || buffer == NULL || size > UINT16_MAX) {
+		return KNOT_EINVAL;
+	}
+
+	if (conn->ktls) {
+		return net_dns_tcp_send(conn->fd, buffer, size, timeout_ms);
+	}
+
+	/* Corked, the size prefix and the message form a single record. */
+	uint16_t pktsize = htons(size);
+	gnutls_record_cork(conn->session);
+	if (gnutls_record_send(conn->session, &pktsize, sizeof(pktsize)) < 0 ||
+	    gnutls_record_send(conn->session, buffer, size) < 0) {
+		return KNOT_NET_ESEND;
+	}
+
+	while (gnutls_record_check_corked(conn->session) > 0) {
+		int ret = gnutls_record_uncork(conn->session, 0);
+		if (ret == GNUTLS_E_AGAIN) {
+			int wait_ret = tls_wait(conn, timeout_ms);
+			if (wait_ret != KNOT_EOK) {
+				return wait_ret;
+			}
+		} else if (ret < 0 && gnutls_error_is_fatal(ret) != 0) {
+			return KNOT_NET_ESEND;
+		}
+	}
+
+	return size;
+}
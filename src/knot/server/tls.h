@@ -0,0 +1,116 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*!
+ * \file
+ *
+ * \brief DNS-over-TLS (RFC 7858) server connections.
+ *
+ * The TLS handshake is performed by GnuTLS. If GnuTLS hands the record
+ * encryption over to the kernel (kTLS), the messages are exchanged with
+ * plain net_dns_tcp_recv() and net_dns_tcp_send() on the connection socket,
+ * otherwise the GnuTLS record layer is used.
+ *
+ * \addtogroup server
+ * @{
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*! \brief Default DNS-over-TLS port. */
+#define TLS_DEFAULT_PORT 853
+
+/*! \brief Server credentials shared by all connections. */
+typedef struct tls_ctx tls_ctx_t;
+
+/*! \brief Server side of a TLS connection. */
+typedef struct tls_conn tls_conn_t;
+
+/*!
+ * \brief Loads the server certificate and the private key.
+ *
+ * \param ctx        Output context.
+ * \param cert_file  PEM certificate (chain) file.
+ * \param key_file   PEM private key file.
+ *
+ * \return KNOT_E*
+ */
+int tls_ctx_new(tls_ctx_t **ctx, const char *cert_file, const char *key_file);
+
+/*!
+ * \brief Frees the server credentials.
+ *
+ * \note All connections using the context must be freed first.
+ */
+void tls_ctx_free(tls_ctx_t *ctx);
+
+/*!
+ * \brief Creates a server connection on an accepted non-blocking socket.
+ *
+ * \note The socket is not closed by \ref tls_conn_free.
+ *
+ * \return Connection or NULL.
+ */
+tls_conn_t *tls_conn_new(tls_ctx_t *ctx, int fd);
+
+/*!
+ * \brief Frees the connection.
+ */
+void tls_conn_free(tls_conn_t *conn);
+
+/*!
+ * \brief Performs the TLS handshake.
+ *
+ * \param conn        Connection.
+ * \param timeout_ms  Timeout for each wait for the peer.
+ *
+ * \retval KNOT_EOK if the connection is established.
+ * \retval KNOT_ETIMEOUT if the peer is too slow.
+ * \return KNOT_E* on handshake failure.
+ */
+int tls_conn_handshake(tls_conn_t *conn, int timeout_ms);
+
+/*!
+ * \brief Checks if the established connection is handled by kernel TLS.
+ */
+bool tls_conn_ktls(const tls_conn_t *conn);
+
+/*!
+ * \brief Checks if received data is buffered in the TLS layer.
+ *
+ * Such data doesn't make the socket readable.
+ */
+bool tls_conn_pending(tls_conn_t *conn);
+
+/*!
+ * \brief Receives one DNS message, see \ref net_dns_tcp_recv.
+ *
+ * \return Message size or KNOT_E*.
+ */
+ssize_t tls_dns_recv(tls_conn_t *conn, uint8_t *buffer, size_t size, int timeout_ms);
+
+/*!
+ * \brief Sends one DNS message, see \ref net_dns_tcp_send.
+ *
+ * \return Message size or KNOT_E*.
+ */
+ssize_t tls_dns_send(tls_conn_t *conn, const uint8_t *buffer, size_t size,
+                     int timeout_ms);
+
+/*! @} */
@@ -23,6 +23,7 @@
 #include <arpa/inet.h>
 #include <string.h>
 #include <assert.h>
+#include <poll.h>
 #include <sys/param.h>
 #include <urcu.h>
 #ifdef HAVE_SYS_UIO_H /* 'struct iovec' for OpenBSD */
@@ -35,9 +36,12 @@
 #include "contrib/macros.h"
 #include "contrib/mempattern.h"
 #include "contrib/sockaddr.h"
+#include "contrib/time.h"
 #include "contrib/ucw/mempool.h"
+#include "knot/common/probe.h"
 #include "knot/nameserver/process_query.h"
 #include "knot/query/layer.h"
+#include "knot/server/answer-cache.h"
 #include "knot/server/server.h"
 #include "knot/server/udp-handler.h"
 
@@ -48,19 +52,467 @@ enum {
 	NBUFS = 2
 };
 
+/*! \brief Maximum number of suspended queries per thread. */
+#define UDP_PARKED_MAX 256
+
+/*! \brief Control message to fit IP_PKTINFO or IPv6_RECVPKTINFO and SO_RXQ_OVFL. */
+typedef union {
+	struct cmsghdr cmsg;
+	uint8_t buf[CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(uint32_t))];
+} cmsg_pktinfo_t;
+
 /*! \brief UDP context data. */
 typedef struct {
 	knot_layer_t layer; /*!< Query processing layer. */
 	server_t *server;   /*!< Name server structure. */
 	unsigned thread_id; /*!< Thread identifier. */
+	list_t parked;      /*!< Suspended queries. */
+	unsigned parked_count;    /*!< Number of suspended queries. */
+	uint32_t rxq_drops; /*!< Last received kernel drop counter. */
+	bool rxq_valid;     /*!< Drop counter received. */
+	answer_cache_t *cache;     /*!< Encoded answers, NULL if disabled. */
+	const conf_t *cache_conf;  /*!< Configuration of the cached answers. */
 } udp_context_t;
 
-static void udp_handle(udp_context_t *udp, int fd, struct sockaddr_storage *ss,
+/*! \brief Suspended query waiting for an event, see \ref process_query_yield. */
+typedef struct {
+	node_t n;
+	knot_layer_t layer;       /*!< Query processing layer, owns the memory context. */
+	knot_pkt_t *query;        /*!< Query packet. */
+	knot_pkt_t *ans;          /*!< Answer packet. */
+	struct process_query_param param;
+	int fd;                   /*!< Socket to answer on. */
+	struct sockaddr_storage addr;
+	socklen_t addrlen;
+	cmsg_pktinfo_t pktinfo;
+	size_t pktinfo_len;
+	void *buf[NBUFS];         /*!< Query and answer buffers. */
+	uint64_t deadline;        /*!< Resume time limit in milliseconds. */
+} udp_parked_t;
+
+static void udp_pktinfo_handle(const struct msghdr *rx, struct msghdr *tx);
+
+/*! \brief Monotonic time in milliseconds. */
+static uint64_t udp_time_ms(void)
+{
+	timev_t now;
+	time_now(&now);
+#ifdef HAVE_CLOCK_GETTIME
+	return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+#else
+	return (uint64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
+#endif
+}
+
+/*! \brief Create a memory context for query processing. */
+static knot_mm_t *udp_mm_new(void)
+{
+	knot_mm_t *mm = malloc(sizeof(*mm));
+	if (mm != NULL) {
+		mm_ctx_mempool(mm, 16 * MM_DEFAULT_BLKSIZE);
+	}
+
+	return mm;
+}
+
+static void udp_mm_free(knot_mm_t *mm)
+{
+	mp_delete(mm->ctx);
+	free(mm);
+}
+
+/*! \brief Check if a query may be suspended. */
+static bool udp_can_park(udp_context_t *udp)
+{
+	return udp->parked_count < UDP_PARKED_MAX;
+}
+
+/*! \brief Resume a suspended query with given events. */
+static int udp_resume(knot_layer_t *layer, knot_pkt_t *ans, short revents)
+{
+	struct query_data *qdata = layer->data;
+	qdata->yield.revents = revents;
+
+	int state = knot_layer_produce(layer, ans);
+	while (state & (KNOT_STATE_PRODUCE|KNOT_STATE_FAIL)) {
+		state = knot_layer_produce(layer, ans);
+	}
+
+	return state;
+}
+
+/*!
+ * \brief Move a suspended query from the handler buffers to a parked context.
+ *
+ * The query buffers and the memory context are handed over to the parked
+ * context and the handler gets new ones.
+ */
+static int udp_park(udp_context_t *udp, int fd, const struct msghdr *msg,
+                    struct iovec *rx, struct iovec *tx,
+                    knot_pkt_t *query, knot_pkt_t *ans)
+{
+	udp_parked_t *p = malloc(sizeof(*p));
+	knot_mm_t *mm = udp_mm_new();
+	void *rx_buf = malloc(KNOT_WIRE_MAX_PKTSIZE);
+	void *tx_buf = malloc(KNOT_WIRE_MAX_PKTSIZE);
+	if (p == NULL || mm == NULL || rx_buf == NULL || tx_buf == NULL) {
+		free(p);
+		if (mm != NULL) {
+			udp_mm_free(mm);
+		}
+		free(rx_buf);
+		free(tx_buf);
+		return KNOT_ENOMEM;
+	}
+	memset(p, 0, sizeof(*p));
+
+	/* Take over the processing context. */
+	struct query_data *qdata = udp->layer.data;
+	p->layer = udp->layer;
+	p->query = query;
+	p->ans = ans;
+	p->param = *qdata->param;
+	p->param.remote = &p->addr;
+	p->param.proc_flags &= ~NS_QUERY_ZONE_FOUND;
+	p->param.zone = NULL;
+	qdata->param = &p->param;
+	udp->layer.mm = mm;
+	udp->layer.data = NULL;
+
+	/* Take over the buffers. */
+	p->buf[RX] = rx->iov_base;
+	p->buf[TX] = tx->iov_base;
+	rx->iov_base = rx_buf;
+	tx->iov_base = tx_buf;
+
+	/* Remember where to answer. */
+	p->fd = fd;
+	p->addrlen = msg->msg_namelen;
+	memcpy(&p->addr, msg->msg_name, MIN(p->addrlen, sizeof(p->addr)));
+	p->pktinfo_len = MIN(msg->msg_controllen, sizeof(p->pktinfo));
+	if (p->pktinfo_len > 0) {
+		memcpy(&p->pktinfo, msg->msg_control, p->pktinfo_len);
+	}
+	p->deadline = udp_time_ms() + qdata->yield.timeout;
+
+	udp->parked_count += 1;
+	add_tail(&udp->parked, &p->n);
+
+	return KNOT_EOK;
+}
+
+/*! \brief Finish a parked query, send the answer if requested. */
+static void udp_unpark(udp_context_t *udp, udp_parked_t *p, int state, bool send)
+{
+	if (send && state == KNOT_STATE_DONE && p->ans->size > 0) {
+		struct iovec iov = {
+			.iov_base = p->ans->wire,
+			.iov_len = p->ans->size
+		};
+		struct msghdr rx = {
+			.msg_control = &p->pktinfo,
+			.msg_controllen = p->pktinfo_len
+		};
+		struct msghdr tx = {
+			.msg_name = &p->addr,
+			.msg_namelen = p->addrlen,
+			.msg_iov = &iov,
+			.msg_iovlen = 1
+		};
+		udp_pktinfo_handle(&rx, &tx);
+		(void)sendmsg(p->fd, &tx, 0);
+	}
+
+	knot_layer_finish(&p->layer);
+	knot_pkt_free(&p->query);
+	knot_pkt_free(&p->ans);
+	udp_mm_free(p->layer.mm);
+	free(p->buf[RX]);
+	free(p->buf[TX]);
+
+	rem_node(&p->n);
+	free(p);
+	udp->parked_count -= 1;
+}
+
+/*! \brief Resume parked queries with received events or elapsed timeouts. */
+static void udp_parked_handle(udp_context_t *udp, struct pollfd *fds, unsigned count)
+{
+	uint64_t now = udp_time_ms();
+
+	udp_parked_t *p = NULL, *nxt = NULL;
+	unsigned i = 0;
+	WALK_LIST_DELSAFE(p, nxt, udp->parked) {
+		if (i >= count) {
+			break;
+		}
+		short revents = fds[i++].revents;
+		if (revents == 0 && now < p->deadline) {
+			continue;
+		}
+
+		int state = udp_resume(&p->layer, p->ans, revents);
+		if (state == KNOT_STATE_YIELD) {
+			struct query_data *qdata = p->layer.data;
+			p->deadline = now + qdata->yield.timeout;
+			continue;
+		}
+
+		udp_unpark(udp, p, state, true);
+	}
+}
+
+/*! \brief Abandon all parked queries. */
+static void udp_parked_clear(udp_context_t *udp)
+{
+	udp_parked_t *p = NULL, *nxt = NULL;
+	WALK_LIST_DELSAFE(p, nxt, udp->parked) {
+		int state = KNOT_STATE_YIELD;
+		while (state == KNOT_STATE_YIELD) {
+			state = udp_resume(&p->layer, p->ans, POLLNVAL);
+		}
+		udp_unpark(udp, p, state, false);
+	}
+}
+
+/*!
+ * \brief Fill the poll set with parked query descriptors.
+ *
+ * \return Poll timeout for the nearest parked query deadline.
+ */
+static int udp_parked_track(udp_context_t *udp, struct pollfd *fds, unsigned *count)
+{
+	uint64_t now = udp_time_ms();
+	int timeout = -1;
+
+	udp_parked_t *p = NULL;
+	unsigned i = 0;
+	WALK_LIST(p, udp->parked) {
+		struct query_data *qdata = p->layer.data;
+		fds[i].fd = qdata->yield.fd;
+		fds[i].events = qdata->yield.events;
+		fds[i].revents = 0;
+		i += 1;
+
+		int left = (p->deadline > now) ? p->deadline - now : 0;
+		if (timeout < 0 || left < timeout) {
+			timeout = left;
+		}
+	}
+
+	*count = i;
+	return timeout;
+}
+
+/*! \brief Find the zone answering a cacheable query, as in the query processing. */
+static const zone_t *udp_cache_zone(udp_context_t *udp, const answer_cache_query_t *q)
+{
+	knot_zonedb_t *zonedb = udp->server->zone_db;
+	const zone_t *zone = NULL;
+	if (q->qtype == KNOT_RRTYPE_DS) {
+		const knot_dname_t *parent = knot_wire_next_label(q->qname, NULL);
+		zone = knot_zonedb_find_suffix(zonedb, parent);
+	}
+	if (zone == NULL) {
+		zone = knot_zonedb_find_suffix(zonedb, q->qname);
+	}
+
+	return zone;
+}
+
+/*!
+ * \brief Get the contents generation of the zone if its answers may be cached.
+ *
+ * Answers of zones with query modules (e.g. dnstap, rosedb or online signing)
+ * and of aliased zones depend on more than the zone contents. The zone ACL
+ * is consulted only for TSIG-signed queries, which are never cached.
+ *
+ * \note Must be called under the read lock.
+ *
+ * \return Generation or 0 if the answer can't be cached.
+ */
+static uint64_t udp_cache_generation(udp_context_t *udp, const zone_t *zone)
+{
+	if (zone == NULL || zone->contents == NULL || zone->alias_of != NULL ||
+	    zone->query_plan != NULL || conf()->query_plan != NULL ||
+	    udp->cache_conf != conf()) {
+		return 0;
+	}
+
+	return zone->contents->generation;
+}
+
+/*!
+ * \brief Check if the query may be answered from the cache.
+ *
+ * \note Must be called under the read lock.
+ *
+ * \param[in]  udp          UDP context.
+ * \param[in]  msg          Received message.
+ * \param[in]  rx           Query buffer.
+ * \param[out] q            Parsed query.
+ * \param[out] opt_payload  Server EDNS payload for the answer.
+ */
+static bool udp_cache_query(udp_context_t *udp, const struct msghdr *msg,
+                            const struct iovec *rx, answer_cache_query_t *q,
+                            uint16_t *opt_payload)
+{
+	/* Drop the cached answers under memory pressure, until it ceases. */
+	if (mempressure_active(&udp->server->mempressure)) {
+		answer_cache_free(udp->cache);
+		udp->cache = NULL;
+		udp->cache_conf = NULL;
+		return false;
+	}
+
+	/* Drop the cached answers after a configuration change. */
+	if (udp->cache_conf != conf()) {
+		udp->cache_conf = conf();
+		answer_cache_free(udp->cache);
+		udp->cache = answer_cache_new(conf()->cache.srv_udp_answer_cache);
+	}
+
+	/* Same answer size limit as in the query processing. */
+	const struct sockaddr_storage *remote = msg->msg_name;
+	switch (remote->ss_family) {
+	case AF_INET:
+		*opt_payload = conf()->cache.srv_max_ipv4_udp_payload;
+		break;
+	case AF_INET6:
+		*opt_payload = conf()->cache.srv_max_ipv6_udp_payload;
+		break;
+	default:
+		*opt_payload = 0;
+		break;
+	}
+
+	if (udp->cache == NULL || *opt_payload == 0) {
+		return false;
+	}
+
+	if (answer_cache_parse(q, rx->iov_base, rx->iov_len) != KNOT_EOK) {
+		return false;
+	}
+	if (q->edns) {
+		q->limit = MAX(KNOT_WIRE_MIN_PKTSIZE, MIN(q->payload, *opt_payload));
+	}
+
+	return true;
+}
+
+/*!
+ * \brief Apply the rate limit to a cached answer, as in the query processing.
+ *
+ * \return Answer size, 0 if dropped.
+ */
+static size_t udp_cache_ratelimit(udp_context_t *udp, const struct msghdr *msg,
+                                  const answer_cache_query_t *q, const zone_t *zone,
+                                  struct iovec *rx, uint8_t *ans, size_t size,
+                                  uint16_t opt_payload)
+{
+	server_t *server = udp->server;
+
+	/* Exempt clients. */
+	conf_val_t *whitelist = &conf()->cache.srv_rate_limit_whitelist;
+	if (conf_addr_range_match(whitelist, msg->msg_name)) {
+		return size;
+	}
+
+	/* The question is classified in lowercase, the answer has the original. */
+	memcpy((uint8_t *)rx->iov_base + KNOT_WIRE_HEADER_SIZE, q->qname, q->qname_size);
+	knot_pkt_t query = {
+		.wire = rx->iov_base,
+		.size = rx->iov_len,
+		.qname_size = q->qname_size
+	};
+
+	rrl_req_t rrl_rq = {0};
+	rrl_rq.w = ans;
+	rrl_rq.query = &query;
+	if (rrl_query(server->rrl, msg->msg_name, &rrl_rq, zone) == KNOT_EOK) {
+		return size;
+	}
+
+	/* Now it is slip or drop, drop is cheaper if overloaded. */
+	int slip = conf()->cache.srv_rate_limit_slip;
+	if (overload_active(&server->overload)) {
+		slip = 0;
+	}
+	if (slip > 0 && rrl_slip_roll(slip)) {
+		return answer_cache_slip(q, opt_payload, ans);
+	}
+
+	return 0;
+}
+
+/*!
+ * \brief Answer the query from the cache.
+ *
+ * The answer is traced, rate limited and charged to the zone as in the query
+ * processing. The admission control is skipped, cacheable queries are cheap.
+ *
+ * \note Must be called under the read lock.
+ */
+static bool udp_cache_answer(udp_context_t *udp, const struct msghdr *msg,
+                             const answer_cache_query_t *q, const zone_t *zone,
+                             uint64_t generation, uint16_t opt_payload,
+                             struct iovec *rx, struct iovec *tx)
+{
+	uint64_t cpu_begin = zone_cputime_query_begin();
+
+	size_t size = answer_cache_answer(udp->cache, q, generation, opt_payload,
+	                                  tx->iov_base, tx->iov_len);
+	if (size == 0) {
+		return false;
+	}
+
+	KNOT_PROBE3(query__receive, q, KNOT_QUERY_NORMAL, rx->iov_len);
+
+	/* Sample the name for the warm-up, the query processing is bypassed. */
+	if (zone->flags & ZONE_WARM_UP) {
+		zone_hot_record(zone->hot, q->qname);
+	}
+
+	if (unlikely(udp->server->rrl != NULL) && udp->server->rrl->rate > 0) {
+		size = udp_cache_ratelimit(udp, msg, q, zone, rx, tx->iov_base,
+		                           size, opt_payload);
+	}
+
+	zone_cputime_query_end(zone->cputime, cpu_begin);
+
+	KNOT_PROBE4(query__answer, q, KNOT_STATE_DONE,
+	            knot_wire_get_rcode(tx->iov_base), size);
+
+	tx->iov_len = size;
+	return true;
+}
+
+static void udp_handle(udp_context_t *udp, int fd, const struct msghdr *msg,
                        struct iovec *rx, struct iovec *tx)
 {
+	/* The zone found for the cache is used by the query processing too. */
+	rcu_read_lock();
+
+	/* Answer from the cache, bypassing the query processing. */
+	answer_cache_query_t cached;
+	uint16_t opt_payload = 0;
+	const zone_t *zone = NULL;
+	uint64_t generation = 0;
+	bool cacheable = udp_cache_query(udp, msg, rx, &cached, &opt_payload);
+	if (cacheable) {
+		zone = udp_cache_zone(udp, &cached);
+		generation = udp_cache_generation(udp, zone);
+		if (generation != 0 &&
+		    udp_cache_answer(udp, msg, &cached, zone, generation,
+		                     opt_payload, rx, tx)) {
+			rcu_read_unlock();
+			return;
+		}
+	}
+
 	/* Create query processing parameter. */
 	struct process_query_param param = {0};
-	param.remote = ss;
+	param.remote = msg->msg_name;
 	param.proc_flags  = NS_QUERY_NO_AXFR|NS_QUERY_NO_IXFR; /* No transfers. */
 	param.proc_flags |= NS_QUERY_LIMIT_SIZE; /* Enforce UDP packet size limit. */
 	param.proc_flags |= NS_QUERY_LIMIT_ANY;  /* Limit ANY over UDP (depends on zone as well). */
@@ -68,11 +520,27 @@ static void udp_handle(udp_context_t *udp, int fd, struct sockaddr_storage *ss,
 	param.server = udp->server;
 	param.thread_id = udp->thread_id;
 
+	/* Zone already looked up, the read lock is held until answered. */
+	if (cacheable) {
+		param.proc_flags |= NS_QUERY_ZONE_FOUND;
+		param.zone = zone;
+	}
+
 	/* Rate limit is applied? */
 	if (unlikely(udp->server->rrl != NULL) && udp->server->rrl->rate > 0) {
 		param.proc_flags |= NS_QUERY_LIMIT_RATE;
 	}
 
+	/* Query may be suspended? */
+	if (udp_can_park(udp)) {
+		param.proc_flags |= NS_QUERY_YIELD;
+	}
+
+	/* Shed optional processing if overloaded. */
+	if (overload_active(&udp->server->overload)) {
+		param.proc_flags |= NS_QUERY_DEGRADED;
+	}
+
 	/* Start query processing. */
 	udp->layer.state = knot_layer_begin(&udp->layer, &param);
 
@@ -89,9 +557,28 @@ static void udp_handle(udp_context_t *udp, int fd, struct sockaddr_storage *ss,
 		state = knot_layer_produce(&udp->layer, ans);
 	}
 
+	/* Park suspended query, answer later. */
+	if (state == KNOT_STATE_YIELD) {
+		if (udp_park(udp, fd, msg, rx, tx, query, ans) == KNOT_EOK) {
+			tx->iov_len = 0;
+			rcu_read_unlock();
+			return;
+		}
+		while (state == KNOT_STATE_YIELD) {
+			state = udp_resume(&udp->layer, ans, POLLNVAL);
+		}
+	}
+
 	/* Send response only if finished successfully. */
 	if (state == KNOT_STATE_DONE) {
 		tx->iov_len = ans->size;
+
+		/* Cache the answer unless the zone changed meanwhile. */
+		if (generation != 0 && !(param.proc_flags & NS_QUERY_DEGRADED) &&
+		    udp_cache_generation(udp, zone) == generation) {
+			answer_cache_insert(udp->cache, &cached, generation,
+			                    ans->wire, ans->size);
+		}
 	} else {
 		tx->iov_len = 0;
 	}
@@ -99,6 +586,8 @@ static void udp_handle(udp_context_t *udp, int fd, struct sockaddr_storage *ss,
 	/* Reset after processing. */
 	knot_layer_finish(&udp->layer);
 
+	rcu_read_unlock();
+
 	/* Cleanup. */
 	knot_pkt_free(&query);
 	knot_pkt_free(&ans);
@@ -111,11 +600,41 @@ static int (*_udp_recv)(int, void *) = 0;
 static int (*_udp_handle)(udp_context_t *, void *) = 0;
 static int (*_udp_send)(void *) = 0;
 
-/*! \brief Control message to fit IP_PKTINFO or IPv6_RECVPKTINFO. */
-typedef union {
-	struct cmsghdr cmsg;
-	uint8_t buf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
-} cmsg_pktinfo_t;
+/*!
+ * \brief Read the kernel drop counter and strip it from the control data.
+ *
+ * The control data are reused for the answer, only the packet info is kept.
+ */
+static void udp_rxq_ovfl_handle(udp_context_t *udp, struct msghdr *rx)
+{
+#if defined(SO_RXQ_OVFL)
+	if (rx->msg_controllen == 0) {
+		return;
+	}
+
+	cmsg_pktinfo_t kept;
+	size_t kept_len = 0;
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(rx); cmsg != NULL;
+	     cmsg = CMSG_NXTHDR(rx, cmsg)) {
+		if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+			memcpy(&udp->rxq_drops, CMSG_DATA(cmsg), sizeof(uint32_t));
+			udp->rxq_valid = true;
+			continue;
+		}
+
+		size_t len = CMSG_SPACE(cmsg->cmsg_len - CMSG_LEN(0));
+		if (kept_len + len <= sizeof(kept)) {
+			memcpy(kept.buf + kept_len, cmsg, len);
+			kept_len += len;
+		}
+	}
+
+	if (udp->rxq_valid) {
+		memcpy(rx->msg_control, &kept, kept_len);
+		rx->msg_controllen = kept_len;
+	}
+#endif
+}
 
 static void udp_pktinfo_handle(const struct msghdr *rx, struct msghdr *tx)
 {
@@ -147,10 +666,19 @@ struct udp_recvfrom {
 	struct sockaddr_storage addr;
 	struct msghdr msg[NBUFS];
 	struct iovec iov[NBUFS];
-	uint8_t buf[NBUFS][KNOT_WIRE_MAX_PKTSIZE];
 	cmsg_pktinfo_t pktinfo;
 };
 
+static int udp_recvfrom_deinit(void *d)
+{
+	struct udp_recvfrom *rq = (struct udp_recvfrom *)d;
+	for (unsigned i = 0; i < NBUFS; ++i) {
+		free(rq->iov[i].iov_base);
+	}
+	free(rq);
+	return 0;
+}
+
 static void *udp_recvfrom_init(void)
 {
 	struct udp_recvfrom *rq = malloc(sizeof(struct udp_recvfrom));
@@ -160,7 +688,11 @@ static void *udp_recvfrom_init(void)
 	memset(rq, 0, sizeof(struct udp_recvfrom));
 
 	for (unsigned i = 0; i < NBUFS; ++i) {
-		rq->iov[i].iov_base = rq->buf + i;
+		rq->iov[i].iov_base = malloc(KNOT_WIRE_MAX_PKTSIZE);
+		if (rq->iov[i].iov_base == NULL) {
+			udp_recvfrom_deinit(rq);
+			return NULL;
+		}
 		rq->iov[i].iov_len = KNOT_WIRE_MAX_PKTSIZE;
 		rq->msg[i].msg_name = &rq->addr;
 		rq->msg[i].msg_namelen = sizeof(rq->addr);
@@ -172,13 +704,6 @@ static void *udp_recvfrom_init(void)
 	return rq;
 }
 
-static int udp_recvfrom_deinit(void *d)
-{
-	struct udp_recvfrom *rq = (struct udp_recvfrom *)d;
-	free(rq);
-	return 0;
-}
-
 static int udp_recvfrom_recv(int fd, void *d)
 {
 	/* Reset max lengths. */
@@ -205,10 +730,11 @@ static int udp_recvfrom_handle(udp_context_t *ctx, void *d)
 	rq->msg[TX].msg_namelen = rq->msg[RX].msg_namelen;
 	rq->iov[TX].iov_len = KNOT_WIRE_MAX_PKTSIZE;
 
+	udp_rxq_ovfl_handle(ctx, &rq->msg[RX]);
 	udp_pktinfo_handle(&rq->msg[RX], &rq->msg[TX]);
 
 	/* Process received pkt. */
-	udp_handle(ctx, rq->fd, &rq->addr, &rq->iov[RX], &rq->iov[TX]);
+	udp_handle(ctx, rq->fd, &rq->msg[RX], &rq->iov[RX], &rq->iov[TX]);
 
 	return KNOT_EOK;
 }
@@ -235,7 +761,6 @@ static int udp_recvfrom_send(void *d)
 struct udp_recvmmsg {
 	int fd;
 	struct sockaddr_storage addrs[RECVMMSG_BATCHLEN];
-	char *iobuf[NBUFS];
 	struct iovec *iov[NBUFS];
 	struct mmsghdr *msgs[NBUFS];
 	unsigned rcvd;
@@ -243,6 +768,21 @@ struct udp_recvmmsg {
 	cmsg_pktinfo_t pktinfo[RECVMMSG_BATCHLEN];
 };
 
+static int udp_recvmmsg_deinit(void *d)
+{
+	struct udp_recvmmsg *rq = (struct udp_recvmmsg *)d;
+	if (rq) {
+		for (unsigned i = 0; i < NBUFS; ++i) {
+			for (unsigned k = 0; rq->iov[i] != NULL && k < RECVMMSG_BATCHLEN; ++k) {
+				free(rq->iov[i][k].iov_base);
+			}
+		}
+		mp_delete(rq->mm.ctx);
+	}
+
+	return 0;
+}
+
 static void *udp_recvmmsg_init(void)
 {
 	knot_mm_t mm;
@@ -254,12 +794,17 @@ static void *udp_recvmmsg_init(void)
 
 	/* Initialize buffers. */
 	for (unsigned i = 0; i < NBUFS; ++i) {
-		rq->iobuf[i] = mm.alloc(mm.ctx, KNOT_WIRE_MAX_PKTSIZE * RECVMMSG_BATCHLEN);
 		rq->iov[i] = mm.alloc(mm.ctx, sizeof(struct iovec) * RECVMMSG_BATCHLEN);
+		memset(rq->iov[i], 0, sizeof(struct iovec) * RECVMMSG_BATCHLEN);
 		rq->msgs[i] = mm.alloc(mm.ctx, sizeof(struct mmsghdr) * RECVMMSG_BATCHLEN);
 		memset(rq->msgs[i], 0, sizeof(struct mmsghdr) * RECVMMSG_BATCHLEN);
 		for (unsigned k = 0; k < RECVMMSG_BATCHLEN; ++k) {
-			rq->iov[i][k].iov_base = rq->iobuf[i] + k * KNOT_WIRE_MAX_PKTSIZE;
+			/* Separate buffers, these may be handed over to parked queries. */
+			rq->iov[i][k].iov_base = malloc(KNOT_WIRE_MAX_PKTSIZE);
+			if (rq->iov[i][k].iov_base == NULL) {
+				udp_recvmmsg_deinit(rq);
+				return NULL;
+			}
 			rq->iov[i][k].iov_len = KNOT_WIRE_MAX_PKTSIZE;
 			rq->msgs[i][k].msg_hdr.msg_iov = rq->iov[i] + k;
 			rq->msgs[i][k].msg_hdr.msg_iovlen = 1;
@@ -273,16 +818,6 @@ static void *udp_recvmmsg_init(void)
 	return rq;
 }
 
-static int udp_recvmmsg_deinit(void *d)
-{
-	struct udp_recvmmsg *rq = (struct udp_recvmmsg *)d;
-	if (rq) {
-		mp_delete(rq->mm.ctx);
-	}
-
-	return 0;
-}
-
 static int udp_recvmmsg_recv(int fd, void *d)
 {
 	struct udp_recvmmsg *rq = (struct udp_recvmmsg *)d;
@@ -305,9 +840,10 @@ static int udp_recvmmsg_handle(udp_context_t *ctx, void *d)
 		struct iovec *tx = rq->msgs[TX][i].msg_hdr.msg_iov;
 		rx->iov_len = rq->msgs[RX][i].msg_len; /* Received bytes. */
 
+		udp_rxq_ovfl_handle(ctx, &rq->msgs[RX][i].msg_hdr);
 		udp_pktinfo_handle(&rq->msgs[RX][i].msg_hdr, &rq->msgs[TX][i].msg_hdr);
 
-		udp_handle(ctx, rq->fd, rq->addrs + i, rx, tx);
+		udp_handle(ctx, rq->fd, &rq->msgs[RX][i].msg_hdr, rx, tx);
 		rq->msgs[TX][i].msg_len = tx->iov_len;
 		rq->msgs[TX][i].msg_hdr.msg_namelen = 0;
 		if (tx->iov_len > 0) {
@@ -322,8 +858,27 @@ static int udp_recvmmsg_handle(udp_context_t *ctx, void *d)
 static int udp_recvmmsg_send(void *d)
 {
 	struct udp_recvmmsg *rq = (struct udp_recvmmsg *)d;
-	int rc = sendmmsg(rq->fd, rq->msgs[TX], rq->rcvd, 0);
-	for (unsigned i = 0; i < rq->rcvd; ++i) {
+
+	/* Send runs of answers, sendmmsg() stops at a message without one. */
+	int rc = 0;
+	unsigned i = 0;
+	while (i < rq->rcvd) {
+		if (rq->msgs[TX][i].msg_len == 0) {
+			i += 1;
+			continue;
+		}
+		unsigned n = 1;
+		while (i + n < rq->rcvd && rq->msgs[TX][i + n].msg_len > 0) {
+			n += 1;
+		}
+		int sent = sendmmsg(rq->fd, rq->msgs[TX] + i, n, 0);
+		if (sent > 0) {
+			rc += sent;
+		}
+		i += n;
+	}
+
+	for (i = 0; i < rq->rcvd; ++i) {
 		/* Reset buffer size and address len. */
 		struct iovec *rx = rq->msgs[RX][i].msg_hdr.msg_iov;
 		struct iovec *tx = rq->msgs[TX][i].msg_hdr.msg_iov;
@@ -358,57 +913,88 @@ void __attribute__ ((constructor)) udp_master_init(void)
 #endif /* ENABLE_RECVMMSG */
 }
 
-/*! \brief Get interface UDP descriptor for a given thread. */
-static int iface_udp_fd(const iface_t *iface, int thread_id)
+/*!
+ * \brief Check if a thread reads an interface UDP socket.
+ *
+ * Each socket is read by one of the serving threads, or each thread reads
+ * one socket if there are more threads than sockets.
+ */
+static bool iface_udp_serves(const iface_t *iface, int sock, unsigned thread,
+                             unsigned active)
 {
-#ifdef ENABLE_REUSEPORT
-		return iface->fd_udp[thread_id % iface->fd_udp_count];
-#else
-		return iface->fd_udp[0];
-#endif
+	if (thread >= active) {
+		return false;
+	}
+	if (active >= iface->fd_udp_count) {
+		return sock == thread % iface->fd_udp_count;
+	}
+	return sock % active == thread;
 }
 
 /*! \brief Release the interface list reference and free watched descriptor set. */
-static void forget_ifaces(ifacelist_t *ifaces, struct pollfd **fds_ptr)
+static void forget_ifaces(ifacelist_t *ifaces, struct pollfd **fds_ptr,
+                          volatile uint32_t ***drops_ptr)
 {
 	ref_release((ref_t *)ifaces);
 	free(*fds_ptr);
 	*fds_ptr = NULL;
+	free(*drops_ptr);
+	*drops_ptr = NULL;
 }
 
 /*!
  * \brief Make a set of watched descriptors based on the interface list.
  *
- * \param[in]   ifaces  New interface list.
- * \param[in]   thrid   Thread ID.
- * \param[out]  fds_ptr Allocated set of descriptors.
+ * The set has extra room for the descriptors of parked queries.
  *
- * \return Number of watched descriptors, zero on error.
+ * \param[in]   ifaces    New interface list.
+ * \param[in]   thread    Thread index in the handler.
+ * \param[in]   active    Number of serving threads, zero for none.
+ * \param[out]  fds_ptr   Allocated set of descriptors.
+ * \param[out]  drops_ptr Allocated set of descriptor drop counters.
+ *
+ * \return Number of watched descriptors.
  */
-static nfds_t track_ifaces(const ifacelist_t *ifaces, int thrid,
-                           struct pollfd **fds_ptr)
+static nfds_t track_ifaces(const ifacelist_t *ifaces, unsigned thread, unsigned active,
+                           struct pollfd **fds_ptr, volatile uint32_t ***drops_ptr)
 {
-	assert(ifaces && fds_ptr);
+	assert(ifaces && fds_ptr && drops_ptr);
+
+	nfds_t nfds = 0;
+	iface_t *iface = NULL;
+	WALK_LIST(iface, ifaces->l) {
+		nfds += iface->fd_udp_count;
+	}
 
-	nfds_t nfds = list_size(&ifaces->l);
-	struct pollfd *fds = malloc(nfds * sizeof(*fds));
-	if (!fds) {
+	struct pollfd *fds = malloc((nfds + UDP_PARKED_MAX) * sizeof(*fds));
+	volatile uint32_t **drops = malloc(nfds * sizeof(*drops));
+	if (!fds || !drops) {
+		free(fds);
+		free(drops);
 		*fds_ptr = NULL;
+		*drops_ptr = NULL;
 		return 0;
 	}
 
-	iface_t *iface = NULL;
 	int i = 0;
 	WALK_LIST(iface, ifaces->l) {
-		fds[i].fd = iface_udp_fd(iface, thrid);
-		fds[i].events = POLLIN;
-		fds[i].revents = 0;
-		i += 1;
+		/* TCP-only (TLS) interfaces have no UDP sockets. */
+		for (int sock = 0; sock < iface->fd_udp_count; ++sock) {
+			if (!iface_udp_serves(iface, sock, thread, active)) {
+				continue;
+			}
+			fds[i].fd = iface->fd_udp[sock];
+			fds[i].events = POLLIN;
+			fds[i].revents = 0;
+			drops[i] = iface->fd_udp_drops + sock;
+			i += 1;
+		}
 	}
-	assert(i == nfds);
+	assert(i <= nfds);
 
 	*fds_ptr = fds;
-	return nfds;
+	*drops_ptr = drops;
+	return i;
 }
 
 int udp_master(dthread_t *thread)
@@ -430,39 +1016,53 @@ int udp_master(dthread_t *thread)
 	/* Prepare structures for bound sockets. */
 	unsigned thr_id = dt_get_id(thread);
 	iohandler_t *handler = (iohandler_t *)thread->data;
-	unsigned *iostate = &handler->thread_state[thr_id];
+	iothread_t *io = server_iothread(handler, thread);
 	void *rq = _udp_init();
 	ifacelist_t *ref = NULL;
 
 	/* Create big enough memory cushion. */
-	knot_mm_t mm;
-	mm_ctx_mempool(&mm, 16 * MM_DEFAULT_BLKSIZE);
+	knot_mm_t *mm = udp_mm_new();
+	if (rq == NULL || mm == NULL) {
+		if (rq != NULL) {
+			_udp_deinit(rq);
+		}
+		if (mm != NULL) {
+			udp_mm_free(mm);
+		}
+		return KNOT_ENOMEM;
+	}
 
 	/* Create UDP answering context. */
 	udp_context_t udp;
 	memset(&udp, 0, sizeof(udp_context_t));
 	udp.server = handler->server;
-	udp.thread_id = handler->thread_id[thr_id];
-	knot_layer_init(&udp.layer, &mm, process_query_layer());
+	udp.thread_id = io->id;
+	init_list(&udp.parked);
+	knot_layer_init(&udp.layer, mm, process_query_layer());
 
 	/* Event source. */
 	struct pollfd *fds = NULL;
+	volatile uint32_t **drops = NULL;
 	nfds_t nfds = 0;
 
 	/* Loop until all data is read. */
 	for (;;) {
 
 		/* Check handler state. */
-		if (unlikely(*iostate & ServerReload)) {
-			*iostate &= ~ServerReload;
-			udp.thread_id = handler->thread_id[thr_id];
+		if (unlikely(ref == NULL || (io->state & ServerReload))) {
+			__sync_and_and_fetch(&io->state, ~ServerReload);
+			udp.thread_id = io->id;
+
+			/* Parked threads don't read the sockets. */
+			unsigned active = dt_is_parked(thread) ? 0 : handler->active;
 
 			rcu_read_lock();
-			forget_ifaces(ref, &fds);
-			ref = handler->server->ifaces;
-			nfds = track_ifaces(ref, udp.thread_id, &fds);
+			forget_ifaces(ref, &fds, &drops);
+			ref = rcu_dereference(handler->server->ifaces);
+			ref_retain(&ref->ref);
+			nfds = track_ifaces(ref, thr_id, active, &fds, &drops);
 			rcu_read_unlock();
-			if (nfds == 0) {
+			if (fds == NULL || (nfds == 0 && thr_id < active)) {
 				break;
 			}
 		}
@@ -472,14 +1072,26 @@ int udp_master(dthread_t *thread)
 			break;
 		}
 
-		/* Wait for events. */
-		int events = poll(fds, nfds, -1);
-		if (events <= 0) {
+		/* Parking point, finish the suspended queries first. */
+		if (unlikely(dt_is_parked(thread))) {
+			nfds = 0;
+			if (udp.parked_count == 0) {
+				break;
+			}
+		}
+
+		/* Wait for events, watch parked queries too. */
+		unsigned parked = 0;
+		int timeout = udp_parked_track(&udp, fds + nfds, &parked);
+		int events = poll(fds, nfds + parked, timeout);
+		if (events < 0) {
 			if (errno == EINTR) continue;
 			break;
 		}
 
-		/* Process the events. */
+		/* Process the events, measure the time spent. */
+		uint64_t begin = scaling_now();
+		bool woken = (events > 0), backlog = false;
 		for (nfds_t i = 0; i < nfds && events > 0; i++) {
 			if (fds[i].revents == 0) {
 				continue;
@@ -487,16 +1099,37 @@ int udp_master(dthread_t *thread)
 			events -= 1;
 			int rcvd = 0;
 			if ((rcvd = _udp_recv(fds[i].fd, rq)) > 0) {
+				/* A full batch leaves more datagrams queued. */
+				backlog |= (rcvd >= RECVMMSG_BATCHLEN);
 				_udp_handle(&udp, rq);
 				/* Flush allocated memory. */
-				mp_flush(mm.ctx);
+				mp_flush(udp.layer.mm->ctx);
 				_udp_send(rq);
+
+				/* Track datagrams dropped by the kernel. */
+				uint32_t dropped = 0;
+				if (udp.rxq_valid) {
+					dropped = overload_sock_drops(drops[i], udp.rxq_drops);
+					udp.rxq_valid = false;
+				}
+				overload_update(&udp.server->overload, dropped, time(NULL));
 			}
 		}
+
+		/* Resume parked queries. */
+		if (parked > 0) {
+			udp_parked_handle(&udp, fds + nfds, parked);
+		}
+
+		if (woken) {
+			scaling_account(&io->stats, begin, backlog);
+		}
 	}
 
+	udp_parked_clear(&udp);
+	answer_cache_free(udp.cache);
 	_udp_deinit(rq);
-	forget_ifaces(ref, &fds);
-	mp_delete(mm.ctx);
+	forget_ifaces(ref, &fds, &drops);
+	udp_mm_free(udp.layer.mm);
 	return KNOT_EOK;
 }
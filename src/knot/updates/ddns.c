@@ -15,6 +15,7 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
 
 #include "knot/common/log.h"
 #include "knot/updates/ddns.h"
@@ -671,6 +672,94 @@ static int process_rr(const knot_rrset_t *rr, zone_update_t *update)
 	}
 }
 
+/*!< \brief Returns true if the addition can be processed with the previous one. */
+static bool can_batch(const knot_rrset_t *first, const knot_rrset_t *rr)
+{
+	switch (rr->type) {
+	case KNOT_RRTYPE_CNAME:
+	case KNOT_RRTYPE_SOA:
+	case KNOT_RRTYPE_NSEC3PARAM:
+	case KNOT_RRTYPE_DNAME:
+		return false;
+	default:
+		break;
+	}
+
+	return is_addition(first) && is_addition(rr) &&
+	       rr->type == first->type &&
+	       knot_rrset_ttl(rr) == knot_rrset_ttl(first) &&
+	       knot_dname_is_equal(rr->owner, first->owner);
+}
+
+static int rdata_ptr_cmp(const void *a, const void *b)
+{
+	return knot_rdata_cmp(*(const knot_rdata_t **)a, *(const knot_rdata_t **)b);
+}
+
+/*!
+ * \brief Processes consecutive additions of the same RRSet at once.
+ *
+ * Same as calling process_rr() for each of them, but the RRs are sorted and
+ * merged into the node in one pass instead of being inserted one by one.
+ */
+static int process_add_batch(const knot_rrset_t *rrs, uint16_t count,
+                             zone_update_t *update)
+{
+	const zone_node_t *node = zone_update_get_node(update, rrs->owner);
+	if (adding_to_cname(rrs->owner, node)) {
+		// Adding RRs to CNAME node, ignore.
+		return sem_check(rrs, node, update) ? KNOT_EOK : KNOT_EDENIED;
+	}
+
+	const knot_rdata_t **add = malloc(count * sizeof(*add));
+	if (add == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	for (uint16_t i = 0; i < count; ++i) {
+		add[i] = rrs[i].rrs.data;
+	}
+	qsort(add, count, sizeof(*add), rdata_ptr_cmp);
+
+	// Skip duplicates and RRs already in the zone, both are sorted.
+	const knot_rdataset_t *zone_rrs = node ? node_rdataset(node, rrs->type) : NULL;
+	uint16_t zone_left = zone_rrs ? zone_rrs->rr_count : 0;
+	const knot_rdata_t *zone_rr = zone_rrs ? zone_rrs->data : NULL;
+	uint16_t add_count = 0;
+	for (uint16_t i = 0; i < count; ++i) {
+		if (add_count > 0 && knot_rdata_cmp(add[add_count - 1], add[i]) == 0) {
+			continue;
+		}
+		int cmp = -1;
+		while (zone_left > 0 && (cmp = knot_rdata_cmp(zone_rr, add[i])) < 0) {
+			zone_rr += knot_rdata_array_size(knot_rdata_rdlen(zone_rr));
+			zone_left--;
+		}
+		if (zone_left > 0 && cmp == 0) {
+			continue;
+		}
+		add[add_count++] = add[i];
+	}
+
+	int ret = KNOT_EOK;
+	if (add_count > 0) {
+		knot_rrset_t batch;
+		knot_rrset_init(&batch, rrs->owner, rrs->type, rrs->rclass);
+		ret = knot_rdataset_gather(&batch.rrs, (knot_rdata_t **)add,
+		                           add_count, NULL);
+		if (ret == KNOT_EOK) {
+			ret = zone_update_add(update, &batch);
+			knot_rdataset_clear(&batch.rrs, NULL);
+		}
+	}
+	free(add);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	return sem_check(rrs, node, update) ? KNOT_EOK : KNOT_EDENIED;
+}
+
 /*!< \brief Maps Knot return code to RCODE. */
 static uint16_t ret_to_rcode(int ret)
 {
@@ -742,7 +831,24 @@ int ddns_process_update(const zone_t *zone, const knot_pkt_t *query,
 			continue;
 		}
 
-		ret = process_rr(rr, update);
+		// Check and collect following additions to the same RRSet.
+		uint16_t count = 1;
+		while (i + count < authority->count &&
+		       can_batch(rr, &authority_rr[i + count])) {
+			ret = check_update(&authority_rr[i + count], query, rcode);
+			if (ret != KNOT_EOK) {
+				assert(*rcode != KNOT_RCODE_NOERROR);
+				return ret;
+			}
+			count++;
+		}
+
+		if (count > 1) {
+			ret = process_add_batch(rr, count, update);
+			i += count - 1;
+		} else {
+			ret = process_rr(rr, update);
+		}
 		if (ret != KNOT_EOK) {
 			*rcode = ret_to_rcode(ret);
 			return ret;
@@ -412,11 +412,12 @@ static int sign_update(zone_update_t *update,
 	if (full_sign) {
 		ret = knot_dnssec_zone_sign(new_contents, &sec_ch,
 		                            ZONE_SIGN_KEEP_SOA_SERIAL,
-		                            &refresh_at);
+		                            &refresh_at, update->zone->rrsig_cache);
 	} else {
 		/* Sign the created changeset */
 		ret = knot_dnssec_sign_changeset(new_contents, &update->change,
-		                                 &sec_ch, &refresh_at);
+		                                 &sec_ch, &refresh_at,
+		                                 update->zone->rrsig_cache);
 	}
 	if (ret != KNOT_EOK) {
 		changeset_clear(&sec_ch);
@@ -609,8 +610,13 @@ int zone_update_commit(conf_t *conf, zone_update_t *update)
 	}
 
 	/* Switch zone contents. */
-	zone_contents_t *old_contents = zone_switch_contents(update->zone,
-	                                                     new_contents);
+	zone_contents_t *old_contents = NULL;
+	if (update->flags & UPDATE_INCREMENTAL) {
+		old_contents = zone_switch_change(update->zone, new_contents,
+		                                  &update->change);
+	} else {
+		old_contents = zone_switch_contents(update->zone, new_contents);
+	}
 
 	/* Sync RCU. */
 	synchronize_rcu();
@@ -0,0 +1,284 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "knot/updates/changesets.h"
+#include "knot/zone/catalog.h"
+#include "libknot/libknot.h"
+
+typedef struct {
+	const knot_dname_t *zones;
+	int zones_labels;
+	const knot_dname_t *apex;
+	hattrie_t *members;
+} members_ctx_t;
+
+static int add_members(zone_node_t *node, void *data)
+{
+	members_ctx_t *ctx = data;
+
+	if (knot_dname_labels(node->owner, NULL) != ctx->zones_labels + 1 ||
+	    !knot_dname_is_sub(node->owner, ctx->zones)) {
+		return KNOT_EOK;
+	}
+
+	const knot_rdataset_t *ptrs = node_rdataset(node, KNOT_RRTYPE_PTR);
+	if (ptrs == NULL) {
+		return KNOT_EOK;
+	}
+
+	for (uint16_t i = 0; i < ptrs->rr_count; i++) {
+		const knot_rdata_t *rr = knot_rdataset_at(ptrs, i);
+		const knot_dname_t *member = knot_rdata_data(rr);
+
+		/* Zone names are kept in lower case. */
+		knot_dname_t name[KNOT_DNAME_MAXLEN];
+		int len = knot_dname_to_wire(name, member, sizeof(name));
+		if (len <= 0) {
+			return KNOT_EMALF;
+		}
+		knot_dname_to_lower(name);
+
+		/* A catalog cannot be its own member. */
+		if (knot_dname_is_equal(name, ctx->apex)) {
+			continue;
+		}
+
+		if (hattrie_get(ctx->members, (char *)name, len) == NULL) {
+			return KNOT_ENOMEM;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+int catalog_members(const zone_contents_t *contents, hattrie_t *members)
+{
+	if (contents == NULL || members == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	const knot_dname_t *apex = contents->apex->owner;
+
+	knot_dname_t zones[KNOT_DNAME_MAXLEN];
+	size_t label_size = sizeof(CATALOG_ZONES_LABEL) - 1;
+	size_t apex_size = knot_dname_size(apex);
+	if (label_size + apex_size > sizeof(zones)) {
+		return KNOT_EOK;
+	}
+	memcpy(zones, CATALOG_ZONES_LABEL, label_size);
+	memcpy(zones + label_size, apex, apex_size);
+
+	/* No member zones. */
+	if (zone_contents_find_node(contents, zones) == NULL) {
+		return KNOT_EOK;
+	}
+
+	members_ctx_t ctx = {
+		.zones = zones,
+		.zones_labels = knot_dname_labels(zones, NULL),
+		.apex = apex,
+		.members = members
+	};
+
+	return zone_contents_apply((zone_contents_t *)contents, add_members, &ctx);
+}
+
+int catalog_update_init(catalog_update_t *upd, void (*apply)(void *), void *ctx)
+{
+	if (upd == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	memset(upd, 0, sizeof(*upd));
+
+	upd->add = hattrie_create(NULL);
+	upd->rem = hattrie_create(NULL);
+	if (upd->add == NULL || upd->rem == NULL) {
+		hattrie_free(upd->add);
+		hattrie_free(upd->rem);
+		return KNOT_ENOMEM;
+	}
+
+	pthread_mutex_init(&upd->lock, NULL);
+	upd->apply = apply;
+	upd->ctx = ctx;
+
+	return KNOT_EOK;
+}
+
+void catalog_update_clear(catalog_update_t *upd)
+{
+	if (upd == NULL || upd->add == NULL) {
+		return;
+	}
+
+	hattrie_clear(upd->add);
+	hattrie_clear(upd->rem);
+}
+
+void catalog_update_deinit(catalog_update_t *upd)
+{
+	if (upd == NULL || upd->add == NULL) {
+		return;
+	}
+
+	hattrie_free(upd->add);
+	hattrie_free(upd->rem);
+	pthread_mutex_destroy(&upd->lock);
+	memset(upd, 0, sizeof(*upd));
+}
+
+/*!
+ * \brief Moves the member of the catalog to the 'to' trie.
+ *
+ * The lock must be held. The trie keys are the member name followed by the
+ * catalog name, so that a member listed in more catalogs is tracked for each.
+ */
+static int record(hattrie_t *to, hattrie_t *from, const knot_dname_t *catalog,
+                  const char *member, size_t len)
+{
+	char key[2 * KNOT_DNAME_MAXLEN];
+	size_t catalog_len = knot_dname_size(catalog);
+	assert(len <= KNOT_DNAME_MAXLEN && catalog_len <= KNOT_DNAME_MAXLEN);
+	memcpy(key, member, len);
+	memcpy(key + len, catalog, catalog_len);
+
+	(void)hattrie_del(from, key, len + catalog_len, NULL);
+
+	return hattrie_get(to, key, len + catalog_len) != NULL ? KNOT_EOK : KNOT_ENOMEM;
+}
+
+/*! \brief Records members of 'names' missing in 'except', the lock must be held. */
+static int record_all(hattrie_t *to, hattrie_t *from, const knot_dname_t *catalog,
+                      hattrie_t *names, hattrie_t *except)
+{
+	int ret = KNOT_EOK;
+	hattrie_iter_t *it = hattrie_iter_begin(names);
+	for (; ret == KNOT_EOK && !hattrie_iter_finished(it); hattrie_iter_next(it)) {
+		size_t len = 0;
+		const char *member = hattrie_iter_key(it, &len);
+		if (except == NULL || hattrie_tryget(except, member, len) == NULL) {
+			ret = record(to, from, catalog, member, len);
+		}
+	}
+	hattrie_iter_free(it);
+
+	return ret;
+}
+
+int catalog_update_contents(catalog_update_t *upd, const knot_dname_t *catalog,
+                            const zone_contents_t *old_cont,
+                            const zone_contents_t *new_cont)
+{
+	if (upd == NULL || catalog == NULL || new_cont == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	hattrie_t *old_members = hattrie_create(NULL);
+	hattrie_t *new_members = hattrie_create(NULL);
+	if (old_members == NULL || new_members == NULL) {
+		hattrie_free(old_members);
+		hattrie_free(new_members);
+		return KNOT_ENOMEM;
+	}
+
+	int ret = catalog_members(new_cont, new_members);
+	if (ret == KNOT_EOK && old_cont != NULL) {
+		ret = catalog_members(old_cont, old_members);
+	}
+
+	if (ret == KNOT_EOK) {
+		pthread_mutex_lock(&upd->lock);
+		ret = record_all(upd->rem, upd->add, catalog, old_members, new_members);
+		if (ret == KNOT_EOK) {
+			ret = record_all(upd->add, upd->rem, catalog, new_members, old_members);
+		}
+		pthread_mutex_unlock(&upd->lock);
+	}
+
+	hattrie_free(old_members);
+	hattrie_free(new_members);
+
+	return ret;
+}
+
+int catalog_update_changes(catalog_update_t *upd, const knot_dname_t *catalog,
+                           list_t *changes, const zone_contents_t *new_cont)
+{
+	if (upd == NULL || catalog == NULL || changes == NULL || new_cont == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	hattrie_t *removed = hattrie_create(NULL);
+	hattrie_t *added = hattrie_create(NULL);
+	if (removed == NULL || added == NULL) {
+		hattrie_free(removed);
+		hattrie_free(added);
+		return KNOT_ENOMEM;
+	}
+
+	int ret = KNOT_EOK;
+	changeset_t *ch = NULL;
+	WALK_LIST(ch, *changes) {
+		ret = catalog_members(ch->remove, removed);
+		if (ret == KNOT_EOK) {
+			ret = catalog_members(ch->add, added);
+		}
+		if (ret != KNOT_EOK) {
+			break;
+		}
+	}
+
+	/* A member may be listed by more PTRs, so the members with a removed
+	 * PTR are recounted in the new contents. Scanned only if needed. */
+	hattrie_t *listed = NULL;
+	if (ret == KNOT_EOK && hattrie_weight(removed) > 0) {
+		listed = hattrie_create(NULL);
+		if (listed == NULL) {
+			ret = KNOT_ENOMEM;
+		} else {
+			ret = catalog_members(new_cont, listed);
+		}
+	}
+
+	/* A member unlisted after being listed again is not in the new contents. */
+	if (ret == KNOT_EOK) {
+		pthread_mutex_lock(&upd->lock);
+		ret = record_all(upd->add, upd->rem, catalog, added, NULL);
+		if (ret == KNOT_EOK) {
+			ret = record_all(upd->rem, upd->add, catalog, removed, listed);
+		}
+		pthread_mutex_unlock(&upd->lock);
+	}
+
+	hattrie_free(listed);
+	hattrie_free(removed);
+	hattrie_free(added);
+
+	return ret;
+}
+
+void catalog_update_apply(catalog_update_t *upd)
+{
+	if (upd == NULL || upd->apply == NULL) {
+		return;
+	}
+
+	upd->apply(upd->ctx);
+}
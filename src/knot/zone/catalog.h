@@ -0,0 +1,129 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*!
+ * \file
+ *
+ * \brief Catalog zone interpretation.
+ *
+ * Member zones of a catalog are listed as PTR records owned by names one
+ * label below the 'zones' label of the catalog apex:
+ *
+ *   <unique-id>.zones.<catalog> PTR <member>
+ *
+ * \addtogroup zone
+ * @{
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+#include "contrib/hat-trie/hat-trie.h"
+#include "contrib/ucw/lists.h"
+#include "knot/zone/contents.h"
+
+/*! \brief Catalog zone label containing the member zones. */
+#define CATALOG_ZONES_LABEL	"\x05""zones"
+
+/*! \brief Delay to batch member zone changes of subsequent switches (ms). */
+#define CATALOG_UPDATE_DELAY	100
+
+/*!
+ * \brief Collects member zone names of a catalog zone.
+ *
+ * \param contents  Catalog zone contents.
+ * \param members   Output trie, member names are inserted as keys.
+ *
+ * \return KNOT_E*
+ */
+int catalog_members(const zone_contents_t *contents, hattrie_t *members);
+
+/*!
+ * \brief Member zone changes not yet applied to the zone database.
+ *
+ * The trie keys are member names followed by catalog names. A member listed
+ * again after being unlisted (or vice versa) is kept in one of the tries
+ * only, so the changes of several catalog switches are applied at once.
+ */
+typedef struct catalog_update {
+	pthread_mutex_t lock;  /*!< Held while the changes are applied. */
+	hattrie_t *add;        /*!< Listed members. */
+	hattrie_t *rem;        /*!< Unlisted members. */
+	void (*apply)(void *ctx); /*!< Server callback applying the changes. */
+	void *ctx;             /*!< Server callback context. */
+} catalog_update_t;
+
+/*!
+ * \brief Initializes the member zone changes.
+ *
+ * \param upd    Member zone changes.
+ * \param apply  Callback applying the changes to the zone database.
+ * \param ctx    Callback context.
+ *
+ * \return KNOT_E*
+ */
+int catalog_update_init(catalog_update_t *upd, void (*apply)(void *), void *ctx);
+
+/*!
+ * \brief Drops the pending changes, the lock must be held.
+ */
+void catalog_update_clear(catalog_update_t *upd);
+
+/*!
+ * \brief Deinitializes the member zone changes.
+ */
+void catalog_update_deinit(catalog_update_t *upd);
+
+/*!
+ * \brief Records member zone changes between two catalog contents.
+ *
+ * Used when the catalog contents is replaced as a whole (load, AXFR), the
+ * members of the catalog are compared.
+ *
+ * \param upd       Member zone changes.
+ * \param catalog   Catalog zone name.
+ * \param old_cont  Previous catalog contents, can be NULL.
+ * \param new_cont  New catalog contents.
+ *
+ * \return KNOT_E*
+ */
+int catalog_update_contents(catalog_update_t *upd, const knot_dname_t *catalog,
+                            const zone_contents_t *old_cont,
+                            const zone_contents_t *new_cont);
+
+/*!
+ * \brief Records member zone changes from catalog changesets.
+ *
+ * Only the PTR records in the changesets are inspected, unless a PTR is
+ * removed. Then the members of the new contents are collected, because a
+ * member listed by another PTR too is not unlisted.
+ *
+ * \param upd       Member zone changes.
+ * \param catalog   Catalog zone name.
+ * \param changes   List of changesets (changeset_t), in order.
+ * \param new_cont  Catalog contents with the changesets applied.
+ *
+ * \return KNOT_E*
+ */
+int catalog_update_changes(catalog_update_t *upd, const knot_dname_t *catalog,
+                           list_t *changes, const zone_contents_t *new_cont);
+
+/*!
+ * \brief Applies the recorded changes by calling the server callback.
+ */
+void catalog_update_apply(catalog_update_t *upd);
+
+/*! @} */
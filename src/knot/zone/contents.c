@@ -405,6 +405,14 @@ static bool nsec3_params_match(const knot_rdataset_t *rrs,
 		          params->salt.size) == 0);
 }
 
+/*! \brief Source of the contents generations. */
+static uint64_t contents_generation = 0;
+
+static uint64_t next_generation(void)
+{
+	return __sync_add_and_fetch(&contents_generation, 1);
+}
+
 zone_contents_t *zone_contents_new(const knot_dname_t *apex_name)
 {
 	if (apex_name == NULL) {
@@ -417,6 +425,7 @@ zone_contents_t *zone_contents_new(const knot_dname_t *apex_name)
 	}
 
 	memset(contents, 0, sizeof(zone_contents_t));
+	contents->generation = next_generation();
 	contents->apex = node_new(apex_name, NULL);
 	if (contents->apex == NULL) {
 		goto cleanup;
@@ -1081,6 +1090,7 @@ int zone_contents_shallow_copy(const zone_contents_t *from, zone_contents_t **to
 	if (contents == NULL) {
 		return KNOT_ENOMEM;
 	}
+	contents->generation = next_generation();
 
 	int ret = recreate_normal_tree(from, contents);
 	if (ret != KNOT_EOK) {
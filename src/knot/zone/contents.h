@@ -42,6 +42,8 @@ typedef struct zone_contents {
 
 	dnssec_nsec3_params_t nsec3_params;
 	size_t size;
+
+	uint64_t generation;     /*!< Unique nonzero identifier of these contents. */
 } zone_contents_t;
 
 /*!
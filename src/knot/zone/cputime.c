@@ -0,0 +1,115 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "knot/zone/cputime.h"
+
+struct zone_cputime {
+	unsigned refs;
+	uint64_t query_ns;
+	uint64_t event_ns[ZONE_EVENT_COUNT];
+	uint64_t event_count[ZONE_EVENT_COUNT];
+};
+
+zone_cputime_t *zone_cputime_new(void)
+{
+	zone_cputime_t *cputime = calloc(1, sizeof(*cputime));
+	if (cputime == NULL) {
+		return NULL;
+	}
+	cputime->refs = 1;
+
+	return cputime;
+}
+
+zone_cputime_t *zone_cputime_ref(zone_cputime_t *cputime)
+{
+	if (cputime != NULL) {
+		__sync_add_and_fetch(&cputime->refs, 1);
+	}
+
+	return cputime;
+}
+
+void zone_cputime_free(zone_cputime_t *cputime)
+{
+	if (cputime != NULL && __sync_sub_and_fetch(&cputime->refs, 1) == 0) {
+		free(cputime);
+	}
+}
+
+uint64_t zone_cputime_now(void)
+{
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+		return 0;
+	}
+
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+uint64_t zone_cputime_query_begin(void)
+{
+	static __thread unsigned queries = 0;
+
+	if (++queries % CPUTIME_SAMPLE != 0) {
+		return 0;
+	}
+
+	return zone_cputime_now();
+}
+
+void zone_cputime_query_end(zone_cputime_t *cputime, uint64_t begin)
+{
+	if (cputime == NULL || begin == 0) {
+		return;
+	}
+
+	uint64_t end = zone_cputime_now();
+	if (end > begin) {
+		__sync_fetch_and_add(&cputime->query_ns, end - begin);
+	}
+}
+
+void zone_cputime_event(zone_cputime_t *cputime, zone_event_type_t type,
+                        uint64_t ns)
+{
+	if (cputime == NULL || type < 0 || type >= ZONE_EVENT_COUNT) {
+		return;
+	}
+
+	__sync_fetch_and_add(&cputime->event_ns[type], ns);
+	__sync_fetch_and_add(&cputime->event_count[type], 1);
+}
+
+void zone_cputime_get(const zone_cputime_t *cputime, zone_cputime_stats_t *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	if (cputime == NULL) {
+		return;
+	}
+
+	stats->query_ns = cputime->query_ns * CPUTIME_SAMPLE;
+
+	for (unsigned i = 0; i < ZONE_EVENT_COUNT; i++) {
+		stats->event_ns[i] = cputime->event_ns[i];
+		stats->event_count[i] = cputime->event_count[i];
+	}
+}
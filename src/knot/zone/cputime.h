@@ -0,0 +1,107 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*!
+ * \file
+ *
+ * \brief Per-zone CPU time accounting.
+ *
+ * Zone events are measured with the thread CPU clock each time. Of the
+ * queries, one of \ref CPUTIME_SAMPLE per thread is measured and the total
+ * is estimated from the sample, so the shared query counter is updated
+ * rarely even for a busy zone.
+ *
+ * The counters are reference counted, a reloaded zone shares them with the
+ * zone it replaces, which may still be running an event.
+ *
+ * \addtogroup zone
+ * @{
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "knot/events/events.h"
+
+/*! \brief One of this many queries of a thread is measured. */
+#define CPUTIME_SAMPLE	64
+
+struct zone_cputime;
+typedef struct zone_cputime zone_cputime_t;
+
+/*! \brief Summed CPU time of a zone, in nanoseconds. */
+typedef struct {
+	uint64_t query_ns;                      /*!< Estimated for all queries. */
+	uint64_t event_ns[ZONE_EVENT_COUNT];    /*!< Per event type. */
+	uint64_t event_count[ZONE_EVENT_COUNT]; /*!< Executed events. */
+} zone_cputime_stats_t;
+
+/*!
+ * \brief Create zeroed counters.
+ */
+zone_cputime_t *zone_cputime_new(void);
+
+/*!
+ * \brief Get another reference to the counters.
+ *
+ * \return The same counters.
+ */
+zone_cputime_t *zone_cputime_ref(zone_cputime_t *cputime);
+
+/*!
+ * \brief Release a reference, free the counters with the last one.
+ */
+void zone_cputime_free(zone_cputime_t *cputime);
+
+/*!
+ * \brief Get the CPU time consumed by the calling thread (nanoseconds).
+ */
+uint64_t zone_cputime_now(void);
+
+/*!
+ * \brief Start the measurement of a query, if sampled.
+ *
+ * \return Thread CPU time or 0 if the query is not measured.
+ */
+uint64_t zone_cputime_query_begin(void);
+
+/*!
+ * \brief Charge the query measured since \a begin to the zone.
+ *
+ * \param cputime  Zone counters (may be NULL).
+ * \param begin    Value returned by \ref zone_cputime_query_begin.
+ */
+void zone_cputime_query_end(zone_cputime_t *cputime, uint64_t begin);
+
+/*!
+ * \brief Charge an executed zone event.
+ *
+ * \param cputime  Zone counters (may be NULL).
+ * \param type     Event type.
+ * \param ns       CPU time of the event.
+ */
+void zone_cputime_event(zone_cputime_t *cputime, zone_event_type_t type,
+                        uint64_t ns);
+
+/*!
+ * \brief Sum up the counters.
+ *
+ * \param cputime  Zone counters.
+ * \param stats    Output statistics.
+ */
+void zone_cputime_get(const zone_cputime_t *cputime, zone_cputime_stats_t *stats);
+
+/*! @} */
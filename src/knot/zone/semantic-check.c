@@ -57,6 +57,8 @@ static const char *zonechecks_error_messages[(-ZC_ERR_UNKNOWN) + 1] = {
 	"signed RRSIG",
 	[-ZC_ERR_RRSIG_TTL] =
 	"wrong RRSIG TTL",
+	[-ZC_ERR_RRSIG_INVALID] =
+	"no valid RRSIG",
 
 	[-ZC_ERR_NO_NSEC] =
 	"missing NSEC",
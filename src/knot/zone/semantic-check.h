@@ -51,6 +51,7 @@ enum zonechecks_errors {
 	ZC_ERR_RRSIG_NO_RRSIG,
 	ZC_ERR_RRSIG_SIGNED,
 	ZC_ERR_RRSIG_TTL,
+	ZC_ERR_RRSIG_INVALID,
 
 	ZC_ERR_RRSIG_GENERAL_ERROR, /* RRSIG error delimiter. */
 
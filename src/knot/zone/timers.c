@@ -195,110 +195,134 @@ int read_zone_timers(knot_db_t *timer_db, const zone_t *zone, time_t *timers)
 	return KNOT_EOK;
 }
 
-int write_timer_db(knot_db_t *timer_db, knot_zonedb_t *zone_db)
+/*!
+ * \brief Run a write transaction, retry with a grown database if it's full.
+ */
+static int timers_write(knot_db_t *timer_db,
+                        int (*write_cb)(knot_db_txn_t *, void *),
+                        void *ctx)
 {
-	if (timer_db == NULL) {
-		return KNOT_EOK;
-	}
-
-	if (zone_db == NULL) {
-		return KNOT_EINVAL;
-	}
-
 	const knot_db_api_t *db_api = knot_db_lmdb_api();
 	assert(db_api);
 
-	knot_db_txn_t txn;
-	int ret = db_api->txn_begin(timer_db, &txn, KNOT_DB_SORTED);
-	if (ret != KNOT_EOK) {
-		return ret;
-	}
+	int ret;
+	do {
+		knot_db_txn_t txn;
+		ret = db_api->txn_begin(timer_db, &txn, KNOT_DB_SORTED);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+
+		ret = write_cb(&txn, ctx);
+		if (ret != KNOT_EOK) {
+			db_api->txn_abort(&txn);
+		} else {
+			ret = db_api->txn_commit(&txn);
+		}
+	} while (ret == KNOT_ESPACE && knot_db_lmdb_grow(timer_db) == KNOT_EOK);
+
+	return ret;
+}
+
+static int write_timers(knot_db_txn_t *txn, void *ctx)
+{
+	knot_zonedb_t *zone_db = ctx;
 
-	knot_zonedb_foreach(zone_db, store_timers, &txn);
+	knot_zonedb_iter_t it;
+	knot_zonedb_iter_begin(zone_db, &it);
+	while (!knot_zonedb_iter_finished(&it)) {
+		int ret = store_timers((zone_t *)knot_zonedb_iter_val(&it), txn);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+		knot_zonedb_iter_next(&it);
+	}
 
-	return db_api->txn_commit(&txn);
+	return KNOT_EOK;
 }
 
-int remove_timer_db(knot_db_t *timer_db, knot_zonedb_t *zone_db,
-                    const knot_dname_t *zone_name)
+int write_timer_db(knot_db_t *timer_db, knot_zonedb_t *zone_db)
 {
 	if (timer_db == NULL) {
 		return KNOT_EOK;
 	}
 
-	if (zone_db == NULL || zone_name == NULL) {
+	if (zone_db == NULL) {
 		return KNOT_EINVAL;
 	}
 
-	const knot_db_api_t *db_api = knot_db_lmdb_api();
-	assert(db_api);
+	return timers_write(timer_db, write_timers, zone_db);
+}
 
-	knot_db_txn_t txn;
-	int ret = db_api->txn_begin(timer_db, &txn, KNOT_DB_SORTED);
-	if (ret != KNOT_EOK) {
-		return ret;
-	}
+static int remove_timers(knot_db_txn_t *txn, void *ctx)
+{
+	const knot_dname_t *zone_name = ctx;
 
 	knot_db_val_t key = {
 		.data = (void *)zone_name,
 		.len = knot_dname_size(zone_name)
 	};
 
-	ret = db_api->del(&txn, &key);
-	if (ret != KNOT_EOK) {
-		db_api->txn_abort(&txn);
-		return ret;
-	}
-
-	return db_api->txn_commit(&txn);
+	return knot_db_lmdb_api()->del(txn, &key);
 }
 
-int sweep_timer_db(knot_db_t *timer_db, knot_zonedb_t *zone_db)
+int remove_timer_db(knot_db_t *timer_db, knot_zonedb_t *zone_db,
+                    const knot_dname_t *zone_name)
 {
 	if (timer_db == NULL) {
 		return KNOT_EOK;
 	}
 
-	if (zone_db == NULL) {
+	if (zone_db == NULL || zone_name == NULL) {
 		return KNOT_EINVAL;
 	}
 
-	const knot_db_api_t *db_api = knot_db_lmdb_api();
-	assert(db_api);
+	return timers_write(timer_db, remove_timers, (void *)zone_name);
+}
 
-	knot_db_txn_t txn;
-	int ret = db_api->txn_begin(timer_db, &txn, KNOT_DB_SORTED);
-	if (ret != KNOT_EOK) {
-		return ret;
-	}
+static int sweep_timers(knot_db_txn_t *txn, void *ctx)
+{
+	knot_zonedb_t *zone_db = ctx;
+	const knot_db_api_t *db_api = knot_db_lmdb_api();
 
-	if (db_api->count(&txn) == 0) {
-		db_api->txn_abort(&txn);
+	if (db_api->count(txn) == 0) {
 		return KNOT_EOK;
 	}
 
-	knot_db_iter_t *it = db_api->iter_begin(&txn, 0);
+	knot_db_iter_t *it = db_api->iter_begin(txn, 0);
 	if (it == NULL) {
-		db_api->txn_abort(&txn);
 		return KNOT_ERROR;
 	}
 
 	while (it) {
 		knot_db_val_t key;
-		ret = db_api->iter_key(it, &key);
+		int ret = db_api->iter_key(it, &key);
 		if (ret != KNOT_EOK) {
-			db_api->txn_abort(&txn);
+			db_api->iter_finish(it);
 			return ret;
 		}
 		const knot_dname_t *dbkey = (const knot_dname_t *)key.data;
 		if (!knot_zonedb_find(zone_db, dbkey)) {
 			// Delete obsolete timers
-			db_api->del(&txn, &key);
+			db_api->del(txn, &key);
 		}
 
 		it = db_api->iter_next(it);
 	}
 	db_api->iter_finish(it);
 
-	return db_api->txn_commit(&txn);
+	return KNOT_EOK;
+}
+
+int sweep_timer_db(knot_db_t *timer_db, knot_zonedb_t *zone_db)
+{
+	if (timer_db == NULL) {
+		return KNOT_EOK;
+	}
+
+	if (zone_db == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	return timers_write(timer_db, sweep_timers, zone_db);
 }
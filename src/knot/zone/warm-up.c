@@ -0,0 +1,164 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/zone/warm-up.h"
+#include "libknot/consts.h"
+#include "libknot/errcode.h"
+#include "libknot/rdataset.h"
+
+/*! \brief Stride of the memory reads, a cache line. */
+#define WARM_UP_STRIDE	64
+
+struct zone_hot {
+	volatile unsigned next;
+	uint8_t names[WARM_UP_NAMES][KNOT_DNAME_MAXLEN];
+};
+
+zone_hot_t *zone_hot_new(void)
+{
+	return calloc(1, sizeof(zone_hot_t));
+}
+
+void zone_hot_free(zone_hot_t *hot)
+{
+	free(hot);
+}
+
+void zone_hot_record(zone_hot_t *hot, const knot_dname_t *name)
+{
+	static __thread unsigned queries = 0;
+
+	if (hot == NULL || name == NULL || ++queries % WARM_UP_SAMPLE != 0) {
+		return;
+	}
+
+	unsigned slot = __sync_fetch_and_add(&hot->next, 1) % WARM_UP_NAMES;
+	memcpy(hot->names[slot], name, knot_dname_size(name));
+}
+
+/*! \brief Read one byte of each cache line of the memory block. */
+static void touch(const void *mem, size_t len)
+{
+	const volatile uint8_t *data = mem;
+	for (size_t i = 0; i < len; i += WARM_UP_STRIDE) {
+		(void)data[i];
+	}
+	if (len > 0) {
+		(void)data[len - 1];
+	}
+}
+
+static void touch_node(const zone_node_t *node)
+{
+	if (node == NULL) {
+		return;
+	}
+
+	touch(node, sizeof(*node));
+	touch(node->owner, knot_dname_size(node->owner));
+	touch(node->rrs, node->rrset_count * sizeof(struct rr_data));
+	for (uint16_t i = 0; i < node->rrset_count; i++) {
+		const struct rr_data *data = &node->rrs[i];
+		touch(data->rrs.data, knot_rdataset_size(&data->rrs));
+		if (data->additional != NULL) {
+			touch(data->additional->glues,
+			      data->additional->count * sizeof(glue_t));
+		}
+	}
+}
+
+static int touch_cb(zone_node_t *node, void *data)
+{
+	touch_node(node);
+
+	return KNOT_EOK;
+}
+
+/*! \brief Resolve the name as a query would, read the answer nodes. */
+static bool touch_name(const zone_contents_t *contents, const knot_dname_t *name)
+{
+	const zone_node_t *match = NULL, *closest = NULL, *previous = NULL;
+	int ret = zone_contents_find_dname(contents, name, &match, &closest,
+	                                   &previous);
+	if (ret < 0) {
+		return false;
+	}
+
+	/* Closest encloser and its denial of existence. */
+	if (match == NULL) {
+		touch_node(closest);
+		touch_node(previous);
+		if (closest != NULL) {
+			touch_node(closest->nsec3_node);
+		}
+		return true;
+	}
+
+	/* Answer and additional records. */
+	touch_node(match);
+	for (uint16_t i = 0; i < match->rrset_count; i++) {
+		const additional_t *additional = match->rrs[i].additional;
+		if (additional == NULL) {
+			continue;
+		}
+		for (uint16_t j = 0; j < additional->count; j++) {
+			touch_node(additional->glues[j].node);
+		}
+	}
+
+	return true;
+}
+
+size_t zone_warm_up(zone_contents_t *contents, const zone_hot_t *hot, bool full)
+{
+	if (contents == NULL) {
+		return 0;
+	}
+
+	/* Walk the whole contents, the recent names are read last. */
+	if (full) {
+		(void)zone_contents_apply(contents, touch_cb, NULL);
+		(void)zone_contents_nsec3_apply(contents, touch_cb, NULL);
+	}
+
+	touch_node(contents->apex);
+
+	if (hot == NULL) {
+		return 0;
+	}
+
+	size_t resolved = 0;
+	for (unsigned i = 0; i < WARM_UP_NAMES; i++) {
+		/* The slot can be rewritten meanwhile, work on a copy. */
+		uint8_t name[KNOT_DNAME_MAXLEN];
+		memcpy(name, hot->names[i], sizeof(name));
+		if (name[0] == 0 ||
+		    knot_dname_wire_check(name, name + sizeof(name), NULL) <= 0 ||
+		    knot_dname_to_lower(name) != KNOT_EOK) {
+			continue;
+		}
+
+		if (touch_name(contents, name)) {
+			resolved++;
+		}
+	}
+
+	return resolved;
+}
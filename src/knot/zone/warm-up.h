@@ -0,0 +1,80 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*!
+ * \file
+ *
+ * \brief Cache warm-up of new zone contents.
+ *
+ * A sample of the names queried in the zone is kept in a small ring. Before
+ * new contents are published, these names are resolved in them through the
+ * regular lookup and the data of the found nodes are read, so the first
+ * queries after the switch don't start from cold memory. Optionally, all
+ * nodes of the new contents are walked first.
+ *
+ * \addtogroup zone
+ * @{
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "knot/zone/contents.h"
+#include "libknot/dname.h"
+
+/*! \brief Number of recent names kept per zone. */
+#define WARM_UP_NAMES	64
+
+/*! \brief One of this many queries of a worker thread is sampled. */
+#define WARM_UP_SAMPLE	16
+
+struct zone_hot;
+typedef struct zone_hot zone_hot_t;
+
+/*!
+ * \brief Create an empty ring of recent names.
+ */
+zone_hot_t *zone_hot_new(void);
+
+/*!
+ * \brief Free the ring.
+ */
+void zone_hot_free(zone_hot_t *hot);
+
+/*!
+ * \brief Sample a queried name.
+ *
+ * Lock-free, may be called from any number of threads. A name overwritten
+ * while being read is discarded or just resolved wrong by the warm-up.
+ *
+ * \param hot   Ring of recent names (may be NULL).
+ * \param name  Queried name.
+ */
+void zone_hot_record(zone_hot_t *hot, const knot_dname_t *name);
+
+/*!
+ * \brief Warm up unpublished zone contents.
+ *
+ * \param contents  Contents about to be published.
+ * \param hot       Ring of recent names (may be NULL).
+ * \param full      Walk all nodes of the contents first.
+ *
+ * \return Number of recent names resolved in the contents.
+ */
+size_t zone_warm_up(zone_contents_t *contents, const zone_hot_t *hot, bool full);
+
+/*! @} */
@@ -166,7 +166,8 @@ int zone_load_post(conf_t *conf, zone_t *zone, zone_contents_t *contents,
 	val = conf_zone_get(conf, C_IXFR_DIFF, zone->name);
 	bool build_diffs = conf_bool(&val);
 	if (dnssec_enable) {
-		ret = knot_dnssec_zone_sign(contents, &change, 0, dnssec_refresh);
+		ret = knot_dnssec_zone_sign(contents, &change, 0, dnssec_refresh,
+		                            zone->rrsig_cache);
 		if (ret != KNOT_EOK) {
 			changeset_clear(&change);
 			return ret;
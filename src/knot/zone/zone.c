@@ -23,6 +23,7 @@
 #include "knot/nameserver/process_query.h"
 #include "knot/query/requestor.h"
 #include "knot/updates/zone-update.h"
+#include "knot/zone/catalog.h"
 #include "knot/zone/contents.h"
 #include "knot/zone/serial.h"
 #include "knot/zone/zone.h"
@@ -58,6 +59,21 @@ zone_t* zone_new(const knot_dname_t *name)
 		return NULL;
 	}
 
+	zone->rrsig_cache = rrsig_cache_new();
+	if (zone->rrsig_cache == NULL) {
+		knot_dname_free(&zone->name, NULL);
+		free(zone);
+		return NULL;
+	}
+
+	zone->cputime = zone_cputime_new();
+	if (zone->cputime == NULL) {
+		rrsig_cache_free(zone->rrsig_cache);
+		knot_dname_free(&zone->name, NULL);
+		free(zone);
+		return NULL;
+	}
+
 	// DDNS
 	pthread_mutex_init(&zone->ddns_lock, NULL);
 	zone->ddns_queue_size = 0;
@@ -100,6 +116,8 @@ void zone_free(zone_t **zone_ptr)
 	zone_events_deinit(zone);
 
 	knot_dname_free(&zone->name, NULL);
+	knot_dname_free(&zone->alias_of, NULL);
+	knot_dname_free(&zone->catalog, NULL);
 
 	free_ddns_queue(zone);
 	pthread_mutex_destroy(&zone->ddns_lock);
@@ -115,6 +133,10 @@ void zone_free(zone_t **zone_ptr)
 	/* Free zone contents. */
 	zone_contents_deep_free(&zone->contents);
 
+	rrsig_cache_free(zone->rrsig_cache);
+	zone_hot_free(zone->hot);
+	zone_cputime_free(zone->cputime);
+
 	conf_deactivate_modules(&zone->query_modules, &zone->query_plan);
 
 	free(zone);
@@ -178,16 +200,103 @@ int zone_changes_store(conf_t *conf, zone_t *zone, list_t *chgs)
 	return ret;
 }
 
-zone_contents_t *zone_switch_contents(zone_t *zone, zone_contents_t *new_contents)
+static zone_contents_t *switch_contents(zone_t *zone, zone_contents_t *new_contents)
 {
-	if (zone == NULL) {
-		return NULL;
+	/* Queries must not start from cold memory after the switch. */
+	if ((zone->flags & ZONE_WARM_UP) && new_contents != NULL) {
+		zone_warm_up(new_contents, zone->hot, zone->flags & ZONE_WARM_UP_FULL);
 	}
 
+	pthread_mutex_lock(&zone->events.mx);
+
 	zone_contents_t *old_contents;
 	zone_contents_t **current_contents = &zone->contents;
 	old_contents = rcu_xchg_pointer(current_contents, new_contents);
 
+	/* Zones replacing this one on reload share the contents. */
+	zone_events_t *locked = &zone->events;
+	for (zone_t *next = locked->successor; next != NULL;
+	     next = next->events.successor) {
+		pthread_mutex_lock(&next->events.mx);
+		pthread_mutex_unlock(&locked->mx);
+		locked = &next->events;
+		rcu_assign_pointer(next->contents, new_contents);
+	}
+
+	pthread_mutex_unlock(&locked->mx);
+
+	return old_contents;
+}
+
+/*! \brief Check if the member zones are to be updated after the switch. */
+static bool catalog_switched(zone_t *zone, zone_contents_t *new_contents)
+{
+	/* Members of an expired catalog are retained. */
+	return (zone->flags & ZONE_CATALOG) && zone->catalog_upd != NULL &&
+	       new_contents != NULL;
+}
+
+static void catalog_apply(zone_t *zone, int ret)
+{
+	if (ret != KNOT_EOK) {
+		log_zone_error(zone->name, "catalog, failed to read member zones (%s)",
+		               knot_strerror(ret));
+		return;
+	}
+
+	catalog_update_apply(zone->catalog_upd);
+}
+
+zone_contents_t *zone_switch_contents(zone_t *zone, zone_contents_t *new_contents)
+{
+	if (zone == NULL) {
+		return NULL;
+	}
+
+	zone_contents_t *old_contents = switch_contents(zone, new_contents);
+
+	if (catalog_switched(zone, new_contents)) {
+		int ret = catalog_update_contents(zone->catalog_upd, zone->name,
+		                                  old_contents, new_contents);
+		catalog_apply(zone, ret);
+	}
+
+	return old_contents;
+}
+
+zone_contents_t *zone_switch_changes(zone_t *zone, zone_contents_t *new_contents,
+                                     list_t *changes)
+{
+	if (zone == NULL || changes == NULL) {
+		return NULL;
+	}
+
+	zone_contents_t *old_contents = switch_contents(zone, new_contents);
+
+	if (catalog_switched(zone, new_contents)) {
+		int ret = catalog_update_changes(zone->catalog_upd, zone->name,
+		                                 changes, new_contents);
+		catalog_apply(zone, ret);
+	}
+
+	return old_contents;
+}
+
+zone_contents_t *zone_switch_change(zone_t *zone, zone_contents_t *new_contents,
+                                    changeset_t *change)
+{
+	if (zone == NULL || change == NULL) {
+		return NULL;
+	}
+
+	list_t changes;
+	init_list(&changes);
+	add_tail(&changes, &change->n);
+
+	zone_contents_t *old_contents = zone_switch_changes(zone, new_contents,
+	                                                    &changes);
+	rem_node(&change->n);
+
 	return old_contents;
 }
 
@@ -31,8 +31,12 @@
 #include "knot/conf/conf.h"
 #include "knot/conf/confio.h"
 #include "knot/server/journal.h"
+#include "knot/dnssec/rrsig-cache.h"
 #include "knot/events/events.h"
+#include "knot/zone/catalog.h"
 #include "knot/zone/contents.h"
+#include "knot/zone/cputime.h"
+#include "knot/zone/warm-up.h"
 #include "libknot/dname.h"
 #include "libknot/packet/pkt.h"
 
@@ -47,6 +51,9 @@ typedef enum zone_flag_t {
 	ZONE_FORCE_RESIGN = 1 << 1, /* Force zone resign. */
 	ZONE_FORCE_FLUSH  = 1 << 2, /* Force zone flush. */
 	ZONE_EXPIRED      = 1 << 3, /* Zone is expired. */
+	ZONE_CATALOG      = 1 << 4, /* Zone is a catalog of member zones. */
+	ZONE_WARM_UP      = 1 << 5, /* Warm up new contents before publication. */
+	ZONE_WARM_UP_FULL = 1 << 6, /* Warm up all nodes of new contents. */
 } zone_flag_t;
 
 /*!
@@ -58,6 +65,15 @@ typedef struct zone
 	zone_contents_t *contents;
 	zone_flag_t flags;
 
+	/*! \brief Zone answered from (if this zone is an alias), or NULL. */
+	knot_dname_t *alias_of;
+
+	/*! \brief Catalog zone listing this zone as a member, or NULL. */
+	knot_dname_t *catalog;
+
+	/*! \brief Server member zone changes, if this zone is a catalog. */
+	catalog_update_t *catalog_upd;
+
 	/*! \brief Dynamic configuration zone change type. */
 	conf_io_type_t change_type;
 
@@ -88,6 +104,15 @@ typedef struct zone
 	/*! \brief Preferred master for remote operation. */
 	struct sockaddr_storage *preferred_master;
 
+	/*! \brief Signatures made or verified by the signer. */
+	rrsig_cache_t *rrsig_cache;
+
+	/*! \brief Recently queried names, for the warm-up of new contents. */
+	zone_hot_t *hot;
+
+	/*! \brief CPU time spent on queries and events. */
+	zone_cputime_t *cputime;
+
 	/*! \brief Query modules. */
 	list_t query_modules;
 	struct query_plan *query_plan;
@@ -127,9 +152,22 @@ int zone_changes_store(conf_t *conf, zone_t *zone, list_t *chgs);
 int zone_change_store(conf_t *conf, zone_t *zone, changeset_t *change);
 /*!
  * \brief Atomically switch the content of the zone.
+ *
+ * Member zones of a catalog are updated according to the difference of the
+ * old and new catalog contents.
  */
 zone_contents_t *zone_switch_contents(zone_t *zone, zone_contents_t *new_contents);
 
+/*!
+ * \brief Atomically switch the content of the zone changed by changesets.
+ *
+ * Member zones of a catalog are updated according to the changesets only.
+ */
+zone_contents_t *zone_switch_changes(zone_t *zone, zone_contents_t *new_contents,
+                                     list_t *changes);
+zone_contents_t *zone_switch_change(zone_t *zone, zone_contents_t *new_contents,
+                                    changeset_t *change);
+
 /*! \brief Checks if the zone is slave. */
 bool zone_is_slave(conf_t *conf, const zone_t *zone);
 
@@ -18,6 +18,7 @@
 #include <urcu.h>
 
 #include "knot/conf/confio.h"
+#include "knot/zone/catalog.h"
 #include "knot/zone/zonedb-load.h"
 #include "knot/zone/zone-load.h"
 #include "knot/zone/zone.h"
@@ -116,7 +117,7 @@ static zone_t *create_zone_from(const knot_dname_t *name, server_t *server)
 	}
 
 	int result = zone_events_setup(zone, server->workers, &server->sched,
-	                               server->timers_db);
+	                               server->timers_db, &server->mempressure);
 	if (result != KNOT_EOK) {
 		zone_free(&zone);
 		return NULL;
@@ -132,9 +133,23 @@ static zone_t *create_zone_reload(conf_t *conf, const knot_dname_t *name,
 	if (!zone) {
 		return NULL;
 	}
-	zone->contents = old_zone->contents;
+	/* Share the contents, hold the new zone's events off. */
+	zone_events_handover(old_zone, zone);
 	zone->bootstrap_retry = old_zone->bootstrap_retry;
 
+	/* Keep known signatures, the old zone gets the empty cache. */
+	rrsig_cache_t *rrsig_cache = zone->rrsig_cache;
+	zone->rrsig_cache = old_zone->rrsig_cache;
+	old_zone->rrsig_cache = rrsig_cache;
+
+	/* Share the CPU time counters, events may still run on the old zone. */
+	zone_cputime_free(zone->cputime);
+	zone->cputime = zone_cputime_ref(old_zone->cputime);
+
+	/* Keep the recent names, the old zone stops sampling. */
+	zone->hot = old_zone->hot;
+	old_zone->hot = NULL;
+
 	zone_status_t zstatus;
 	if (zone_is_slave(conf, zone) && old_zone->flags & ZONE_EXPIRED) {
 		zone->flags |= ZONE_EXPIRED;
@@ -246,6 +261,42 @@ static zone_t *create_zone_new(conf_t *conf, const knot_dname_t *name,
 	return zone;
 }
 
+static zone_t *create_zone_alias(conf_t *conf, const knot_dname_t *name,
+                                 server_t *server, zone_t *old_zone)
+{
+	zone_t *zone = create_zone_from(name, server);
+	if (!zone) {
+		return NULL;
+	}
+
+	conf_val_t val = conf_zone_get(conf, C_ALIAS_OF, name);
+	zone->alias_of = knot_dname_copy(conf_dname(&val), NULL);
+	if (zone->alias_of == NULL) {
+		zone_free(&zone);
+		return NULL;
+	}
+
+	char alias_str[KNOT_DNAME_TXT_MAXLEN + 1] = "";
+	(void)knot_dname_to_str(alias_str, zone->alias_of, sizeof(alias_str));
+
+	if (!conf_rawid_exists(conf, C_ZONE, zone->alias_of,
+	                       knot_dname_size(zone->alias_of))) {
+		log_zone_error(zone->name, "aliased zone %s does not exist",
+		               alias_str);
+		zone_free(&zone);
+		return NULL;
+	}
+
+	if (old_zone != NULL && old_zone->control_update != NULL) {
+		log_zone_warning(old_zone->name, "control transaction aborted");
+		zone_control_clear(old_zone);
+	}
+
+	log_zone_info(zone->name, "zone is an alias of %s", alias_str);
+
+	return zone;
+}
+
 /*!
  * \brief Load or reload the zone.
  *
@@ -262,11 +313,180 @@ static zone_t *create_zone(conf_t *conf, const knot_dname_t *name, server_t *ser
 	assert(name);
 	assert(server);
 
-	if (old_zone) {
-		return create_zone_reload(conf, name, server, old_zone);
+	conf_val_t alias = conf_zone_get(conf, C_ALIAS_OF, name);
+	if (alias.code == KNOT_EOK) {
+		return create_zone_alias(conf, name, server, old_zone);
+	}
+
+	zone_t *zone = NULL;
+	if (old_zone && old_zone->alias_of == NULL) {
+		zone = create_zone_reload(conf, name, server, old_zone);
 	} else {
-		return create_zone_new(conf, name, server);
+		zone = create_zone_new(conf, name, server);
+	}
+	if (zone == NULL) {
+		return NULL;
+	}
+
+	conf_val_t val = conf_zone_get(conf, C_WARM_UP, name);
+	switch (conf_opt(&val)) {
+	case WARM_UP_FULL:
+		zone->flags |= ZONE_WARM_UP_FULL;
+		// FALLTHROUGH
+	case WARM_UP_HOT:
+		zone->flags |= ZONE_WARM_UP;
+		break;
+	default:
+		break;
+	}
+
+	/* Without the recent names, only the full walk is done. */
+	if ((zone->flags & ZONE_WARM_UP) && zone->hot == NULL) {
+		zone->hot = zone_hot_new();
 	}
+
+	return zone;
+}
+
+/*! \brief Check if the zone is configured explicitly (not a catalog member). */
+static bool zone_configured(conf_t *conf, const knot_dname_t *name)
+{
+	return conf_rawid_exists(conf, C_ZONE, name, knot_dname_size(name));
+}
+
+static zone_t *create_member(conf_t *conf, const knot_dname_t *name,
+                             const knot_dname_t *catalog, server_t *server,
+                             zone_t *old_zone)
+{
+	/* Can't fail after the old zone is handed over. */
+	knot_dname_t *catalog_copy = knot_dname_copy(catalog, NULL);
+	if (catalog_copy == NULL) {
+		return NULL;
+	}
+
+	zone_t *zone = create_zone(conf, name, server, old_zone);
+	if (zone == NULL) {
+		knot_dname_free(&catalog_copy, NULL);
+		return NULL;
+	}
+
+	zone->catalog = catalog_copy;
+
+	conf_activate_modules(conf, zone->name, &zone->query_modules,
+	                      &zone->query_plan);
+
+	return zone;
+}
+
+/*! \brief Add catalog members to the output trie, first catalog wins. */
+static int add_catalog_members(conf_t *conf, const zone_t *catalog,
+                               hattrie_t *members)
+{
+	hattrie_t *listed = hattrie_create(NULL);
+	if (listed == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	rcu_read_lock();
+	int ret = catalog_members(catalog->contents, listed);
+	rcu_read_unlock();
+
+	hattrie_iter_t *it = hattrie_iter_begin(listed);
+	for (; ret == KNOT_EOK && !hattrie_iter_finished(it); hattrie_iter_next(it)) {
+		size_t len = 0;
+		const char *name = hattrie_iter_key(it, &len);
+
+		/* Explicit zone configuration takes precedence. */
+		if (zone_configured(conf, (const knot_dname_t *)name)) {
+			continue;
+		}
+
+		value_t *val = hattrie_get(members, name, len);
+		if (val == NULL) {
+			ret = KNOT_ENOMEM;
+		} else if (*val == NULL) {
+			*val = catalog->name;
+		}
+	}
+	hattrie_iter_free(it);
+	hattrie_free(listed);
+
+	return ret;
+}
+
+/*!
+ * \brief Get member zones of all catalog zones in the database.
+ *
+ * Members of a catalog without contents (not loaded yet or expired) are
+ * retained from the database as there is no up-to-date member list.
+ *
+ * \param conf  Configuration.
+ * \param db    Zone database with the catalog zones.
+ *
+ * \return Trie of member names with catalog names as values, or NULL.
+ */
+static hattrie_t *catalog_members_all(conf_t *conf, knot_zonedb_t *db)
+{
+	hattrie_t *members = hattrie_create(NULL);
+	if (members == NULL) {
+		return NULL;
+	}
+
+	bool unavailable = false;
+	for (conf_iter_t iter = conf_iter(conf, C_ZONE); iter.code == KNOT_EOK;
+	     conf_iter_next(conf, &iter)) {
+		conf_val_t id = conf_iter_id(conf, &iter);
+		const knot_dname_t *name = conf_dname(&id);
+
+		conf_val_t val = conf_zone_get(conf, C_CATALOG, name);
+		zone_t *catalog = knot_zonedb_find(db, name);
+		if (!conf_bool(&val) || catalog == NULL) {
+			continue;
+		}
+
+		if (catalog->contents == NULL) {
+			unavailable = true;
+			continue;
+		}
+
+		int ret = add_catalog_members(conf, catalog, members);
+		if (ret != KNOT_EOK) {
+			log_zone_error(name, "catalog, failed to read member zones (%s)",
+			               knot_strerror(ret));
+			hattrie_free(members);
+			return NULL;
+		}
+	}
+
+	if (!unavailable) {
+		return members;
+	}
+
+	knot_zonedb_iter_t it;
+	knot_zonedb_iter_begin(db, &it);
+	for (; !knot_zonedb_iter_finished(&it); knot_zonedb_iter_next(&it)) {
+		zone_t *zone = knot_zonedb_iter_val(&it);
+		if (zone->catalog == NULL || zone_configured(conf, zone->name)) {
+			continue;
+		}
+
+		zone_t *catalog = knot_zonedb_find(db, zone->catalog);
+		if (catalog == NULL || catalog->contents != NULL ||
+		    !zone_configured(conf, catalog->name)) {
+			continue;
+		}
+
+		value_t *val = hattrie_get(members, (char *)zone->name,
+		                           knot_dname_size(zone->name));
+		if (val == NULL) {
+			hattrie_free(members);
+			return NULL;
+		} else if (*val == NULL) {
+			*val = catalog->name;
+		}
+	}
+
+	return members;
 }
 
 static void mark_changed_zones(knot_zonedb_t *zonedb, hattrie_t *changed)
@@ -307,8 +527,17 @@ static knot_zonedb_t *create_zonedb(conf_t *conf, server_t *server)
 	assert(server);
 
 	knot_zonedb_t *db_old = server->zone_db;
-	knot_zonedb_t *db_new = knot_zonedb_new(conf_id_count(conf, C_ZONE));
+
+	/* Catalog contents is reused, so are the member lists. */
+	hattrie_t *members = catalog_members_all(conf, db_old);
+	if (members == NULL) {
+		return NULL;
+	}
+
+	size_t count = conf_id_count(conf, C_ZONE) + hattrie_weight(members);
+	knot_zonedb_t *db_new = knot_zonedb_new(count);
 	if (!db_new) {
+		hattrie_free(members);
 		return NULL;
 	}
 
@@ -340,12 +569,43 @@ static knot_zonedb_t *create_zonedb(conf_t *conf, server_t *server)
 			continue;
 		}
 
+		conf_val_t val = conf_zone_get(conf, C_CATALOG, name);
+		if (conf_bool(&val)) {
+			zone->flags |= ZONE_CATALOG;
+			zone->catalog_upd = &server->catalog_upd;
+		}
+
 		conf_activate_modules(conf, zone->name, &zone->query_modules,
 		                      &zone->query_plan);
 
 		knot_zonedb_insert(db_new, zone);
 	}
 
+	hattrie_iter_t *it = hattrie_iter_begin(members);
+	for (; !hattrie_iter_finished(it); hattrie_iter_next(it)) {
+		const knot_dname_t *name =
+			(const knot_dname_t *)hattrie_iter_key(it, NULL);
+		const knot_dname_t *catalog = *hattrie_iter_val(it);
+
+		zone_t *old_zone = knot_zonedb_find(db_old, name);
+		if (old_zone != NULL && old_zone->catalog != NULL && !full) {
+			/* Reuse unchanged member zone. */
+			knot_zonedb_insert(db_new, old_zone);
+			continue;
+		}
+
+		zone_t *zone = create_member(conf, name, catalog, server,
+		                             full ? old_zone : NULL);
+		if (zone == NULL) {
+			log_zone_error(name, "catalog, member zone cannot be created");
+			continue;
+		}
+
+		knot_zonedb_insert(db_new, zone);
+	}
+	hattrie_iter_free(it);
+	hattrie_free(members);
+
 	return db_new;
 }
 
@@ -354,6 +614,7 @@ static knot_zonedb_t *create_zonedb(conf_t *conf, server_t *server)
  *
  * \note Zone content may be preserved in the new zone database, in this case
  *       new and old zone share the contents. Shared content is not freed.
+ *       Zones with a running event are freed when the event finishes.
  *
  * \param conf    New server configuration.
  * \param db_old  Old zone database to remove.
@@ -369,38 +630,34 @@ static void remove_old_zonedb(conf_t *conf, knot_zonedb_t *db_old,
 	bool full = !(conf->io.flags & CONF_IO_FACTIVE) ||
 	            (conf->io.flags & CONF_IO_FRLD_ZONES);
 
+	if (full) {
+		knot_zonedb_retire(&db_old);
+		return;
+	}
+
 	knot_zonedb_iter_t it;
 	knot_zonedb_iter_begin(db_old, &it);
 
 	while (!knot_zonedb_iter_finished(&it)) {
 		zone_t *zone = knot_zonedb_iter_val(&it);
 
-		if (full) {
-			/* Check if reloaded (reused contents). */
-			if (knot_zonedb_find(db_new, zone->name)) {
-				zone->contents = NULL;
-			}
-			/* Completely new zone. */
-		} else {
-			/* Check if reloaded (reused contents). */
-			if (zone->change_type & CONF_IO_TRELOAD) {
-				zone->contents = NULL;
-				zone_free(&zone);
-			/* Check if removed (drop also contents). */
-			} else if (zone->change_type & CONF_IO_TUNSET) {
-				zone_free(&zone);
-			}
-			/* Completely reused zone. */
+		/* Check if reloaded (reused contents). */
+		if (zone->change_type & CONF_IO_TRELOAD) {
+			zone_events_retire(zone);
+		/* Check if removed (drop also contents). */
+		} else if (zone->change_type & CONF_IO_TUNSET) {
+			zone_events_retire(zone);
+		/* Check if catalog member not retained. */
+		} else if (zone->catalog != NULL &&
+		           knot_zonedb_find(db_new, zone->name) != zone) {
+			zone_events_retire(zone);
 		}
+		/* Completely reused zone. */
 
 		knot_zonedb_iter_next(&it);
 	}
 
-	if (full) {
-		knot_zonedb_deep_free(&db_old);
-	} else {
-		knot_zonedb_free(&db_old);
-	}
+	knot_zonedb_free(&db_old);
 }
 
 void zonedb_reload(conf_t *conf, server_t *server)
@@ -432,3 +689,163 @@ void zonedb_reload(conf_t *conf, server_t *server)
 	/* Remove old zone DB. */
 	remove_old_zonedb(conf, db_old, db_new);
 }
+
+/*! \brief Split the catalog update key into the member and catalog names. */
+static const knot_dname_t *update_key(hattrie_iter_t *it, const knot_dname_t **catalog)
+{
+	const knot_dname_t *member = (const knot_dname_t *)hattrie_iter_key(it, NULL);
+	*catalog = member + knot_dname_size(member);
+	return member;
+}
+
+/*! \brief Check if the member zone is unlisted in its catalog. */
+static bool member_removed(zone_t *zone, hattrie_t *rem)
+{
+	if (zone->catalog == NULL) {
+		return false;
+	}
+
+	char key[2 * KNOT_DNAME_MAXLEN];
+	size_t name_len = knot_dname_size(zone->name);
+	size_t catalog_len = knot_dname_size(zone->catalog);
+	memcpy(key, zone->name, name_len);
+	memcpy(key + name_len, zone->catalog, catalog_len);
+
+	return hattrie_tryget(rem, key, name_len + catalog_len) != NULL;
+}
+
+/*! \brief Check if the listed member zone is to be created. */
+static bool member_added(conf_t *conf, knot_zonedb_t *db, const knot_dname_t *name)
+{
+	/* Explicit zone configuration takes precedence. */
+	return knot_zonedb_find(db, name) == NULL && !zone_configured(conf, name);
+}
+
+void zonedb_update_catalogs(conf_t *conf, server_t *server)
+{
+	if (conf == NULL || server == NULL || server->zone_db == NULL) {
+		return;
+	}
+
+	knot_zonedb_t *db_old = server->zone_db;
+	catalog_update_t *upd = &server->catalog_upd;
+
+	/* Count the effective changes, the other zones are left untouched. */
+	size_t added = 0, removed = 0;
+	hattrie_iter_t *it = hattrie_iter_begin(upd->add);
+	for (; !hattrie_iter_finished(it); hattrie_iter_next(it)) {
+		const knot_dname_t *catalog = NULL;
+		const knot_dname_t *name = update_key(it, &catalog);
+		if (member_added(conf, db_old, name)) {
+			added++;
+		}
+	}
+	hattrie_iter_free(it);
+
+	it = hattrie_iter_begin(upd->rem);
+	for (; !hattrie_iter_finished(it); hattrie_iter_next(it)) {
+		const knot_dname_t *catalog = NULL;
+		const knot_dname_t *name = update_key(it, &catalog);
+		zone_t *zone = knot_zonedb_find(db_old, name);
+		if (zone != NULL && member_removed(zone, upd->rem)) {
+			removed++;
+		}
+	}
+	hattrie_iter_free(it);
+
+	if (added == 0 && removed == 0) {
+		catalog_update_clear(upd);
+		return;
+	}
+
+	/* The database is published by RCU, so the zone pointers are copied. */
+	knot_zonedb_t *db_new = knot_zonedb_new(knot_zonedb_size(db_old) + added);
+	if (db_new == NULL) {
+		log_error("catalog, failed to update member zones");
+		return;
+	}
+
+	knot_zonedb_iter_t zit;
+	knot_zonedb_iter_begin(db_old, &zit);
+	for (; !knot_zonedb_iter_finished(&zit); knot_zonedb_iter_next(&zit)) {
+		zone_t *zone = knot_zonedb_iter_val(&zit);
+		knot_zonedb_insert(db_new, zone);
+	}
+
+	/* Drop removed zones. */
+	it = hattrie_iter_begin(upd->rem);
+	for (; removed > 0 && !hattrie_iter_finished(it); hattrie_iter_next(it)) {
+		const knot_dname_t *catalog = NULL;
+		const knot_dname_t *name = update_key(it, &catalog);
+		zone_t *zone = knot_zonedb_find(db_old, name);
+		if (zone != NULL && member_removed(zone, upd->rem)) {
+			/* Prevent emitting of new zone events. */
+			zone_events_freeze(zone);
+			knot_zonedb_del(db_new, name);
+		}
+	}
+	hattrie_iter_free(it);
+
+	/* Create added member zones, also the ones moved to another catalog. */
+	added = 0;
+	it = hattrie_iter_begin(upd->add);
+	for (; !hattrie_iter_finished(it); hattrie_iter_next(it)) {
+		const knot_dname_t *catalog = NULL;
+		const knot_dname_t *name = update_key(it, &catalog);
+		if (!member_added(conf, db_new, name)) {
+			/* Existing, or listed in more catalogs, first one wins. */
+			continue;
+		}
+
+		zone_t *zone = create_member(conf, name, catalog, server, NULL);
+		if (zone == NULL) {
+			log_zone_error(name, "catalog, member zone cannot be created");
+			continue;
+		}
+
+		knot_zonedb_insert(db_new, zone);
+		added++;
+	}
+	hattrie_iter_free(it);
+
+	/* Rebuild zone database search stack. */
+	knot_zonedb_build_index(db_new);
+
+	/* Switch the databases. */
+	knot_zonedb_t **db_current = &server->zone_db;
+	db_old = rcu_xchg_pointer(db_current, db_new);
+
+	/* Wait for readers to finish reading old zone database. */
+	synchronize_rcu();
+
+	/* Allow events on added zones. */
+	it = hattrie_iter_begin(upd->add);
+	for (; !hattrie_iter_finished(it); hattrie_iter_next(it)) {
+		const knot_dname_t *catalog = NULL;
+		const knot_dname_t *name = update_key(it, &catalog);
+		zone_t *zone = knot_zonedb_find(db_new, name);
+		if (zone != NULL && zone != knot_zonedb_find(db_old, name)) {
+			zone_events_start(zone);
+		}
+	}
+	hattrie_iter_free(it);
+
+	/* Free the removed zones, or let their running events finish first. */
+	it = hattrie_iter_begin(upd->rem);
+	for (; removed > 0 && !hattrie_iter_finished(it); hattrie_iter_next(it)) {
+		const knot_dname_t *catalog = NULL;
+		const knot_dname_t *name = update_key(it, &catalog);
+		zone_t *zone = knot_zonedb_find(db_old, name);
+		if (zone != NULL && zone != knot_zonedb_find(db_new, name)) {
+			log_zone_info(zone->name, "catalog, member zone removed");
+			(void)remove_timer_db(server->timers_db, db_new, zone->name);
+			zone_events_retire(zone);
+		}
+	}
+	hattrie_iter_free(it);
+
+	knot_zonedb_free(&db_old);
+	catalog_update_clear(upd);
+
+	log_info("catalog, %zu member zones added, %zu removed", added, removed);
+}
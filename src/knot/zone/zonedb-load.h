@@ -26,3 +26,15 @@
  * \param[in] server Server instance.
  */
 void zonedb_reload(conf_t *conf, server_t *server);
+
+/*!
+ * \brief Add and remove catalog member zones recorded in the server.
+ *
+ * Only the member zones listed or unlisted since the last update are
+ * created or freed, the other zones are kept in the new zone database.
+ * The server catalog update lock must be held.
+ *
+ * \param[in] conf Configuration.
+ * \param[in] server Server instance.
+ */
+void zonedb_update_catalogs(conf_t *conf, server_t *server);
@@ -16,33 +16,51 @@
 
 #include <stdlib.h>
 #include <assert.h>
+#include <urcu.h>
 
+#include "knot/common/probe.h"
 #include "knot/zone/zonedb.h"
 #include "libknot/packet/wire.h"
 #include "contrib/macros.h"
 #include "contrib/mempattern.h"
 #include "contrib/ucw/mempool.h"
 
-/*! \brief Discard zone in zone database. */
-static void discard_zone(zone_t *zone)
+/*! \brief Flush the journal of a zone leaving the zone database. */
+static void flush_discarded(zone_t *zone)
 {
 	// Don't flush if removed zone (no previous configuration available).
-	if (conf_rawid_exists(conf(), C_ZONE, zone->name, knot_dname_size(zone->name))) {
+	// The contents of a reloaded zone are kept by the new zone.
+	if (zone->events.successor == NULL &&
+	    conf_rawid_exists(conf(), C_ZONE, zone->name, knot_dname_size(zone->name))) {
 		char *journal_file = conf_journalfile(conf(), zone->name);
 
 		/* Flush if bootstrapped or if the journal doesn't exist. */
 		if (!zone->zonefile.exists || !journal_exists(journal_file)) {
 			pthread_mutex_lock(&zone->journal_lock);
+			rcu_read_lock();
 			zone_flush_journal(conf(), zone);
+			rcu_read_unlock();
 			pthread_mutex_unlock(&zone->journal_lock);
 		}
 
 		free(journal_file);
 	}
+}
 
+/*! \brief Discard zone in zone database. */
+static void discard_zone(zone_t *zone)
+{
+	flush_discarded(zone);
 	zone_free(&zone);
 }
 
+/*! \brief Discard zone in zone database, after its running event. */
+static void retire_zone(zone_t *zone)
+{
+	flush_discarded(zone);
+	zone_events_retire(zone);
+}
+
 knot_zonedb_t *knot_zonedb_new(uint32_t size)
 {
 	/* Create memory pool context. */
@@ -129,11 +147,10 @@ zone_t *knot_zonedb_find(knot_zonedb_t *db, const knot_dname_t *zone_name)
 	}
 
 	value_t *ret = find_name(db, zone_name, name_size);
-	if (ret == NULL) {
-		return NULL;
-	}
+	zone_t *zone = (ret != NULL) ? *ret : NULL;
+	KNOT_PROBE2(zone__lookup, zone_name, zone);
 
-	return *ret;
+	return zone;
 }
 
 zone_t *knot_zonedb_find_suffix(knot_zonedb_t *db, const knot_dname_t *dname)
@@ -156,6 +173,7 @@ zone_t *knot_zonedb_find_suffix(knot_zonedb_t *db, const knot_dname_t *dname)
 	while (name_size > 0) { /* Include root label. */
 		val = find_name(db, dname, name_size);
 		if (val != NULL) {
+			KNOT_PROBE2(zone__lookup, dname, *val);
 			return *val;
 		}
 
@@ -164,6 +182,7 @@ zone_t *knot_zonedb_find_suffix(knot_zonedb_t *db, const knot_dname_t *dname)
 		dname = knot_wire_next_label(dname, NULL);
 	}
 
+	KNOT_PROBE2(zone__lookup, dname, NULL);
 	return NULL;
 }
 
@@ -199,3 +218,17 @@ void knot_zonedb_deep_free(knot_zonedb_t **db)
 	knot_zonedb_foreach(*db, discard_zone);
 	knot_zonedb_free(db);
 }
+
+void knot_zonedb_retire(knot_zonedb_t **db)
+{
+	if (db == NULL || *db == NULL) {
+		return;
+	}
+
+	/* Reindex for iteration. */
+	knot_zonedb_build_index(*db);
+
+	/* Retire zones and free database. */
+	knot_zonedb_foreach(*db, retire_zone);
+	knot_zonedb_free(db);
+}
@@ -142,4 +142,14 @@ void knot_zonedb_free(knot_zonedb_t **db);
  */
 void knot_zonedb_deep_free(knot_zonedb_t **db);
 
+/*!
+ * \brief Destroys the zone database, the zones are freed after their
+ *        running events.
+ *
+ * \see zone_events_retire
+ *
+ * \param db Zone database to be destroyed.
+ */
+void knot_zonedb_retire(knot_zonedb_t **db);
+
 /*! @} */
@@ -15,6 +15,7 @@
 */
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -32,15 +33,62 @@
 #define LMDB_DIR_MODE   0770
 #define LMDB_FILE_MODE  0660
 
+/*! \brief Approximate per-record overhead in a leaf page (node header + index). */
+#define LMDB_NODE_OVERHEAD	16
+/*! \brief Request map growth if less than 1/N of the map is left. */
+#define LMDB_GROW_THRESHOLD	8
+/*! \brief Alignment of the per-thread state. */
+#define LMDB_CACHELINE		64
+
 _public_ const unsigned KNOT_DB_LMDB_NOTLS = MDB_NOTLS;
 _public_ const unsigned KNOT_DB_LMDB_RDONLY = MDB_RDONLY;
 
+struct lmdb_space;
+
+/*!
+ * \brief Per-thread state of one environment.
+ *
+ * Each thread counts its transactions in its own cache line, so starting
+ * a read transaction doesn't write to memory shared with other threads.
+ * A transaction may finish in another thread (MDB_NOTLS), so only the sum
+ * over all threads is exact. Write transactions are bound to their thread,
+ * the insertion budget of the running one is kept here too.
+ */
+struct lmdb_thread
+{
+	volatile unsigned txns;   /*!< Started minus finished transactions. */
+	size_t budget;            /*!< Bytes insertable before an exact space check. */
+	struct lmdb_space *space; /*!< Owning environment. */
+	struct lmdb_thread *next; /*!< Next registered thread. */
+} __attribute__((aligned(LMDB_CACHELINE)));
+
+/*!
+ * \brief Environment-wide map state, shared by all DBIs of one environment.
+ *
+ * The map may be resized only if no transaction is active in this process.
+ * The resize is requested when the headroom gets low and performed at the
+ * start of the next write transaction, if the sum of the per-thread counters
+ * is zero. New transactions wait while the resize is in progress.
+ */
+struct lmdb_space
+{
+	pthread_mutex_t lock;        /*!< Serializes resizing and thread registration. */
+	pthread_key_t key;           /*!< Thread-specific struct lmdb_thread. */
+	struct lmdb_thread *threads; /*!< Registered threads. */
+	unsigned retired;            /*!< Transactions counted by exited threads. */
+	volatile bool resizing;      /*!< Resize in progress, transactions wait. */
+	bool grow;                   /*!< Map growth requested. */
+	size_t mapsize;              /*!< Current map size. */
+	size_t psize;                /*!< Database page size. */
+};
+
 struct lmdb_env
 {
 	bool shared;
 	MDB_dbi dbi;
 	MDB_env *env;
 	knot_mm_t *pool;
+	struct lmdb_space *space;
 };
 
 /*!
@@ -81,7 +129,7 @@ static int create_env_dir(const char *path)
 /*! \brief Set the environment map size.
  * \note This also sets the maximum database size, see \fn mdb_env_set_mapsize
  */
-static int set_mapsize(MDB_env *env, size_t map_size)
+static int set_mapsize(MDB_env *env, size_t *map_size)
 {
 	long page_size = sysconf(_SC_PAGESIZE);
 	if (page_size <= 0) {
@@ -89,21 +137,266 @@ static int set_mapsize(MDB_env *env, size_t map_size)
 	}
 
 	/* Round to page size. */
-	map_size = (map_size / page_size) * page_size;
-	int ret = mdb_env_set_mapsize(env, map_size);
+	size_t new_size = (*map_size / page_size) * page_size;
+	int ret = mdb_env_set_mapsize(env, new_size);
 	if (ret != MDB_SUCCESS) {
 		return lmdb_error_to_knot(ret);
 	}
 
+	*map_size = new_size;
+
 	return KNOT_EOK;
 }
 
+/*! \brief Unregister the thread, called on the thread exit. */
+static void thread_free(void *ptr)
+{
+	struct lmdb_thread *thr = ptr;
+	struct lmdb_space *space = thr->space;
+
+	pthread_mutex_lock(&space->lock);
+	for (struct lmdb_thread **it = &space->threads; *it != NULL; it = &(*it)->next) {
+		if (*it == thr) {
+			*it = thr->next;
+			break;
+		}
+	}
+	space->retired += thr->txns;
+	pthread_mutex_unlock(&space->lock);
+
+	free(thr);
+}
+
+/*! \brief Get the state of the calling thread, register it on the first use. */
+static struct lmdb_thread *thread_get(struct lmdb_space *space)
+{
+	struct lmdb_thread *thr = pthread_getspecific(space->key);
+	if (thr != NULL) {
+		return thr;
+	}
+
+	if (posix_memalign((void **)&thr, LMDB_CACHELINE, sizeof(*thr)) != 0) {
+		return NULL;
+	}
+	memset(thr, 0, sizeof(*thr));
+	thr->space = space;
+
+	if (pthread_setspecific(space->key, thr) != 0) {
+		free(thr);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&space->lock);
+	thr->next = space->threads;
+	space->threads = thr;
+	pthread_mutex_unlock(&space->lock);
+
+	return thr;
+}
+
+/*! \brief Count a started transaction, wait if the map is being resized. */
+static void thread_txn_start(struct lmdb_thread *thr)
+{
+	struct lmdb_space *space = thr->space;
+
+	while (true) {
+		thr->txns++;
+		/* Pairs with the barrier in space_quiesce(). */
+		__sync_synchronize();
+		if (!space->resizing) {
+			return;
+		}
+		thr->txns--;
+
+		/* The resize is done with the lock held. */
+		pthread_mutex_lock(&space->lock);
+		pthread_mutex_unlock(&space->lock);
+	}
+}
+
+/*! \brief Count a finished transaction. */
+static void thread_txn_end(struct lmdb_space *space)
+{
+	struct lmdb_thread *thr = thread_get(space);
+	if (thr != NULL) {
+		thr->txns--;
+		return;
+	}
+
+	/* Unregistered thread, the sum stays exact. */
+	pthread_mutex_lock(&space->lock);
+	space->retired--;
+	pthread_mutex_unlock(&space->lock);
+}
+
+/*!
+ * \brief Stop new transactions if no transaction is active.
+ *
+ * \note Must be called with the space lock held, the resize flag must be
+ *       cleared before unlocking if true was returned.
+ */
+static bool space_quiesce(struct lmdb_space *space)
+{
+	space->resizing = true;
+	__sync_synchronize();
+
+	unsigned txns = space->retired;
+	for (struct lmdb_thread *thr = space->threads; thr != NULL; thr = thr->next) {
+		txns += thr->txns;
+	}
+
+	if (txns != 0) {
+		space->resizing = false;
+		return false;
+	}
+
+	return true;
+}
+
+/*! \brief Request map growth at the next safe point. */
+static void space_request_grow(struct lmdb_space *space)
+{
+	pthread_mutex_lock(&space->lock);
+	space->grow = true;
+	pthread_mutex_unlock(&space->lock);
+}
+
+/*!
+ * \brief Double the map size.
+ *
+ * \note Must be called with the space lock held and no transaction active.
+ */
+static int space_grow(MDB_env *env, struct lmdb_space *space)
+{
+	size_t new_size = 2 * space->mapsize;
+	if (new_size <= space->mapsize) {
+		return KNOT_ESPACE;
+	}
+
+	int ret = set_mapsize(env, &new_size);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	space->mapsize = new_size;
+	space->grow = false;
+
+	return KNOT_EOK;
+}
+
+/*!
+ * \brief Grow the map if requested and no transaction is active.
+ *
+ * \note Must be called with the space lock held.
+ */
+static void space_try_grow(MDB_env *env, struct lmdb_space *space)
+{
+	if (!space->grow || !space_quiesce(space)) {
+		return;
+	}
+
+	/* Keep the current map on failure. */
+	(void)space_grow(env, space);
+	space->grow = false;
+	space->resizing = false;
+}
+
+/*!
+ * \brief Compute the exact remaining space and refill the insertion budget.
+ *
+ * \retval KNOT_ESPACE if the map is (almost) full.
+ */
+static int space_check(knot_db_txn_t *txn, struct lmdb_thread *thr)
+{
+	struct lmdb_env *env = txn->db;
+	struct lmdb_space *space = env->space;
+
+	/* Reserve some pages for clearing */
+	MDB_stat stat;
+	MDB_stat stat_free;
+	MDB_envinfo info;
+	if (mdb_stat(txn->txn, env->dbi, &stat) != MDB_SUCCESS ||
+	    mdb_stat(txn->txn, 0, &stat_free) != MDB_SUCCESS ||
+	    mdb_env_info(env->env, &info) != MDB_SUCCESS) {
+		return KNOT_ERROR;
+	}
+	/* Count head room pages */
+	size_t map_pages = info.me_mapsize / stat.ms_psize;
+	size_t max_pages = map_pages - info.me_last_pgno - 2;
+	/* Add free leaf pages, allow worst-case headroom for branch pages */
+	max_pages += stat_free.ms_leaf_pages - stat.ms_branch_pages;
+	/* The freelist must be able to hold db tree pages */
+	size_t used_pages = stat.ms_branch_pages + stat.ms_overflow_pages;
+
+	/* Ask for a bigger map before it's too late. */
+	if (used_pages + map_pages / LMDB_GROW_THRESHOLD >= max_pages) {
+		space_request_grow(space);
+	}
+
+	if (used_pages + 1 >= max_pages) {
+		thr->budget = 0;
+		return KNOT_ESPACE;
+	}
+
+	/* Leaf pages may be half-empty after splits, count conservatively. */
+	thr->budget = (max_pages - used_pages - 1) * stat.ms_psize / 2;
+
+	return KNOT_EOK;
+}
+
+/*! \brief Estimate the number of map bytes consumed by a new record. */
+static size_t space_estimate(const struct lmdb_space *space, const MDB_val *key,
+                             const MDB_val *data)
+{
+	size_t len = key->mv_size + data->mv_size + LMDB_NODE_OVERHEAD;
+
+	/* Big records go to overflow pages, count also a possible leaf split. */
+	if (len > space->psize / 2) {
+		return (len / space->psize + 2) * space->psize;
+	}
+
+	return len;
+}
+
+/*! \brief Create the environment-wide map state. */
+static struct lmdb_space *space_new(knot_mm_t *mm)
+{
+	struct lmdb_space *space = mm_alloc(mm, sizeof(struct lmdb_space));
+	if (space == NULL) {
+		return NULL;
+	}
+	memset(space, 0, sizeof(struct lmdb_space));
+
+	if (pthread_key_create(&space->key, thread_free) != 0) {
+		mm_free(mm, space);
+		return NULL;
+	}
+	pthread_mutex_init(&space->lock, NULL);
+
+	return space;
+}
+
+/*! \brief Free the map state, the environment must not be used anymore. */
+static void space_free(struct lmdb_space *space, knot_mm_t *mm)
+{
+	/* No destructor is called for a deleted key. */
+	pthread_key_delete(space->key);
+	while (space->threads != NULL) {
+		struct lmdb_thread *next = space->threads->next;
+		free(space->threads);
+		space->threads = next;
+	}
+	pthread_mutex_destroy(&space->lock);
+	mm_free(mm, space);
+}
+
 /*! \brief Close the database. */
 static void dbase_close(struct lmdb_env *env)
 {
 	mdb_dbi_close(env->env, env->dbi);
 	if (!env->shared) {
 		mdb_env_close(env->env);
+		space_free(env->space, env->pool);
 	}
 }
 
@@ -122,7 +415,8 @@ static int dbase_open_env(struct lmdb_env *env, struct knot_db_lmdb_opts *opts)
 		return ret;
 	}
 
-	ret = set_mapsize(mdb_env, opts->mapsize);
+	size_t mapsize = opts->mapsize;
+	ret = set_mapsize(mdb_env, &mapsize);
 	if (ret != KNOT_EOK) {
 		mdb_env_close(mdb_env);
 		return ret;
@@ -159,8 +453,32 @@ static int dbase_open_env(struct lmdb_env *env, struct knot_db_lmdb_opts *opts)
 		return lmdb_error_to_knot(ret);
 	}
 
+	/* The map may be bigger than requested if already grown. */
+	MDB_envinfo info;
+	ret = mdb_env_info(mdb_env, &info);
+	if (ret != MDB_SUCCESS) {
+		mdb_env_close(mdb_env);
+		return lmdb_error_to_knot(ret);
+	}
+
+	MDB_stat stat;
+	ret = mdb_env_stat(mdb_env, &stat);
+	if (ret != MDB_SUCCESS) {
+		mdb_env_close(mdb_env);
+		return lmdb_error_to_knot(ret);
+	}
+
 	/* Keep the environment pointer. */
 	env->env = mdb_env;
+	env->space->mapsize = info.me_mapsize;
+	env->space->psize = stat.ms_psize;
+
+	/* Nothing is running yet, make headroom for a grown database. */
+	size_t map_pages = info.me_mapsize / stat.ms_psize;
+	if (info.me_last_pgno + map_pages / LMDB_GROW_THRESHOLD >= map_pages &&
+	    !(opts->flags.env & MDB_RDONLY)) {
+		(void)space_grow(mdb_env, env->space);
+	}
 
 	return KNOT_EOK;
 }
@@ -213,20 +531,31 @@ static int init(knot_db_t **db_ptr, knot_mm_t *mm, void *arg)
 	/* Open new environment. */
 	struct lmdb_env *old_env = *db_ptr;
 	if (old_env == NULL) {
+		env->space = space_new(mm);
+		if (env->space == NULL) {
+			mm_free(mm, env);
+			return KNOT_ENOMEM;
+		}
+
 		int ret = dbase_open_env(env, (struct knot_db_lmdb_opts *)arg);
 		if (ret != KNOT_EOK) {
+			space_free(env->space, mm);
 			mm_free(mm, env);
 			return ret;
 		}
 	} else {
 		/* Shared environment, this instance just owns the DBI. */
 		env->env = old_env->env;
+		env->space = old_env->space;
 		env->shared = true;
 	}
 
 	/* Open the database. */
 	int ret = dbase_open(env, (struct knot_db_lmdb_opts *)arg);
 	if (ret != KNOT_EOK) {
+		if (!env->shared) {
+			space_free(env->space, mm);
+		}
 		mm_free(mm, env);
 		return ret;
 	}
@@ -247,6 +576,27 @@ static void deinit(knot_db_t *db)
 	}
 }
 
+_public_
+int knot_db_lmdb_grow(knot_db_t *db)
+{
+	if (db == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	struct lmdb_env *env = db;
+	struct lmdb_space *space = env->space;
+
+	pthread_mutex_lock(&space->lock);
+	int ret = KNOT_EBUSY;
+	if (space_quiesce(space)) {
+		ret = space_grow(env->env, space);
+		space->resizing = false;
+	}
+	pthread_mutex_unlock(&space->lock);
+
+	return ret;
+}
+
 _public_
 int knot_db_lmdb_txn_begin(knot_db_t *db, knot_db_txn_t *txn, knot_db_txn_t *parent,
                            unsigned flags)
@@ -262,11 +612,52 @@ int knot_db_lmdb_txn_begin(knot_db_t *db, knot_db_txn_t *txn, knot_db_txn_t *par
 	MDB_txn *parent_txn = (parent != NULL) ? (MDB_txn *)parent->txn : NULL;
 
 	struct lmdb_env *env = db;
+	struct lmdb_space *space = env->space;
+
+	struct lmdb_thread *thr = thread_get(space);
+	if (thr == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	/* Safe point, resize the map if requested and nothing else is running.
+	 * Read-only transactions never take the lock. */
+	if (!(flags & KNOT_DB_RDONLY)) {
+		pthread_mutex_lock(&space->lock);
+		space_try_grow(env->env, space);
+		pthread_mutex_unlock(&space->lock);
+	}
+
+	thread_txn_start(thr);
 	int ret = mdb_txn_begin(env->env, parent_txn, txn_flags, (MDB_txn **)&txn->txn);
+	if (ret == MDB_MAP_RESIZED) {
+		/* The map was grown by another process, adopt the new size. */
+		thr->txns--;
+		pthread_mutex_lock(&space->lock);
+		if (space_quiesce(space)) {
+			if (mdb_env_set_mapsize(env->env, 0) == MDB_SUCCESS) {
+				MDB_envinfo info;
+				mdb_env_info(env->env, &info);
+				space->mapsize = info.me_mapsize;
+			}
+			space->resizing = false;
+		}
+		pthread_mutex_unlock(&space->lock);
+
+		thread_txn_start(thr);
+		ret = mdb_txn_begin(env->env, parent_txn, txn_flags,
+		                    (MDB_txn **)&txn->txn);
+	}
 	if (ret != MDB_SUCCESS) {
+		txn->txn = NULL;
+		thr->txns--;
 		return lmdb_error_to_knot(ret);
 	}
 
+	/* Space is checked on the first insertion. */
+	if (!(flags & KNOT_DB_RDONLY) && parent == NULL) {
+		thr->budget = 0;
+	}
+
 	return KNOT_EOK;
 }
 
@@ -275,9 +666,20 @@ static int txn_begin(knot_db_t *db, knot_db_txn_t *txn, unsigned flags)
 	return knot_db_lmdb_txn_begin(db, txn, NULL, flags);
 }
 
+/*! \brief Invalidate the finished transaction. */
+static void txn_finished(knot_db_txn_t *txn)
+{
+	if (txn->txn != NULL) {
+		struct lmdb_env *env = txn->db;
+		txn->txn = NULL;
+		thread_txn_end(env->space);
+	}
+}
+
 static int txn_commit(knot_db_txn_t *txn)
 {
 	int ret = mdb_txn_commit((MDB_txn *)txn->txn);
+	txn_finished(txn);
 	if (ret != MDB_SUCCESS) {
 		return lmdb_error_to_knot(ret);
 	}
@@ -288,6 +690,7 @@ static int txn_commit(knot_db_txn_t *txn)
 static void txn_abort(knot_db_txn_t *txn)
 {
 	mdb_txn_abort((MDB_txn *)txn->txn);
+	txn_finished(txn);
 }
 
 static int count(knot_db_txn_t *txn)
@@ -465,27 +868,31 @@ static int insert(knot_db_txn_t *txn, knot_db_val_t *key, knot_db_val_t *val, un
 		mdb_flags |= MDB_RESERVE;
 	}
 
-	/* Reserve some pages for clearing */
-	MDB_stat stat;
-	MDB_stat stat_free;
-	MDB_envinfo info;
-	if (mdb_stat(txn->txn, env->dbi, &stat) != MDB_SUCCESS ||
-	    mdb_stat(txn->txn, 0, &stat_free) != MDB_SUCCESS ||
-	    mdb_env_info(env->env, &info) != MDB_SUCCESS) {
-		return KNOT_ERROR;
+	/* Check the exact space only if the estimated budget is exhausted.
+	 * The write transaction is bound to the calling thread. */
+	struct lmdb_space *space = env->space;
+	struct lmdb_thread *thr = thread_get(space);
+	if (thr == NULL) {
+		return KNOT_ENOMEM;
 	}
-	/* Count head room pages */
-	size_t max_pages = (info.me_mapsize / stat.ms_psize) - info.me_last_pgno - 2;
-	/* Add free leaf pages, allow worst-case headroom for branch pages */
-	max_pages += stat_free.ms_leaf_pages - stat.ms_branch_pages;
-	/* The freelist must be able to hold db tree pages */
-	size_t used_pages = stat.ms_branch_pages + stat.ms_overflow_pages;
-	if (used_pages + 1 >= max_pages) {
-		return KNOT_ESPACE;
+	size_t cost = space_estimate(space, &db_key, &data);
+	if (cost > thr->budget) {
+		int ret = space_check(txn, thr);
+		if (ret == KNOT_EOK && cost > thr->budget) {
+			space_request_grow(space);
+			ret = KNOT_ESPACE;
+		}
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
 	}
+	thr->budget -= cost;
 
 	int ret = mdb_put(txn->txn, env->dbi, &db_key, &data, mdb_flags);
 	if (ret != MDB_SUCCESS) {
+		if (ret == MDB_MAP_FULL) {
+			space_request_grow(space);
+		}
 		return lmdb_error_to_knot(ret);
 	}
 
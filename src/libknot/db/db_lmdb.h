@@ -29,7 +29,7 @@ extern const unsigned KNOT_DB_LMDB_RDONLY;
 struct knot_db_lmdb_opts {
 	const char *path;     /*!< Database environment path. */
 	const char *dbname;   /*!< Database name (or NULL). */
-	size_t mapsize;       /*!< Environment map size. */
+	size_t mapsize;       /*!< Initial environment map size (grows on demand). */
 	unsigned maxdbs;      /*!< Maximum number of databases in the env. */
 	struct {
 		unsigned env; /*!< Environment flags. */
@@ -48,6 +48,17 @@ struct knot_db_lmdb_opts {
 const knot_db_api_t *knot_db_lmdb_api(void);
 
 /* LMDB specific operations. */
+
+/*!
+ * \brief Grow the environment map after a write failed with KNOT_ESPACE.
+ *
+ * The failed transaction must be aborted first, the write can be retried
+ * if the map was grown.
+ *
+ * \retval KNOT_EOK if the map was grown.
+ * \retval KNOT_EBUSY if a transaction is still active in this process.
+ */
+int knot_db_lmdb_grow(knot_db_t *db);
 int knot_db_lmdb_txn_begin(knot_db_t *db, knot_db_txn_t *txn, knot_db_txn_t *parent,
                            unsigned flags);
 int knot_db_lmdb_iter_del(knot_db_iter_t *iter);
@@ -294,16 +294,10 @@ char *knot_dname_to_str(char *dst, const knot_dname_t *name, size_t maxlen)
 			}
 
 			/* Write encoded character. */
-			int ret = snprintf(res + str_len, alloc_size - str_len,
-			                   "\\%03u", c);
-			if (ret <= 0 || ret >= alloc_size - str_len) {
-				if (dst == NULL) {
-					free(res);
-				}
-				return NULL;
-			}
-
-			str_len += ret;
+			res[str_len++] = '\\';
+			res[str_len++] = '0' + c / 100;
+			res[str_len++] = '0' + c / 10 % 10;
+			res[str_len++] = '0' + c % 10;
 		}
 
 		label_len--;
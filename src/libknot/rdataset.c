@@ -25,29 +25,34 @@
 #include "contrib/macros.h"
 #include "contrib/mempattern.h"
 
+/*! \brief Returns the RR following the given one in the RR array. */
+static knot_rdata_t *rr_next(const knot_rdata_t *rr)
+{
+	return (knot_rdata_t *)rr + knot_rdata_array_size(knot_rdata_rdlen(rr));
+}
+
 static knot_rdata_t *rr_seek(knot_rdata_t *d, size_t pos)
 {
 	if (d == NULL) {
 		return NULL;
 	}
 
-	size_t offset = 0;
 	for (size_t i = 0; i < pos; i++) {
-		knot_rdata_t *rr = d + offset;
-		offset += knot_rdata_array_size(knot_rdata_rdlen(rr));
+		d = rr_next(d);
 	}
 
-	return d + offset;
+	return d;
 }
 
 static int find_rr_pos(const knot_rdataset_t *search_in,
                        const knot_rdata_t *rr)
 {
+	const knot_rdata_t *search_rr = search_in->data;
 	for (uint16_t i = 0; i < search_in->rr_count; ++i) {
-		const knot_rdata_t *search_rr = knot_rdataset_at(search_in, i);
 		if (knot_rdata_cmp(rr, search_rr) == 0) {
 			return i;
 		}
+		search_rr = rr_next(search_rr);
 	}
 
 	return KNOT_ENOENT;
@@ -100,6 +105,68 @@ static int add_rr_at(knot_rdataset_t *rrs, const knot_rdata_t *rr, size_t pos,
 	return KNOT_EOK;
 }
 
+/*! \brief Checks if the RRs are in canonical order without duplicates. */
+static bool rrs_sorted(const knot_rdataset_t *rrs)
+{
+	const knot_rdata_t *rr = rrs->data;
+	for (uint16_t i = 1; i < rrs->rr_count; ++i) {
+		const knot_rdata_t *next = rr_next(rr);
+		if (knot_rdata_cmp(rr, next) >= 0) {
+			return false;
+		}
+		rr = next;
+	}
+
+	return true;
+}
+
+/*!
+ * \brief Merges two sorted RR arrays in one pass.
+ *
+ * Equivalent to adding the RRs from \a rrs2 one by one, which is quadratic
+ * in the number of RRs for large RRSets.
+ */
+static int merge_sorted(knot_rdataset_t *rrs1, const knot_rdataset_t *rrs2,
+                        knot_mm_t *mm)
+{
+	knot_rdata_t *data = mm_alloc(mm, knot_rdataset_size(rrs1) +
+	                                  knot_rdataset_size(rrs2));
+	if (data == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	const knot_rdata_t *rr1 = rrs1->data;
+	const knot_rdata_t *rr2 = rrs2->data;
+	uint16_t left1 = rrs1->rr_count;
+	uint16_t left2 = rrs2->rr_count;
+	uint16_t count = 0;
+	knot_rdata_t *out = data;
+	while (left1 > 0 || left2 > 0) {
+		int cmp = (left1 == 0) ? 1 : (left2 == 0) ? -1 : knot_rdata_cmp(rr1, rr2);
+		const knot_rdata_t *rr = (cmp <= 0) ? rr1 : rr2;
+		if (cmp <= 0) {
+			rr1 = rr_next(rr1);
+			left1--;
+		}
+		if (cmp >= 0) {
+			// Duplicates are skipped, the first RRS wins.
+			rr2 = rr_next(rr2);
+			left2--;
+		}
+
+		size_t len = knot_rdata_array_size(knot_rdata_rdlen(rr));
+		memcpy(out, rr, len);
+		out += len;
+		count++;
+	}
+
+	mm_free(mm, rrs1->data);
+	rrs1->data = data;
+	rrs1->rr_count = count;
+
+	return KNOT_EOK;
+}
+
 static int remove_rr_at(knot_rdataset_t *rrs, size_t pos, knot_mm_t *mm)
 {
 	if (rrs == NULL || pos >= rrs->rr_count) {
@@ -206,9 +273,10 @@ uint32_t knot_rdataset_ttl(const knot_rdataset_t *rrs)
 _public_
 void knot_rdataset_set_ttl(knot_rdataset_t *rrs, uint32_t ttl)
 {
+	knot_rdata_t *rrset_rr = rrs->data;
 	for (uint16_t i = 0; i < rrs->rr_count; ++i) {
-		knot_rdata_t *rrset_rr = knot_rdataset_at(rrs, i);
 		knot_rdata_set_ttl(rrset_rr, ttl);
+		rrset_rr = rr_next(rrset_rr);
 	}
 }
 
@@ -219,8 +287,8 @@ int knot_rdataset_add(knot_rdataset_t *rrs, const knot_rdata_t *rr, knot_mm_t *m
 		return KNOT_EINVAL;
 	}
 
+	const knot_rdata_t *rrset_rr = rrs->data;
 	for (uint16_t i = 0; i < rrs->rr_count; ++i) {
-		const knot_rdata_t *rrset_rr = knot_rdataset_at(rrs, i);
 		int cmp = knot_rdata_cmp(rrset_rr, rr);
 		if (cmp == 0) {
 			// Duplication - no need to add this RR
@@ -229,6 +297,7 @@ int knot_rdataset_add(knot_rdataset_t *rrs, const knot_rdata_t *rr, knot_mm_t *m
 			// Found position to insert
 			return add_rr_at(rrs, rr, i, mm);
 		}
+		rrset_rr = rr_next(rrset_rr);
 	}
 
 	// If flow gets here, it means that we should insert at the last position
@@ -305,12 +374,14 @@ bool knot_rdataset_eq(const knot_rdataset_t *rrs1, const knot_rdataset_t *rrs2)
 		return false;
 	}
 
+	const knot_rdata_t *rr1 = rrs1->data;
+	const knot_rdata_t *rr2 = rrs2->data;
 	for (uint16_t i = 0; i < rrs1->rr_count; ++i) {
-		const knot_rdata_t *rr1 = knot_rdataset_at(rrs1, i);
-		const knot_rdata_t *rr2 = knot_rdataset_at(rrs2, i);
 		if (knot_rdata_cmp(rr1, rr2) != 0) {
 			return false;
 		}
+		rr1 = rr_next(rr1);
+		rr2 = rr_next(rr2);
 	}
 
 	return true;
@@ -320,8 +391,9 @@ _public_
 bool knot_rdataset_member(const knot_rdataset_t *rrs, const knot_rdata_t *rr,
                           bool cmp_ttl)
 {
+	const knot_rdata_t *cmp_rr = NULL;
 	for (uint16_t i = 0; i < rrs->rr_count; ++i) {
-		const knot_rdata_t *cmp_rr = knot_rdataset_at(rrs, i);
+		cmp_rr = (cmp_rr == NULL) ? rrs->data : rr_next(cmp_rr);
 		if (cmp_ttl) {
 			if (knot_rdata_ttl(rr) != knot_rdata_ttl(cmp_rr)) {
 				continue;
@@ -347,12 +419,19 @@ int knot_rdataset_merge(knot_rdataset_t *rrs1, const knot_rdataset_t *rrs2, knot
 		return KNOT_EINVAL;
 	}
 
+	if (rrs2->rr_count > 1 && rrs1->data != rrs2->data &&
+	    rrs1->rr_count + rrs2->rr_count <= UINT16_MAX &&
+	    rrs_sorted(rrs1) && rrs_sorted(rrs2)) {
+		return merge_sorted(rrs1, rrs2, mm);
+	}
+
+	const knot_rdata_t *rr = rrs2->data;
 	for (uint16_t i = 0; i < rrs2->rr_count; ++i) {
-		const knot_rdata_t *rr = knot_rdataset_at(rrs2, i);
 		int ret = knot_rdataset_add(rrs1, rr, mm);
 		if (ret != KNOT_EOK) {
 			return ret;
 		}
+		rr = rr_next(rr);
 	}
 
 	return KNOT_EOK;
@@ -368,8 +447,9 @@ int knot_rdataset_intersect(const knot_rdataset_t *a, const knot_rdataset_t *b,
 
 	knot_rdataset_init(out);
 	const bool compare_ttls = false;
+	const knot_rdata_t *rr = NULL;
 	for (uint16_t i = 0; i < a->rr_count; ++i) {
-		const knot_rdata_t *rr = knot_rdataset_at(a, i);
+		rr = (rr == NULL) ? a->data : rr_next(rr);
 		if (knot_rdataset_member(b, rr, compare_ttls)) {
 			// Add RR into output intersection RRSet.
 			int ret = knot_rdataset_add(out, rr, mm);
@@ -397,8 +477,9 @@ int knot_rdataset_subtract(knot_rdataset_t *from, const knot_rdataset_t *what,
 		return KNOT_EOK;
 	}
 
+	const knot_rdata_t *to_remove = NULL;
 	for (uint16_t i = 0; i < what->rr_count; ++i) {
-		const knot_rdata_t *to_remove = knot_rdataset_at(what, i);
+		to_remove = (to_remove == NULL) ? what->data : rr_next(to_remove);
 		int pos_to_remove = find_rr_pos(from, to_remove);
 		if (pos_to_remove >= 0) {
 			int ret = remove_rr_at(from, pos_to_remove, mm);
@@ -427,7 +508,7 @@ int knot_rdataset_sort_at(knot_rdataset_t *rrs, size_t pos, knot_mm_t *mm)
 			// It already is at the position
 			return KNOT_EOK;
 		}
-		earlier_rr = knot_rdataset_at(rrs, i);
+		earlier_rr = (earlier_rr == NULL) ? rrs->data : rr_next(earlier_rr);
 		int cmp = knot_rdata_cmp(earlier_rr, rr);
 		if (cmp == 0) {
 			// Duplication - we need to remove this RR
@@ -16,12 +16,10 @@
 
 #include <arpa/inet.h>
 #include <ctype.h>
-#include <inttypes.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
 
@@ -47,6 +45,8 @@
 
 #define LOC_ZERO		2147483648	// 2^31
 
+#define NUM_TXT_MAXLEN		20	// UINT64_MAX
+
 typedef struct {
 	const knot_dump_style_t *style;
 	const uint8_t *in;
@@ -90,6 +90,81 @@ static void dump_string(rrset_dump_params_t *p, const char *str)
 	p->ret = 0;
 }
 
+/*! \brief Two-digit decimal strings 00 to 99. */
+static const char digit_pairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233"
+	"34353637383940414243444546474849505152535455565758596061626364656667"
+	"6869707172737475767778798081828384858687888990919293949596979899";
+
+/*!
+ * \brief Writes decimal representation of the number, same as "%u" format.
+ *
+ * \note The output is not terminated, \a out must have NUM_TXT_MAXLEN bytes.
+ */
+static size_t num_to_str(char *out, uint64_t num)
+{
+	char buf[NUM_TXT_MAXLEN];
+	char *pos = buf + sizeof(buf);
+
+	while (num >= 100) {
+		unsigned idx = 2 * (num % 100);
+		num /= 100;
+		*--pos = digit_pairs[idx + 1];
+		*--pos = digit_pairs[idx];
+	}
+	if (num >= 10) {
+		*--pos = digit_pairs[2 * num + 1];
+		*--pos = digit_pairs[2 * num];
+	} else {
+		*--pos = '0' + num;
+	}
+
+	size_t len = buf + sizeof(buf) - pos;
+	memcpy(out, pos, len);
+
+	return len;
+}
+
+/*!
+ * \brief Writes terminated string of the given length, fails as snprintf()
+ *        would if the output is truncated.
+ */
+static int str_to_out(char *out, size_t out_max, const char *str, size_t len)
+{
+	if (len >= out_max) {
+		return -1;
+	}
+
+	memcpy(out, str, len);
+	out[len] = '\0';
+
+	return len;
+}
+
+/*! \brief Writes terminated decimal number, same as snprintf("%u"). */
+static int num_to_out(char *out, size_t out_max, uint64_t num)
+{
+	char buf[NUM_TXT_MAXLEN];
+	size_t len = num_to_str(buf, num);
+
+	return str_to_out(out, out_max, buf, len);
+}
+
+/*! \brief Writes terminated RR type mnemonic or generic TYPE<num> notation. */
+static int type_to_out(char *out, size_t out_max, uint16_t type)
+{
+	const char *name = knot_get_rdata_descriptor(type)->type_name;
+	if (name != NULL) {
+		return str_to_out(out, out_max, name, strlen(name));
+	}
+
+	char buf[4 + NUM_TXT_MAXLEN];
+	memcpy(buf, "TYPE", 4);
+	size_t len = 4 + num_to_str(buf + 4, type);
+
+	return str_to_out(out, out_max, buf, len);
+}
+
 static void wire_num8_to_str(rrset_dump_params_t *p)
 {
 	uint8_t data = *(p->in);
@@ -102,8 +177,8 @@ static void wire_num8_to_str(rrset_dump_params_t *p)
 	}
 
 	// Write number.
-	int ret = snprintf(p->out, p->out_max, "%u", data);
-	if (ret <= 0 || (size_t)ret >= p->out_max) {
+	int ret = num_to_out(p->out, p->out_max, data);
+	if (ret <= 0) {
 		return;
 	}
 	out_len = ret;
@@ -132,8 +207,8 @@ static void wire_num16_to_str(rrset_dump_params_t *p)
 	data = wire_read_u16(p->in);
 
 	// Write number.
-	int ret = snprintf(p->out, p->out_max, "%u", data);
-	if (ret <= 0 || (size_t)ret >= p->out_max) {
+	int ret = num_to_out(p->out, p->out_max, data);
+	if (ret <= 0) {
 		return;
 	}
 	out_len = ret;
@@ -162,8 +237,8 @@ static void wire_num32_to_str(rrset_dump_params_t *p)
 	data = wire_read_u32(p->in);
 
 	// Write number.
-	int ret = snprintf(p->out, p->out_max, "%u", data);
-	if (ret <= 0 || (size_t)ret >= p->out_max) {
+	int ret = num_to_out(p->out, p->out_max, data);
+	if (ret <= 0) {
 		return;
 	}
 	out_len = ret;
@@ -192,8 +267,8 @@ static void wire_num48_to_str(rrset_dump_params_t *p)
 	data = wire_read_u48(p->in);
 
 	// Write number.
-	int ret = snprintf(p->out, p->out_max, "%"PRIu64"", data);
-	if (ret <= 0 || (size_t)ret >= p->out_max) {
+	int ret = num_to_out(p->out, p->out_max, data);
+	if (ret <= 0) {
 		return;
 	}
 	out_len = ret;
@@ -209,8 +284,7 @@ static void wire_num48_to_str(rrset_dump_params_t *p)
 
 static void wire_ipv4_to_str(rrset_dump_params_t *p)
 {
-	struct in_addr addr4;
-	size_t in_len = sizeof(addr4.s_addr);
+	size_t in_len = sizeof(struct in_addr);
 	size_t out_len = 0;
 
 	// Check input size.
@@ -218,16 +292,17 @@ static void wire_ipv4_to_str(rrset_dump_params_t *p)
 		return;
 	}
 
-	// Fill in input data.
-	if (memcpy(&(addr4.s_addr), p->in, in_len) == NULL) {
-		return;
+	// Write address, same as inet_ntop().
+	char buf[INET_ADDRSTRLEN];
+	for (size_t i = 0; i < in_len; i++) {
+		if (i > 0) {
+			buf[out_len++] = '.';
+		}
+		out_len += num_to_str(buf + out_len, p->in[i]);
 	}
-
-	// Write address.
-	if (inet_ntop(AF_INET, &addr4, p->out, p->out_max) == NULL) {
+	if (str_to_out(p->out, p->out_max, buf, out_len) < 0) {
 		return;
 	}
-	out_len = strlen(p->out);
 
 	// Fill in output.
 	p->in += in_len;
@@ -271,7 +346,6 @@ static void wire_ipv6_to_str(rrset_dump_params_t *p)
 
 static void wire_type_to_str(rrset_dump_params_t *p)
 {
-	char     type[32];
 	uint16_t data;
 	size_t   in_len = sizeof(data);
 	size_t   out_len = 0;
@@ -282,18 +356,11 @@ static void wire_type_to_str(rrset_dump_params_t *p)
 	}
 
 	// Fill in input data.
-	if (memcpy(&data, p->in, in_len) == NULL) {
-		return;
-	}
-
-	// Get record type name string.
-	if (knot_rrtype_to_string(ntohs(data), type, sizeof(type)) <= 0) {
-		return;
-	}
+	data = wire_read_u16(p->in);
 
-	// Write string.
-	int ret = snprintf(p->out, p->out_max, "%s", type);
-	if (ret <= 0 || (size_t)ret >= p->out_max) {
+	// Write record type name string.
+	int ret = type_to_out(p->out, p->out_max, data);
+	if (ret <= 0) {
 		return;
 	}
 	out_len = ret;
@@ -369,11 +436,20 @@ static void wire_data_encode_to_str(rrset_dump_params_t *p,
 		p->total += out_len;
 	} else {
 		int     src_begin;
-		uint8_t *buf;
+		bool    fail = false;
+		uint8_t stack_buf[1024];
+		uint8_t *buf = stack_buf;
 
-		// Encode data to the temporary buffer.
-		ret = enc_alloc(p->in, in_len, &buf);
+		// Encode data to the temporary buffer, allocate for large data.
+		ret = enc(p->in, in_len, stack_buf, sizeof(stack_buf));
+		if (ret < 0) {
+			ret = enc_alloc(p->in, in_len, &buf);
+		}
 		if (ret <= 0) {
+			// The allocated buffer is freed on encoding error.
+			if (ret == 0 && buf != stack_buf) {
+				free(buf);
+			}
 			return;
 		}
 
@@ -383,8 +459,8 @@ static void wire_data_encode_to_str(rrset_dump_params_t *p,
 				// Write indent block.
 				dump_string(p, BLOCK_INDENT);
 				if (p->ret != 0) {
-					free(buf);
-					return;
+					fail = true;
+					break;
 				}
 			}
 
@@ -393,8 +469,8 @@ static void wire_data_encode_to_str(rrset_dump_params_t *p,
 			              (ret - src_begin) : BLOCK_WIDTH;
 
 			if ((size_t)src_len > p->out_max) {
-				free(buf);
-				return;
+				fail = true;
+				break;
 			}
 
 			// Write data block.
@@ -406,7 +482,12 @@ static void wire_data_encode_to_str(rrset_dump_params_t *p,
 		}
 
 		// Destroy temporary buffer.
-		free(buf);
+		if (buf != stack_buf) {
+			free(buf);
+		}
+		if (fail) {
+			return;
+		}
 	}
 
 	// String termination.
@@ -551,6 +632,17 @@ static void wire_unknown_to_str(rrset_dump_params_t *p)
 	p->ret = 0;
 }
 
+/*! \brief Checks if the text character is printed without escaping. */
+static bool text_char_plain(uint8_t ch)
+{
+	if (ch < 0x80) {
+		return ch >= ' ' && ch <= '~' && ch != '\\' && ch != '"';
+	}
+
+	// Printability of the upper half depends on the locale.
+	return isprint(ch) != 0;
+}
+
 static void wire_text_to_str(rrset_dump_params_t *p, bool quote, bool with_header)
 {
 	size_t in_len = 0;
@@ -573,13 +665,8 @@ static void wire_text_to_str(rrset_dump_params_t *p, bool quote, bool with_heade
 	}
 
 	// Check if quotation can ever be disabled (parser protection fallback).
-	if (!quote) {
-		for (size_t i = 0; i < in_len; i++) {
-			if (p->in[i] == ' ') { // Other WS characters are encoded.
-				quote = true;
-				break;
-			}
-		}
+	if (!quote && memchr(p->in, ' ', in_len) != NULL) {
+		quote = true; // Other WS characters are encoded.
 	}
 
 	// Opening quotation.
@@ -591,37 +678,51 @@ static void wire_text_to_str(rrset_dump_params_t *p, bool quote, bool with_heade
 	}
 
 	// Loop over all characters.
-	for (size_t i = 0; i < in_len; i++) {
-		uint8_t ch = p->in[i];
-
-		if (isprint(ch) != 0) {
-			// For special character print leading slash.
-			if (ch == '\\' || ch == '"') {
-				dump_string(p, "\\");
-				if (p->ret != 0) {
-					return;
-				}
+	for (size_t i = 0; i < in_len; ) {
+		// Copy the longest run of characters without escaping at once.
+		size_t run = 0;
+		while (i + run < in_len && text_char_plain(p->in[i + run])) {
+			run++;
+		}
+		if (run > 0) {
+			if (run > p->out_max) {
+				return;
 			}
 
-			// Print text character.
-			if (p->out_max == 0) {
+			memcpy(p->out, p->in + i, run);
+			p->out += run;
+			p->out_max -= run;
+			p->total += run;
+			i += run;
+			continue;
+		}
+
+		uint8_t ch = p->in[i++];
+
+		if (isprint(ch) != 0) {
+			// Special character with leading slash.
+			if (p->out_max < 2) {
 				return;
 			}
 
-			*p->out = ch;
-			p->out++;
-			p->out_max--;
-			p->total++;
+			p->out[0] = '\\';
+			p->out[1] = ch;
+			p->out += 2;
+			p->out_max -= 2;
+			p->total += 2;
 		} else {
 			// Unprintable character encode via \ddd notation.
-			int ret = snprintf(p->out, p->out_max,"\\%03u", ch);
-			if (ret <= 0 || (size_t)ret >= p->out_max) {
+			if (p->out_max <= 4) {
 				return;
 			}
 
-			p->out += ret;
-			p->out_max -= ret;
-			p->total += ret;
+			p->out[0] = '\\';
+			p->out[1] = '0' + ch / 100;
+			p->out[2] = '0' + ch / 10 % 10;
+			p->out[3] = '0' + ch % 10;
+			p->out += 4;
+			p->out_max -= 4;
+			p->total += 4;
 		}
 	}
 
@@ -646,6 +747,47 @@ static void wire_text_to_str(rrset_dump_params_t *p, bool quote, bool with_heade
 	p->ret = 0;
 }
 
+#define TIMESTAMP_TXT_LEN	14	// YYYYMMDDhhmmss
+
+/*! \brief Writes two-digit number with leading zero. */
+static char *two_digits(char *out, unsigned num)
+{
+	out[0] = digit_pairs[2 * num];
+	out[1] = digit_pairs[2 * num + 1];
+
+	return out + 2;
+}
+
+/*!
+ * \brief Writes UTC time as YYYYMMDDhhmmss, same as strftime() with gmtime().
+ *
+ * Converts days to a civil date directly, the 32-bit timestamp range
+ * always fits into the four-digit year.
+ */
+static void timestamp_to_str(char *out, uint32_t timestamp)
+{
+	uint32_t secs = timestamp % 86400;
+
+	// Shift the epoch to 0000-03-01, eras are 400 years (146097 days) long.
+	uint32_t days = timestamp / 86400 + 719468;
+	uint32_t era = days / 146097;
+	uint32_t doe = days - era * 146097;
+	uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	uint32_t mp = (5 * doy + 2) / 153;
+	uint32_t day = doy - (153 * mp + 2) / 5 + 1;
+	uint32_t month = mp < 10 ? mp + 3 : mp - 9;
+	uint32_t year = yoe + era * 400 + (month <= 2);
+
+	out = two_digits(out, year / 100);
+	out = two_digits(out, year % 100);
+	out = two_digits(out, month);
+	out = two_digits(out, day);
+	out = two_digits(out, secs / 3600);
+	out = two_digits(out, secs / 60 % 60);
+	two_digits(out, secs % 60);
+}
+
 static void wire_timestamp_to_str(rrset_dump_params_t *p)
 {
 	uint32_t data;
@@ -663,20 +805,18 @@ static void wire_timestamp_to_str(rrset_dump_params_t *p)
 		return;
 	}
 
-	time_t timestamp = ntohl(data);
-
 	if (p->style->human_tmstamp) {
-		struct tm result;
 		// Write timestamp in YYYYMMDDhhmmss format.
-		ret = strftime(p->out, p->out_max, "%Y%m%d%H%M%S",
-		               gmtime_r(&timestamp, &result));
-		if (ret == 0) {
+		char buf[TIMESTAMP_TXT_LEN];
+		timestamp_to_str(buf, ntohl(data));
+		ret = str_to_out(p->out, p->out_max, buf, sizeof(buf));
+		if (ret <= 0) {
 			return;
 		}
 	} else {
 		// Write timestamp only.
-		ret = snprintf(p->out, p->out_max, "%u", ntohl(data));
-		if (ret <= 0 || (size_t)ret >= p->out_max) {
+		ret = num_to_out(p->out, p->out_max, ntohl(data));
+		if (ret <= 0) {
 			return;
 		}
 	}
@@ -695,62 +835,43 @@ static int time_to_human_str(char         *out,
                              const size_t out_len,
                              uint32_t     data)
 {
+	// Longest is 49710d6h28m15s.
+	char     buf[32];
 	size_t   total_len = 0;
 	uint32_t num;
-	int      ret;
 
 	// Process days.
 	num = data / 86400;
 	if (num > 0) {
-		ret = snprintf(out + total_len, out_len - total_len,
-		               "%ud", num);
-		if (ret <= 0 || (size_t)ret >= out_len - total_len) {
-			return -1;
-		}
-
-		total_len += ret;
+		total_len += num_to_str(buf + total_len, num);
+		buf[total_len++] = 'd';
 		data -= num * 86400;
 	}
 
 	// Process hours.
 	num = data / 3600;
 	if (num > 0) {
-		ret = snprintf(out + total_len, out_len - total_len,
-		               "%uh", num);
-		if (ret <= 0 || (size_t)ret >= out_len - total_len) {
-			return -1;
-		}
-
-		total_len += ret;
+		total_len += num_to_str(buf + total_len, num);
+		buf[total_len++] = 'h';
 		data -= num * 3600;
 	}
 
 	// Process minutes.
 	num = data / 60;
 	if (num > 0) {
-		ret = snprintf(out + total_len, out_len - total_len,
-		               "%um", num);
-		if (ret <= 0 || (size_t)ret >= out_len - total_len) {
-			return -1;
-		}
-
-		total_len += ret;
+		total_len += num_to_str(buf + total_len, num);
+		buf[total_len++] = 'm';
 		data -= num * 60;
 	}
 
 	// Process seconds.
 	num = data;
 	if (num > 0 || total_len == 0) {
-		ret = snprintf(out + total_len, out_len - total_len,
-		               "%us", num);
-		if (ret <= 0 || (size_t)ret >= out_len - total_len) {
-			return -1;
-		}
-
-		total_len += ret;
+		total_len += num_to_str(buf + total_len, num);
+		buf[total_len++] = 's';
 	}
 
-	return total_len;
+	return str_to_out(out, out_len, buf, total_len);
 }
 
 static void wire_ttl_to_str(rrset_dump_params_t *p)
@@ -778,8 +899,8 @@ static void wire_ttl_to_str(rrset_dump_params_t *p)
 		}
 	} else {
 		// Write timestamp only.
-		ret = snprintf(p->out, p->out_max, "%u", ntohl(data));
-		if (ret <= 0 || (size_t)ret >= p->out_max) {
+		ret = num_to_out(p->out, p->out_max, ntohl(data));
+		if (ret <= 0) {
 			return;
 		}
 	}
@@ -797,7 +918,6 @@ static void wire_ttl_to_str(rrset_dump_params_t *p)
 static void wire_bitmap_to_str(rrset_dump_params_t *p)
 {
 	int    ret;
-	char   type[32];
 	size_t i = 0;
 	size_t in_len = p->in_max;
 	size_t out_len = 0;
@@ -825,20 +945,18 @@ static void wire_bitmap_to_str(rrset_dump_params_t *p)
 			if ((p->in[i + j / 8] & (128 >> (j % 8))) != 0) {
 				uint16_t type_num = win * 256 + j;
 
-				if (knot_rrtype_to_string(type_num, type,
-				                          sizeof(type)) <= 0) {
-					return;
-				}
-
 				// Print type name to type list.
 				if (out_len > 0) {
-					ret = snprintf(p->out, p->out_max,
-					               " %s", type);
-				} else {
-					ret = snprintf(p->out, p->out_max,
-					               "%s", type);
+					if (p->out_max <= 1) {
+						return;
+					}
+					*p->out = ' ';
+					out_len++;
+					p->out++;
+					p->out_max--;
 				}
-				if (ret <= 0 || (size_t)ret >= p->out_max) {
+				ret = type_to_out(p->out, p->out_max, type_num);
+				if (ret <= 0) {
 					return;
 				}
 				out_len += ret;
@@ -1913,11 +2031,26 @@ int knot_rrset_txt_dump_data(const knot_rrset_t      *rrset,
 	return ret;
 }
 
-#define SNPRINTF_CHECK(ret, max_len)			\
-	if ((ret) < 0 || (size_t)(ret) >= (max_len)) {	\
-		return KNOT_ESPACE;			\
+/*! \brief Writes header field padded to the minimal width and a separator. */
+static int header_field(char *dst, size_t maxlen, const char *str, size_t len,
+                        size_t width, char sep)
+{
+	size_t pad = len < width ? width - len : 0;
+	size_t total = len + pad + (sep != '\0' ? 1 : 0);
+	if (total >= maxlen) {
+		return KNOT_ESPACE;
 	}
 
+	memcpy(dst, str, len);
+	memset(dst + len, ' ', pad);
+	if (sep != '\0') {
+		dst[len + pad] = sep;
+	}
+	dst[total] = '\0';
+
+	return total;
+}
+
 _public_
 int knot_rrset_txt_dump_header(const knot_rrset_t      *rrset,
                                const uint32_t          ttl,
@@ -1934,14 +2067,26 @@ int knot_rrset_txt_dump_header(const knot_rrset_t      *rrset,
 	int    ret;
 
 	// Dump rrset owner.
-	char *name = knot_dname_to_str_alloc(rrset->owner);
+	char name_buf[KNOT_DNAME_TXT_MAXLEN + 1];
+	char *name;
 	if (style->ascii_to_idn != NULL) {
+		name = knot_dname_to_str_alloc(rrset->owner);
 		style->ascii_to_idn(&name);
+	} else {
+		name = knot_dname_to_str(name_buf, rrset->owner, sizeof(name_buf));
+	}
+	if (name == NULL) {
+		return KNOT_EINVAL;
+	}
+	size_t name_len = strlen(name);
+	char sep = name_len < 4 * TAB_WIDTH ? '\t' : ' ';
+	ret = header_field(dst + len, maxlen - len, name, name_len, 20, sep);
+	if (name != name_buf) {
+		free(name);
+	}
+	if (ret < 0) {
+		return ret;
 	}
-	char sep = strlen(name) < 4 * TAB_WIDTH ? '\t' : ' ';
-	ret = snprintf(dst + len, maxlen - len, "%-20s%c", name, sep);
-	free(name);
-	SNPRINTF_CHECK(ret, maxlen - len);
 	len += ret;
 
 	// Set white space separation character.
@@ -1950,45 +2095,53 @@ int knot_rrset_txt_dump_header(const knot_rrset_t      *rrset,
 	// Dump rrset ttl.
 	if (style->show_ttl) {
 		if (style->empty_ttl) {
-			ret = snprintf(dst + len, maxlen - len, "%c", sep);
+			ret = 0;
 		} else if (style->human_ttl) {
 			// Create human readable ttl string.
-			if (time_to_human_str(buf, sizeof(buf), ttl) < 0) {
+			ret = time_to_human_str(buf, sizeof(buf), ttl);
+			if (ret < 0) {
 				return KNOT_ESPACE;
 			}
-			ret = snprintf(dst + len, maxlen - len, "%s%c",
-			               buf, sep);
 		} else {
-			ret = snprintf(dst + len, maxlen - len, "%u%c", ttl, sep);
+			ret = num_to_str(buf, ttl);
+		}
+		ret = header_field(dst + len, maxlen - len, buf, ret, 0, sep);
+		if (ret < 0) {
+			return ret;
 		}
-		SNPRINTF_CHECK(ret, maxlen - len);
 		len += ret;
 	}
 
 	// Dump rrset class.
 	if (style->show_class) {
-		if (knot_rrclass_to_string(rrset->rclass, buf, sizeof(buf)) < 0) {
+		ret = knot_rrclass_to_string(rrset->rclass, buf, sizeof(buf));
+		if (ret < 0) {
 			return KNOT_ESPACE;
 		}
-		ret = snprintf(dst + len, maxlen - len, "%-2s%c", buf, sep);
-		SNPRINTF_CHECK(ret, maxlen - len);
+		ret = header_field(dst + len, maxlen - len, buf, ret, 2, sep);
+		if (ret < 0) {
+			return ret;
+		}
 		len += ret;
 	}
 
 	// Dump rrset type.
 	if (style->generic) {
-		if (snprintf(buf, sizeof(buf), "TYPE%u", rrset->type) < 0) {
+		memcpy(buf, "TYPE", 4);
+		ret = 4 + num_to_str(buf + 4, rrset->type);
+	} else {
+		ret = type_to_out(buf, sizeof(buf), rrset->type);
+		if (ret < 0) {
 			return KNOT_ESPACE;
 		}
-	} else if (knot_rrtype_to_string(rrset->type, buf, sizeof(buf)) < 0) {
-		return KNOT_ESPACE;
 	}
-	if (rrset->rrs.rr_count > 0) {
-		ret = snprintf(dst + len, maxlen - len, "%s%c", buf, sep);
-	} else {
-		ret = snprintf(dst + len, maxlen - len, "%s", buf);
+	if (rrset->rrs.rr_count == 0) {
+		sep = '\0';
+	}
+	ret = header_field(dst + len, maxlen - len, buf, ret, 0, sep);
+	if (ret < 0) {
+		return ret;
 	}
-	SNPRINTF_CHECK(ret, maxlen - len);
 	len += ret;
 
 	return len;
@@ -2004,22 +2157,39 @@ static int rrset_txt_dump(const knot_rrset_t      *rrset,
 	}
 
 	size_t len = 0;
+	size_t header_pos = 0;
+	size_t header_len = 0;
+	uint32_t header_ttl = 0;
 
 	// Loop over rdata in rrset.
 	uint16_t rr_count = rrset->rrs.rr_count;
 	for (uint16_t i = 0; i < rr_count; i++) {
 		// Dump rdata owner, class, ttl and type.
 		const knot_rdata_t *rr_data = knot_rdataset_at(&rrset->rrs, i);
-		int ret = knot_rrset_txt_dump_header(rrset, knot_rdata_ttl(rr_data),
-		                                     dst + len, maxlen - len, style);
-		if (ret < 0) {
-			return KNOT_ESPACE;
+		uint32_t ttl = knot_rdata_ttl(rr_data);
+		if (i > 0 && ttl == header_ttl) {
+			// Same as the previous header.
+			if (header_len >= maxlen - len) {
+				return KNOT_ESPACE;
+			}
+			memcpy(dst + len, dst + header_pos, header_len);
+			header_pos = len;
+			len += header_len;
+		} else {
+			int ret = knot_rrset_txt_dump_header(rrset, ttl, dst + len,
+			                                     maxlen - len, style);
+			if (ret < 0) {
+				return KNOT_ESPACE;
+			}
+			header_pos = len;
+			header_len = ret;
+			header_ttl = ttl;
+			len += ret;
 		}
-		len += ret;
 
 		// Dump rdata as such.
-		ret = knot_rrset_txt_dump_data(rrset, i, dst + len,
-		                               maxlen - len, style);
+		int ret = knot_rrset_txt_dump_data(rrset, i, dst + len,
+		                                   maxlen - len, style);
 		if (ret < 0) {
 			return KNOT_ESPACE;
 		}
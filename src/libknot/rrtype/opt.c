@@ -736,3 +736,48 @@ int knot_edns_client_subnet_get_addr(struct sockaddr_storage *addr,
 
 	return KNOT_EOK;
 }
+
+_public_
+size_t knot_edns_keepalive_size(uint16_t timeout)
+{
+	return (timeout > 0) ? sizeof(uint16_t) : 0;
+}
+
+_public_
+int knot_edns_keepalive_write(uint8_t *option, size_t option_len,
+                              uint16_t timeout)
+{
+	if (timeout == 0) {
+		return KNOT_EOK;
+	}
+
+	if (option == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	wire_ctx_t wire = wire_ctx_init(option, option_len);
+	wire_ctx_write_u16(&wire, timeout);
+
+	return wire.error;
+}
+
+_public_
+int knot_edns_keepalive_parse(uint16_t *timeout, const uint8_t *option,
+                              size_t option_len)
+{
+	if (timeout == NULL || (option == NULL && option_len > 0)) {
+		return KNOT_EINVAL;
+	}
+
+	*timeout = 0;
+
+	switch (option_len) {
+	case 0:
+		return KNOT_EOK;
+	case sizeof(uint16_t):
+		*timeout = wire_read_u16(option);
+		return KNOT_EOK;
+	default:
+		return KNOT_EMALF;
+	}
+}
@@ -51,6 +51,8 @@ enum knot_edns_const {
 	KNOT_EDNS_MAX_OPTION_CLIENT_SUBNET = 20,
 	/*! \brief Maximal size of EDNS client subnet address in bytes (IPv6). */
 	KNOT_EDNS_CLIENT_SUBNET_ADDRESS_MAXLEN = 16,
+	/*! \brief Maximal EDNS TCP keepalive data size. */
+	KNOT_EDNS_MAX_OPTION_TCP_KEEPALIVE = 2,
 
 	/*! \brief NSID option code. */
 	KNOT_EDNS_OPTION_NSID          = 3,
@@ -58,6 +60,8 @@ enum knot_edns_const {
 	KNOT_EDNS_OPTION_CLIENT_SUBNET = 8,
 	/*! \brief EDNS DNS Cookie option code. */
 	KNOT_EDNS_OPTION_COOKIE        = 10,
+	/*! \brief EDNS TCP Keepalive option code. */
+	KNOT_EDNS_OPTION_TCP_KEEPALIVE = 11,
 	/*! \brief EDNS Padding option code. */
 	KNOT_EDNS_OPTION_PADDING       = 12
 };
@@ -451,4 +455,37 @@ int knot_edns_client_subnet_set_addr(knot_edns_client_subnet_t *ecs,
 int knot_edns_client_subnet_get_addr(struct sockaddr_storage *addr,
                                      const knot_edns_client_subnet_t *ecs);
 
+/*!
+ * \brief Get the wire size of the EDNS TCP keepalive option data.
+ *
+ * \param timeout  Idle timeout in units of 100 milliseconds (0 means none).
+ *
+ * \return Size of the option data.
+ */
+size_t knot_edns_keepalive_size(uint16_t timeout);
+
+/*!
+ * \brief Write EDNS TCP keepalive option data (RFC 7828).
+ *
+ * \param option      Option data buffer.
+ * \param option_len  Size of the option data buffer.
+ * \param timeout     Idle timeout in units of 100 milliseconds (0 means none).
+ *
+ * \return Error code, KNOT_EOK if successful.
+ */
+int knot_edns_keepalive_write(uint8_t *option, size_t option_len,
+                              uint16_t timeout);
+
+/*!
+ * \brief Parse EDNS TCP keepalive option data (RFC 7828).
+ *
+ * \param timeout     Parsed idle timeout (0 if the timeout is not present).
+ * \param option      Option data.
+ * \param option_len  Option data length.
+ *
+ * \return Error code, KNOT_EOK if successful.
+ */
+int knot_edns_keepalive_parse(uint16_t *timeout, const uint8_t *option,
+                              size_t option_len);
+
 /*! @} */
@@ -104,13 +104,14 @@ static int compute_digest(const uint8_t *wire, size_t wire_len,
 	}
 
 	dnssec_binary_t cover = { .data = (uint8_t *)wire, .size = wire_len };
-	dnssec_tsig_add(ctx, &cover);
-
-	*digest_len = dnssec_tsig_size(ctx);
-	dnssec_tsig_write(ctx, digest);
+	result = dnssec_tsig_add(ctx, &cover);
+	if (result == DNSSEC_EOK) {
+		*digest_len = dnssec_tsig_size(ctx);
+		result = dnssec_tsig_write(ctx, digest);
+	}
 	dnssec_tsig_free(ctx);
 
-	return KNOT_EOK;
+	return (result == DNSSEC_EOK) ? KNOT_EOK : KNOT_TSIG_EBADSIG;
 }
 
 static int check_time_signed(const knot_rrset_t *tsig_rr,
@@ -293,61 +294,6 @@ static int create_sign_wire(const uint8_t *msg, size_t msg_len,
 	return KNOT_EOK;
 }
 
-static int create_sign_wire_next(const uint8_t *msg, size_t msg_len,
-                                 const uint8_t *prev_mac, size_t prev_mac_len,
-                                 uint8_t *digest, size_t *digest_len,
-                                 const knot_rrset_t *tmp_tsig,
-                                 const knot_tsig_key_t *key)
-{
-	if (!msg || !key || digest_len == NULL) {
-		return KNOT_EINVAL;
-	}
-
-	/* Create tmp TSIG. */
-	int ret = KNOT_EOK;
-
-	/*
-	 * Create tmp wire, it should contain message
-	 * plus request mac plus tsig varibles.
-	 */
-	size_t wire_len = sizeof(uint8_t) *
-	                (msg_len + prev_mac_len +
-			knot_tsig_rdata_tsig_timers_length() + 2);
-	uint8_t *wire = malloc(wire_len);
-	if (!wire) {
-		return KNOT_ENOMEM;
-	}
-
-	memset(wire, 0, wire_len);
-
-	/* Copy the request MAC - should work even if NULL. */
-	wire_write_u16(wire, prev_mac_len);
-	memcpy(wire + 2, prev_mac, sizeof(uint8_t) * prev_mac_len);
-	/* Copy the original message. */
-	memcpy(wire + prev_mac_len + 2, msg, msg_len);
-	/* Copy TSIG variables. */
-
-	ret = wire_write_timers(wire + prev_mac_len + msg_len + 2,
-	                                  tmp_tsig);
-	if (ret != KNOT_EOK) {
-		free(wire);
-		return ret;
-	}
-
-	/* Compute digest. */
-	ret = compute_digest(wire, wire_len,
-	                               digest, digest_len, key);
-	if (ret != KNOT_EOK) {
-		*digest_len = 0;
-		free(wire);
-		return ret;
-	}
-
-	free(wire);
-
-	return KNOT_EOK;
-}
-
 _public_
 int knot_tsig_sign(uint8_t *msg, size_t *msg_len, size_t msg_max_len,
                    const uint8_t *request_mac, size_t request_mac_len,
@@ -537,16 +483,99 @@ int knot_tsig_sign_next(uint8_t *msg, size_t *msg_len, size_t msg_max_len,
 	return KNOT_EOK;
 }
 
-static int check_digest(const knot_rrset_t *tsig_rr,
-                        const uint8_t *wire, size_t size,
-                        const uint8_t *request_mac, size_t request_mac_len,
-                        const knot_tsig_key_t *tsig_key,
-                        uint64_t prev_time_signed, int use_times)
+_public_
+int knot_tsig_stream_begin(knot_tsig_stream_t *stream,
+                           const uint8_t *prev_digest, size_t prev_digest_len,
+                           const knot_tsig_key_t *key, bool use_times)
 {
-	if (!wire || !tsig_key) {
+	if (!stream || !key || (prev_digest_len > 0 && !prev_digest)) {
 		return KNOT_EINVAL;
 	}
 
+	stream->hmac = NULL;
+	stream->use_times = use_times;
+
+	int ret = dnssec_tsig_new(&stream->hmac, key->algorithm, &key->secret);
+	if (ret != DNSSEC_EOK) {
+		stream->hmac = NULL;
+		return KNOT_TSIG_EBADSIG;
+	}
+
+	/* Prefix with the request MAC or the previous digest. */
+	if (prev_digest_len > 0 || use_times) {
+		uint8_t len[2];
+		wire_write_u16(len, prev_digest_len);
+		dnssec_binary_t cover = { .data = len, .size = sizeof(len) };
+		ret = dnssec_tsig_add(stream->hmac, &cover);
+
+		if (ret == DNSSEC_EOK && prev_digest_len > 0) {
+			cover.data = (uint8_t *)prev_digest;
+			cover.size = prev_digest_len;
+			ret = dnssec_tsig_add(stream->hmac, &cover);
+		}
+
+		if (ret != DNSSEC_EOK) {
+			knot_tsig_stream_clear(stream);
+			return KNOT_TSIG_EBADSIG;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+_public_
+int knot_tsig_stream_add(knot_tsig_stream_t *stream,
+                         const uint8_t *wire, size_t size)
+{
+	if (!stream || !stream->hmac || !wire) {
+		return KNOT_EINVAL;
+	}
+
+	dnssec_binary_t cover = { .data = (uint8_t *)wire, .size = size };
+	if (dnssec_tsig_add(stream->hmac, &cover) != DNSSEC_EOK) {
+		return KNOT_TSIG_EBADSIG;
+	}
+
+	return KNOT_EOK;
+}
+
+static int stream_add_variables(knot_tsig_stream_t *stream,
+                                const knot_rrset_t *tsig_rr)
+{
+	dnssec_binary_t cover = { 0 };
+
+	if (stream->use_times) {
+		uint8_t timers[KNOT_TSIG_TIMERS_LENGTH];
+		wire_write_timers(timers, tsig_rr);
+		cover.data = timers;
+		cover.size = sizeof(timers);
+		if (dnssec_tsig_add(stream->hmac, &cover) != DNSSEC_EOK) {
+			return KNOT_TSIG_EBADSIG;
+		}
+		return KNOT_EOK;
+	}
+
+	cover.size = knot_tsig_rdata_tsig_variables_length(tsig_rr);
+	cover.data = malloc(cover.size);
+	if (!cover.data) {
+		return KNOT_ENOMEM;
+	}
+
+	int ret = write_tsig_variables(cover.data, tsig_rr);
+	if (ret == KNOT_EOK && dnssec_tsig_add(stream->hmac, &cover) != DNSSEC_EOK) {
+		ret = KNOT_TSIG_EBADSIG;
+	}
+
+	free(cover.data);
+
+	return ret;
+}
+
+static int stream_check(knot_tsig_stream_t *stream,
+                        const knot_rrset_t *tsig_rr,
+                        const knot_tsig_key_t *tsig_key,
+                        uint64_t prev_time_signed)
+{
 	/* No TSIG record means verification failure. */
 	if (tsig_rr == NULL) {
 		return KNOT_TSIG_EBADKEY;
@@ -570,41 +599,20 @@ static int check_digest(const knot_rrset_t *tsig_rr,
 		return ret;
 	}
 
-	uint8_t *wire_to_sign = malloc(sizeof(uint8_t) * size);
-	if (!wire_to_sign) {
-		return KNOT_ENOMEM;
-	}
-
-	memset(wire_to_sign, 0, sizeof(uint8_t) * size);
-	memcpy(wire_to_sign, wire, size);
-
-	uint8_t digest_tmp[KNOT_TSIG_MAX_DIGEST_SIZE];
-	size_t digest_tmp_len = 0;
 	assert(tsig_rr->rrs.rr_count > 0);
 
-	if (use_times) {
-		/* Wire is not a single packet, TSIG RRs must be stripped already. */
-		ret = create_sign_wire_next(wire_to_sign, size,
-		                                 request_mac, request_mac_len,
-		                                 digest_tmp, &digest_tmp_len,
-		                                 tsig_rr, tsig_key);
-	} else {
-		ret = create_sign_wire(wire_to_sign, size,
-		                            request_mac, request_mac_len,
-		                            digest_tmp, &digest_tmp_len,
-		                            tsig_rr, tsig_key);
-	}
-
-	assert(tsig_rr->rrs.rr_count > 0);
-	free(wire_to_sign);
-
+	ret = stream_add_variables(stream, tsig_rr);
 	if (ret != KNOT_EOK) {
 		return ret;
 	}
 
+	uint8_t digest_tmp[KNOT_TSIG_MAX_DIGEST_SIZE];
+	if (dnssec_tsig_write(stream->hmac, digest_tmp) != DNSSEC_EOK) {
+		return KNOT_TSIG_EBADSIG;
+	}
+
 	/* Compare MAC from TSIG RR RDATA with just computed digest. */
 
-	/*!< \todo move to function. */
 	const knot_dname_t *alg_name = knot_tsig_rdata_alg_name(tsig_rr);
 	dnssec_tsig_algorithm_t alg = dnssec_tsig_algorithm_from_dname(alg_name);
 
@@ -612,7 +620,8 @@ static int check_digest(const knot_rrset_t *tsig_rr,
 	uint16_t mac_length = knot_tsig_rdata_mac_length(tsig_rr);
 	const uint8_t *tsig_mac = knot_tsig_rdata_mac(tsig_rr);
 
-	if (mac_length != dnssec_tsig_algorithm_size(alg)) {
+	if (mac_length != dnssec_tsig_algorithm_size(alg) ||
+	    mac_length != dnssec_tsig_size(stream->hmac)) {
 		return KNOT_TSIG_EBADSIG;
 	}
 
@@ -623,13 +632,67 @@ static int check_digest(const knot_rrset_t *tsig_rr,
 	return KNOT_EOK;
 }
 
+_public_
+int knot_tsig_stream_check(knot_tsig_stream_t *stream,
+                           const knot_rrset_t *tsig_rr,
+                           const knot_tsig_key_t *key,
+                           uint64_t prev_time_signed)
+{
+	if (!stream || !stream->hmac || !key) {
+		knot_tsig_stream_clear(stream);
+		return KNOT_EINVAL;
+	}
+
+	int ret = stream_check(stream, tsig_rr, key, prev_time_signed);
+	knot_tsig_stream_clear(stream);
+
+	return ret;
+}
+
+_public_
+void knot_tsig_stream_clear(knot_tsig_stream_t *stream)
+{
+	if (!stream) {
+		return;
+	}
+
+	dnssec_tsig_free(stream->hmac);
+	stream->hmac = NULL;
+}
+
+static int check_digest(const knot_rrset_t *tsig_rr,
+                        const uint8_t *wire, size_t size,
+                        const uint8_t *request_mac, size_t request_mac_len,
+                        const knot_tsig_key_t *tsig_key,
+                        uint64_t prev_time_signed, bool use_times)
+{
+	if (!wire || !tsig_key) {
+		return KNOT_EINVAL;
+	}
+
+	knot_tsig_stream_t stream;
+	int ret = knot_tsig_stream_begin(&stream, request_mac, request_mac_len,
+	                                 tsig_key, use_times);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	ret = knot_tsig_stream_add(&stream, wire, size);
+	if (ret != KNOT_EOK) {
+		knot_tsig_stream_clear(&stream);
+		return ret;
+	}
+
+	return knot_tsig_stream_check(&stream, tsig_rr, tsig_key, prev_time_signed);
+}
+
 _public_
 int knot_tsig_server_check(const knot_rrset_t *tsig_rr,
                            const uint8_t *wire, size_t size,
                            const knot_tsig_key_t *tsig_key)
 {
 	return check_digest(tsig_rr, wire, size, NULL, 0, tsig_key,
-	                              0, 0);
+	                              0, false);
 }
 
 _public_
@@ -641,7 +704,7 @@ int knot_tsig_client_check(const knot_rrset_t *tsig_rr,
 {
 	return check_digest(tsig_rr, wire, size, request_mac,
 	                              request_mac_len, tsig_key,
-	                              prev_time_signed, 0);
+	                              prev_time_signed, false);
 }
 
 _public_
@@ -654,7 +717,7 @@ int knot_tsig_client_check_next(const knot_rrset_t *tsig_rr,
 {
 	return check_digest(tsig_rr, wire, size, prev_digest,
 	                              prev_digest_len, tsig_key,
-	                              prev_time_signed, 1);
+	                              prev_time_signed, true);
 }
 
 _public_
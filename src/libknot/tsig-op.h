@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "libknot/rrtype/tsig.h"
@@ -157,6 +158,66 @@ int knot_tsig_client_check_next(const knot_rrset_t *tsig_rr,
                                 const knot_tsig_key_t *key,
                                 uint64_t prev_time_signed);
 
+/*!
+ * \brief Running digest of a multi-message response.
+ *
+ * The messages of a TCP session are hashed as they arrive, so the unsigned
+ * messages between two signed ones don't have to be buffered.
+ */
+typedef struct {
+	dnssec_tsig_ctx_t *hmac; /*!< Running HMAC, NULL if not started. */
+	bool use_times;          /*!< Cover only timers, not the TSIG variables. */
+} knot_tsig_stream_t;
+
+/*!
+ * \brief Starts a digest covering the messages up to the next signed one.
+ *
+ * \param stream Stream to be started.
+ * \param prev_digest Request MAC or previous digest in the session.
+ * \param prev_digest_len Size of the previous digest in bytes.
+ * \param key TSIG key.
+ * \param use_times Set for the 2nd or later signed message in the session.
+ *
+ * \retval KNOT_EOK if successful.
+ */
+int knot_tsig_stream_begin(knot_tsig_stream_t *stream,
+                           const uint8_t *prev_digest, size_t prev_digest_len,
+                           const knot_tsig_key_t *key, bool use_times);
+
+/*!
+ * \brief Adds a message (with the TSIG RR stripped) to the running digest.
+ *
+ * \param stream Started stream.
+ * \param wire Wire format of the message.
+ * \param size Size of the wire format of the message in bytes.
+ *
+ * \retval KNOT_EOK if successful.
+ */
+int knot_tsig_stream_add(knot_tsig_stream_t *stream,
+                         const uint8_t *wire, size_t size);
+
+/*!
+ * \brief Finishes the digest and checks it against the signed message.
+ *
+ * The stream is cleared regardless of the result.
+ *
+ * \param stream Started stream, including the signed message.
+ * \param tsig_rr TSIG extracted from the signed message.
+ * \param key TSIG key.
+ * \param prev_time_signed Time signed of the previous signed message.
+ *
+ * \retval KNOT_EOK If the signature is valid.
+ */
+int knot_tsig_stream_check(knot_tsig_stream_t *stream,
+                           const knot_rrset_t *tsig_rr,
+                           const knot_tsig_key_t *key,
+                           uint64_t prev_time_signed);
+
+/*!
+ * \brief Clears the stream, the running digest is dropped.
+ */
+void knot_tsig_stream_clear(knot_tsig_stream_t *stream);
+
 /*!
  * \todo Documentation!
  */
@@ -40,6 +40,7 @@
 #define CMD_ZONE_CHECK		"zone-check"
 #define CMD_ZONE_MEMSTATS	"zone-memstats"
 #define CMD_ZONE_STATUS		"zone-status"
+#define CMD_ZONE_CPUTIME	"zone-cputime"
 #define CMD_ZONE_RELOAD		"zone-reload"
 #define CMD_ZONE_REFRESH	"zone-refresh"
 #define CMD_ZONE_RETRANSFER	"zone-retransfer"
@@ -211,6 +212,7 @@ static void format_data(ctl_cmd_t cmd, knot_ctl_type_t data_type,
 		}
 		break;
 	case CTL_ZONE_STATUS:
+	case CTL_ZONE_CPUTIME:
 	case CTL_ZONE_RELOAD:
 	case CTL_ZONE_REFRESH:
 	case CTL_ZONE_RETRANSFER:
@@ -232,7 +234,7 @@ static void format_data(ctl_cmd_t cmd, knot_ctl_type_t data_type,
 			       (error != NULL ? ")"       : ""));
 			*empty = false;
 		}
-		if (cmd == CTL_ZONE_STATUS && type != NULL) {
+		if ((cmd == CTL_ZONE_STATUS || cmd == CTL_ZONE_CPUTIME) && type != NULL) {
 			printf("%s %s: %s",
 			       (data_type != KNOT_CTL_TYPE_DATA ? " |" : ""),
 			       type, value);
@@ -327,6 +329,7 @@ static void format_block(ctl_cmd_t cmd, bool failed, bool empty)
 		printf("%s\n", failed ? "" : "OK");
 		break;
 	case CTL_ZONE_STATUS:
+	case CTL_ZONE_CPUTIME:
 	case CTL_ZONE_READ:
 	case CTL_ZONE_DIFF:
 	case CTL_ZONE_GET:
@@ -874,6 +877,7 @@ const cmd_desc_t cmd_table[] = {
 	{ CMD_ZONE_CHECK,      cmd_zone_check,    CTL_NONE,            CMD_FOPT_ZONE | CMD_FREAD },
 	{ CMD_ZONE_MEMSTATS,   cmd_zone_memstats, CTL_NONE,            CMD_FOPT_ZONE | CMD_FREAD },
 	{ CMD_ZONE_STATUS,     cmd_zone_ctl,      CTL_ZONE_STATUS,     CMD_FOPT_ZONE },
+	{ CMD_ZONE_CPUTIME,    cmd_zone_ctl,      CTL_ZONE_CPUTIME,    CMD_FOPT_ZONE },
 	{ CMD_ZONE_RELOAD,     cmd_zone_ctl,      CTL_ZONE_RELOAD,     CMD_FOPT_ZONE },
 	{ CMD_ZONE_REFRESH,    cmd_zone_ctl,      CTL_ZONE_REFRESH,    CMD_FOPT_ZONE },
 	{ CMD_ZONE_RETRANSFER, cmd_zone_ctl,      CTL_ZONE_RETRANSFER, CMD_FOPT_ZONE },
@@ -916,6 +920,7 @@ static const cmd_help_t cmd_help_table[] = {
 	{ CMD_ZONE_CHECK,      "[<zone>...]",                            "Check if the zone can be loaded. (*)" },
 	{ CMD_ZONE_MEMSTATS,   "[<zone>...]",                            "Estimate memory use for the zone. (*)" },
 	{ CMD_ZONE_STATUS,     "[<zone>...]",                            "Show the zone status." },
+	{ CMD_ZONE_CPUTIME,    "[<zone>...]",                            "Show the CPU time spent on the zone." },
 	{ CMD_ZONE_RELOAD,     "[<zone>...]",                            "Reload a zone from a disk." },
 	{ CMD_ZONE_REFRESH,    "[<zone>...]",                            "Force slave zone refresh." },
 	{ CMD_ZONE_RETRANSFER, "[<zone>...]",                            "Force slave zone retransfer (no serial check)." },
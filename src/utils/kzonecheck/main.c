@@ -33,6 +33,7 @@ static void print_help(void)
 	       "Parameters:\n"
 	       " -o, --origin <zone_origin>  Zone name.\n"
 	       "                              (default filename or filename without .zone)\n"
+	       " -d, --dnssec                Verify DNSSEC signatures.\n"
 	       " -v, --verbose               Enable debug output.\n"
 	       " -h, --help                  Print the program help.\n"
 	       " -V, --version               Print the program version.\n"
@@ -44,11 +45,13 @@ int main(int argc, char *argv[])
 {
 	const char *origin = NULL;
 	bool verbose = false;
+	bool dnssec = false;
 	FILE *outfile = stdout;
 
 	/* Long options. */
 	struct option opts[] = {
 		{ "origin",  required_argument, NULL, 'o' },
+		{ "dnssec",  no_argument,       NULL, 'd' },
 		{ "verbose", no_argument,       NULL, 'v' },
 		{ "help",    no_argument,       NULL, 'h' },
 		{ "version", no_argument,       NULL, 'V' },
@@ -57,11 +60,14 @@ int main(int argc, char *argv[])
 
 	/* Parse command line arguments */
 	int opt = 0;
-	while ((opt = getopt_long(argc, argv, "o:vVh", opts, NULL)) != -1) {
+	while ((opt = getopt_long(argc, argv, "o:dvVh", opts, NULL)) != -1) {
 		switch (opt) {
 		case 'o':
 			origin = optarg;
 			break;
+		case 'd':
+			dnssec = true;
+			break;
 		case 'v':
 			verbose = true;
 			break;
@@ -112,7 +118,7 @@ int main(int argc, char *argv[])
 
 	knot_dname_t *dname = knot_dname_from_str_alloc(zonename);
 	free(zonename);
-	int ret = zone_check(filename, dname, outfile);
+	int ret = zone_check(filename, dname, dnssec, outfile);
 	knot_dname_free(&dname, NULL);
 
 	log_close();
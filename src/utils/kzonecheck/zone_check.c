@@ -16,7 +16,10 @@
 
 #include <stdio.h>
 #include <assert.h>
+#include <time.h>
 
+#include "knot/dnssec/zone-verify.h"
+#include "knot/server/dthreads.h"
 #include "knot/zone/contents.h"
 #include "knot/zone/zonefile.h"
 #include "contrib/ucw/lists.h"
@@ -78,7 +81,7 @@ static void print_statistics(err_handler_stats_t *handler)
 }
 
 int zone_check(const char *zone_file, const knot_dname_t *zone_name,
-               FILE *outfile)
+               bool dnssec, FILE *outfile)
 {
 	zloader_t zl;
 	int ret = zonefile_open(&zl, zone_file, zone_name, true);
@@ -97,6 +100,16 @@ int zone_check(const char *zone_file, const knot_dname_t *zone_name,
 	zone_contents_t *contents;
 	contents = zonefile_load(&zl);
 
+	if (contents != NULL && dnssec) {
+		int vret = knot_zone_verify(contents, time(NULL), dt_optimal_size(),
+		                            &handler._cb);
+		if (vret != KNOT_EOK && vret != KNOT_ESEMCHECK) {
+			zone_contents_deep_free(&contents);
+			zonefile_close(&zl);
+			return vret;
+		}
+	}
+
 	if (handler.error_count > 0) {
 		ret = KNOT_ESEMCHECK;
 		print_statistics(&handler);
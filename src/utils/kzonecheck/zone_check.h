@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <stdbool.h>
+
 #include "libknot/libknot.h"
 
 int zone_check(const char *zone_file, const knot_dname_t *zone_name,
-               FILE *outfile);
+               bool dnssec, FILE *outfile);
@@ -0,0 +1,97 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "base_zone.h"
+#include "libknot/libknot.h"
+#include "zscanner/scanner.h"
+
+static const char *ZONE_TEXT =
+	"@       SOA   ns1 hostmaster 2016010101 3600 900 604800 300\n"
+	"@       NS    ns1\n"
+	"@       NS    ns2\n"
+	"@       MX    10 mail\n"
+	"@       TXT   \"v=spf1 mx -all\"\n"
+	"ns1     A     192.0.2.1\n"
+	"ns2     A     192.0.2.2\n"
+	"ns2     AAAA  2001:db8::2\n"
+	"mail    A     192.0.2.3\n"
+	"www     CNAME @\n"
+	"*.wild  A     192.0.2.4\n"
+	"sub     NS    ns.sub\n"
+	"ns.sub  A     192.0.2.5\n"
+	"a.b.c   TXT   \"empty non-terminals\"\n";
+
+static void add_record(zs_scanner_t *s)
+{
+	zone_contents_t *contents = s->process.data;
+
+	knot_rrset_t rr;
+	knot_rrset_init(&rr, s->r_owner, s->r_type, s->r_class);
+	if (knot_rrset_add_rdata(&rr, s->r_data, s->r_data_length, s->r_ttl,
+	                         NULL) != KNOT_EOK) {
+		s->state = ZS_STATE_STOP;
+		return;
+	}
+
+	zone_node_t *node = NULL;
+	if (zone_contents_add_rr(contents, &rr, &node) != KNOT_EOK) {
+		s->state = ZS_STATE_STOP;
+	}
+	knot_rdataset_clear(&rr.rrs, NULL);
+}
+
+zone_t *base_zone_new(void)
+{
+	knot_dname_t *apex = knot_dname_from_str_alloc(BASE_ZONE);
+	if (apex == NULL) {
+		return NULL;
+	}
+
+	zone_t *zone = zone_new(apex);
+	zone_contents_t *contents = zone_contents_new(apex);
+	knot_dname_free(&apex, NULL);
+	if (zone == NULL || contents == NULL) {
+		zone_free(&zone);
+		zone_contents_free(&contents);
+		return NULL;
+	}
+
+	zs_scanner_t s;
+	int ret = zs_init(&s, BASE_ZONE, KNOT_CLASS_IN, 3600);
+	if (ret == 0) {
+		ret = zs_set_processing(&s, add_record, NULL, contents);
+	}
+	if (ret == 0) {
+		ret = zs_set_input_string(&s, ZONE_TEXT, strlen(ZONE_TEXT));
+	}
+	if (ret == 0) {
+		ret = zs_parse_all(&s);
+	}
+	zs_deinit(&s);
+
+	if (ret != 0 || s.state == ZS_STATE_STOP ||
+	    zone_contents_adjust_full(contents) != KNOT_EOK) {
+		zone_contents_deep_free(&contents);
+		zone_free(&zone);
+		return NULL;
+	}
+
+	zone->contents = contents;
+
+	return zone;
+}
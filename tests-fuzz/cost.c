@@ -0,0 +1,220 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "cost.h"
+
+#define COST_FEATURES 64
+
+static int counter_fd = -1;
+static uint64_t cost_base;
+static uint64_t cost_per_byte;
+static const char *regression_dir = ".";
+
+static uint64_t start_value;
+static uint64_t limit_value;
+
+#ifdef LIBFUZZER
+/* Extra coverage for libFuzzer, one feature per cost class. */
+__attribute__((section("__libfuzzer_extra_counters")))
+static uint8_t cost_features[COST_FEATURES];
+#endif
+
+static void counter_open(void)
+{
+#ifdef __linux__
+	struct perf_event_attr attr = {
+		.type = PERF_TYPE_HARDWARE,
+		.size = sizeof(attr),
+		.config = PERF_COUNT_HW_INSTRUCTIONS,
+		.exclude_kernel = 1,
+		.exclude_hv = 1
+	};
+
+	counter_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+
+	/* Some virtual machines open the counter but never count. */
+	uint64_t value;
+	if (counter_fd >= 0 &&
+	    (read(counter_fd, &value, sizeof(value)) != sizeof(value) || value == 0)) {
+		close(counter_fd);
+		counter_fd = -1;
+	}
+#endif
+}
+
+static uint64_t counter_value(void)
+{
+	uint64_t value;
+	if (counter_fd >= 0 && read(counter_fd, &value, sizeof(value)) == sizeof(value)) {
+		return value;
+	}
+
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t env_u64(const char *name, uint64_t dflt)
+{
+	const char *value = getenv(name);
+	return (value != NULL) ? strtoull(value, NULL, 10) : dflt;
+}
+
+static int cost_init(void)
+{
+	counter_open();
+
+	cost_base = env_u64("KNOT_FUZZ_COST_BASE", cost_target.base);
+	cost_per_byte = env_u64("KNOT_FUZZ_COST_PER_BYTE", cost_target.per_byte);
+	const char *dir = getenv("KNOT_FUZZ_REGRESSION_DIR");
+	if (dir != NULL) {
+		regression_dir = dir;
+	}
+
+	return (cost_target.init != NULL) ? cost_target.init() : 0;
+}
+
+static void save_input(const uint8_t *data, size_t size)
+{
+	/* FNV-1a keeps the name stable for the same input. */
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ data[i]) * 0x100000001b3ULL;
+	}
+
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/%s-%016" PRIx64, regression_dir,
+	         cost_target.name, hash);
+
+	FILE *file = fopen(path, "wb");
+	if (file == NULL || fwrite(data, 1, size, file) != size) {
+		fprintf(stderr, "failed to save %s\n", path);
+	} else {
+		fprintf(stderr, "saved %s\n", path);
+	}
+	if (file != NULL) {
+		fclose(file);
+	}
+}
+
+bool cost_exceeded(void)
+{
+	return counter_value() - start_value > limit_value;
+}
+
+/*!
+ * \brief Runs the target on one input, returns the cost and the bound.
+ */
+static void cost_run(const uint8_t *data, size_t size, uint64_t *cost, uint64_t *bound)
+{
+	*bound = cost_base + cost_per_byte * size;
+	limit_value = *bound;
+
+	start_value = counter_value();
+	cost_target.run(data, size);
+	*cost = counter_value() - start_value;
+
+#ifdef LIBFUZZER
+	/* Logarithmic cost per byte, relative to the bound. */
+	uint64_t unit = (cost_per_byte > 0) ? cost_per_byte : 1;
+	uint64_t ratio = *cost / (unit * (size + 1));
+	unsigned class = 0;
+	while (ratio > 0 && class < COST_FEATURES - 1) {
+		ratio >>= 1;
+		class += 1;
+	}
+	cost_features[class] = 1;
+#endif
+}
+
+#ifdef LIBFUZZER
+
+int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+	return cost_init();
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	uint64_t cost, bound;
+	cost_run(data, size, &cost, &bound);
+	if (cost > bound) {
+		fprintf(stderr, "%s: cost %" PRIu64 " over bound %" PRIu64 " for %zu bytes\n",
+		        cost_target.name, cost, bound, size);
+		save_input(data, size);
+		abort();
+	}
+
+	return 0;
+}
+
+#else
+
+static int run_file(const char *name, FILE *file)
+{
+	static uint8_t buffer[1 << 20];
+	size_t size = fread(buffer, 1, sizeof(buffer), file);
+
+	uint64_t cost, bound;
+	cost_run(buffer, size, &cost, &bound);
+	printf("%s: %zu bytes, cost %" PRIu64 ", bound %" PRIu64 "%s\n", name,
+	       size, cost, bound, (cost > bound) ? ", EXCEEDED" : "");
+	if (cost > bound) {
+		save_input(buffer, size);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if (cost_init() != 0) {
+		fprintf(stderr, "%s: failed to initialize\n", cost_target.name);
+		return EXIT_FAILURE;
+	}
+
+	int failed = 0;
+	if (argc < 2) {
+		failed = run_file("stdin", stdin);
+	}
+	for (int i = 1; i < argc; i++) {
+		FILE *file = fopen(argv[i], "rb");
+		if (file == NULL) {
+			perror(argv[i]);
+			return EXIT_FAILURE;
+		}
+		failed |= run_file(argv[i], file);
+		fclose(file);
+	}
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#endif
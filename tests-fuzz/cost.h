@@ -0,0 +1,62 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Algorithmic-complexity fuzzing. A target processes one input and the
+ * driver measures the cost of the processing: retired user-space
+ * instructions from perf_event_open(2), or the thread CPU time in
+ * nanoseconds if the counter is not available. The cost must be linear in
+ * the input size:
+ *
+ *   cost <= base + per_byte * size
+ *
+ * An input over the bound is written to the regression directory as
+ * "<target>-<hash>" and reported as a failure. The standalone driver runs
+ * the files given on the command line (or stdin), so saved inputs can be
+ * replayed. With libFuzzer, the cost per input byte is also exported as an
+ * extra coverage feature, so inputs reaching a higher cost class are kept in
+ * the corpus and mutated further.
+ *
+ * Environment:
+ *   KNOT_FUZZ_COST_BASE       Constant part of the bound.
+ *   KNOT_FUZZ_COST_PER_BYTE   Per-byte part of the bound.
+ *   KNOT_FUZZ_REGRESSION_DIR  Directory for inputs over the bound (default ".").
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*! \brief Fuzzing target description. */
+typedef struct {
+	const char *name;   /*!< Target name, prefix of the saved inputs. */
+	uint64_t base;      /*!< Default constant part of the bound. */
+	uint64_t per_byte;  /*!< Default per-byte part of the bound. */
+	int (*init)(void);  /*!< Optional one-time initialization. */
+	void (*run)(const uint8_t *data, size_t size); /*!< Input processing. */
+} cost_target_t;
+
+/*! \brief The target, defined once in each fuzzing program. */
+extern const cost_target_t cost_target;
+
+/*!
+ * \brief Checks if the current input is already over the bound.
+ *
+ * Targets with potentially unbounded loops may call it to stop early.
+ */
+bool cost_exceeded(void);
@@ -0,0 +1,89 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost-bounded fuzzing of the DDNS processing, see cost.h. The input is an
+ * UPDATE message for the base zone, the prerequisites are checked and the
+ * update is applied onto a copy of the zone, which is then discarded.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/updates/apply.h"
+#include "knot/updates/ddns.h"
+#include "knot/updates/zone-update.h"
+#include "libknot/libknot.h"
+#include "base_zone.h"
+#include "cost.h"
+
+static zone_t *zone;
+
+static int init(void)
+{
+	zone = base_zone_new();
+	return (zone != NULL) ? 0 : -1;
+}
+
+static void process(const knot_pkt_t *query)
+{
+	if (knot_wire_get_opcode(query->wire) != KNOT_OPCODE_UPDATE ||
+	    knot_wire_get_qdcount(query->wire) != 1 ||
+	    !knot_dname_is_equal(knot_pkt_qname(query), zone->name)) {
+		return;
+	}
+
+	zone_update_t up;
+	if (zone_update_init(&up, zone, UPDATE_INCREMENTAL) != KNOT_EOK) {
+		return;
+	}
+
+	uint16_t rcode;
+	int ret = ddns_process_prereqs(query, &up, &rcode);
+	if (ret == KNOT_EOK) {
+		ret = ddns_process_update(zone, query, &up, &rcode);
+	}
+	if (ret == KNOT_EOK && !changeset_empty(&up.change)) {
+		apply_finalize(&up.a_ctx);
+	}
+
+	zone_update_clear(&up);
+}
+
+static void run(const uint8_t *data, size_t size)
+{
+	uint8_t *copy = malloc(size + 1);
+	if (copy == NULL) {
+		return;
+	}
+	memcpy(copy, data, size);
+
+	knot_pkt_t *pkt = knot_pkt_new(copy, size, NULL);
+	if (pkt != NULL && knot_pkt_parse(pkt, 0) == KNOT_EOK) {
+		process(pkt);
+	}
+
+	knot_pkt_free(&pkt);
+	free(copy);
+}
+
+const cost_target_t cost_target = {
+	.name = "ddns",
+	.base = 1000000,
+	.per_byte = 1000,
+	.init = init,
+	.run = run
+};
@@ -0,0 +1,130 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost-bounded fuzzing of the IXFR application, see cost.h. The answer
+ * section of the input message is read as an incremental transfer of the
+ * base zone, the changesets are applied onto a copy of the zone, which is
+ * then discarded.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/updates/apply.h"
+#include "knot/updates/changesets.h"
+#include "libknot/libknot.h"
+#include "base_zone.h"
+#include "cost.h"
+
+static zone_t *zone;
+
+static int init(void)
+{
+	zone = base_zone_new();
+	return (zone != NULL) ? 0 : -1;
+}
+
+/*!
+ * \brief Splits the transfer into changesets, same as the IXFR-in processing.
+ */
+static int read_changesets(const knot_pkt_t *pkt, list_t *chgs)
+{
+	const knot_pktsection_t *answer = knot_pkt_section(pkt, KNOT_ANSWER);
+	if (answer->count < 2 || knot_pkt_rr(answer, 0)->type != KNOT_RRTYPE_SOA) {
+		return KNOT_EMALF;
+	}
+
+	const knot_rrset_t *final_soa = knot_pkt_rr(answer, 0);
+	changeset_t *change = NULL;
+	bool adding = true;
+
+	for (uint16_t i = 1; i < answer->count; i++) {
+		const knot_rrset_t *rr = knot_pkt_rr(answer, i);
+		if (!knot_dname_in(zone->name, rr->owner)) {
+			continue;
+		}
+
+		int ret = KNOT_EOK;
+		if (rr->type != KNOT_RRTYPE_SOA) {
+			if (change == NULL) {
+				return KNOT_EMALF;
+			}
+			ret = adding ? changeset_add_addition(change, rr, 0) :
+			               changeset_add_removal(change, rr, 0);
+		} else if (adding) {
+			if (change != NULL &&
+			    knot_rrset_equal(rr, final_soa, KNOT_RRSET_COMPARE_WHOLE)) {
+				return KNOT_EOK;
+			}
+			change = changeset_new(zone->name);
+			if (change == NULL) {
+				return KNOT_ENOMEM;
+			}
+			add_tail(chgs, &change->n);
+			change->soa_from = knot_rrset_copy(rr, NULL);
+			ret = (change->soa_from != NULL) ? KNOT_EOK : KNOT_ENOMEM;
+			adding = false;
+		} else {
+			change->soa_to = knot_rrset_copy(rr, NULL);
+			ret = (change->soa_to != NULL) ? KNOT_EOK : KNOT_ENOMEM;
+			adding = true;
+		}
+
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EMALF;
+}
+
+static void run(const uint8_t *data, size_t size)
+{
+	uint8_t *copy = malloc(size + 1);
+	if (copy == NULL) {
+		return;
+	}
+	memcpy(copy, data, size);
+
+	list_t chgs;
+	init_list(&chgs);
+
+	knot_pkt_t *pkt = knot_pkt_new(copy, size, NULL);
+	if (pkt != NULL && knot_pkt_parse(pkt, 0) == KNOT_EOK &&
+	    read_changesets(pkt, &chgs) == KNOT_EOK) {
+		apply_ctx_t a_ctx = { 0 };
+		apply_init_ctx(&a_ctx, NULL, APPLY_STRICT);
+
+		zone_contents_t *new_contents = NULL;
+		if (apply_changesets(&a_ctx, zone, &chgs, &new_contents) == KNOT_EOK) {
+			update_rollback(&a_ctx);
+			update_free_zone(&new_contents);
+		}
+	}
+
+	changesets_free(&chgs);
+	knot_pkt_free(&pkt);
+	free(copy);
+}
+
+const cost_target_t cost_target = {
+	.name = "ixfr",
+	.base = 1000000,
+	.per_byte = 1000,
+	.init = init,
+	.run = run
+};
@@ -0,0 +1,54 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost-bounded fuzzing of the zone file parser, see cost.h. Includes are
+ * skipped, the input must not touch the file system.
+ */
+
+#include "libknot/libknot.h"
+#include "zscanner/scanner.h"
+#include "cost.h"
+
+static zs_scanner_t scanner;
+
+static void run(const uint8_t *data, size_t size)
+{
+	zs_scanner_t *s = &scanner;
+	if (zs_init(s, "example.com.", KNOT_CLASS_IN, 3600) != 0 ||
+	    zs_set_input_string(s, (const char *)data, size) != 0) {
+		zs_deinit(s);
+		return;
+	}
+
+	for (unsigned records = 1; zs_parse_record(s) == 0; records++) {
+		if (s->state == ZS_STATE_ERROR && s->error.fatal) {
+			break;
+		}
+		if (records % 64 == 0 && cost_exceeded()) {
+			break;
+		}
+	}
+
+	zs_deinit(s);
+}
+
+const cost_target_t cost_target = {
+	.name = "zscanner",
+	.base = 1000000,
+	.per_byte = 100,
+	.run = run
+};
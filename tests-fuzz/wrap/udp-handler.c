@@ -80,7 +80,11 @@ static int udp_stdin_recv(int fd, void *d)
 static int udp_stdin_handle(udp_context_t *ctx, void *d)
 {
 	struct udp_stdin *rq = (struct udp_stdin *)d;
-	udp_handle(ctx, STDIN_FILENO, &rq->addr, &rq->iov[RX], &rq->iov[TX]);
+	struct msghdr msg = {
+		.msg_name = &rq->addr,
+		.msg_namelen = sizeof(rq->addr)
+	};
+	udp_handle(ctx, STDIN_FILENO, &msg, &rq->iov[RX], &rq->iov[TX]);
 	return 0;
 }
 
@@ -0,0 +1,170 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+#define MAX_ITERATIONS (1UL << 30)
+
+static double min_time = 200e6;
+static const char *filter = NULL;
+static bool first = true;
+static double paused = 0;
+static double paused_at = 0;
+
+#ifdef __GLIBC__
+#define COUNT_ALLOCS
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static volatile bool counting = false;
+static size_t allocs = 0;
+
+void *malloc(size_t size)
+{
+	if (counting) {
+		__sync_add_and_fetch(&allocs, 1);
+	}
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	if (counting) {
+		__sync_add_and_fetch(&allocs, 1);
+	}
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	if (counting) {
+		__sync_add_and_fetch(&allocs, 1);
+	}
+	return __libc_realloc(ptr, size);
+}
+#endif
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int bench_init(int argc, char *argv[], const char *suite)
+{
+	int opt;
+	while ((opt = getopt(argc, argv, "t:f:")) != -1) {
+		switch (opt) {
+		case 't':
+			min_time = atof(optarg) * 1e6;
+			break;
+		case 'f':
+			filter = optarg;
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-t <ms>] [-f <name>] [args...]\n", argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	printf("{\"suite\": \"%s\", \"results\": [", suite);
+
+	return optind;
+}
+
+void bench_run(const char *name, bench_fn fn, void *ctx)
+{
+	if (filter != NULL && strstr(name, filter) == NULL) {
+		return;
+	}
+
+	/* Warm up, then grow the iteration count up to the minimal time. */
+	fn(ctx, 1);
+
+	size_t iterations = 1;
+	double elapsed = 0;
+	for (;;) {
+#ifdef COUNT_ALLOCS
+		allocs = 0;
+		counting = true;
+#endif
+		paused = 0;
+		double start = now();
+		fn(ctx, iterations);
+		double wall = now() - start;
+		elapsed = wall - paused;
+#ifdef COUNT_ALLOCS
+		counting = false;
+#endif
+		/* The paused time counts for the run length. */
+		if (wall >= min_time || iterations >= MAX_ITERATIONS) {
+			break;
+		}
+
+		double estimate = (wall > 0) ? 1.2 * min_time / wall * iterations : 0;
+		size_t next = 2 * iterations;
+		if (estimate > next) {
+			next = (estimate < MAX_ITERATIONS) ? estimate : MAX_ITERATIONS;
+		}
+		iterations = next;
+	}
+
+	printf("%s\n  {\"name\": \"%s\", \"iterations\": %zu, \"ns_per_op\": %.1f, ",
+	       first ? "" : ",", name, iterations, elapsed / iterations);
+#ifdef COUNT_ALLOCS
+	printf("\"allocs_per_op\": %.2f}", (double)allocs / iterations);
+#else
+	printf("\"allocs_per_op\": null}");
+#endif
+	fflush(stdout);
+	first = false;
+}
+
+void bench_pause(void)
+{
+#ifdef COUNT_ALLOCS
+	counting = false;
+#endif
+	paused_at = now();
+}
+
+void bench_resume(void)
+{
+	paused += now() - paused_at;
+#ifdef COUNT_ALLOCS
+	counting = true;
+#endif
+}
+
+void bench_finish(void)
+{
+	printf("\n]}\n");
+}
+
+void bench_use(const void *ptr)
+{
+	__asm__ volatile("" : : "g"(ptr) : "memory");
+}
@@ -0,0 +1,76 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Microbenchmark harness. Each benchmark runs with a growing number of
+ * iterations until it takes at least the minimal time, the last run is
+ * reported. The results are written to stdout as one JSON document:
+ *
+ *   {"suite": "libknot", "results": [
+ *     {"name": "pkt_parse", "iterations": 1048576, "ns_per_op": 312.4,
+ *      "allocs_per_op": 1.00},
+ *     ...
+ *   ]}
+ *
+ * The allocations are counted by interposing malloc(), calloc() and
+ * realloc(), only with glibc; "allocs_per_op" is null elsewhere.
+ *
+ * Options:
+ *   -t <ms>       Minimal run time of each benchmark (default 200).
+ *   -f <string>   Run only benchmarks with the string in the name.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*! \brief Benchmark body, runs the measured operation \a iterations times. */
+typedef void (*bench_fn)(void *ctx, size_t iterations);
+
+/*!
+ * \brief Parses the options and starts the JSON output.
+ *
+ * \return Index of the first non-option argument.
+ */
+int bench_init(int argc, char *argv[], const char *suite);
+
+/*!
+ * \brief Measures and reports one benchmark.
+ */
+void bench_run(const char *name, bench_fn fn, void *ctx);
+
+/*!
+ * \brief Stops the measurement, e.g. for a per-iteration setup.
+ *
+ * The paused time is not reported, but counts for the minimal run time.
+ */
+void bench_pause(void);
+
+/*!
+ * \brief Resumes the measurement stopped by \ref bench_pause.
+ */
+void bench_resume(void);
+
+/*!
+ * \brief Finishes the JSON output.
+ */
+void bench_finish(void);
+
+/*!
+ * \brief Keeps the compiler from optimizing away a computed value.
+ */
+void bench_use(const void *ptr);
@@ -0,0 +1,450 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * libknot hot path microbenchmarks, see bench.h for the options and the
+ * output format. The inputs are a synthetic referral-sized response and
+ * names of a generated zone. Packet files (e.g. a fuzzing corpus) given as
+ * arguments are parsed by an extra 'pkt_parse_files' benchmark.
+ *
+ *   $ tests-perf/libknot -t 500 corpus/packet-* > libknot.json
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libknot/libknot.h"
+#include "contrib/mempattern.h"
+#include "contrib/ucw/mempool.h"
+#include "contrib/wire.h"
+#include "bench.h"
+
+#define NAMES     1024
+#define RDATA     16
+#define MAX_FILES 4096
+
+typedef struct {
+	knot_mm_t mm;
+	knot_dname_t *names[NAMES];
+	char strings[NAMES][32];
+	knot_rrset_t *answer[3];  /* Answer, authority and additional. */
+	uint8_t response[KNOT_WIRE_MAX_PKTSIZE];
+	size_t response_size;
+	uint8_t query[KNOT_WIRE_MAX_PKTSIZE];
+	size_t query_size;
+	knot_tsig_key_t key;
+	uint8_t signed_query[KNOT_WIRE_MAX_PKTSIZE];
+	size_t signed_size;
+	knot_rdata_t *rdata[RDATA];
+	knot_rdataset_t rdataset;
+	knot_rrset_t opt;
+	uint8_t *files[MAX_FILES];
+	size_t file_sizes[MAX_FILES];
+	size_t file_count;
+} ctx_t;
+
+static knot_rrset_t *make_rrset(const char *owner, uint16_t type,
+                                const uint8_t *rdata, uint16_t size, int count)
+{
+	knot_dname_t *name = knot_dname_from_str_alloc(owner);
+	knot_rrset_t *rr = knot_rrset_new(name, type, KNOT_CLASS_IN, NULL);
+	knot_dname_free(&name, NULL);
+	if (rr == NULL) {
+		abort();
+	}
+
+	uint8_t buf[256];
+	for (int i = 0; i < count; i++) {
+		memcpy(buf, rdata, size);
+		buf[size - 1] += i;
+		if (knot_rrset_add_rdata(rr, buf, size, 3600, NULL) != KNOT_EOK) {
+			abort();
+		}
+	}
+
+	return rr;
+}
+
+static void make_response(ctx_t *ctx)
+{
+	/* Answer with two A, two NS in authority and their glue. */
+	ctx->answer[0] = make_rrset("www.example.com.", KNOT_RRTYPE_A,
+	                            (const uint8_t *)"\xc0\x00\x02\x01", 4, 2);
+	ctx->answer[1] = make_rrset("example.com.", KNOT_RRTYPE_NS,
+	                            (const uint8_t *)"\x03ns1\x07""example\x03""com", 17, 1);
+	ctx->answer[2] = make_rrset("ns1.example.com.", KNOT_RRTYPE_A,
+	                            (const uint8_t *)"\xc0\x00\x02\x35", 4, 1);
+
+	knot_pkt_t *pkt = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	if (pkt == NULL || knot_pkt_put_question(pkt, ctx->answer[0]->owner,
+	                                         KNOT_CLASS_IN, KNOT_RRTYPE_A) != KNOT_EOK) {
+		abort();
+	}
+	knot_wire_set_id(pkt->wire, 0x1234);
+	memcpy(ctx->query, pkt->wire, pkt->size);
+	ctx->query_size = pkt->size;
+	knot_pkt_free(&pkt);
+}
+
+static size_t put_response(ctx_t *ctx, uint8_t *wire, knot_mm_t *mm)
+{
+	knot_pkt_t *query = knot_pkt_new(ctx->query, ctx->query_size, mm);
+	knot_pkt_t *pkt = knot_pkt_new(wire, KNOT_WIRE_MAX_PKTSIZE, mm);
+	if (knot_pkt_parse(query, 0) != KNOT_EOK ||
+	    knot_pkt_init_response(pkt, query) != KNOT_EOK) {
+		abort();
+	}
+
+	knot_pkt_begin(pkt, KNOT_ANSWER);
+	knot_pkt_put(pkt, KNOT_COMPR_HINT_QNAME, ctx->answer[0], 0);
+	knot_pkt_begin(pkt, KNOT_AUTHORITY);
+	knot_pkt_put(pkt, KNOT_COMPR_HINT_NONE, ctx->answer[1], 0);
+	knot_pkt_begin(pkt, KNOT_ADDITIONAL);
+	knot_pkt_put(pkt, KNOT_COMPR_HINT_NONE, ctx->answer[2], 0);
+	size_t size = pkt->size;
+
+	knot_pkt_free(&pkt);
+	knot_pkt_free(&query);
+
+	return size;
+}
+
+static void make_names(ctx_t *ctx)
+{
+	for (int i = 0; i < NAMES; i++) {
+		snprintf(ctx->strings[i], sizeof(ctx->strings[i]),
+		         "Host%d.Example.com.", (i * 7919) % NAMES);
+		ctx->names[i] = knot_dname_from_str_alloc(ctx->strings[i]);
+		knot_dname_to_lower(ctx->names[i]);
+	}
+}
+
+static void make_rdata(ctx_t *ctx)
+{
+	uint8_t aaaa[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+	for (int i = 0; i < RDATA; i++) {
+		ctx->rdata[i] = malloc(knot_rdata_array_size(sizeof(aaaa)));
+		aaaa[15] = (i * 5) % RDATA;
+		knot_rdata_init(ctx->rdata[i], sizeof(aaaa), aaaa, 3600);
+	}
+
+	knot_rdataset_init(&ctx->rdataset);
+	for (int i = 0; i < RDATA; i++) {
+		knot_rdataset_add(&ctx->rdataset, ctx->rdata[i], NULL);
+	}
+}
+
+static void make_tsig(ctx_t *ctx)
+{
+	if (knot_tsig_key_init(&ctx->key, "hmac-sha256", "key.example.com.",
+	                       "Wg2pJtN2r5N5Ro2cTs3xXUVXMdkz2QvpHp3SN8P0PzY=") != KNOT_EOK) {
+		abort();
+	}
+
+	memcpy(ctx->signed_query, ctx->query, ctx->query_size);
+	ctx->signed_size = ctx->query_size;
+	uint8_t digest[64];
+	size_t digest_len = sizeof(digest);
+	if (knot_tsig_sign(ctx->signed_query, &ctx->signed_size, sizeof(ctx->signed_query),
+	                   NULL, 0, digest, &digest_len, &ctx->key, 0, 0) != KNOT_EOK) {
+		abort();
+	}
+}
+
+static void make_opt(ctx_t *ctx)
+{
+	const uint8_t cookie[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	const uint8_t ecs[7] = { 0, 1, 24, 0, 192, 0, 2 };
+	if (knot_edns_init(&ctx->opt, 1232, 0, 0, NULL) != KNOT_EOK ||
+	    knot_edns_add_option(&ctx->opt, KNOT_EDNS_OPTION_NSID, 0, NULL, NULL) != KNOT_EOK ||
+	    knot_edns_add_option(&ctx->opt, KNOT_EDNS_OPTION_CLIENT_SUBNET,
+	                         sizeof(ecs), ecs, NULL) != KNOT_EOK ||
+	    knot_edns_add_option(&ctx->opt, KNOT_EDNS_OPTION_COOKIE, sizeof(cookie), cookie,
+	                         NULL) != KNOT_EOK) {
+		abort();
+	}
+}
+
+static void load_files(ctx_t *ctx, int argc, char *argv[])
+{
+	for (int i = 0; i < argc && ctx->file_count < MAX_FILES; i++) {
+		FILE *fp = fopen(argv[i], "r");
+		if (fp == NULL) {
+			continue;
+		}
+		uint8_t *buf = malloc(KNOT_WIRE_MAX_PKTSIZE);
+		size_t len = fread(buf, 1, KNOT_WIRE_MAX_PKTSIZE, fp);
+		fclose(fp);
+		if (len < KNOT_WIRE_HEADER_SIZE) {
+			free(buf);
+			continue;
+		}
+		ctx->files[ctx->file_count] = buf;
+		ctx->file_sizes[ctx->file_count] = len;
+		ctx->file_count += 1;
+	}
+}
+
+/* Benchmarks. */
+
+static void b_dname_from_str(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	uint8_t buf[KNOT_DNAME_MAXLEN];
+	for (size_t i = 0; i < n; i++) {
+		knot_dname_from_str(buf, ctx->strings[i % NAMES], sizeof(buf));
+		bench_use(buf);
+	}
+}
+
+static void b_dname_to_str(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	char buf[KNOT_DNAME_TXT_MAXLEN + 1];
+	for (size_t i = 0; i < n; i++) {
+		knot_dname_to_str(buf, ctx->names[i % NAMES], sizeof(buf));
+		bench_use(buf);
+	}
+}
+
+static void b_dname_cmp(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	int sum = 0;
+	for (size_t i = 0; i < n; i++) {
+		sum += knot_dname_cmp(ctx->names[i % NAMES], ctx->names[(i + 1) % NAMES]);
+	}
+	bench_use(&sum);
+}
+
+static void b_dname_to_lower(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	uint8_t buf[KNOT_DNAME_MAXLEN];
+	for (size_t i = 0; i < n; i++) {
+		knot_dname_to_wire(buf, ctx->names[i % NAMES], sizeof(buf));
+		knot_dname_to_lower(buf);
+		bench_use(buf);
+	}
+}
+
+static void b_dname_parse(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	/* Compressed owner of the first answer. */
+	size_t start = ctx->query_size;
+	for (size_t i = 0; i < n; i++) {
+		size_t pos = start;
+		knot_dname_t *name = knot_dname_parse(ctx->response, &pos,
+		                                      ctx->response_size, &ctx->mm);
+		bench_use(name);
+		if ((i & 1023) == 1023) {
+			mp_flush(ctx->mm.ctx);
+		}
+	}
+	mp_flush(ctx->mm.ctx);
+}
+
+static void parse(ctx_t *ctx, uint8_t *wire, size_t size)
+{
+	knot_pkt_t *pkt = knot_pkt_new(wire, size, &ctx->mm);
+	int ret = knot_pkt_parse(pkt, 0);
+	bench_use(&ret);
+	knot_pkt_free(&pkt);
+	mp_flush(ctx->mm.ctx);
+}
+
+static void b_pkt_parse(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	for (size_t i = 0; i < n; i++) {
+		parse(ctx, ctx->response, ctx->response_size);
+	}
+}
+
+static void b_pkt_parse_files(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+	for (size_t i = 0; i < n; i++) {
+		/* Parsing may modify the wire. */
+		size_t id = i % ctx->file_count;
+		memcpy(buf, ctx->files[id], ctx->file_sizes[id]);
+		parse(ctx, buf, ctx->file_sizes[id]);
+	}
+}
+
+static void b_pkt_put(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	uint8_t wire[KNOT_WIRE_MAX_PKTSIZE];
+	for (size_t i = 0; i < n; i++) {
+		size_t size = put_response(ctx, wire, &ctx->mm);
+		bench_use(&size);
+		mp_flush(ctx->mm.ctx);
+	}
+}
+
+static void b_rdataset_add(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	for (size_t i = 0; i < n; i++) {
+		knot_rdataset_t rrs;
+		knot_rdataset_init(&rrs);
+		for (int j = 0; j < RDATA; j++) {
+			knot_rdataset_add(&rrs, ctx->rdata[j], &ctx->mm);
+		}
+		bench_use(rrs.data);
+		mp_flush(ctx->mm.ctx);
+	}
+}
+
+static void b_rdataset_member(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	int found = 0;
+	for (size_t i = 0; i < n; i++) {
+		found += knot_rdataset_member(&ctx->rdataset, ctx->rdata[i % RDATA], true);
+	}
+	bench_use(&found);
+}
+
+static void b_rdataset_merge(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	for (size_t i = 0; i < n; i++) {
+		knot_rdataset_t rrs;
+		knot_rdataset_init(&rrs);
+		knot_rdataset_add(&rrs, ctx->rdata[i % RDATA], &ctx->mm);
+		knot_rdataset_merge(&rrs, &ctx->rdataset, &ctx->mm);
+		bench_use(rrs.data);
+		mp_flush(ctx->mm.ctx);
+	}
+}
+
+static void b_tsig_sign(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	uint8_t wire[KNOT_WIRE_MAX_PKTSIZE];
+	uint8_t digest[64];
+	memcpy(wire, ctx->query, ctx->query_size);
+	for (size_t i = 0; i < n; i++) {
+		size_t size = ctx->query_size;
+		size_t digest_len = sizeof(digest);
+		knot_wire_set_arcount(wire, 0);
+		if (knot_tsig_sign(wire, &size, sizeof(wire), NULL, 0, digest,
+		                   &digest_len, &ctx->key, 0, 0) != KNOT_EOK) {
+			abort();
+		}
+	}
+}
+
+static void b_tsig_verify(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	uint8_t wire[KNOT_WIRE_MAX_PKTSIZE];
+	for (size_t i = 0; i < n; i++) {
+		memcpy(wire, ctx->signed_query, ctx->signed_size);
+		knot_pkt_t *pkt = knot_pkt_new(wire, ctx->signed_size, &ctx->mm);
+		if (knot_pkt_parse(pkt, 0) != KNOT_EOK ||
+		    knot_tsig_server_check(pkt->tsig_rr, pkt->wire, pkt->size,
+		                           &ctx->key) != KNOT_EOK) {
+			abort();
+		}
+		knot_pkt_free(&pkt);
+		mp_flush(ctx->mm.ctx);
+	}
+}
+
+static void b_edns_init(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	const uint8_t nsid[] = "ns1.example.com";
+	for (size_t i = 0; i < n; i++) {
+		knot_rrset_t opt;
+		knot_edns_init(&opt, 1232, 0, 0, &ctx->mm);
+		knot_edns_set_do(&opt);
+		knot_edns_add_option(&opt, KNOT_EDNS_OPTION_NSID, sizeof(nsid) - 1,
+		                     nsid, &ctx->mm);
+		size_t size = knot_edns_wire_size(&opt);
+		bench_use(&size);
+		mp_flush(ctx->mm.ctx);
+	}
+}
+
+static void b_edns_get_option(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	for (size_t i = 0; i < n; i++) {
+		uint8_t *opt = knot_edns_get_option(&ctx->opt, KNOT_EDNS_OPTION_COOKIE);
+		bench_use(opt);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int first_arg = bench_init(argc, argv, "libknot");
+
+	static ctx_t ctx;
+	mm_ctx_mempool(&ctx.mm, MM_DEFAULT_BLKSIZE);
+	make_names(&ctx);
+	make_response(&ctx);
+	ctx.response_size = put_response(&ctx, ctx.response, NULL);
+	make_rdata(&ctx);
+	make_tsig(&ctx);
+	make_opt(&ctx);
+	load_files(&ctx, argc - first_arg, argv + first_arg);
+
+	bench_run("dname_from_str", b_dname_from_str, &ctx);
+	bench_run("dname_to_str", b_dname_to_str, &ctx);
+	bench_run("dname_cmp", b_dname_cmp, &ctx);
+	bench_run("dname_to_lower", b_dname_to_lower, &ctx);
+	bench_run("dname_parse", b_dname_parse, &ctx);
+	bench_run("pkt_parse", b_pkt_parse, &ctx);
+	if (ctx.file_count > 0) {
+		bench_run("pkt_parse_files", b_pkt_parse_files, &ctx);
+	}
+	bench_run("pkt_put", b_pkt_put, &ctx);
+	bench_run("rdataset_add", b_rdataset_add, &ctx);
+	bench_run("rdataset_member", b_rdataset_member, &ctx);
+	bench_run("rdataset_merge", b_rdataset_merge, &ctx);
+	bench_run("tsig_sign", b_tsig_sign, &ctx);
+	bench_run("tsig_verify", b_tsig_verify, &ctx);
+	bench_run("edns_init", b_edns_init, &ctx);
+	bench_run("edns_get_option", b_edns_get_option, &ctx);
+
+	bench_finish();
+
+	for (int i = 0; i < NAMES; i++) {
+		knot_dname_free(&ctx.names[i], NULL);
+	}
+	for (int i = 0; i < 3; i++) {
+		knot_rrset_free(&ctx.answer[i], NULL);
+	}
+	for (int i = 0; i < RDATA; i++) {
+		free(ctx.rdata[i]);
+	}
+	for (size_t i = 0; i < ctx.file_count; i++) {
+		free(ctx.files[i]);
+	}
+	knot_rdataset_clear(&ctx.rdataset, NULL);
+	knot_rrset_clear(&ctx.opt, NULL);
+	knot_tsig_key_deinit(&ctx.key);
+	mp_delete(ctx.mm.ctx);
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * NSEC3 hashing benchmark, compares dnssec_nsec3_hash() and
+ * dnssec_nsec3_hash_batch() for typical iteration counts and salt lengths.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dnssec/binary.h"
+#include "dnssec/crypto.h"
+#include "dnssec/error.h"
+#include "dnssec/nsec.h"
+
+#define NAMES 4096
+#define BATCH 64
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double bench_single(const dnssec_binary_t *names,
+                           const dnssec_nsec3_params_t *params)
+{
+	dnssec_binary_t hash = { 0 };
+
+	double start = now();
+	for (int i = 0; i < NAMES; i++) {
+		if (dnssec_nsec3_hash(&names[i], params, &hash) != DNSSEC_EOK) {
+			abort();
+		}
+	}
+	double end = now();
+
+	dnssec_binary_free(&hash);
+
+	return (end - start) / NAMES;
+}
+
+static double bench_batch(const dnssec_binary_t *names,
+                          const dnssec_nsec3_params_t *params)
+{
+	dnssec_binary_t hashes[BATCH] = { { 0 } };
+
+	double start = now();
+	for (int i = 0; i < NAMES; i += BATCH) {
+		if (dnssec_nsec3_hash_batch(names + i, BATCH, params,
+		                            hashes) != DNSSEC_EOK) {
+			abort();
+		}
+	}
+	double end = now();
+
+	for (int i = 0; i < BATCH; i++) {
+		dnssec_binary_free(&hashes[i]);
+	}
+
+	return (end - start) / NAMES;
+}
+
+int main(void)
+{
+	dnssec_crypto_init();
+
+	/* Names like 'host1234.example.com.' */
+	static uint8_t wire[NAMES][32];
+	dnssec_binary_t names[NAMES];
+	for (int i = 0; i < NAMES; i++) {
+		int len = snprintf((char *)wire[i] + 1, sizeof(wire[i]) - 1,
+		                   "host%d", i);
+		wire[i][0] = len;
+		memcpy(wire[i] + 1 + len, "\x07""example""\x03""com", 13);
+		names[i].data = wire[i];
+		names[i].size = len + 14;
+	}
+
+	uint8_t salt[32];
+	for (int i = 0; i < sizeof(salt); i++) {
+		salt[i] = rand();
+	}
+
+	const int iterations[] = { 0, 1, 10, 50, 150 };
+	const size_t salt_sizes[] = { 0, 8, 32 };
+
+	printf("%10s %10s %14s %14s\n", "iterations", "salt", "single [ns]", "batch [ns]");
+	for (int i = 0; i < sizeof(iterations) / sizeof(*iterations); i++) {
+		for (int j = 0; j < sizeof(salt_sizes) / sizeof(*salt_sizes); j++) {
+			dnssec_nsec3_params_t params = {
+				.algorithm = DNSSEC_NSEC3_ALGORITHM_SHA1,
+				.iterations = iterations[i],
+				.salt = { .size = salt_sizes[j], .data = salt }
+			};
+
+			printf("%10d %10zu %14.0f %14.0f\n", iterations[i], salt_sizes[j],
+			       bench_single(names, &params), bench_batch(names, &params));
+		}
+	}
+
+	dnssec_crypto_cleanup();
+
+	return 0;
+}
@@ -0,0 +1,159 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Zone text dump benchmark, formats a synthetic signed zone with
+ * knot_rrset_txt_dump() the same way as zone_dump_text() does. The output
+ * checksum allows to compare the output of two builds.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libknot/libknot.h"
+#include "contrib/wire.h"
+
+#define NAMES  2000
+#define ROUNDS 20
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static knot_rrset_t *rrset(const char *owner, uint16_t type, uint32_t ttl,
+                           const uint8_t *rdata, uint16_t size)
+{
+	knot_dname_t *name = knot_dname_from_str_alloc(owner);
+	knot_rrset_t *rr = knot_rrset_new(name, type, KNOT_CLASS_IN, NULL);
+	knot_dname_free(&name, NULL);
+	if (rr == NULL || knot_rrset_add_rdata(rr, rdata, size, ttl, NULL) != KNOT_EOK) {
+		abort();
+	}
+
+	return rr;
+}
+
+static size_t make_zone(knot_rrset_t **zone)
+{
+	size_t count = 0;
+	uint8_t rd[512];
+
+	for (int i = 0; i < NAMES; i++) {
+		char owner[64];
+		snprintf(owner, sizeof(owner), "host%d.example.com.", i);
+		knot_dname_t *next = knot_dname_from_str_alloc(owner);
+
+		// A
+		wire_write_u32(rd, 0xc0000200 + i);
+		zone[count++] = rrset(owner, KNOT_RRTYPE_A, 3600, rd, 4);
+
+		// AAAA
+		memset(rd, 0, 16);
+		wire_write_u32(rd, 0x20010db8);
+		wire_write_u16(rd + 14, i);
+		zone[count++] = rrset(owner, KNOT_RRTYPE_AAAA, 3600, rd, 16);
+
+		// MX
+		wire_write_u16(rd, 10);
+		int len = knot_dname_to_wire(rd + 2, (uint8_t *)"\x04""mail""\x07""example""\x03""com", 256);
+		zone[count++] = rrset(owner, KNOT_RRTYPE_MX, 86400, rd, 2 + len);
+
+		// TXT with escaped characters
+		len = snprintf((char *)rd + 1, 255, "v=spf1 \"quoted\" \\ host %d\t", i);
+		rd[0] = len;
+		zone[count++] = rrset(owner, KNOT_RRTYPE_TXT, 300, rd, 1 + len);
+
+		// NSEC
+		len = knot_dname_to_wire(rd, next, 256);
+		memcpy(rd + len, "\x00\x06\x60\x00\x00\x08\x00\x03", 8);
+		zone[count++] = rrset(owner, KNOT_RRTYPE_NSEC, 3600, rd, len + 8);
+		knot_dname_free(&next, NULL);
+
+		// RRSIG
+		wire_write_u16(rd, KNOT_RRTYPE_A);
+		rd[2] = 13;
+		rd[3] = 3;
+		wire_write_u32(rd + 4, 3600);
+		wire_write_u32(rd + 8, 1480000000 + i);
+		wire_write_u32(rd + 12, 1470000000 + i);
+		wire_write_u16(rd + 16, 12345);
+		len = knot_dname_to_wire(rd + 18, (uint8_t *)"\x07""example""\x03""com", 256);
+		for (int j = 0; j < 64; j++) {
+			rd[18 + len + j] = i * j;
+		}
+		zone[count++] = rrset(owner, KNOT_RRTYPE_RRSIG, 3600, rd, 18 + len + 64);
+	}
+
+	return count;
+}
+
+static void bench(knot_rrset_t **zone, size_t count, const char *name,
+                  const knot_dump_style_t *style)
+{
+	size_t buflen = 512;
+	char *buf = malloc(buflen);
+	size_t bytes = 0;
+	uint32_t sum = 2166136261;
+
+	double start = now();
+	for (int r = 0; r < ROUNDS; r++) {
+		for (size_t i = 0; i < count; i++) {
+			int ret = knot_rrset_txt_dump(zone[i], &buf, &buflen, style);
+			if (ret < 0) {
+				abort();
+			}
+			bytes += ret;
+			if (r == 0) {
+				for (int j = 0; j < ret; j++) {
+					sum = (sum ^ (uint8_t)buf[j]) * 16777619;
+				}
+			}
+		}
+	}
+	double end = now();
+
+	free(buf);
+
+	printf("%-10s %10.1f %10.0f %10.1f %10.8x\n", name,
+	       (end - start) / (ROUNDS * count), bytes / (end - start) * 1e3,
+	       count * ROUNDS / (end - start) * 1e6, sum);
+}
+
+int main(void)
+{
+	static knot_rrset_t *zone[NAMES * 6];
+	size_t count = make_zone(zone);
+
+	knot_dump_style_t human = KNOT_DUMP_STYLE_DEFAULT;
+	human.wrap = true;
+	human.show_class = true;
+	human.human_ttl = true;
+
+	printf("%-10s %10s %10s %10s %10s\n", "style", "ns/rr", "MB/s", "krr/s", "checksum");
+	bench(zone, count, "default", &KNOT_DUMP_STYLE_DEFAULT);
+	bench(zone, count, "human", &human);
+
+	for (size_t i = 0; i < count; i++) {
+		knot_rrset_free(&zone[i], NULL);
+	}
+
+	return 0;
+}
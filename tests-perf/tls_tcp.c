@@ -0,0 +1,239 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * DNS-over-TLS loopback benchmark, compares the per-query cost of the
+ * server TLS connection (kTLS if GnuTLS enables it) with plain TCP. The
+ * client sends queries one by one over a single connection, the server
+ * echoes them back.
+ */
+
+#include <gnutls/gnutls.h>
+#include <gnutls/x509.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "knot/server/tls.h"
+#include "libknot/errcode.h"
+#include "contrib/net.h"
+
+#define QUERIES  20000
+#define MSG_SIZE 64
+#define TIMEOUT  5000
+
+typedef struct {
+	int listen_fd;
+	tls_ctx_t *tls;
+	bool ktls;
+} server_t;
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void write_file(const char *path, const gnutls_datum_t *data)
+{
+	FILE *fp = fopen(path, "w");
+	if (fp == NULL || fwrite(data->data, data->size, 1, fp) != 1) {
+		abort();
+	}
+	fclose(fp);
+}
+
+static void make_cert(const char *cert_file, const char *key_file)
+{
+	gnutls_x509_privkey_t key;
+	gnutls_x509_crt_t crt;
+	gnutls_datum_t key_pem, crt_pem;
+	time_t t = time(NULL);
+	const uint8_t serial[] = { 1 };
+
+	if (gnutls_x509_privkey_init(&key) < 0 ||
+	    gnutls_x509_privkey_generate(key, GNUTLS_PK_ECDSA,
+	                                 GNUTLS_CURVE_TO_BITS(GNUTLS_ECC_CURVE_SECP256R1), 0) < 0 ||
+	    gnutls_x509_crt_init(&crt) < 0 ||
+	    gnutls_x509_crt_set_version(crt, 3) < 0 ||
+	    gnutls_x509_crt_set_serial(crt, serial, sizeof(serial)) < 0 ||
+	    gnutls_x509_crt_set_activation_time(crt, t - 3600) < 0 ||
+	    gnutls_x509_crt_set_expiration_time(crt, t + 3600) < 0 ||
+	    gnutls_x509_crt_set_dn(crt, "CN=localhost", NULL) < 0 ||
+	    gnutls_x509_crt_set_key(crt, key) < 0 ||
+	    gnutls_x509_crt_sign2(crt, crt, key, GNUTLS_DIG_SHA256, 0) < 0 ||
+	    gnutls_x509_privkey_export2(key, GNUTLS_X509_FMT_PEM, &key_pem) < 0 ||
+	    gnutls_x509_crt_export2(crt, GNUTLS_X509_FMT_PEM, &crt_pem) < 0) {
+		abort();
+	}
+
+	write_file(cert_file, &crt_pem);
+	write_file(key_file, &key_pem);
+
+	gnutls_free(key_pem.data);
+	gnutls_free(crt_pem.data);
+	gnutls_x509_crt_deinit(crt);
+	gnutls_x509_privkey_deinit(key);
+}
+
+static void *serve(void *arg)
+{
+	server_t *srv = arg;
+	struct sockaddr_storage addr;
+	int fd = net_accept(srv->listen_fd, &addr);
+	if (fd < 0) {
+		abort();
+	}
+
+	tls_conn_t *conn = NULL;
+	if (srv->tls != NULL) {
+		conn = tls_conn_new(srv->tls, fd);
+		if (conn == NULL || tls_conn_handshake(conn, TIMEOUT) != KNOT_EOK) {
+			abort();
+		}
+		srv->ktls = tls_conn_ktls(conn);
+	}
+
+	uint8_t buf[MSG_SIZE];
+	for (;;) {
+		ssize_t len = (conn != NULL) ? tls_dns_recv(conn, buf, sizeof(buf), TIMEOUT)
+		                             : net_dns_tcp_recv(fd, buf, sizeof(buf), TIMEOUT);
+		if (len <= 0) {
+			break;
+		}
+		len = (conn != NULL) ? tls_dns_send(conn, buf, len, TIMEOUT)
+		                     : net_dns_tcp_send(fd, buf, len, TIMEOUT);
+		if (len <= 0) {
+			break;
+		}
+	}
+
+	tls_conn_free(conn);
+	close(fd);
+
+	return NULL;
+}
+
+/*! \brief Blocking GnuTLS client I/O of exactly \a len bytes. */
+static void client_io(gnutls_session_t session, bool send, uint8_t *buf, size_t len)
+{
+	size_t done = 0;
+	while (done < len) {
+		ssize_t ret = send ? gnutls_record_send(session, buf + done, len - done)
+		                   : gnutls_record_recv(session, buf + done, len - done);
+		if (ret <= 0) {
+			abort();
+		}
+		done += ret;
+	}
+}
+
+static void bench(const char *name, tls_ctx_t *tls)
+{
+	struct sockaddr_in sa = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+	server_t srv = { .tls = tls };
+	srv.listen_fd = net_bound_socket(SOCK_STREAM, (struct sockaddr *)&sa, 0);
+	socklen_t salen = sizeof(sa);
+	if (srv.listen_fd < 0 || listen(srv.listen_fd, 1) != 0 ||
+	    getsockname(srv.listen_fd, (struct sockaddr *)&sa, &salen) != 0) {
+		abort();
+	}
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, serve, &srv);
+
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (struct sockaddr *)&sa, salen) != 0) {
+		abort();
+	}
+
+	gnutls_certificate_credentials_t cred = NULL;
+	gnutls_session_t session = NULL;
+	if (tls != NULL) {
+		gnutls_certificate_allocate_credentials(&cred);
+		gnutls_init(&session, GNUTLS_CLIENT);
+		gnutls_set_default_priority(session);
+		gnutls_credentials_set(session, GNUTLS_CRD_CERTIFICATE, cred);
+		gnutls_transport_set_int(session, fd);
+		if (gnutls_handshake(session) != GNUTLS_E_SUCCESS) {
+			abort();
+		}
+	}
+
+	uint8_t msg[2 + MSG_SIZE] = { 0, MSG_SIZE };
+	double start = now();
+	for (int i = 0; i < QUERIES; i++) {
+		msg[2] = i;
+		if (session != NULL) {
+			client_io(session, true, msg, sizeof(msg));
+			client_io(session, false, msg, sizeof(msg));
+		} else if (net_dns_tcp_send(fd, msg + 2, MSG_SIZE, TIMEOUT) != MSG_SIZE ||
+		           net_dns_tcp_recv(fd, msg + 2, MSG_SIZE, TIMEOUT) != MSG_SIZE) {
+			abort();
+		}
+		if (msg[2] != (uint8_t)i) {
+			abort();
+		}
+	}
+	double end = now();
+
+	if (session != NULL) {
+		gnutls_bye(session, GNUTLS_SHUT_WR);
+		gnutls_deinit(session);
+		gnutls_certificate_free_credentials(cred);
+	}
+	close(fd);
+	pthread_join(thread, NULL);
+	close(srv.listen_fd);
+
+	printf("%-10s %10.2f %10.1f %10s\n", name, (end - start) / QUERIES / 1e3,
+	       QUERIES / (end - start) * 1e6, srv.ktls ? "yes" : "no");
+}
+
+int main(void)
+{
+	char dir[] = "/tmp/knot-perf-tls.XXXXXX";
+	if (mkdtemp(dir) == NULL) {
+		abort();
+	}
+	char cert_file[sizeof(dir) + 16], key_file[sizeof(dir) + 16];
+	snprintf(cert_file, sizeof(cert_file), "%s/cert.pem", dir);
+	snprintf(key_file, sizeof(key_file), "%s/key.pem", dir);
+	make_cert(cert_file, key_file);
+
+	tls_ctx_t *tls = NULL;
+	if (tls_ctx_new(&tls, cert_file, key_file) != KNOT_EOK) {
+		abort();
+	}
+	unlink(cert_file);
+	unlink(key_file);
+	rmdir(dir);
+
+	printf("%-10s %10s %10s %10s\n", "transport", "us/query", "kq/s", "ktls");
+	bench("tcp", NULL);
+	bench("tls", tls);
+
+	tls_ctx_free(tls);
+
+	return 0;
+}
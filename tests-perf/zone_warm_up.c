@@ -0,0 +1,186 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Zone warm-up benchmark, measures the lookups of all recently queried names
+ * in zone contents that are no longer cached (as new contents right after
+ * the switch, "lookup_cold") and in contents warmed up before publication
+ * ("lookup_warm"), and the cost of the warm-up itself. Each iteration starts
+ * with an unmeasured sweep over a large buffer. See bench.h for the options
+ * and the output format.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "knot/zone/warm-up.h"
+#include "libknot/libknot.h"
+#include "contrib/wire.h"
+#include "bench.h"
+
+#define NAMES		200000
+#define EVICT_SIZE	(64 * 1024 * 1024)
+
+typedef struct {
+	zone_contents_t *contents;
+	zone_hot_t *hot;
+	knot_dname_t *names[WARM_UP_NAMES];
+	uint8_t *evict;
+} ctx_t;
+
+static void add_rr(zone_contents_t *contents, const knot_dname_t *owner,
+                   uint16_t type, const uint8_t *rdata, uint16_t size)
+{
+	knot_rrset_t *rr = knot_rrset_new(owner, type, KNOT_CLASS_IN, NULL);
+	zone_node_t *node = NULL;
+	if (rr == NULL || knot_rrset_add_rdata(rr, rdata, size, 3600, NULL) != KNOT_EOK ||
+	    zone_contents_add_rr(contents, rr, &node) != KNOT_EOK) {
+		abort();
+	}
+	knot_rrset_free(&rr, NULL);
+}
+
+static void make_zone(ctx_t *ctx, const knot_dname_t *apex)
+{
+	ctx->contents = zone_contents_new(apex);
+	ctx->hot = zone_hot_new();
+	ctx->evict = malloc(EVICT_SIZE);
+	if (ctx->contents == NULL || ctx->hot == NULL || ctx->evict == NULL) {
+		abort();
+	}
+
+	/* Nodes are chained from the non-empty apex. */
+	const uint8_t apex_txt[] = "\x04""apex";
+	add_rr(ctx->contents, apex, KNOT_RRTYPE_TXT, apex_txt, sizeof(apex_txt) - 1);
+
+	for (int i = 0; i < NAMES; i++) {
+		char owner[64];
+		snprintf(owner, sizeof(owner), "host%d.example.com.", i);
+		knot_dname_t *name = knot_dname_from_str_alloc(owner);
+
+		uint8_t a[4];
+		wire_write_u32(a, 0xc0000200 + i);
+		add_rr(ctx->contents, name, KNOT_RRTYPE_A, a, sizeof(a));
+
+		uint8_t txt[32];
+		txt[0] = snprintf((char *)txt + 1, sizeof(txt) - 1, "host %d", i);
+		add_rr(ctx->contents, name, KNOT_RRTYPE_TXT, txt, 1 + txt[0]);
+
+		/* Recent names spread over the zone. */
+		if (i % (NAMES / WARM_UP_NAMES) == 0 &&
+		    i / (NAMES / WARM_UP_NAMES) < WARM_UP_NAMES) {
+			ctx->names[i / (NAMES / WARM_UP_NAMES)] = name;
+			for (int j = 0; j < WARM_UP_SAMPLE; j++) {
+				zone_hot_record(ctx->hot, name);
+			}
+		} else {
+			knot_dname_free(&name, NULL);
+		}
+	}
+
+	if (zone_contents_adjust_full(ctx->contents) != KNOT_EOK) {
+		abort();
+	}
+}
+
+static void evict(ctx_t *ctx)
+{
+	for (size_t i = 0; i < EVICT_SIZE; i += 64) {
+		ctx->evict[i]++;
+	}
+	bench_use(ctx->evict);
+}
+
+static void lookup(ctx_t *ctx)
+{
+	for (int i = 0; i < WARM_UP_NAMES; i++) {
+		const zone_node_t *match = NULL, *closest = NULL, *prev = NULL;
+		(void)zone_contents_find_dname(ctx->contents, ctx->names[i],
+		                               &match, &closest, &prev);
+		bench_use(node_rdataset(match, KNOT_RRTYPE_A)->data);
+	}
+}
+
+static void b_lookup_cold(void *arg, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		bench_pause();
+		evict(arg);
+		bench_resume();
+		lookup(arg);
+	}
+}
+
+static void b_lookup_warm(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	for (size_t i = 0; i < n; i++) {
+		bench_pause();
+		evict(ctx);
+		(void)zone_warm_up(ctx->contents, ctx->hot, false);
+		bench_resume();
+		lookup(ctx);
+	}
+}
+
+static void b_warm_up_hot(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	for (size_t i = 0; i < n; i++) {
+		bench_pause();
+		evict(ctx);
+		bench_resume();
+		(void)zone_warm_up(ctx->contents, ctx->hot, false);
+	}
+}
+
+static void b_warm_up_full(void *arg, size_t n)
+{
+	ctx_t *ctx = arg;
+	for (size_t i = 0; i < n; i++) {
+		bench_pause();
+		evict(ctx);
+		bench_resume();
+		(void)zone_warm_up(ctx->contents, ctx->hot, true);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init(argc, argv, "zone_warm_up");
+
+	static ctx_t ctx;
+	knot_dname_t *apex = knot_dname_from_str_alloc("example.com.");
+	make_zone(&ctx, apex);
+
+	bench_run("lookup_cold", b_lookup_cold, &ctx);
+	bench_run("lookup_warm", b_lookup_warm, &ctx);
+	bench_run("warm_up_hot", b_warm_up_hot, &ctx);
+	bench_run("warm_up_full", b_warm_up_full, &ctx);
+
+	bench_finish();
+
+	zone_contents_deep_free(&ctx.contents);
+	zone_hot_free(ctx.hot);
+	free(ctx.evict);
+	for (int i = 0; i < WARM_UP_NAMES; i++) {
+		knot_dname_free(&ctx.names[i], NULL);
+	}
+	knot_dname_free(&apex, NULL);
+
+	return 0;
+}
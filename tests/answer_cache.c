@@ -0,0 +1,210 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <tap/basic.h>
+
+#include "knot/server/answer-cache.h"
+#include "libknot/errcode.h"
+#include "libknot/packet/wire.h"
+
+/* ID 0x1234, RD, QNAME Www.Example.COM, A, IN. */
+static const uint8_t QUERY[] = {
+	0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x03, 'W', 'w', 'w', 0x07, 'E', 'x', 'a', 'm', 'p', 'l', 'e',
+	0x03, 'C', 'O', 'M', 0x00, 0x00, 0x01, 0x00, 0x01
+};
+
+/* Empty OPT, payload 1232. */
+static const uint8_t OPT[] = {
+	0x00, 0x00, 0x29, 0x04, 0xd0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+/* Answer to the query, AA, one A record with a compressed owner. */
+static const uint8_t ANSWER[] = {
+	0x12, 0x34, 0x85, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+	0x03, 'W', 'w', 'w', 0x07, 'E', 'x', 'a', 'm', 'p', 'l', 'e',
+	0x03, 'C', 'O', 'M', 0x00, 0x00, 0x01, 0x00, 0x01,
+	0xc0, 0x0c, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x0e, 0x10, 0x00, 0x04,
+	192, 0, 2, 1
+};
+
+static size_t with_opt(uint8_t *out, const uint8_t *wire, size_t size)
+{
+	memcpy(out, wire, size);
+	memcpy(out + size, OPT, sizeof(OPT));
+	knot_wire_set_arcount(out, knot_wire_get_arcount(out) + 1);
+	return size + sizeof(OPT);
+}
+
+static void test_parse(void)
+{
+	answer_cache_query_t q;
+	uint8_t wire[128];
+
+	int ret = answer_cache_parse(&q, QUERY, sizeof(QUERY));
+	ok(ret == KNOT_EOK && !q.edns && q.qtype == 1 && q.qname_size == 17 &&
+	   memcmp(q.qname, "\x03www\x07""example\x03""com", 17) == 0,
+	   "parse: plain query, lowercased");
+
+	size_t size = with_opt(wire, QUERY, sizeof(QUERY));
+	ret = answer_cache_parse(&q, wire, size);
+	ok(ret == KNOT_EOK && q.edns && q.payload == 1232, "parse: EDNS query");
+
+	wire[size - 4] = 0x80; /* DO bit */
+	ret = answer_cache_parse(&q, wire, size);
+	ok(ret != KNOT_EOK, "parse: DNSSEC query refused");
+
+	ret = answer_cache_parse(&q, wire, size - 1);
+	ok(ret != KNOT_EOK, "parse: truncated OPT refused");
+
+	memcpy(wire, QUERY, sizeof(QUERY));
+	wire[sizeof(QUERY) - 3] = 0xff; /* ANY */
+	ret = answer_cache_parse(&q, wire, sizeof(QUERY));
+	ok(ret != KNOT_EOK, "parse: ANY refused");
+
+	memcpy(wire, QUERY, sizeof(QUERY));
+	knot_wire_set_opcode(wire, KNOT_OPCODE_NOTIFY);
+	ret = answer_cache_parse(&q, wire, sizeof(QUERY));
+	ok(ret != KNOT_EOK, "parse: NOTIFY refused");
+
+	ret = answer_cache_parse(&q, QUERY, sizeof(QUERY) - 1);
+	ok(ret != KNOT_EOK, "parse: malformed refused");
+}
+
+static void test_answer(answer_cache_t *cache)
+{
+	answer_cache_query_t q;
+	uint8_t out[KNOT_WIRE_MAX_PKTSIZE];
+	uint8_t wire[128];
+
+	answer_cache_parse(&q, QUERY, sizeof(QUERY));
+	size_t size = answer_cache_answer(cache, &q, 1, 1232, out, sizeof(out));
+	ok(size == 0, "answer: empty cache");
+
+	/* Not authoritative. */
+	memcpy(wire, ANSWER, sizeof(ANSWER));
+	knot_wire_clear_aa(wire);
+	ok(!answer_cache_insert(cache, &q, 1, wire, sizeof(ANSWER)), "insert: non-AA ignored");
+	memcpy(wire, ANSWER, sizeof(ANSWER));
+	knot_wire_set_tc(wire);
+	ok(!answer_cache_insert(cache, &q, 1, wire, sizeof(ANSWER)), "insert: TC ignored");
+	ok(answer_cache_insert(cache, &q, 1, ANSWER, sizeof(ANSWER)), "insert: plain answer");
+
+	/* Different ID, no RD, different letter case. */
+	memcpy(wire, QUERY, sizeof(QUERY));
+	knot_wire_set_id(wire, 0xabcd);
+	knot_wire_clear_rd(wire);
+	wire[13] = 'w';
+	wire[25] = 'c';
+	answer_cache_parse(&q, wire, sizeof(QUERY));
+	size = answer_cache_answer(cache, &q, 1, 1232, out, sizeof(out));
+	ok(size == sizeof(ANSWER) && knot_wire_get_id(out) == 0xabcd &&
+	   !knot_wire_get_rd(out) && knot_wire_get_aa(out) &&
+	   memcmp(out + KNOT_WIRE_HEADER_SIZE, wire + KNOT_WIRE_HEADER_SIZE, 17) == 0 &&
+	   memcmp(out + 29, ANSWER + 29, sizeof(ANSWER) - 29) == 0,
+	   "answer: ID, flags and case patched");
+
+	size = answer_cache_answer(cache, &q, 2, 1232, out, sizeof(out));
+	ok(size == 0, "answer: zone changed");
+
+	size = answer_cache_answer(cache, &q, 1, 1232, out, sizeof(ANSWER) - 1);
+	ok(size == 0, "answer: no space");
+
+	/* EDNS query differs from the plain one. */
+	size = with_opt(wire, QUERY, sizeof(QUERY));
+	answer_cache_parse(&q, wire, size);
+	q.limit = 1232;
+	size = answer_cache_answer(cache, &q, 1, 1232, out, sizeof(out));
+	ok(size == 0, "answer: EDNS query not cached");
+
+	uint8_t ans_opt[128];
+	size = with_opt(ans_opt, ANSWER, sizeof(ANSWER));
+	ok(answer_cache_insert(cache, &q, 1, ans_opt, size), "insert: EDNS answer");
+
+	size = answer_cache_answer(cache, &q, 1, 4096, out, sizeof(out));
+	ok(size == sizeof(ANSWER) + sizeof(OPT) && knot_wire_get_arcount(out) == 1 &&
+	   out[sizeof(ANSWER) + 2] == 0x29 && out[sizeof(ANSWER) + 3] == 0x10 &&
+	   out[sizeof(ANSWER) + 4] == 0x00,
+	   "answer: OPT with server payload");
+
+	q.limit = 4096;
+	size = answer_cache_answer(cache, &q, 1, 4096, out, sizeof(out));
+	ok(size == 0, "answer: different size limit");
+
+	/* Rate limited, only the question and OPT are kept. */
+	q.limit = 1232;
+	size = answer_cache_answer(cache, &q, 1, 4096, out, sizeof(out));
+	size = answer_cache_slip(&q, 4096, out);
+	ok(size == sizeof(QUERY) + sizeof(OPT) && knot_wire_get_tc(out) &&
+	   !knot_wire_get_aa(out) && knot_wire_get_ancount(out) == 0 &&
+	   knot_wire_get_arcount(out) == 1 && out[sizeof(QUERY) + 2] == 0x29 &&
+	   out[sizeof(QUERY) + 3] == 0x10,
+	   "slip: question and OPT kept");
+}
+
+static void test_replace(void)
+{
+	answer_cache_t *cache = answer_cache_new(1);
+	ok(cache != NULL, "replace: create single bucket");
+
+	/* Fill the bucket with different query types. */
+	answer_cache_query_t q;
+	uint8_t query[sizeof(QUERY)], ans[sizeof(ANSWER)];
+	memcpy(query, QUERY, sizeof(QUERY));
+	memcpy(ans, ANSWER, sizeof(ANSWER));
+	for (int type = 1; type <= ANSWER_CACHE_WAYS + 1; type++) {
+		query[30] = type;
+		ans[30] = type;
+		answer_cache_parse(&q, query, sizeof(query));
+		answer_cache_insert(cache, &q, 1, ans, sizeof(ans));
+	}
+
+	uint8_t out[KNOT_WIRE_MAX_PKTSIZE];
+	int cached = 0;
+	for (int type = 1; type <= ANSWER_CACHE_WAYS + 1; type++) {
+		query[30] = type;
+		answer_cache_parse(&q, query, sizeof(query));
+		if (answer_cache_answer(cache, &q, 1, 1232, out, sizeof(out)) > 0) {
+			cached += 1;
+		}
+	}
+	is_int(ANSWER_CACHE_WAYS, cached, "replace: bucket full");
+
+	query[30] = ANSWER_CACHE_WAYS + 1;
+	answer_cache_parse(&q, query, sizeof(query));
+	ok(answer_cache_answer(cache, &q, 1, 1232, out, sizeof(out)) > 0,
+	   "replace: last inserted kept");
+
+	answer_cache_free(cache);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	ok(answer_cache_new(0) == NULL, "create disabled");
+	answer_cache_t *cache = answer_cache_new(100);
+	ok(cache != NULL, "create");
+
+	test_parse();
+	test_answer(cache);
+	test_replace();
+
+	answer_cache_free(cache);
+
+	return 0;
+}
@@ -0,0 +1,197 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <tap/basic.h>
+
+#include "knot/updates/changesets.h"
+#include "knot/zone/catalog.h"
+#include "libknot/libknot.h"
+
+static void add_rr(zone_contents_t *contents, const char *owner_str,
+                   uint16_t type, const char *rdata_str)
+{
+	knot_dname_t *owner = knot_dname_from_str_alloc(owner_str);
+	knot_rrset_t *rr = knot_rrset_new(owner, type, KNOT_CLASS_IN, NULL);
+	knot_dname_free(&owner, NULL);
+
+	uint8_t rdata[KNOT_DNAME_MAXLEN];
+	if (type == KNOT_RRTYPE_PTR) {
+		knot_dname_from_str(rdata, rdata_str, sizeof(rdata));
+	} else {
+		rdata[0] = strlen(rdata_str);
+		memcpy(rdata + 1, rdata_str, rdata[0]);
+	}
+	uint16_t size = (type == KNOT_RRTYPE_PTR) ? knot_dname_size(rdata) :
+	                                            rdata[0] + 1;
+
+	zone_node_t *node = NULL;
+	int ret = knot_rrset_add_rdata(rr, rdata, size, 3600, NULL);
+	if (ret == KNOT_EOK) {
+		ret = zone_contents_add_rr(contents, rr, &node);
+	}
+	ok(ret == KNOT_EOK, "catalog: add %s", owner_str);
+
+	knot_rrset_free(&rr, NULL);
+}
+
+static bool has_member(hattrie_t *members, const char *name_str)
+{
+	knot_dname_t *name = knot_dname_from_str_alloc(name_str);
+	bool found = hattrie_tryget(members, (char *)name,
+	                            knot_dname_size(name)) != NULL;
+	knot_dname_free(&name, NULL);
+	return found;
+}
+
+static bool has_change(hattrie_t *changes, const char *name_str,
+                       const char *catalog_str)
+{
+	uint8_t key[2 * KNOT_DNAME_MAXLEN];
+	knot_dname_from_str(key, name_str, KNOT_DNAME_MAXLEN);
+	size_t len = knot_dname_size(key);
+	knot_dname_from_str(key + len, catalog_str, KNOT_DNAME_MAXLEN);
+	len += knot_dname_size(key + len);
+	return hattrie_tryget(changes, (char *)key, len) != NULL;
+}
+
+static int applied;
+
+static void apply(void *ctx)
+{
+	applied++;
+}
+
+static void test_update(void)
+{
+	knot_dname_t *apex = knot_dname_from_str_alloc("catalog.");
+
+	catalog_update_t upd;
+	int ret = catalog_update_init(&upd, apply, NULL);
+	ok(ret == KNOT_EOK, "catalog update: init");
+
+	/* Changes between whole contents. */
+	zone_contents_t *old_cont = zone_contents_new(apex);
+	add_rr(old_cont, "a1.zones.catalog.", KNOT_RRTYPE_PTR, "kept.");
+	add_rr(old_cont, "a2.zones.catalog.", KNOT_RRTYPE_PTR, "removed.");
+	zone_contents_t *new_cont = zone_contents_new(apex);
+	add_rr(new_cont, "a1.zones.catalog.", KNOT_RRTYPE_PTR, "kept.");
+	add_rr(new_cont, "a3.zones.catalog.", KNOT_RRTYPE_PTR, "added.");
+
+	ret = catalog_update_contents(&upd, apex, old_cont, new_cont);
+	ok(ret == KNOT_EOK && hattrie_weight(upd.add) == 1 &&
+	   hattrie_weight(upd.rem) == 1 &&
+	   has_change(upd.add, "added.", "catalog.") &&
+	   has_change(upd.rem, "removed.", "catalog."),
+	   "catalog update: contents difference");
+
+	/* Changes from a changeset, re-listing cancels the removal. */
+	changeset_t *ch = changeset_new(apex);
+	add_rr(ch->remove, "a3.zones.catalog.", KNOT_RRTYPE_PTR, "added.");
+	add_rr(ch->add, "a4.zones.catalog.", KNOT_RRTYPE_PTR, "removed.");
+	add_rr(ch->add, "a5.zones.catalog.", KNOT_RRTYPE_PTR, "other.");
+	list_t changes;
+	init_list(&changes);
+	add_tail(&changes, &ch->n);
+
+	zone_contents_t *next_cont = zone_contents_new(apex);
+	add_rr(next_cont, "a1.zones.catalog.", KNOT_RRTYPE_PTR, "kept.");
+	add_rr(next_cont, "a4.zones.catalog.", KNOT_RRTYPE_PTR, "removed.");
+	add_rr(next_cont, "a5.zones.catalog.", KNOT_RRTYPE_PTR, "other.");
+	ret = catalog_update_changes(&upd, apex, &changes, next_cont);
+	ok(ret == KNOT_EOK && hattrie_weight(upd.add) == 2 &&
+	   hattrie_weight(upd.rem) == 1 &&
+	   has_change(upd.add, "removed.", "catalog.") &&
+	   has_change(upd.add, "other.", "catalog.") &&
+	   has_change(upd.rem, "added.", "catalog."),
+	   "catalog update: changeset");
+
+	/* Unlisting one of duplicate PTRs keeps the member. */
+	catalog_update_clear(&upd);
+	changeset_t *dup = changeset_new(apex);
+	add_rr(dup->add, "a6.zones.catalog.", KNOT_RRTYPE_PTR, "kept.");
+	add_rr(dup->remove, "a1.zones.catalog.", KNOT_RRTYPE_PTR, "kept.");
+	add_rr(dup->remove, "a5.zones.catalog.", KNOT_RRTYPE_PTR, "other.");
+	list_t dup_changes;
+	init_list(&dup_changes);
+	add_tail(&dup_changes, &dup->n);
+	zone_contents_t *dup_cont = zone_contents_new(apex);
+	add_rr(dup_cont, "a4.zones.catalog.", KNOT_RRTYPE_PTR, "removed.");
+	add_rr(dup_cont, "a6.zones.catalog.", KNOT_RRTYPE_PTR, "kept.");
+
+	ret = catalog_update_changes(&upd, apex, &dup_changes, dup_cont);
+	ok(ret == KNOT_EOK && hattrie_weight(upd.rem) == 1 &&
+	   has_change(upd.rem, "other.", "catalog.") &&
+	   !has_change(upd.rem, "kept.", "catalog."),
+	   "catalog update: duplicate member kept");
+
+	catalog_update_apply(&upd);
+	ok(applied == 1, "catalog update: apply callback");
+
+	catalog_update_clear(&upd);
+	ok(hattrie_weight(upd.add) == 0 && hattrie_weight(upd.rem) == 0,
+	   "catalog update: clear");
+
+	changesets_free(&changes);
+	changesets_free(&dup_changes);
+	zone_contents_deep_free(&next_cont);
+	zone_contents_deep_free(&dup_cont);
+	zone_contents_deep_free(&old_cont);
+	zone_contents_deep_free(&new_cont);
+	catalog_update_deinit(&upd);
+	knot_dname_free(&apex, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	knot_dname_t *apex = knot_dname_from_str_alloc("catalog.");
+	zone_contents_t *contents = zone_contents_new(apex);
+	knot_dname_free(&apex, NULL);
+	ok(contents != NULL, "catalog: create contents");
+
+	hattrie_t *members = hattrie_create(NULL);
+
+	/* No member zones. */
+	int ret = catalog_members(contents, members);
+	ok(ret == KNOT_EOK && hattrie_weight(members) == 0,
+	   "catalog: empty catalog");
+
+	add_rr(contents, "version.catalog.", KNOT_RRTYPE_TXT, "2");
+	add_rr(contents, "a1.zones.catalog.", KNOT_RRTYPE_PTR, "Example.com.");
+	add_rr(contents, "a2.zones.catalog.", KNOT_RRTYPE_PTR, "example.net.");
+	add_rr(contents, "a3.zones.catalog.", KNOT_RRTYPE_TXT, "example.org.");
+	add_rr(contents, "x.a4.zones.catalog.", KNOT_RRTYPE_PTR, "example.org.");
+	add_rr(contents, "a5.zones.catalog.", KNOT_RRTYPE_PTR, "catalog.");
+
+	ret = catalog_members(contents, members);
+	ok(ret == KNOT_EOK, "catalog: collect members");
+	is_int(2, hattrie_weight(members), "catalog: member count");
+	ok(has_member(members, "example.com."), "catalog: member in lower case");
+	ok(has_member(members, "example.net."), "catalog: member");
+	ok(!has_member(members, "example.org."), "catalog: ignored non-member");
+	ok(!has_member(members, "catalog."), "catalog: ignored catalog itself");
+
+	ret = catalog_members(NULL, members);
+	ok(ret == KNOT_EINVAL, "catalog: no contents");
+
+	hattrie_free(members);
+	zone_contents_deep_free(&contents);
+
+	test_update();
+
+	return 0;
+}
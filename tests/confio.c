@@ -891,6 +891,10 @@ static void test_conf_io_list(void)
 	      "server.tcp-idle-timeout\n"
 	      "server.tcp-reply-timeout\n"
 	      "server.max-tcp-clients\n"
+	      "server.max-tcp-clients-per-prefix\n"
+	      "server.max-expensive-queries\n"
+	      "server.udp-answer-cache\n"
+	      "server.memory-pressure\n"
 	      "server.max-udp-payload\n"
 	      "server.max-ipv4-udp-payload\n"
 	      "server.max-ipv6-udp-payload\n"
@@ -907,6 +911,10 @@ static const yp_item_t desc_server[] = {
 	{ C_TCP_IDLE_TIMEOUT,	  YP_TINT,  YP_VNONE },
 	{ C_TCP_REPLY_TIMEOUT,	  YP_TINT,  YP_VNONE },
 	{ C_MAX_TCP_CLIENTS,	  YP_TINT,  YP_VNONE },
+	{ C_MAX_TCP_PREFIX,       YP_TINT,  YP_VNONE },
+	{ C_MAX_EXPENSIVE_QUERIES, YP_TINT, YP_VNONE },
+	{ C_UDP_ANSWER_CACHE,     YP_TINT,  YP_VNONE },
+	{ C_MEMORY_PRESSURE,      YP_TINT,  YP_VNONE },
 	{ C_MAX_UDP_PAYLOAD,      YP_TINT,  YP_VNONE },
 	{ C_MAX_IPV4_UDP_PAYLOAD, YP_TINT,  YP_VNONE },
 	{ C_MAX_IPV6_UDP_PAYLOAD, YP_TINT,  YP_VNONE },
@@ -17,10 +17,13 @@
 #include <pthread.h>
 #include <sched.h>
 #include <signal.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <tap/basic.h>
+#include <unistd.h>
 
 #include "knot/server/dthreads.h"
+#include "libknot/errcode.h"
 
 /* Unit runnable data. */
 static pthread_mutex_t _runnable_mx;
@@ -63,6 +66,69 @@ int destruct(struct dthread *thread)
 	return 0;
 }
 
+/* Parking runnable data. */
+static volatile int _parking_runs = 0;
+static volatile int _parking_returns = 0;
+
+/*! \brief Runnable serving until parked. */
+static int parking_runnable(struct dthread *thread)
+{
+	__sync_add_and_fetch(&_parking_runs, 1);
+	while (!dt_is_parked(thread) && !dt_is_cancelled(thread)) {
+		usleep(1000);
+	}
+	__sync_add_and_fetch(&_parking_returns, 1);
+
+	return 0;
+}
+
+/*! \brief Wait until the counter reaches the value. */
+static bool wait_count(volatile int *counter, int value)
+{
+	for (int i = 0; i < 5000 && *counter < value; ++i) {
+		usleep(1000);
+	}
+
+	return *counter == value;
+}
+
+static void test_parking(void)
+{
+	dt_unit_t *unit = dt_create(2, &parking_runnable, NULL, NULL);
+	ok(unit != NULL && dt_start(unit) == KNOT_EOK &&
+	   wait_count(&_parking_runs, 2), "dthreads: parking, start");
+	if (unit == NULL) {
+		skip_block(9, "No dthreads unit");
+		return;
+	}
+
+	/* New threads are parked. */
+	ok(dt_extend(unit, 4) == KNOT_EOK && unit->size == 4,
+	   "dthreads: parking, extend");
+	usleep(10000);
+	ok(_parking_runs == 2 && dt_is_parked(unit->threads[3]),
+	   "dthreads: parking, new threads parked");
+	is_int(3, dt_get_id(unit->threads[3]), "dthreads: parking, new thread ID");
+	ok(dt_activate(unit->threads[3]) == KNOT_EOK &&
+	   wait_count(&_parking_runs, 3), "dthreads: parking, activate new thread");
+
+	/* Park and reactivate a running thread. */
+	ok(dt_park(unit->threads[0]) == KNOT_EOK &&
+	   wait_count(&_parking_returns, 1), "dthreads: parking, park thread");
+	ok(dt_activate(unit->threads[0]) == KNOT_EOK &&
+	   wait_count(&_parking_runs, 4), "dthreads: parking, reactivate thread");
+
+	/* Shrinking isn't supported. */
+	is_int(KNOT_EINVAL, dt_extend(unit, 2), "dthreads: parking, no shrinking");
+
+	dt_stop(unit);
+	dt_join(unit);
+	dt_delete(&unit);
+
+	is_int(KNOT_EINVAL, dt_extend(NULL, 1), "dthreads: parking, extend NULL");
+	is_int(KNOT_EINVAL, dt_park(NULL), "dthreads: parking, park NULL");
+}
+
 // Signal handler
 static void interrupt_handle(int s)
 {
@@ -71,7 +137,7 @@ static void interrupt_handle(int s)
 /*! API: run tests. */
 int main(int argc, char *argv[])
 {
-	plan(8);
+	plan(18);
 
 	// Register service and signal handler
 	struct sigaction sa;
@@ -137,6 +203,9 @@ int main(int argc, char *argv[])
 	is_int(2, _destructor_data, "dthreads: destructor with dt_create_coherent()");
 	dt_delete(&unit);
 
+	/* Tests 9-18: Parked threads. */
+	test_parking();
+
 skip_all:
 
 	pthread_mutex_destroy(&_runnable_mx);
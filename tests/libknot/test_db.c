@@ -14,6 +14,8 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <limits.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
@@ -251,6 +253,161 @@ static void knot_db_test_set(unsigned nkeys, char **keys, void *opts,
 	api->deinit(db);
 }
 
+static void knot_db_test_grow(const char *dir, knot_mm_t *pool)
+{
+	const knot_db_api_t *api = knot_db_lmdb_api();
+
+	char path[PATH_MAX];
+	(void)snprintf(path, sizeof(path), "%s/grow", dir);
+
+	/* Create a database with a small map. */
+	struct knot_db_lmdb_opts opts = KNOT_DB_LMDB_OPTS_INITIALIZER;
+	opts.path = path;
+	opts.mapsize = 256 * 1024;
+
+	knot_db_t *db = NULL;
+	int ret = api->init(&db, pool, &opts);
+	ok(ret == KNOT_EOK && db != NULL, "%s: create small map", api->name);
+
+	/* Insert much more data than the initial map can hold. */
+	const unsigned nrecords = 2048;
+	uint8_t data[1024] = { 0 };
+	bool passed = true;
+	for (unsigned i = 0; i < nrecords && passed; ++i) {
+		knot_db_val_t key = { .data = &i, .len = sizeof(i) };
+		knot_db_val_t val = { .data = data, .len = sizeof(data) };
+
+		/* Retry once, the map grows at the next transaction start. */
+		for (int attempt = 0; attempt < 2; ++attempt) {
+			knot_db_txn_t txn;
+			ret = api->txn_begin(db, &txn, 0);
+			if (ret != KNOT_EOK) {
+				break;
+			}
+			ret = api->insert(&txn, &key, &val, 0);
+			if (ret == KNOT_EOK) {
+				ret = api->txn_commit(&txn);
+				break;
+			}
+			api->txn_abort(&txn);
+		}
+		passed = (ret == KNOT_EOK);
+	}
+	ok(passed, "%s: insert beyond the initial map size", api->name);
+
+	/* Check the records. */
+	knot_db_txn_t txn;
+	ret = api->txn_begin(db, &txn, KNOT_DB_RDONLY);
+	ok(ret == KNOT_EOK, "%s: txn_begin(RD)", api->name);
+	is_int(nrecords, api->count(&txn), "%s: count after growth", api->name);
+	api->txn_abort(&txn);
+
+	api->deinit(db);
+}
+
+static int insert_bulk(const knot_db_api_t *api, knot_db_t *db, unsigned nrecords)
+{
+	uint8_t data[1024] = { 0 };
+
+	knot_db_txn_t txn;
+	int ret = api->txn_begin(db, &txn, 0);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	for (unsigned i = 0; i < nrecords; ++i) {
+		knot_db_val_t key = { .data = &i, .len = sizeof(i) };
+		knot_db_val_t val = { .data = data, .len = sizeof(data) };
+		ret = api->insert(&txn, &key, &val, 0);
+		if (ret != KNOT_EOK) {
+			api->txn_abort(&txn);
+			return ret;
+		}
+	}
+
+	return api->txn_commit(&txn);
+}
+
+struct reader {
+	const knot_db_api_t *api;
+	knot_db_t *db;
+	pthread_barrier_t barrier;
+	int ret;
+};
+
+static void *reader_thread(void *arg)
+{
+	struct reader *r = arg;
+
+	knot_db_txn_t txn;
+	r->ret = r->api->txn_begin(r->db, &txn, KNOT_DB_RDONLY);
+	pthread_barrier_wait(&r->barrier);
+	/* The main thread tries to grow the map. */
+	pthread_barrier_wait(&r->barrier);
+	if (r->ret == KNOT_EOK) {
+		r->api->txn_abort(&txn);
+	}
+
+	return NULL;
+}
+
+static void knot_db_test_grow_bulk(const char *dir, knot_mm_t *pool)
+{
+	const knot_db_api_t *api = knot_db_lmdb_api();
+
+	char path[PATH_MAX];
+	(void)snprintf(path, sizeof(path), "%s/grow_bulk", dir);
+
+	struct knot_db_lmdb_opts opts = KNOT_DB_LMDB_OPTS_INITIALIZER;
+	opts.path = path;
+	opts.mapsize = 256 * 1024;
+
+	knot_db_t *db = NULL;
+	int ret = api->init(&db, pool, &opts);
+	ok(ret == KNOT_EOK && db != NULL, "%s: create small map", api->name);
+
+	/* A single transaction bigger than the map. */
+	const unsigned nrecords = 4096;
+	ret = insert_bulk(api, db, nrecords);
+	is_int(KNOT_ESPACE, ret, "%s: bulk insert beyond the map size", api->name);
+
+	/* The map can't grow while another transaction is open. */
+	knot_db_txn_t txn;
+	int txn_ret = api->txn_begin(db, &txn, KNOT_DB_RDONLY);
+	ok(txn_ret == KNOT_EOK, "%s: txn_begin(RD)", api->name);
+	is_int(KNOT_EBUSY, knot_db_lmdb_grow(db), "%s: no growth with open txn",
+	       api->name);
+	api->txn_abort(&txn);
+
+	/* Transactions of other threads are counted too. */
+	struct reader r = { .api = api, .db = db };
+	pthread_barrier_init(&r.barrier, NULL, 2);
+	pthread_t thread;
+	pthread_create(&thread, NULL, reader_thread, &r);
+	pthread_barrier_wait(&r.barrier);
+	ok(r.ret == KNOT_EOK, "%s: txn_begin(RD) in another thread", api->name);
+	is_int(KNOT_EBUSY, knot_db_lmdb_grow(db), "%s: no growth with txn in "
+	       "another thread", api->name);
+	pthread_barrier_wait(&r.barrier);
+	pthread_join(thread, NULL);
+	pthread_barrier_destroy(&r.barrier);
+
+	/* Grow and retry the whole transaction. */
+	unsigned attempts = 1;
+	while (ret == KNOT_ESPACE && knot_db_lmdb_grow(db) == KNOT_EOK) {
+		ret = insert_bulk(api, db, nrecords);
+		attempts++;
+	}
+	ok(ret == KNOT_EOK && attempts > 1, "%s: bulk insert after growth", api->name);
+
+	ret = api->txn_begin(db, &txn, KNOT_DB_RDONLY);
+	ok(ret == KNOT_EOK, "%s: txn_begin(RD)", api->name);
+	is_int(nrecords, api->count(&txn), "%s: count after bulk growth", api->name);
+	api->txn_abort(&txn);
+
+	api->deinit(db);
+}
+
 int main(int argc, char *argv[])
 {
 	plan_lazy();
@@ -278,6 +435,10 @@ int main(int argc, char *argv[])
 	knot_db_test_set(nkeys, keys, &lmdb_opts, knot_db_lmdb_api(), &pool);
 	knot_db_test_set(nkeys, keys, &trie_opts, knot_db_trie_api(), &pool);
 
+	/* Check the LMDB map growth. */
+	knot_db_test_grow(dbid, &pool);
+	knot_db_test_grow_bulk(dbid, &pool);
+
 	/* Cleanup. */
 	mp_delete(pool.ctx);
 	test_rm_rf(dbid);
@@ -734,6 +734,33 @@ static void test_alignment(void)
 	ok(ret == (512 - (1 + 1 + KNOT_EDNS_OPTION_HDRLEN)), "%i-Byte alignment", ret);
 }
 
+static void test_keepalive(void)
+{
+	uint8_t wire[KNOT_EDNS_MAX_OPTION_TCP_KEEPALIVE] = { 0 };
+	uint16_t timeout = 1;
+	int ret;
+
+	ok(knot_edns_keepalive_size(0) == 0 &&
+	   knot_edns_keepalive_size(1200) == sizeof(uint16_t),
+	   "keepalive: size");
+
+	ret = knot_edns_keepalive_write(wire, sizeof(wire), 1200);
+	ok(ret == KNOT_EOK && memcmp(wire, "\x04\xb0", sizeof(wire)) == 0,
+	   "keepalive: write");
+
+	ret = knot_edns_keepalive_write(wire, 1, 1200);
+	ok(ret == KNOT_ESPACE, "keepalive: write to short buffer");
+
+	ret = knot_edns_keepalive_parse(&timeout, wire, sizeof(wire));
+	ok(ret == KNOT_EOK && timeout == 1200, "keepalive: parse");
+
+	ret = knot_edns_keepalive_parse(&timeout, NULL, 0);
+	ok(ret == KNOT_EOK && timeout == 0, "keepalive: parse empty");
+
+	ret = knot_edns_keepalive_parse(&timeout, wire, 1);
+	ok(ret == KNOT_EMALF, "keepalive: parse malformed");
+}
+
 int main(int argc, char *argv[])
 {
 	plan_lazy();
@@ -750,6 +777,7 @@ int main(int argc, char *argv[])
 	test_remove();
 	test_unique();
 	test_alignment();
+	test_keepalive();
 
 	knot_rrset_clear(&opt_rr, NULL);
 
@@ -29,7 +29,7 @@
 
 int main(int argc, char *argv[])
 {
-	plan(34);
+	plan(35);
 
 	// Test init
 	knot_rdataset_t rdataset;
@@ -131,6 +131,21 @@ int main(int argc, char *argv[])
 	merge_ok = ret == KNOT_EOK && knot_rdataset_eq(&rdataset_gt, &rdataset);
 	ok(merge_ok, "rdataset: merge into greater.");
 
+	knot_rdata_t rdata_mid[knot_rdata_array_size(4)];
+	knot_rdata_init(rdata_mid, 4, (uint8_t *)"mnop", 3600);
+	RDATASET_INIT_WITH(rdataset_lo, rdata_lo);
+	ret = knot_rdataset_add(&rdataset_lo, rdata_mid, NULL);
+	assert(ret == KNOT_EOK);
+	RDATASET_INIT_WITH(rdataset_gt, rdata_gt);
+	ret = knot_rdataset_add(&rdataset_gt, rdata_mid, NULL);
+	assert(ret == KNOT_EOK);
+	ret = knot_rdataset_merge(&rdataset_lo, &rdataset_gt, NULL);
+	merge_ok = ret == KNOT_EOK && rdataset_lo.rr_count == 3 &&
+	           knot_rdata_cmp(knot_rdataset_at(&rdataset_lo, 0), rdata_lo) == 0 &&
+	           knot_rdata_cmp(knot_rdataset_at(&rdataset_lo, 1), rdata_mid) == 0 &&
+	           knot_rdata_cmp(knot_rdataset_at(&rdataset_lo, 2), rdata_gt) == 0;
+	ok(merge_ok, "rdataset: merge multiple with duplicate.");
+
 	// Test intersect
 	ok(knot_rdataset_intersect(NULL, NULL, NULL, NULL) == KNOT_EINVAL,
 	   "rdataset: intersect NULL.");
@@ -0,0 +1,226 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <tap/basic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libknot/descriptor.h"
+#include "libknot/dname.h"
+#include "libknot/errcode.h"
+#include "libknot/error.h"
+#include "libknot/rrset-dump.h"
+
+#define STYLES 3
+
+struct test {
+	const char *msg;
+	const char *owner;
+	uint16_t type;
+	uint32_t ttl;
+	const char *rdata;
+	uint16_t rdata_len;
+	const char *expected[STYLES];
+};
+
+static const struct test TESTS[] = {
+	{ "A",          "example.com.", KNOT_RRTYPE_A, 3600, "\xc0\x00\x02\x01", 4,
+	  { "example.com.        \t3600\tA\t192.0.2.1\n",
+	    "example.com.        \t1h IN A 192.0.2.1\n",
+	    "example.com.        \t\tTYPE1\t\\# 4 C0000201\n" } },
+	{ "A zero",     "example.com.", KNOT_RRTYPE_A, 0, "\x00\x00\x00\x00", 4,
+	  { "example.com.        \t0\tA\t0.0.0.0\n",
+	    "example.com.        \t0s IN A 0.0.0.0\n",
+	    "example.com.        \t\tTYPE1\t\\# 4 00000000\n" } },
+	{ "AAAA",       "example.com.", KNOT_RRTYPE_AAAA, 300, "\x20\x01\x0d\xb8\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x01", 16,
+	  { "example.com.        \t300\tAAAA\t2001:db8::1\n",
+	    "example.com.        \t5m IN AAAA 2001:db8::1\n",
+	    "example.com.        \t\tTYPE28\t\\# 16 20010DB8000000000000000000000001\n" } },
+	{ "MX",         "example.com.", KNOT_RRTYPE_MX, 86400, "\x00\x0a\x04mail\x07" "example\x03" "com\x00", 20,
+	  { "example.com.        \t86400\tMX\t10 mail.example.com.\n",
+	    "example.com.        \t1d IN MX 10 mail.example.com.\n",
+	    "example.com.        \t\tTYPE15\t\\# 20 000A046D61696C076578616D706C6503636F6D00\n" } },
+	{ "TXT",        "example.com.", KNOT_RRTYPE_TXT, 60, "\x0e" "a\"b\\c\tX\xff ~\x7f\x01yz", 15,
+	  { "example.com.        \t60\tTXT\t\"a\\\"b\\\\c\\009X\\255 ~\\127\\001yz\"\n",
+	    "example.com.        \t1m IN TXT \"a\\\"b\\\\c\\009X\\255 ~\\127\\001yz\"\n",
+	    "example.com.        \t\tTYPE16\t\\# 15 0E6122625C630958FF207E7F01797A\n" } },
+	{ "TXT multi",  "example.com.", KNOT_RRTYPE_TXT, 60, "\x03" "abc" "\x00" "\x02" "d ", 8,
+	  { "example.com.        \t60\tTXT\t\"abc\" \"\" \"d \"\n",
+	    "example.com.        \t1m IN TXT \"abc\" \"\" \"d \"\n",
+	    "example.com.        \t\tTYPE16\t\\# 8 0361626300026420\n" } },
+	{ "HINFO",      "example.com.", KNOT_RRTYPE_HINFO, 60, "\x03" "CPU" "\x02" "OS", 7,
+	  { "example.com.        \t60\tHINFO\t\"CPU\" \"OS\"\n",
+	    "example.com.        \t1m IN HINFO \"CPU\" \"OS\"\n",
+	    "example.com.        \t\tTYPE13\t\\# 7 03435055024F53\n" } },
+	{ "SOA",        "example.com.", KNOT_RRTYPE_SOA, 4294967295, "\x02ns\x00\x05" "admin\x00\x78\x24\xbd\x28\x00\x00\x0e\x10\x00\x00\x03\x84\x00\x12\x75\x00\x00\x01\x5f\x91", 31,
+	  { "example.com.        \t4294967295\tSOA\tns. admin. 2015673640 3600 900 1209600 90001\n",
+	    "example.com.        \t49710d6h28m15s IN SOA ns. admin. (\n"
+	    "\t\t\t\t2015673640 ; serial\n"
+	    "\t\t\t\t1h ; refresh\n"
+	    "\t\t\t\t15m ; retry\n"
+	    "\t\t\t\t14d ; expire\n"
+	    "\t\t\t\t1d1h1s ; minimum\n"
+	    "\t\t\t\t)\n",
+	    "example.com.        \t\tTYPE6\t\\# 31 026E73000561646D696E007824BD2800000E10000003840012750000015F91\n" } },
+	{ "RRSIG",      "example.com.", KNOT_RRTYPE_RRSIG, 3600, "\x00\x01\x0d\x02\x00\x00\x0e\x10\x56\xd4\x3a\xf0\x00\x00\x00\x00\x30\x39\x07" "example\x03" "com\x00\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f\x20\x21\x22\x23\x24\x25\x26\x27\x28\x29\x2a\x2b\x2c\x2d\x2e\x2f\x30", 79,
+	  { "example.com.        \t3600\tRRSIG\tA 13 2 3600 20160229123456 19700101000000 12345 example.com. AQIDBAUGBwgJCgsMDQ4PEBESExQVFhcYGRobHB0eHyAhIiMkJSYnKCkqKywtLi8w\n",
+	    "example.com.        \t1h IN RRSIG A 13 2 3600 20160229123456 (\n"
+	    "\t\t\t\t19700101000000 12345 example.com.\n"
+	    "\t\t\t\tAQIDBAUGBwgJCgsMDQ4PEBESExQVFhcYGRobHB0e\n"
+	    "\t\t\t\tHyAhIiMkJSYnKCkqKywtLi8w\n"
+	    "\t\t\t\t)\n",
+	    "example.com.        \t\tTYPE46\t\\# 79 00010D0200000E1056D43AF0000000003039076578616D706C6503636F6D000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F202122232425262728292A2B2C2D2E2F30\n" } },
+	{ "RRSIG max",  "example.com.", KNOT_RRTYPE_RRSIG, 3600, "\xfe\x00\x08\x00\xff\xff\xff\xff\xff\xff\xff\xff\x38\x6d\x43\x80\xff\xff\x00\xab", 20,
+	  { "example.com.        \t3600\tRRSIG\tTYPE65024 8 0 4294967295 21060207062815 20000101000000 65535 . qw==\n",
+	    "example.com.        \t1h IN RRSIG TYPE65024 8 0 4294967295 21060207062815 (\n"
+	    "\t\t\t\t20000101000000 65535 .\n"
+	    "\t\t\t\tqw==\n"
+	    "\t\t\t\t)\n",
+	    "example.com.        \t\tTYPE46\t\\# 20 FE000800FFFFFFFFFFFFFFFF386D4380FFFF00AB\n" } },
+	{ "NSEC",       "a.example.", KNOT_RRTYPE_NSEC, 3600, "\x01" "b\x07" "example\x00\x00\x06\x62\x01\x00\x00\x00\x03\xfd\x01\x80", 22,
+	  { "a.example.          \t3600\tNSEC\tb.example. A NS SOA MX RRSIG NSEC TYPE64768\n",
+	    "a.example.          \t1h IN NSEC b.example. A NS SOA MX RRSIG NSEC TYPE64768\n",
+	    "a.example.          \t\tTYPE47\t\\# 22 0162076578616D706C65000006620100000003FD0180\n" } },
+	{ "NSEC3PARAM", "example.", KNOT_RRTYPE_NSEC3PARAM, 0, "\x01\x00\x00\x0a\x04\xde\xad\xbe\xef", 9,
+	  { "example.            \t0\tNSEC3PARAM\t1 0 10 DEADBEEF\n",
+	    "example.            \t0s IN NSEC3PARAM 1 0 10 DEADBEEF\n",
+	    "example.            \t\tTYPE51\t\\# 9 0100000A04DEADBEEF\n" } },
+	{ "DS",         "example.", KNOT_RRTYPE_DS, 3600, "\xe3\x3c\x08\x02\x01\x23\x45\x67\x89\xab\xcd\xef", 12,
+	  { "example.            \t3600\tDS\t58172 8 2 0123456789ABCDEF\n",
+	    "example.            \t1h IN DS 58172 8 2 (\n"
+	    "\t\t\t\t0123456789ABCDEF\n"
+	    "\t\t\t\t)\n",
+	    "example.            \t\tTYPE43\t\\# 12 E33C08020123456789ABCDEF\n" } },
+	{ "unknown",    "example.", 65280, 3600, "\x01\x02\xff", 3,
+	  { "example.            \t3600\tTYPE65280\t\\# 3 0102FF\n",
+	    "example.            \t1h IN TYPE65280 (\n"
+	    "\t\t\t\t\\# 3 \n"
+	    "\t\t\t\t0102FF\n"
+	    "\t\t\t\t)\n",
+	    "example.            \t\tTYPE65280\t\\# 3 0102FF\n" } },
+	{ "owner escape", "a\\.b\\035c\\000\\032\\(.example.", KNOT_RRTYPE_A, 3600, "\x7f\x00\x00\x01", 4,
+	  { "a\\.b\\035c\\000\\032\\(.example.\t3600\tA\t127.0.0.1\n",
+	    "a\\.b\\035c\\000\\032\\(.example.\t1h IN A 127.0.0.1\n",
+	    "a\\.b\\035c\\000\\032\\(.example.\t\tTYPE1\t\\# 4 7F000001\n" } },
+	{ "owner long", "a-very-long-owner-name-over-32.example.com.", KNOT_RRTYPE_A, 90061, "\x0a\x0b\x0c\x0d", 4,
+	  { "a-very-long-owner-name-over-32.example.com. 90061\tA\t10.11.12.13\n",
+	    "a-very-long-owner-name-over-32.example.com. 1d1h1m1s IN A 10.11.12.13\n",
+	    "a-very-long-owner-name-over-32.example.com. \tTYPE1\t\\# 4 0A0B0C0D\n" } },
+	{ "root",       ".", KNOT_RRTYPE_NS, 518400, "\x01" "a\x0c" "root-servers\x03" "net\x00", 20,
+	  { ".                   \t518400\tNS\ta.root-servers.net.\n",
+	    ".                   \t6d IN NS a.root-servers.net.\n",
+	    ".                   \t\tTYPE2\t\\# 20 01610C726F6F742D73657276657273036E657400\n" } },
+	{ NULL }
+};
+
+static void init_styles(knot_dump_style_t *styles)
+{
+	// Default style.
+	styles[0] = KNOT_DUMP_STYLE_DEFAULT;
+
+	// Multi-line, human readable style.
+	styles[1] = KNOT_DUMP_STYLE_DEFAULT;
+	styles[1].wrap = true;
+	styles[1].show_class = true;
+	styles[1].human_ttl = true;
+	styles[1].verbose = true;
+
+	// Generic RFC 3597 style.
+	styles[2] = KNOT_DUMP_STYLE_DEFAULT;
+	styles[2].empty_ttl = true;
+	styles[2].human_tmstamp = false;
+	styles[2].generic = true;
+}
+
+static void test_styles(void)
+{
+	knot_dump_style_t styles[STYLES];
+	init_styles(styles);
+
+	size_t buflen = 1024;
+	char *buf = malloc(buflen);
+
+	for (const struct test *t = TESTS; t->msg != NULL; t++) {
+		knot_dname_t *owner = knot_dname_from_str_alloc(t->owner);
+		knot_rrset_t rrset;
+		knot_rrset_init(&rrset, owner, t->type, KNOT_CLASS_IN);
+		int ret = knot_rrset_add_rdata(&rrset, (const uint8_t *)t->rdata,
+		                               t->rdata_len, t->ttl, NULL);
+		ok(ret == KNOT_EOK, "%s: create rrset", t->msg);
+
+		for (int i = 0; i < STYLES; i++) {
+			ret = knot_rrset_txt_dump(&rrset, &buf, &buflen, &styles[i]);
+			ok(ret == strlen(t->expected[i]) &&
+			   strcmp(buf, t->expected[i]) == 0,
+			   "%s: style %i", t->msg, i);
+			if (ret < 0 || strcmp(buf, t->expected[i]) != 0) {
+				diag("got '%s'", ret < 0 ? knot_strerror(ret) : buf);
+			}
+		}
+
+		knot_rrset_clear(&rrset, NULL);
+	}
+
+	free(buf);
+}
+
+static void test_multiple(void)
+{
+	knot_dname_t *owner = knot_dname_from_str_alloc("example.com.");
+	knot_rrset_t rrset;
+	knot_rrset_init(&rrset, owner, KNOT_RRTYPE_A, KNOT_CLASS_IN);
+	knot_rrset_add_rdata(&rrset, (const uint8_t *)"\x01\x02\x03\x04", 4, 60, NULL);
+	knot_rrset_add_rdata(&rrset, (const uint8_t *)"\x01\x02\x03\x05", 4, 60, NULL);
+	knot_rrset_add_rdata(&rrset, (const uint8_t *)"\x01\x02\x03\x06", 4, 120, NULL);
+	knot_rrset_add_rdata(&rrset, (const uint8_t *)"\x01\x02\x03\x07", 4, 120, NULL);
+
+	const char *expected =
+		"example.com.        \t60\tA\t1.2.3.4\n"
+		"example.com.        \t60\tA\t1.2.3.5\n"
+		"example.com.        \t120\tA\t1.2.3.6\n"
+		"example.com.        \t120\tA\t1.2.3.7\n";
+
+	// Too short buffer to check the header reuse boundary.
+	size_t buflen = strlen(expected) - 1;
+	char *buf = malloc(buflen);
+	int ret = knot_rrset_txt_dump(&rrset, &buf, &buflen, &KNOT_DUMP_STYLE_DEFAULT);
+	ok(ret == strlen(expected) && strcmp(buf, expected) == 0,
+	   "multiple rdata: dump");
+	free(buf);
+
+	// Header output limit.
+	char header[64];
+	const size_t header_len = strlen("example.com.        \t60\tA\t");
+	ret = knot_rrset_txt_dump_header(&rrset, 60, header, header_len,
+	                                 &KNOT_DUMP_STYLE_DEFAULT);
+	ok(ret == KNOT_ESPACE, "multiple rdata: header no space");
+	ret = knot_rrset_txt_dump_header(&rrset, 60, header, header_len + 1,
+	                                 &KNOT_DUMP_STYLE_DEFAULT);
+	ok(ret == header_len && strncmp(header, expected, header_len) == 0,
+	   "multiple rdata: header");
+
+	knot_rrset_clear(&rrset, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	test_styles();
+	test_multiple();
+
+	return 0;
+}
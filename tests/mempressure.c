@@ -0,0 +1,140 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tap/basic.h>
+#include <tap/files.h>
+
+#include "knot/server/mempressure.h"
+#include "libknot/errcode.h"
+
+static void write_file(const char *dir, const char *name, const char *data)
+{
+	char path[4096];
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	FILE *file = fopen(path, "w");
+	if (file != NULL) {
+		fputs(data, file);
+		fclose(file);
+	}
+}
+
+static void test_read(const char *dir)
+{
+	mempressure_t mp;
+	mempressure_sample_t s;
+
+	mempressure_init(&mp, dir);
+	write_file(dir, "memory.current", "943718400\n");
+	write_file(dir, "memory.max", "1073741824\n");
+	write_file(dir, "memory.pressure",
+	           "some avg10=12.50 avg60=3.10 avg300=0.80 total=123456\n"
+	           "full avg10=1.00 avg60=0.20 avg300=0.05 total=2345\n");
+
+	int ret = mempressure_read(&mp, &s);
+	ok(ret == KNOT_EOK && s.current == 943718400 && s.max == 1073741824 &&
+	   s.psi_some == 12.5, "read: cgroup usage, limit and stall");
+
+	write_file(dir, "memory.max", "max\n");
+	ret = mempressure_read(&mp, &s);
+	ok(ret == KNOT_EOK && s.current == 943718400 && s.max == 0,
+	   "read: unlimited cgroup");
+
+	mempressure_deinit(&mp);
+}
+
+static void test_update(void)
+{
+	mempressure_t mp;
+	mempressure_init(&mp, "/nonexistent");
+
+	mempressure_sample_t s = { .current = 800, .max = 1000, .psi_some = 0.5 };
+	mempressure_update(&mp, &s, 90);
+	ok(!mempressure_active(&mp), "update: below limit");
+
+	s.current = 950;
+	mempressure_update(&mp, &s, 0);
+	ok(!mempressure_active(&mp), "update: disabled");
+	mempressure_update(&mp, &s, 90);
+	ok(mempressure_active(&mp), "update: over limit signalled");
+
+	s.current = 100;
+	for (int i = 1; i < MEMPRESSURE_PERIODS; i++) {
+		mempressure_update(&mp, &s, 90);
+	}
+	ok(mempressure_active(&mp), "update: still signalled");
+	mempressure_update(&mp, &s, 90);
+	ok(!mempressure_active(&mp), "update: pressure ceased");
+
+	s.max = 0;
+	s.psi_some = MEMPRESSURE_PSI;
+	mempressure_update(&mp, &s, 90);
+	ok(mempressure_active(&mp), "update: stall signalled");
+
+	mempressure_deinit(&mp);
+}
+
+static void test_events(void)
+{
+	mempressure_t mp;
+	mempressure_init(&mp, "/nonexistent");
+
+	ok(mempressure_event_begin(NULL, MEMPRESSURE_REPLACE, true), "events: no detection");
+
+	/* Without pressure, all events run. */
+	ok(mempressure_event_begin(&mp, MEMPRESSURE_REPLACE, true) &&
+	   mempressure_event_begin(&mp, MEMPRESSURE_COPY, true),
+	   "events: no pressure");
+
+	/* Under pressure, copying events wait for the running ones. */
+	mp.active = true;
+	ok(mempressure_event_begin(&mp, MEMPRESSURE_LIGHT, true), "events: light runs");
+	ok(!mempressure_event_begin(&mp, MEMPRESSURE_COPY, true), "events: copy deferred");
+	mempressure_event_end(&mp, MEMPRESSURE_COPY);
+	mempressure_event_end(&mp, MEMPRESSURE_REPLACE);
+	is_int(0, mp.copying, "events: all finished");
+
+	ok(!mempressure_event_begin(&mp, MEMPRESSURE_REPLACE, true),
+	   "events: reload deferred");
+	ok(mempressure_event_begin(&mp, MEMPRESSURE_REPLACE, false),
+	   "events: first load runs");
+	ok(!mempressure_event_begin(&mp, MEMPRESSURE_REPLACE, false),
+	   "events: second load deferred");
+	mempressure_event_end(&mp, MEMPRESSURE_REPLACE);
+	ok(mempressure_event_begin(&mp, MEMPRESSURE_COPY, true), "events: copy runs");
+	mempressure_event_end(&mp, MEMPRESSURE_COPY);
+
+	mempressure_deinit(&mp);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	char *dir = test_mkdtemp();
+	ok(dir != NULL, "make temporary directory");
+
+	test_read(dir);
+	test_update();
+	test_events();
+
+	test_rm_rf(dir);
+	free(dir);
+
+	return 0;
+}
@@ -0,0 +1,72 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <tap/basic.h>
+
+#include "knot/server/overload.h"
+
+static void test_sock_drops(void)
+{
+	volatile uint32_t last = 0;
+
+	is_int(5, overload_sock_drops(&last, 5), "sock: first drops");
+	is_int(0, overload_sock_drops(&last, 5), "sock: no new drops");
+	is_int(0, overload_sock_drops(&last, 3), "sock: older sample ignored");
+	is_int(2, overload_sock_drops(&last, 7), "sock: new drops");
+
+	last = UINT32_MAX - 1;
+	is_int(3, overload_sock_drops(&last, 1), "sock: counter wrap");
+}
+
+static void test_update(void)
+{
+	overload_t ov;
+	memset(&ov, 0, sizeof(ov));
+	time_t now = 1000;
+
+	/* Baseline period. */
+	overload_update(&ov, 0, now);
+	ok(!overload_active(&ov), "update: idle");
+
+	/* Drops in consecutive periods. */
+	for (int i = 1; i < OVERLOAD_PERIODS; i++) {
+		overload_update(&ov, 10, now);
+		overload_update(&ov, 0, ++now);
+	}
+	ok(!overload_active(&ov), "update: short burst not signalled");
+	overload_update(&ov, 10, now);
+	overload_update(&ov, 0, ++now);
+	ok(overload_active(&ov), "update: sustained drops signalled");
+	is_int(10 * OVERLOAD_PERIODS, ov.drops, "update: drops accounted");
+
+	/* Periods without drops. */
+	overload_update(&ov, 0, ++now);
+	ok(overload_active(&ov), "update: still signalled");
+	now += OVERLOAD_PERIODS;
+	overload_update(&ov, 0, now);
+	ok(!overload_active(&ov), "update: overload ceased");
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	test_sock_drops();
+	test_update();
+
+	return 0;
+}
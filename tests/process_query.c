@@ -15,13 +15,16 @@
  */
 
 #include <assert.h>
+#include <poll.h>
 #include <tap/basic.h>
 #include <string.h>
 #include <stdlib.h>
 
 #include "libknot/descriptor.h"
 #include "libknot/packet/wire.h"
+#include "libknot/rrtype/soa.h"
 #include "knot/nameserver/process_query.h"
+#include "knot/nameserver/query_module.h"
 #include "fake_server.h"
 #include "contrib/ucw/mempool.h"
 
@@ -70,6 +73,251 @@ static void exec_query(knot_layer_t *query_ctx, const char *name,
 	knot_pkt_free(&answer);
 }
 
+/* Resolve query to a zone alias and check rewritten names (3 TAP tests). */
+static void exec_alias_query(knot_layer_t *query_ctx, knot_pkt_t *query,
+                             const knot_dname_t *alias)
+{
+	knot_pkt_t *answer = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	assert(answer);
+
+	knot_pkt_parse(query, 0);
+	knot_layer_consume(query_ctx, query);
+	int state = knot_layer_produce(query_ctx, answer);
+	ok(state == KNOT_STATE_DONE, "ns: answer IN/alias query");
+
+	/* Check the answer names. */
+	int ret = knot_pkt_parse(answer, 0);
+	const knot_pktsection_t *section = knot_pkt_section(answer, KNOT_ANSWER);
+	if (ret == KNOT_EOK && section->count == 1) {
+		const knot_rrset_t *rr = knot_pkt_rr(section, 0);
+		ok(knot_dname_is_equal(rr->owner, alias), "ns: alias owner rewritten");
+		ok(knot_dname_is_equal(knot_soa_primary_ns(&rr->rrs),
+		                       (const uint8_t *)"\x02""ns""\x07""example"),
+		   "ns: alias RDATA name rewritten");
+	} else {
+		skip_block(2, "ns: no alias answer");
+	}
+
+	knot_pkt_free(&answer);
+}
+
+/* Resolve DNSSEC query to a zone alias, no records expected (2 TAP tests). */
+static void exec_alias_dnssec_query(knot_layer_t *query_ctx, knot_pkt_t *query)
+{
+	knot_pkt_t *answer = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	assert(answer);
+
+	knot_pkt_parse(query, 0);
+	knot_layer_consume(query_ctx, query);
+	int state = knot_layer_produce(query_ctx, answer);
+	ok(state == KNOT_STATE_DONE, "ns: answer IN/alias NSEC query");
+
+	int ret = knot_pkt_parse(answer, 0);
+	ok(ret == KNOT_EOK && knot_pkt_section(answer, KNOT_ANSWER)->count == 0,
+	   "ns: no DNSSEC records through alias");
+
+	knot_pkt_free(&answer);
+}
+
+/* Resolve expensive queries with a limit of one slot (5 TAP tests). */
+static void exec_expensive_query(knot_layer_t *query_ctx, knot_pkt_t *query,
+                                 struct process_query_param *param)
+{
+	knot_pkt_t *answer = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	assert(answer);
+
+	server_t *server = param->server;
+	conf()->cache.srv_max_expensive_queries = 1;
+
+	knot_pkt_clear(query);
+	knot_pkt_put_question(query, ROOT_DNAME, KNOT_CLASS_IN, KNOT_RRTYPE_ANY);
+	knot_pkt_parse(query, 0);
+
+	/* Within the limit. */
+	knot_layer_reset(query_ctx);
+	knot_layer_consume(query_ctx, query);
+	int state = knot_layer_produce(query_ctx, answer);
+	ok(state == KNOT_STATE_DONE && server->expensive_queries == 0,
+	   "ns: expensive query admitted and released");
+
+	/* Over the limit over TCP. */
+	server->expensive_queries = 1;
+	knot_layer_reset(query_ctx);
+	knot_pkt_clear(answer);
+	knot_layer_consume(query_ctx, query);
+	state = knot_layer_produce(query_ctx, answer);
+	if (state == KNOT_STATE_FAIL) {
+		state = knot_layer_produce(query_ctx, answer);
+	}
+	ok(state == KNOT_STATE_DONE &&
+	   knot_wire_get_rcode(answer->wire) == KNOT_RCODE_REFUSED,
+	   "ns: expensive query over the limit refused");
+
+	/* Over the limit over UDP. */
+	param->proc_flags |= NS_QUERY_LIMIT_SIZE;
+	knot_layer_reset(query_ctx);
+	knot_pkt_clear(answer);
+	knot_layer_consume(query_ctx, query);
+	state = knot_layer_produce(query_ctx, answer);
+	ok(state == KNOT_STATE_DONE && knot_wire_get_tc(answer->wire),
+	   "ns: expensive query over the limit truncated");
+	is_int(0, knot_wire_get_ancount(answer->wire), "ns: truncated answer empty");
+	param->proc_flags &= ~NS_QUERY_LIMIT_SIZE;
+
+	ok(server->expensive_queries == 1, "ns: refused queries hold no slot");
+	server->expensive_queries = 0;
+	conf()->cache.srv_max_expensive_queries = 0;
+
+	knot_pkt_free(&answer);
+}
+
+/* Resolve a query with the EDNS TCP keepalive option (3 TAP tests). */
+static void exec_keepalive_query(knot_layer_t *query_ctx, knot_pkt_t *query,
+                                 struct process_query_param *param)
+{
+	knot_pkt_t *answer = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	assert(answer);
+
+	const uint8_t data[] = { 0x00, 0x01 };
+	for (int len = 0; len <= sizeof(data); len += sizeof(data)) {
+		knot_rrset_t opt;
+		knot_edns_init(&opt, KNOT_EDNS_MAX_UDP_PAYLOAD, 0, KNOT_EDNS_VERSION, NULL);
+		knot_edns_add_option(&opt, KNOT_EDNS_OPTION_TCP_KEEPALIVE, len, data, NULL);
+		knot_pkt_clear(query);
+		knot_pkt_put_question(query, ROOT_DNAME, KNOT_CLASS_IN, KNOT_RRTYPE_SOA);
+		knot_pkt_begin(query, KNOT_ADDITIONAL);
+		knot_pkt_put(query, KNOT_COMPR_HINT_NONE, &opt, 0);
+		knot_pkt_parse(query, 0);
+
+		/* UDP first, then TCP with a 20 s idle timeout. */
+		for (unsigned keepalive = 0; keepalive <= 20; keepalive += 20) {
+			if (len > 0 && keepalive == 0) {
+				continue;
+			}
+			param->tcp_keepalive = keepalive;
+			knot_layer_reset(query_ctx);
+			knot_pkt_clear(answer);
+			knot_layer_consume(query_ctx, query);
+			int state = knot_layer_produce(query_ctx, answer);
+			if (state == KNOT_STATE_FAIL) {
+				state = knot_layer_produce(query_ctx, answer);
+			}
+			knot_pkt_parse(answer, 0);
+
+			uint16_t timeout = 0;
+			uint8_t *option = NULL;
+			if (answer->opt_rr != NULL) {
+				option = knot_edns_get_option(answer->opt_rr,
+				                              KNOT_EDNS_OPTION_TCP_KEEPALIVE);
+			}
+			if (option != NULL) {
+				knot_edns_keepalive_parse(&timeout,
+				                          knot_edns_opt_get_data(option),
+				                          knot_edns_opt_get_length(option));
+			}
+
+			if (len > 0) {
+				is_int(KNOT_RCODE_FORMERR, knot_wire_get_rcode(answer->wire),
+				       "ns: keepalive with data refused");
+			} else if (keepalive == 0) {
+				ok(state == KNOT_STATE_DONE && option == NULL,
+				   "ns: keepalive ignored over UDP");
+			} else {
+				ok(state == KNOT_STATE_DONE && timeout == 200,
+				   "ns: keepalive timeout advertised over TCP");
+			}
+		}
+
+		knot_rrset_clear(&opt, NULL);
+	}
+	param->tcp_keepalive = 0;
+
+	knot_pkt_clear(query);
+	knot_pkt_put_question(query, ROOT_DNAME, KNOT_CLASS_IN, KNOT_RRTYPE_SOA);
+
+	knot_pkt_free(&answer);
+}
+
+/* Query plan step suspending the processing once. */
+static int yield_step(int state, knot_pkt_t *pkt, struct query_data *qdata, void *ctx)
+{
+	/* The context is not available if the suspended step is abandoned. */
+	int *calls = (ctx != NULL) ? ctx : qdata->yield.data;
+	*calls += 1;
+
+	if (qdata->yield.data == NULL) {
+		if (!process_query_can_yield(qdata)) {
+			return state;
+		}
+		return process_query_yield(qdata, -1, 0, 100, calls);
+	}
+
+	return (qdata->yield.revents == POLLIN) ? state : KNOT_STATE_FAIL;
+}
+
+/* Resolve query with a suspending step (7 TAP tests). */
+static void exec_yield_query(knot_layer_t *query_ctx, knot_pkt_t *query,
+                             struct process_query_param *param)
+{
+	knot_pkt_t *answer = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	assert(answer);
+
+	struct query_plan *orig_plan = conf()->query_plan;
+	struct query_plan *plan = query_plan_create(NULL);
+	int calls = 0;
+	query_plan_step(plan, QPLAN_BEGIN, yield_step, &calls);
+	conf()->query_plan = plan;
+
+	/* Suspension not allowed. */
+	knot_layer_reset(query_ctx);
+	knot_pkt_parse(query, 0);
+	knot_layer_consume(query_ctx, query);
+	int state = knot_layer_produce(query_ctx, answer);
+	ok(state == KNOT_STATE_DONE && calls == 1, "ns: step not suspended without NS_QUERY_YIELD");
+
+	/* Suspend and resume. */
+	param->proc_flags |= NS_QUERY_YIELD;
+	calls = 0;
+	knot_layer_reset(query_ctx);
+	knot_pkt_clear(answer);
+	knot_layer_consume(query_ctx, query);
+	state = knot_layer_produce(query_ctx, answer);
+	struct query_data *qdata = query_ctx->data;
+	ok(state == KNOT_STATE_YIELD && qdata->yield.fd == -1 &&
+	   qdata->yield.timeout == 100, "ns: step suspended");
+	qdata->yield.revents = POLLIN;
+	state = knot_layer_produce(query_ctx, answer);
+	ok(state == KNOT_STATE_DONE && calls == 2, "ns: step resumed");
+	is_int(KNOT_RCODE_NOERROR, knot_wire_get_rcode(answer->wire),
+	       "ns: resumed answer RCODE");
+
+	/* Suspend, replace the plan and resume. */
+	calls = 0;
+	knot_layer_reset(query_ctx);
+	knot_pkt_clear(answer);
+	knot_layer_consume(query_ctx, query);
+	state = knot_layer_produce(query_ctx, answer);
+	ok(state == KNOT_STATE_YIELD, "ns: step suspended before plan change");
+	struct query_plan *new_plan = query_plan_create(NULL);
+	query_plan_step(new_plan, QPLAN_BEGIN, yield_step, &calls);
+	conf()->query_plan = new_plan;
+	qdata->yield.revents = POLLIN;
+	state = knot_layer_produce(query_ctx, answer);
+	ok(state == KNOT_STATE_FAIL && calls == 2 && qdata->yield.data == NULL,
+	   "ns: step abandoned after plan change");
+	while (state == KNOT_STATE_FAIL) {
+		state = knot_layer_produce(query_ctx, answer);
+	}
+	is_int(KNOT_RCODE_SERVFAIL, knot_wire_get_rcode(answer->wire),
+	       "ns: abandoned answer RCODE");
+	param->proc_flags &= ~NS_QUERY_YIELD;
+
+	conf()->query_plan = orig_plan;
+	query_plan_free(plan);
+	query_plan_free(new_plan);
+	knot_pkt_free(&answer);
+}
+
 /* \internal Helpers */
 #define WIRE_COPY(dst, dst_len, src, src_len) \
 	memcpy(dst, src, src_len); \
@@ -77,7 +325,7 @@ static void exec_query(knot_layer_t *query_ctx, const char *name,
 
 int main(int argc, char *argv[])
 {
-	plan(8*6 + 4); /* exec_query = 6 TAP tests */
+	plan(8*6 + 4 + 3 + 7 + 5 + 3 + 2); /* exec_query = 6 TAP tests */
 
 	knot_mm_t mm;
 	mm_ctx_mempool(&mm, MM_DEFAULT_BLKSIZE);
@@ -117,6 +365,40 @@ int main(int argc, char *argv[])
 	knot_pkt_put_question(query, ROOT_DNAME, KNOT_CLASS_IN, KNOT_RRTYPE_SOA);
 	exec_query(&proc, "IN/root", query, KNOT_RCODE_NOERROR);
 
+	/* Query processor (expensive query limit). */
+	exec_expensive_query(&proc, query, &param);
+
+	/* Query processor (EDNS TCP keepalive). */
+	exec_keepalive_query(&proc, query, &param);
+
+	/* Query processor (suspended step). */
+	exec_yield_query(&proc, query, &param);
+
+	/* Query processor (zone alias of the root zone). */
+	zone_t *alias = zone_new(EXAMPLE_DNAME);
+	alias->alias_of = knot_dname_copy(ROOT_DNAME, NULL);
+	knot_zonedb_insert(server.zone_db, alias);
+	knot_zonedb_build_index(server.zone_db);
+
+	/* Query processor (DNSSEC records of the aliased zone). */
+	static const uint8_t NSEC_RDATA[] = { 0x00, 0x00, 0x01, 0x22 };
+	zone_t *root = knot_zonedb_find(server.zone_db, ROOT_DNAME);
+	knot_rrset_t *nsec = knot_rrset_new(root->name, KNOT_RRTYPE_NSEC,
+	                                    KNOT_CLASS_IN, NULL);
+	knot_rrset_add_rdata(nsec, NSEC_RDATA, sizeof(NSEC_RDATA), 7200, NULL);
+	node_add_rrset(root->contents->apex, nsec, NULL);
+	knot_rrset_free(&nsec, NULL);
+	knot_layer_reset(&proc);
+	knot_pkt_clear(query);
+	knot_pkt_put_question(query, EXAMPLE_DNAME, KNOT_CLASS_IN, KNOT_RRTYPE_NSEC);
+	exec_alias_dnssec_query(&proc, query);
+
+	/* Query processor (names rewritten to the zone alias). */
+	knot_layer_reset(&proc);
+	knot_pkt_clear(query);
+	knot_pkt_put_question(query, EXAMPLE_DNAME, KNOT_CLASS_IN, KNOT_RRTYPE_SOA);
+	exec_alias_query(&proc, query, EXAMPLE_DNAME);
+
 	/* Query processor (-1 bytes, not enough data). */
 	knot_layer_reset(&proc);
 	query->size -= 1;
@@ -0,0 +1,112 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <tap/basic.h>
+
+#include "dnssec/crypto.h"
+#include "dnssec/error.h"
+#include "dnssec/key.h"
+#include "knot/dnssec/rrsig-cache.h"
+#include "libknot/errcode.h"
+
+static uint8_t ECDSA_RDATA[] = {
+	0x01, 0x00, 0x03, 0x0d,
+	0xf2, 0xe0, 0xfb, 0x0b, 0x84, 0xc7, 0x4c, 0xcf, 0xf0, 0xee,
+	0xe8, 0x6b, 0xc9, 0x14, 0x93, 0xa1, 0xe1, 0x3f, 0x8c, 0xa4,
+	0xfb, 0xf3, 0xfa, 0x7c, 0xe7, 0x74, 0x57, 0xd0, 0xbe, 0x44,
+	0xc2, 0xb6, 0x6b, 0x48, 0xb0, 0x6e, 0x6c, 0xb3, 0xe2, 0x07,
+	0x0e, 0xe0, 0x6e, 0xf5, 0x0f, 0xe9, 0x2b, 0x08, 0x81, 0xae,
+	0x59, 0x43, 0x80, 0x92, 0x03, 0x13, 0x66, 0x60, 0x0f, 0xe0,
+	0x66, 0xcb, 0x97, 0xcc,
+};
+
+static dnssec_key_t *make_key(uint16_t flags)
+{
+	dnssec_key_t *key = NULL;
+	if (dnssec_key_new(&key) != DNSSEC_EOK) {
+		return NULL;
+	}
+
+	ECDSA_RDATA[0] = flags >> 8;
+	ECDSA_RDATA[1] = flags & 0xff;
+	dnssec_binary_t rdata = { .data = ECDSA_RDATA, .size = sizeof(ECDSA_RDATA) };
+	if (dnssec_key_set_rdata(key, &rdata) != DNSSEC_EOK) {
+		dnssec_key_free(key);
+		return NULL;
+	}
+
+	return key;
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	dnssec_crypto_init();
+
+	dnssec_key_t *zsk = make_key(256);
+	dnssec_key_t *ksk = make_key(257);
+	ok(zsk != NULL && ksk != NULL, "create keys");
+
+	uint8_t sig1_data[] = "rrsig one";
+	uint8_t sig2_data[] = "rrsig two";
+	uint8_t data1_data[] = "covered one";
+	uint8_t data2_data[] = "covered two";
+	dnssec_binary_t sig1 = { .data = sig1_data, .size = sizeof(sig1_data) };
+	dnssec_binary_t sig2 = { .data = sig2_data, .size = sizeof(sig2_data) };
+	dnssec_binary_t data1 = { .data = data1_data, .size = sizeof(data1_data) };
+	dnssec_binary_t data2 = { .data = data2_data, .size = sizeof(data2_data) };
+
+	rrsig_cache_t *cache = rrsig_cache_new();
+	ok(cache != NULL, "create cache");
+
+	ok(!rrsig_cache_contains(NULL, zsk, &sig1, &data1), "contains, NULL cache");
+	is_int(KNOT_EINVAL, rrsig_cache_add(NULL, zsk, &sig1, &data1), "add, NULL cache");
+
+	ok(!rrsig_cache_contains(cache, zsk, &sig1, &data1), "contains, empty cache");
+	is_int(KNOT_EOK, rrsig_cache_add(cache, zsk, &sig1, &data1), "add");
+	ok(rrsig_cache_contains(cache, zsk, &sig1, &data1), "contains, added");
+	ok(!rrsig_cache_contains(cache, ksk, &sig1, &data1), "contains, other key");
+	ok(!rrsig_cache_contains(cache, zsk, &sig2, &data1), "contains, other signature");
+	ok(!rrsig_cache_contains(cache, zsk, &sig1, &data2), "contains, other data");
+
+	// entries used between begin and sweep are kept, others are dropped
+	is_int(KNOT_EOK, rrsig_cache_add(cache, zsk, &sig2, &data2), "add, second");
+	rrsig_cache_begin(cache);
+	ok(rrsig_cache_contains(cache, zsk, &sig2, &data2), "contains, used");
+	is_int(KNOT_EOK, rrsig_cache_add(cache, ksk, &sig1, &data2), "add, third");
+	rrsig_cache_sweep(cache);
+	ok(!rrsig_cache_contains(cache, zsk, &sig1, &data1), "sweep, unused dropped");
+	ok(rrsig_cache_contains(cache, zsk, &sig2, &data2), "sweep, used kept");
+	ok(rrsig_cache_contains(cache, ksk, &sig1, &data2), "sweep, added kept");
+
+	// sweep without begin keeps everything
+	rrsig_cache_sweep(cache);
+	ok(rrsig_cache_contains(cache, zsk, &sig2, &data2), "sweep, no tracking");
+
+	// other cache instances use other digest secret, still consistent
+	rrsig_cache_t *other = rrsig_cache_new();
+	ok(!rrsig_cache_contains(other, zsk, &sig2, &data2), "contains, other cache");
+	rrsig_cache_free(other);
+
+	rrsig_cache_free(cache);
+	dnssec_key_free(zsk);
+	dnssec_key_free(ksk);
+
+	dnssec_crypto_cleanup();
+
+	return 0;
+}
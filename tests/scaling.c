@@ -0,0 +1,87 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+#include <tap/basic.h>
+
+#include "knot/server/scaling.h"
+
+#define SEC 1000000ULL
+
+/*! \brief Feed a sample of the given utilisation and queue depth. */
+static unsigned feed(scaling_t *sc, scaling_sample_t *total, uint64_t *now,
+                     unsigned active, unsigned min, unsigned max,
+                     unsigned util, unsigned backlog, bool overload)
+{
+	*now += SEC;
+	total->busy += active * SEC * util / 100;
+	total->wakeups += 100;
+	total->backlog += backlog;
+
+	return scaling_update(sc, total, *now, active, min, max, overload);
+}
+
+static void test_update(void)
+{
+	scaling_t sc;
+	memset(&sc, 0, sizeof(sc));
+	scaling_sample_t total = { 0 };
+	uint64_t now = 1000 * SEC;
+
+	/* Baseline. */
+	is_int(4, scaling_update(&sc, &total, now, 4, 1, 8, false), "update: baseline");
+
+	/* Moderate load is kept. */
+	is_int(4, feed(&sc, &total, &now, 4, 1, 8, 50, 0, false), "update: moderate load");
+
+	/* Spike, enough workers for the target utilisation. */
+	is_int(8, feed(&sc, &total, &now, 4, 1, 16, 100, 0, false), "update: spike");
+	is_int(6, feed(&sc, &total, &now, 4, 1, 16, 70, 0, false), "update: high load");
+	is_int(5, feed(&sc, &total, &now, 4, 1, 16, 40, 20, false), "update: at least one more");
+	is_int(6, feed(&sc, &total, &now, 4, 1, 6, 100, 0, false), "update: spike capped");
+
+	/* Queued work and overload add a worker. */
+	is_int(5, feed(&sc, &total, &now, 4, 1, 8, 30, 20, false), "update: queue depth");
+	is_int(4, feed(&sc, &total, &now, 4, 1, 8, 30, 5, false), "update: shallow queue");
+	is_int(5, feed(&sc, &total, &now, 4, 1, 8, 30, 0, true), "update: overload");
+
+	/* Low load parks one worker after several periods. */
+	unsigned active = 4;
+	for (int i = 1; i < SCALING_IDLE_PERIODS; i++) {
+		active = feed(&sc, &total, &now, active, 1, 8, 10, 0, false);
+	}
+	is_int(4, active, "update: short idle time kept");
+	active = feed(&sc, &total, &now, active, 1, 8, 10, 0, false);
+	is_int(3, active, "update: idle worker parked");
+
+	/* Bounds take precedence. */
+	for (int i = 0; i < SCALING_IDLE_PERIODS; i++) {
+		active = feed(&sc, &total, &now, active, 3, 8, 0, 0, false);
+	}
+	is_int(3, active, "update: lower bound");
+	is_int(2, feed(&sc, &total, &now, 6, 1, 2, 50, 0, false), "update: lowered upper bound");
+	is_int(4, feed(&sc, &total, &now, 2, 4, 8, 50, 0, false), "update: raised lower bound");
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	test_update();
+
+	return 0;
+}
@@ -0,0 +1,208 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <gnutls/gnutls.h>
+#include <gnutls/x509.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <tap/basic.h>
+#include <tap/files.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "knot/server/tls.h"
+#include "libknot/errcode.h"
+#include "contrib/string.h"
+
+#define TIMEOUT 2000
+
+static const uint8_t QUERY[] = "query data";
+static const uint8_t REPLY[] = "reply data, longer";
+
+/*! \brief Write a self-signed certificate and its key into the directory. */
+static bool make_cert(const char *cert_file, const char *key_file)
+{
+	gnutls_x509_privkey_t key = NULL;
+	gnutls_x509_crt_t crt = NULL;
+	gnutls_datum_t key_pem = { 0 }, crt_pem = { 0 };
+	bool success = false;
+
+	time_t now = time(NULL);
+	const uint8_t serial[] = { 1 };
+	if (gnutls_x509_privkey_init(&key) < 0 ||
+	    gnutls_x509_privkey_generate(key, GNUTLS_PK_ECDSA,
+	                                 GNUTLS_CURVE_TO_BITS(GNUTLS_ECC_CURVE_SECP256R1), 0) < 0 ||
+	    gnutls_x509_crt_init(&crt) < 0 ||
+	    gnutls_x509_crt_set_version(crt, 3) < 0 ||
+	    gnutls_x509_crt_set_serial(crt, serial, sizeof(serial)) < 0 ||
+	    gnutls_x509_crt_set_activation_time(crt, now - 3600) < 0 ||
+	    gnutls_x509_crt_set_expiration_time(crt, now + 3600) < 0 ||
+	    gnutls_x509_crt_set_dn(crt, "CN=localhost", NULL) < 0 ||
+	    gnutls_x509_crt_set_key(crt, key) < 0 ||
+	    gnutls_x509_crt_sign2(crt, crt, key, GNUTLS_DIG_SHA256, 0) < 0 ||
+	    gnutls_x509_privkey_export2(key, GNUTLS_X509_FMT_PEM, &key_pem) < 0 ||
+	    gnutls_x509_crt_export2(crt, GNUTLS_X509_FMT_PEM, &crt_pem) < 0) {
+		goto cleanup;
+	}
+
+	FILE *fp = fopen(cert_file, "w");
+	if (fp != NULL) {
+		success = fwrite(crt_pem.data, crt_pem.size, 1, fp) == 1;
+		fclose(fp);
+	}
+	fp = fopen(key_file, "w");
+	if (fp != NULL) {
+		success = success && fwrite(key_pem.data, key_pem.size, 1, fp) == 1;
+		fclose(fp);
+	}
+
+cleanup:
+	gnutls_free(key_pem.data);
+	gnutls_free(crt_pem.data);
+	gnutls_x509_crt_deinit(crt);
+	gnutls_x509_privkey_deinit(key);
+
+	return success;
+}
+
+/*! \brief Client side, sends two queries at once and expects two replies. */
+static void *client(void *arg)
+{
+	int fd = *(int *)arg;
+	bool *success = calloc(1, sizeof(bool));
+
+	gnutls_certificate_credentials_t cred = NULL;
+	gnutls_session_t session = NULL;
+	gnutls_certificate_allocate_credentials(&cred);
+	gnutls_init(&session, GNUTLS_CLIENT);
+	gnutls_set_default_priority(session);
+	gnutls_credentials_set(session, GNUTLS_CRD_CERTIFICATE, cred);
+	gnutls_transport_set_int(session, fd);
+
+	int ret;
+	do {
+		ret = gnutls_handshake(session);
+	} while (ret < 0 && gnutls_error_is_fatal(ret) == 0);
+	if (ret != GNUTLS_E_SUCCESS) {
+		goto cleanup;
+	}
+
+	uint8_t msg[2 * (2 + sizeof(QUERY))];
+	for (int i = 0; i < 2; i++) {
+		uint8_t *pos = msg + i * (2 + sizeof(QUERY));
+		pos[0] = 0;
+		pos[1] = sizeof(QUERY);
+		memcpy(pos + 2, QUERY, sizeof(QUERY));
+	}
+	if (gnutls_record_send(session, msg, sizeof(msg)) != sizeof(msg)) {
+		goto cleanup;
+	}
+
+	for (int i = 0; i < 2; i++) {
+		uint8_t reply[2 + sizeof(REPLY)];
+		size_t done = 0;
+		while (done < sizeof(reply)) {
+			ssize_t rcvd = gnutls_record_recv(session, reply + done,
+			                                  sizeof(reply) - done);
+			if (rcvd <= 0) {
+				goto cleanup;
+			}
+			done += rcvd;
+		}
+		if (reply[1] != sizeof(REPLY) || memcmp(reply + 2, REPLY, sizeof(REPLY)) != 0) {
+			goto cleanup;
+		}
+	}
+
+	*success = true;
+cleanup:
+	gnutls_bye(session, GNUTLS_SHUT_WR);
+	gnutls_deinit(session);
+	gnutls_certificate_free_credentials(cred);
+
+	return success;
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	char *dir = test_mkdtemp();
+	char *cert_file = sprintf_alloc("%s/cert.pem", dir);
+	char *key_file = sprintf_alloc("%s/key.pem", dir);
+	ok(make_cert(cert_file, key_file), "create certificate");
+
+	tls_ctx_t *ctx = NULL;
+	char *missing = sprintf_alloc("%s/missing.pem", dir);
+	int ret = tls_ctx_new(&ctx, missing, key_file);
+	ok(ret != KNOT_EOK && ctx == NULL, "load missing certificate");
+	free(missing);
+
+	ret = tls_ctx_new(&ctx, cert_file, key_file);
+	ok(ret == KNOT_EOK && ctx != NULL, "load certificate");
+
+	int fds[2];
+	ret = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+	ok(ret == 0, "create socket pair");
+	fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+	tls_conn_t *conn = tls_conn_new(ctx, fds[0]);
+	ok(conn != NULL, "create connection");
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, client, &fds[1]);
+
+	ret = tls_conn_handshake(conn, TIMEOUT);
+	ok(ret == KNOT_EOK, "handshake");
+	ok(!tls_conn_ktls(conn), "no kernel TLS on UNIX socket");
+
+	/* Both queries arrive in one record, the second one is buffered. */
+	uint8_t buf[64];
+	ssize_t len = tls_dns_recv(conn, buf, sizeof(buf), TIMEOUT);
+	ok(len == sizeof(QUERY) && memcmp(buf, QUERY, len) == 0, "receive first query");
+	ok(tls_conn_pending(conn), "second query buffered");
+	len = tls_dns_send(conn, REPLY, sizeof(REPLY), TIMEOUT);
+	ok(len == sizeof(REPLY), "send first reply");
+
+	len = tls_dns_recv(conn, buf, sizeof(buf), TIMEOUT);
+	ok(len == sizeof(QUERY) && memcmp(buf, QUERY, len) == 0, "receive second query");
+	len = tls_dns_send(conn, REPLY, sizeof(REPLY), TIMEOUT);
+	ok(len == sizeof(REPLY), "send second reply");
+
+	bool *client_ok = NULL;
+	pthread_join(thread, (void **)&client_ok);
+	ok(client_ok != NULL && *client_ok, "client received replies");
+	free(client_ok);
+
+	len = tls_dns_recv(conn, buf, sizeof(buf), TIMEOUT);
+	ok(len < 0, "receive after close");
+
+	tls_conn_free(conn);
+	close(fds[0]);
+	close(fds[1]);
+	tls_ctx_free(ctx);
+
+	test_rm_rf(dir);
+	free(dir);
+	free(cert_file);
+	free(key_file);
+
+	return 0;
+}
@@ -0,0 +1,168 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <tap/basic.h>
+#include <string.h>
+
+#include "knot/nameserver/tsig_ctx.h"
+#include "libknot/libknot.h"
+
+#define MSG_MAX 512
+
+typedef struct {
+	uint8_t wire[MSG_MAX];
+	size_t size;
+} msg_t;
+
+static void msg_init(msg_t *msg, uint16_t qtype)
+{
+	knot_pkt_t *pkt = knot_pkt_new(NULL, sizeof(msg->wire), NULL);
+	knot_wire_set_id(pkt->wire, 0x1234);
+	knot_wire_set_qr(pkt->wire);
+	knot_pkt_put_question(pkt, (const knot_dname_t *)"\x07""example", KNOT_CLASS_IN, qtype);
+	memcpy(msg->wire, pkt->wire, pkt->size);
+	msg->size = pkt->size;
+	knot_pkt_free(&pkt);
+}
+
+static int verify(tsig_ctx_t *ctx, msg_t *msg)
+{
+	knot_pkt_t *pkt = knot_pkt_new(msg->wire, msg->size, NULL);
+	int ret = knot_pkt_parse(pkt, 0);
+	if (ret == KNOT_EOK) {
+		ret = tsig_verify_packet(ctx, pkt);
+	}
+	knot_pkt_free(&pkt);
+
+	return ret;
+}
+
+/*!
+ * \brief Signs the response as a server, the request MAC is set on the first call.
+ */
+static void sign(msg_t *msg, uint8_t *mac, size_t *mac_size, bool next,
+                 const msg_t *unsigned_msg, const knot_tsig_key_t *key)
+{
+	uint8_t digest[TSIG_MAX_DIGEST_SIZE];
+	size_t digest_size = sizeof(digest);
+
+	if (!next) {
+		knot_tsig_sign(msg->wire, &msg->size, sizeof(msg->wire), mac, *mac_size,
+		               digest, &digest_size, key, 0, 0);
+	} else {
+		uint8_t to_sign[2 * MSG_MAX];
+		size_t to_sign_size = 0;
+		if (unsigned_msg != NULL) {
+			memcpy(to_sign, unsigned_msg->wire, unsigned_msg->size);
+			to_sign_size = unsigned_msg->size;
+		}
+		memcpy(to_sign + to_sign_size, msg->wire, msg->size);
+		to_sign_size += msg->size;
+		knot_tsig_sign_next(msg->wire, &msg->size, sizeof(msg->wire), mac, *mac_size,
+		                    digest, &digest_size, key, to_sign, to_sign_size);
+	}
+
+	memcpy(mac, digest, digest_size);
+	*mac_size = digest_size;
+}
+
+static void test_stream(const knot_tsig_key_t *key, bool corrupt)
+{
+	tsig_ctx_t ctx;
+	tsig_init(&ctx, key);
+
+	// Client query.
+
+	msg_t query;
+	msg_init(&query, KNOT_RRTYPE_AXFR);
+	knot_wire_clear_qr(query.wire);
+	knot_pkt_t *pkt = knot_pkt_new(query.wire, sizeof(query.wire), NULL);
+	pkt->size = query.size;
+	int ret = tsig_sign_packet(&ctx, pkt);
+	knot_pkt_free(&pkt);
+	ok(ret == KNOT_EOK, "sign query");
+
+	// Server responses: signed, unsigned, signed, signed.
+
+	uint8_t mac[TSIG_MAX_DIGEST_SIZE];
+	size_t mac_size = ctx.digest_size;
+	memcpy(mac, ctx.digest, mac_size);
+
+	msg_t resp[4];
+	for (int i = 0; i < 4; i++) {
+		msg_init(&resp[i], KNOT_RRTYPE_A + i);
+	}
+	sign(&resp[0], mac, &mac_size, false, NULL, key);
+	sign(&resp[2], mac, &mac_size, true, &resp[1], key);
+	sign(&resp[3], mac, &mac_size, true, NULL, key);
+
+	if (corrupt) {
+		resp[1].wire[resp[1].size - 1] ^= 0xff;
+	}
+
+	ok(verify(&ctx, &resp[0]) == KNOT_EOK && ctx.unsigned_count == 0,
+	   "verify first signed message");
+	ok(verify(&ctx, &resp[1]) == KNOT_EOK && ctx.unsigned_count == 1,
+	   "verify unsigned message");
+	if (corrupt) {
+		ok(verify(&ctx, &resp[2]) == KNOT_TSIG_EBADSIG,
+		   "reject signature over a modified unsigned message");
+	} else {
+		ok(verify(&ctx, &resp[2]) == KNOT_EOK && ctx.unsigned_count == 0,
+		   "verify signature over an unsigned message");
+		ok(verify(&ctx, &resp[3]) == KNOT_EOK, "verify next signed message");
+	}
+
+	tsig_cleanup(&ctx);
+}
+
+static void test_check_compat(const knot_tsig_key_t *key)
+{
+	msg_t msg;
+	msg_init(&msg, KNOT_RRTYPE_SOA);
+
+	uint8_t mac[TSIG_MAX_DIGEST_SIZE] = { 0 };
+	size_t mac_size = 0;
+	sign(&msg, mac, &mac_size, false, NULL, key);
+
+	knot_pkt_t *pkt = knot_pkt_new(msg.wire, msg.size, NULL);
+	knot_pkt_parse(pkt, 0);
+	int ret = knot_tsig_server_check(pkt->tsig_rr, pkt->wire, pkt->size, key);
+	ok(ret == KNOT_EOK, "server check of a signed request");
+
+	knot_wire_set_id(pkt->wire, 0x4321);
+	ret = knot_tsig_server_check(pkt->tsig_rr, pkt->wire, pkt->size, key);
+	ok(ret == KNOT_TSIG_EBADSIG, "server check of a modified request");
+	knot_pkt_free(&pkt);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	knot_tsig_key_t key;
+	int ret = knot_tsig_key_init_str(&key, "hmac-sha256:key.:Wg==");
+	ok(ret == KNOT_EOK, "key init");
+
+	test_stream(&key, false);
+	test_stream(&key, true);
+	test_check_compat(&key);
+
+	knot_tsig_key_deinit(&key);
+
+	return 0;
+}
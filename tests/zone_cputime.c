@@ -0,0 +1,97 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <tap/basic.h>
+
+#include "knot/zone/cputime.h"
+
+static volatile unsigned sink;
+
+static void burn(void)
+{
+	uint64_t begin = zone_cputime_now();
+	while (zone_cputime_now() - begin < 1000000) {
+		sink++;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	zone_cputime_stats_t stats;
+
+	zone_cputime_t *cputime = zone_cputime_new();
+	ok(cputime != NULL, "create counters");
+
+	zone_cputime_get(cputime, &stats);
+	ok(stats.query_ns == 0 && stats.event_count[ZONE_EVENT_LOAD] == 0,
+	   "new counters are zero");
+
+	ok(zone_cputime_now() > 0, "thread CPU time");
+
+	// Queries, one of CPUTIME_SAMPLE is measured.
+	unsigned sampled = 0;
+	uint64_t begin = 0;
+	for (int i = 0; i < CPUTIME_SAMPLE; i++) {
+		uint64_t now = zone_cputime_query_begin();
+		if (now != 0) {
+			sampled++;
+			begin = now;
+		}
+	}
+	ok(sampled == 1, "one query of %u sampled", CPUTIME_SAMPLE);
+
+	burn();
+	zone_cputime_query_end(cputime, begin);
+	zone_cputime_query_end(cputime, 0);
+	zone_cputime_query_end(NULL, begin);
+	zone_cputime_get(cputime, &stats);
+	ok(stats.query_ns >= 1000000 * CPUTIME_SAMPLE &&
+	   stats.query_ns % CPUTIME_SAMPLE == 0, "query time extrapolated");
+
+	// Events.
+	zone_cputime_event(cputime, ZONE_EVENT_LOAD, 1000);
+	zone_cputime_event(cputime, ZONE_EVENT_LOAD, 500);
+	zone_cputime_event(cputime, ZONE_EVENT_DNSSEC, 42);
+	zone_cputime_event(cputime, ZONE_EVENT_COUNT, 1);
+	zone_cputime_event(cputime, ZONE_EVENT_INVALID, 1);
+	zone_cputime_event(NULL, ZONE_EVENT_LOAD, 1);
+	zone_cputime_get(cputime, &stats);
+	ok(stats.event_ns[ZONE_EVENT_LOAD] == 1500 &&
+	   stats.event_count[ZONE_EVENT_LOAD] == 2, "load events summed");
+	ok(stats.event_ns[ZONE_EVENT_DNSSEC] == 42 &&
+	   stats.event_count[ZONE_EVENT_DNSSEC] == 1, "sign event summed");
+	ok(stats.event_count[ZONE_EVENT_FLUSH] == 0, "other events untouched");
+
+	zone_cputime_get(NULL, &stats);
+	ok(stats.query_ns == 0, "no counters");
+
+	// Shared counters, e.g. by a reloaded zone.
+	zone_cputime_t *shared = zone_cputime_ref(cputime);
+	ok(shared == cputime, "counters referenced");
+	zone_cputime_free(cputime);
+	zone_cputime_event(shared, ZONE_EVENT_LOAD, 500);
+	zone_cputime_get(shared, &stats);
+	ok(stats.event_ns[ZONE_EVENT_LOAD] == 2000 &&
+	   stats.event_count[ZONE_EVENT_LOAD] == 3, "shared counters kept");
+
+	zone_cputime_free(shared);
+	zone_cputime_free(NULL);
+
+	return 0;
+}
@@ -14,6 +14,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <signal.h>
 #include <tap/basic.h>
 
 #include "knot/common/evsched.h"
@@ -67,10 +68,71 @@ static void test_scheduling(zone_t *zone)
 	// zone_events_start
 }
 
+static zone_t *zone_with_events(worker_pool_t *pool, evsched_t *sched)
+{
+	zone_t *zone = zone_new((const knot_dname_t *)"\x07""example");
+	if (zone != NULL) {
+		zone_events_setup(zone, pool, sched, NULL, NULL);
+	}
+	return zone;
+}
+
+static void test_handover(worker_pool_t *pool, evsched_t *sched)
+{
+	// Idle old zone.
+
+	zone_t *old_zone = zone_with_events(pool, sched);
+	zone_t *zone = zone_with_events(pool, sched);
+	zone_events_freeze(old_zone);
+	zone_events_handover(old_zone, zone);
+	ok(zone->events.running, "handover, new zone held");
+
+	zone_contents_t *contents = zone_contents_new(zone->name);
+	zone_switch_contents(old_zone, contents);
+	ok(zone->contents == contents, "handover, contents passed over");
+
+	zone_events_schedule(old_zone, ZONE_EVENT_FLUSH, 1000);
+	ok(zone_events_is_scheduled(zone, ZONE_EVENT_FLUSH) &&
+	   !zone_events_is_scheduled(old_zone, ZONE_EVENT_FLUSH),
+	   "handover, planning passed over");
+
+	zone_events_retire(old_zone);
+	ok(!zone->events.running && zone->contents == contents,
+	   "handover, new zone released by idle old zone");
+	zone_free(&zone);
+
+	// Old zone with a queued event, the pool isn't started yet.
+
+	old_zone = zone_with_events(pool, sched);
+	zone = zone_with_events(pool, sched);
+	zone_events_enqueue(old_zone, ZONE_EVENT_NOTIFY);
+	zone_events_freeze(old_zone);
+	zone_events_handover(old_zone, zone);
+	zone_events_retire(old_zone);
+	ok(zone->events.running, "handover, new zone held by queued event");
+
+	worker_pool_start(pool);
+	worker_pool_wait(pool);
+	ok(!zone->events.running, "handover, new zone released after queued event");
+	ok(zone_events_is_scheduled(zone, ZONE_EVENT_NOTIFY),
+	   "handover, queued event migrated");
+	zone_free(&zone);
+}
+
+static void interrupt_handle(int s)
+{
+}
+
 int main(void)
 {
 	plan_lazy();
 
+	struct sigaction sa;
+	sa.sa_handler = interrupt_handle;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sigaction(SIGALRM, &sa, NULL); // Interrupt
+
 	int r;
 
 	evsched_t sched = { 0 };
@@ -86,12 +148,17 @@ int main(void)
 	r = zone_events_init(&zone);
 	ok(r == KNOT_EOK, "zone events init");
 
-	r = zone_events_setup(&zone, pool, &sched, NULL);
+	r = zone_events_setup(&zone, pool, &sched, NULL, NULL);
 	ok(r == KNOT_EOK, "zone events setup");
 
 	test_scheduling(&zone);
 
 	zone_events_deinit(&zone);
+
+	test_handover(pool, &sched);
+
+	worker_pool_stop(pool);
+	worker_pool_join(pool);
 	worker_pool_destroy(pool);
 	evsched_deinit(&sched);
 
@@ -0,0 +1,120 @@
+/*  Copyright (C) 2016 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <tap/basic.h>
+
+#include "knot/zone/warm-up.h"
+#include "libknot/libknot.h"
+
+static zone_contents_t *make_zone(void)
+{
+	knot_dname_t *apex = knot_dname_from_str_alloc("example.com.");
+	zone_contents_t *contents = zone_contents_new(apex);
+	knot_dname_free(&apex, NULL);
+	if (contents == NULL) {
+		return NULL;
+	}
+
+	for (int i = -1; i < 100; i++) {
+		char owner[64];
+		if (i < 0) {
+			/* Nodes are chained from the non-empty apex. */
+			snprintf(owner, sizeof(owner), "example.com.");
+		} else {
+			snprintf(owner, sizeof(owner), "host%d.example.com.", i);
+		}
+		knot_dname_t *name = knot_dname_from_str_alloc(owner);
+		knot_rrset_t *rr = knot_rrset_new(name, KNOT_RRTYPE_A,
+		                                  KNOT_CLASS_IN, NULL);
+		knot_dname_free(&name, NULL);
+
+		uint8_t a[4] = { 192, 0, 2, i };
+		zone_node_t *node = NULL;
+		if (rr == NULL ||
+		    knot_rrset_add_rdata(rr, a, sizeof(a), 3600, NULL) != KNOT_EOK ||
+		    zone_contents_add_rr(contents, rr, &node) != KNOT_EOK) {
+			knot_rrset_free(&rr, NULL);
+			zone_contents_deep_free(&contents);
+			return NULL;
+		}
+		knot_rrset_free(&rr, NULL);
+	}
+
+	if (zone_contents_adjust_full(contents) != KNOT_EOK) {
+		zone_contents_deep_free(&contents);
+	}
+
+	return contents;
+}
+
+/*! \brief Record the name once, regardless of the sampling state. */
+static void record(zone_hot_t *hot, const char *str)
+{
+	knot_dname_t *name = knot_dname_from_str_alloc(str);
+	for (int i = 0; i < WARM_UP_SAMPLE; i++) {
+		zone_hot_record(hot, name);
+	}
+	knot_dname_free(&name, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	zone_contents_t *contents = make_zone();
+	ok(contents != NULL, "create zone contents");
+	if (contents == NULL) {
+		return 1;
+	}
+
+	ok(zone_warm_up(NULL, NULL, true) == 0, "warm-up without contents");
+	ok(zone_warm_up(contents, NULL, true) == 0, "full warm-up without recent names");
+
+	zone_hot_t *hot = zone_hot_new();
+	ok(hot != NULL, "create recent names");
+	ok(zone_warm_up(contents, hot, false) == 0, "warm-up with no recent names");
+
+	record(hot, "host0.example.com.");
+	record(hot, "HOST2.Example.com.");
+	record(hot, "missing.example.com.");
+	record(hot, "example.org.");
+	ok(zone_warm_up(contents, hot, false) == 3, "recent names in the zone resolved");
+	ok(zone_warm_up(contents, hot, true) == 3, "recent names resolved after full walk");
+
+	for (int i = 0; i < 2 * WARM_UP_NAMES; i++) {
+		char owner[64];
+		snprintf(owner, sizeof(owner), "host%d.example.com.", i);
+		record(hot, owner);
+	}
+	ok(zone_warm_up(contents, hot, false) == WARM_UP_NAMES, "ring of recent names wraps");
+
+	/* Sampling without a ring must not store the name anywhere. */
+	zone_hot_t *empty = zone_hot_new();
+	record(NULL, "host1.example.com.");
+	ok(zone_warm_up(contents, empty, false) == 0 &&
+	   zone_warm_up(contents, NULL, false) == 0,
+	   "sampling without recent names");
+	record(empty, "host1.example.com.");
+	ok(zone_warm_up(contents, empty, false) == 1, "single recent name resolved");
+
+	zone_hot_free(empty);
+	zone_hot_free(hot);
+	zone_contents_deep_free(&contents);
+
+	return 0;
+}